@@ -30,6 +30,10 @@ include_directories(${UT_INC})
 link_directories(${UT_LIB} ${RVS_LIB_DIR})
 
 file(GLOB TESTSOURCES RELATIVE ${CMAKE_CURRENT_SOURCE_DIR} test/test*.cpp )
+## tests not to be built in this configuration
+if(UT_EXCLUDE)
+  list(REMOVE_ITEM TESTSOURCES ${UT_EXCLUDE})
+endif()
 #message ( "TESTSOURCES: ${TESTSOURCES}" )
 
 
@@ -0,0 +1,1112 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/gst_worker.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <iostream>
+
+#include "include/rvs_blas.h"
+#include "include/gpu_util.h"
+#include "include/rvs_module.h"
+#include "include/rvsloglp.h"
+
+#define MODULE_NAME                             "gst"
+
+#define GST_MEM_ALLOC_ERROR                     "memory allocation error!"
+#define GST_BLAS_ERROR                          "memory/blas error!"
+#define GST_BLAS_MEMCPY_ERROR                   "HostToDevice mem copy error!"
+
+#define GST_MAX_GFLOPS_OUTPUT_KEY               "Gflop"
+#define GST_FLOPS_PER_OP_OUTPUT_KEY             "flops_per_op"
+#define GST_BYTES_COPIED_PER_OP_OUTPUT_KEY      "bytes_copied_per_op"
+#define GST_TRY_OPS_PER_SEC_OUTPUT_KEY          "try_ops_per_sec"
+
+#define GST_LOG_GFLOPS_INTERVAL_KEY             "Gflops"
+#define GST_LOG_STREAM_KEY                      "stream"
+#define GST_COPY_BANDWIDTH_KEY                  "PCIe GBps"
+#define GST_GFLOPS_MEAN_KEY                     "Gflops mean"
+#define GST_GFLOPS_MIN_KEY                      "Gflops min"
+#define GST_GFLOPS_P5_KEY                       "Gflops p5"
+#define GST_GFLOPS_P50_KEY                      "Gflops p50"
+#define GST_GFLOPS_P95_KEY                      "Gflops p95"
+#define GST_GFLOPS_CV_KEY                       "Gflops cv"
+#define GST_TIME_TO_THROTTLE_KEY                "time to throttle ms"
+#define GST_PASS_METRIC_KEY                     "pass metric"
+#define GST_VERIFY_MISMATCH_MSG                 "GEMM result mismatch"
+#define GST_VERIFY_TILES_KEY                    "verified tiles"
+#define GST_VERIFY_CHECKED_KEY                  "verified elements"
+#define GST_VERIFY_SKIPPED_KEY                  "skipped elements"
+#define GST_VERIFY_ERRORS_KEY                   "mismatched elements"
+#define GST_VERIFY_UNVERIFIED_KEY               "unverified tiles"
+#define GST_VERIFY_UNVERIFIED_MSG               "GEMM result tile not verified"
+#define GST_JSON_LOG_GPU_ID_KEY                 "gpu_id"
+
+#define PROC_DEC_INC_SGEMM_FREQ_DELAY           10
+
+#define NMAX_MS_GPU_RUN_PEAK_PERFORMANCE        1000
+#define NMAX_MS_SGEMM_OPS_RAMP_SUB_INTERVAL     1000
+#define USLEEP_MAX_VAL                          (1000000 - 1)
+
+#define GST_COPY_MATRIX_MSG                     "copy matrix"
+#define GST_START_MSG                           "start"
+#define GST_PASS_KEY                            "pass"
+#define GST_RAMP_EXCEEDED_MSG                   "ramp time exceeded"
+#define GST_TARGET_ACHIEVED_MSG                 "target achieved"
+#define GST_STRESS_VIOLATION_MSG                "stress violation"
+#define GST_MATRIX_SEED_MSG                     "matrix seed"
+#define GST_GEMM_TIMING_MSG                     "gemm timing"
+#define GST_AUTOTUNE_MSG                        "autotune"
+
+//! how long each autotune candidate is measured
+#define GST_AUTOTUNE_CANDIDATE_MS               500
+
+using std::string;
+
+bool GSTWorker::bjson = false;
+
+GSTWorker::GSTWorker() {
+    autotune = false;
+    throttle_threshold = 0.1;
+    pass_metric = "max";
+    verify_interval = 0;
+    trans_a = false;
+    trans_b = true;
+}
+GSTWorker::~GSTWorker() {}
+
+/**
+ * @brief performs the rvsBlas setup
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::setup_blas(int *error, string *err_description) {
+    *error = 0;
+    // setup rvsBlas
+    gpu_blas = std::unique_ptr<rvs_blas>(
+        new rvs_blas(gpu_device_index, matrix_size_a, matrix_size_b,
+                     matrix_size_c, gst_ops_type, streams, batch_count));
+
+    if (!gpu_blas) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+
+    if (gpu_blas->error()) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+    gpu_blas->set_transpose(trans_a, trans_b);
+
+    // generate random matrix & copy it to the GPU
+    gpu_blas->generate_random_matrix_data(matrix_seed, matrix_cache_dir);
+    if (gpu_blas->error()) {
+        *error = 1;
+        *err_description = GST_MEM_ALLOC_ERROR;
+        return;
+    }
+    if (!copy_matrix || !per_call_timing) {
+        // copy matrix only once (C is not re-uploaded by the copy pipeline)
+        if (!gpu_blas->copy_data_to_gpu()) {
+            *error = 1;
+            *err_description = GST_BLAS_MEMCPY_ERROR;
+            return;
+        }
+    }
+    if (copy_matrix && !per_call_timing) {
+        // upload next operands while the current GEMMs run
+        if (!gpu_blas->enable_copy_pipeline()) {
+            *error = 1;
+            *err_description = GST_BLAS_MEMCPY_ERROR;
+        }
+    }
+}
+
+/**
+ * @brief builds autotune cache key of this GPU and workload
+ * @return cache key (device id, VBIOS version, GEMM type, streams, batch)
+ */
+string GSTWorker::get_autotune_key(void) {
+    hipDeviceProp_t props;
+    string device_id = "unknown", vbios;
+    char path[128];
+
+    if (hipGetDeviceProperties(&props, gpu_device_index) == hipSuccess) {
+        uint16_t dev_id;
+        uint16_t location_id = (((unsigned int) (props.pciBusID)) << 8) |
+                               (props.pciDeviceID);
+        if (!rvs::gpulist::location2device(location_id, &dev_id))
+            device_id = std::to_string(dev_id);
+
+        snprintf(path, sizeof(path),
+                 "/sys/bus/pci/devices/%04x:%02x:%02x.0/vbios_version",
+                 props.pciDomainID, props.pciBusID, props.pciDeviceID);
+        std::ifstream vbios_file(path);
+        std::getline(vbios_file, vbios);
+    }
+
+    return rvs::gemmtune::make_key(device_id, vbios, gst_ops_type, streams,
+                                   batch_count);
+}
+
+/**
+ * @brief measures sustained Gflops of one autotune candidate
+ * @param candidate matrix size and transposition
+ * @return Gflops, 0 if candidate could not be run (e.g. out of memory)
+ */
+double GSTWorker::measure_candidate(
+                            const rvs::gemmtune::candidate_t& candidate) {
+    std::chrono::time_point<std::chrono::system_clock> start_time;
+    double seconds = 0, total_seconds = 0;
+    uint64_t num_ops = 0;
+
+    rvs_blas blas(gpu_device_index, candidate.m, candidate.n, candidate.k,
+                  gst_ops_type, streams, batch_count);
+    if (blas.error())
+        return 0;
+    blas.set_transpose(candidate.trans_a, candidate.trans_b);
+    blas.generate_random_matrix_data(matrix_seed, matrix_cache_dir);
+    if (blas.error() || !blas.copy_data_to_gpu())
+        return 0;
+
+    // warm-up (kernel selection, clocks) is not measured
+    if (!blas.run_blass_gemm_batch(1, false, &seconds))
+        return 0;
+
+    start_time = std::chrono::system_clock::now();
+    while (time_diff(std::chrono::system_clock::now(), start_time) <
+                GST_AUTOTUNE_CANDIDATE_MS && !rvs::lp::Stopping()) {
+        if (!blas.run_blass_gemm_batch(batch_size, false, &seconds))
+            return 0;
+        total_seconds += seconds;
+        num_ops += static_cast<uint64_t>(batch_size) * blas.get_streams();
+    }
+
+    if (total_seconds <= 0)
+        return 0;
+    return blas.gemm_gflop_count() * num_ops / total_seconds / 1e9;
+}
+
+/**
+ * @brief picks matrix size and transposition giving the highest sustained
+ * Gflops
+ *
+ * Winner is looked up in the autotune cache first. If this GPU and workload
+ * are not cached, all candidates are measured and the winner is stored.
+ * Configured matrix sizes are kept if no candidate could be run.
+ */
+void GSTWorker::do_autotune(void) {
+    rvs::gemmtune::candidate_t best;
+    string msg, key = get_autotune_key();
+
+    bool cached = !autotune_cache.empty() &&
+                  rvs::gemmtune::load(autotune_cache, key, &best);
+
+    if (!cached) {
+        rvs::gemmtune tune;
+        auto candidates = rvs::gemmtune::get_candidates(autotune_sizes);
+        for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+            if (rvs::lp::Stopping())
+                return;
+            it->gflops = measure_candidate(*it);
+            tune.add(*it);
+
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG +
+                    " size: " + std::to_string(it->m) +
+                    " trans_a: " + (it->trans_a ? "true" : "false") +
+                    " trans_b: " + (it->trans_b ? "true" : "false") + " " +
+                    GST_LOG_GFLOPS_INTERVAL_KEY + " " +
+                    std::to_string(it->gflops);
+            rvs::lp::Log(msg, rvs::logdebug);
+        }
+
+        if (!tune.get_best(&best)) {
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG +
+                    " failed, using configured matrix size";
+            rvs::lp::Log(msg, rvs::loginfo);
+            return;
+        }
+
+        if (!autotune_cache.empty() &&
+            !rvs::gemmtune::save(autotune_cache, key, best)) {
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                    std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG +
+                    " cannot write " + autotune_cache;
+            rvs::lp::Log(msg, rvs::logdebug);
+        }
+    }
+
+    matrix_size_a = best.m;
+    matrix_size_b = best.n;
+    matrix_size_c = best.k;
+    trans_a = best.trans_a;
+    trans_b = best.trans_b;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_AUTOTUNE_MSG +
+            (cached ? " (cached)" : "") +
+            " m: " + std::to_string(best.m) +
+            " n: " + std::to_string(best.n) +
+            " k: " + std::to_string(best.k) +
+            " trans_a: " + (best.trans_a ? "true" : "false") +
+            " trans_b: " + (best.trans_b ? "true" : "false") + " " +
+            GST_LOG_GFLOPS_INTERVAL_KEY + " " + std::to_string(best.gflops);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(GST_AUTOTUNE_MSG, std::to_string(best.m) + "x" +
+                std::to_string(best.n) + "x" + std::to_string(best.k),
+                rvs::loginfo);
+}
+
+/**
+ * @brief attempts to hit the maximum Gflops value
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ */
+void GSTWorker::hit_max_gflops(int *error, string *err_description) {
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                                    gst_end_time,
+                                                    gst_log_interval_time;
+    double seconds_elapsed = 0, curr_gflops;
+    uint16_t num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops;
+    string msg;
+
+    *error = 0;
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            break;
+
+        gst_end_time = std::chrono::system_clock::now();
+        if (time_diff(gst_end_time, gst_start_time) >=
+                            NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            break;
+
+        if (copy_matrix) {
+            // copy matrix before each GEMM
+            if (!gpu_blas->copy_data_to_gpu()) {
+                *error = 1;
+                *err_description = GST_BLAS_MEMCPY_ERROR;
+                return;
+            }
+        }
+
+        // run GEMM & wait for completion
+        if (!gpu_blas->run_blass_gemm())
+            continue;  // failed to run the current SGEMM
+
+        while (!gpu_blas->is_gemm_op_complete()) {}
+
+        num_sgemm_ops_log_interval++;
+
+        gst_end_time = std::chrono::system_clock::now();
+        millis_sgemm_ops = time_diff(gst_end_time, gst_log_interval_time);
+
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double> (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed != 0) {
+                curr_gflops = static_cast<double>(gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                log_interval_gflops(curr_gflops);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            gst_log_interval_time = std::chrono::system_clock::now();
+        }
+    }
+}
+
+/**
+ * @brief runs GEMMs and measures the Gflops they achieved
+ *
+ * In per-call mode a single GEMM per stream is run and timed from the host
+ * around a device synchronization. Otherwise batch_size GEMMs are enqueued
+ * on each stream and the batches are timed with HIP events. Gflops of each
+ * stream are stored in stream_gflops.
+ *
+ * @param num_ops [out] number of GEMMs that were run (on all streams)
+ * @param gflops [out] aggregate Gflops achieved by the GEMMs
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if the GEMMs were run and timed, false otherwise
+ */
+bool GSTWorker::run_timed_gemms(uint64_t *num_ops, double *gflops,
+                                int *error, string *err_description) {
+    uint64_t start_time, end_time;
+    double seconds = 0;
+    std::vector<double> stream_seconds;
+
+    *num_ops = 0;
+    *gflops = 0;
+
+    if (per_call_timing) {
+        if (copy_matrix) {
+            // copy matrix before each GEMM
+            if (!gpu_blas->copy_data_to_gpu()) {
+                *error = 1;
+                *err_description = GST_BLAS_MEMCPY_ERROR;
+                return false;
+            }
+        }
+
+        // run GEMM(s) & wait for completion
+        start_time = gpu_blas->get_time_us();
+        for (uint32_t s = 0; s < streams; s++) {
+            if (!gpu_blas->run_blass_gemm(s)) {
+                *error = 1;
+                *err_description = GST_BLAS_ERROR;
+                return false;
+            }
+        }
+        end_time = gpu_blas->get_time_us();
+
+        *num_ops = streams;
+        seconds = (end_time - start_time) / 1e6;
+        // streams cannot be told apart when timed from the host
+        stream_seconds.assign(streams, seconds);
+    } else {
+        if (!gpu_blas->run_blass_gemm_batch(batch_size, copy_matrix,
+                                            &seconds, &stream_seconds)) {
+            *error = 1;
+            *err_description = GST_BLAS_ERROR;
+            return false;
+        }
+        *num_ops = static_cast<uint64_t>(batch_size) * streams;
+    }
+
+    if (seconds > 0)
+        *gflops = gpu_blas->gemm_gflop_count() * *num_ops / seconds / 1e9;
+
+    stream_gflops.assign(streams, 0);
+    stream_max_gflops.resize(streams, 0);
+    for (uint32_t s = 0; s < streams && s < stream_seconds.size(); s++) {
+        if (stream_seconds[s] <= 0)
+            continue;
+        stream_gflops[s] = gpu_blas->gemm_gflop_count() * *num_ops / streams
+                           / stream_seconds[s] / 1e9;
+        if (stream_gflops[s] > stream_max_gflops[s])
+            stream_max_gflops[s] = stream_gflops[s];
+    }
+
+    return true;
+}
+
+/**
+ * @brief performs the ramp-up on the given GPU (attempts to reach the given 
+ * target stress Gflops)
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if target stress is achieved within the ramp_interval,
+ * false otherwise
+ */
+bool GSTWorker::do_gst_ramp(int *error, string *err_description) {
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                                    gst_end_time,
+                                                    gst_log_interval_time,
+                                                    gst_start_gflops_time,
+                                                    gst_last_sgemm_start_time,
+                                                    gst_last_sgemm_end_time;
+    double seconds_elapsed, curr_gflops, dyn_delay_target_stress;
+    uint64_t num_sgemm_ops = 0, num_sgemm_ops_log_interval = 0;
+    uint64_t millis_sgemm_ops, millis_last_sgemm;
+    uint16_t proc_delay = 0;
+    uint64_t num_last_sgemm;
+    double gflops_interval;
+    string msg;
+
+    // make sure that the ramp_interval & duration are not less than
+    // NMAX_MS_GPU_RUN_PEAK_PERFORMANCE (e.g.: 1000)
+    if (run_duration_ms < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        run_duration_ms += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+    if (ramp_interval < NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+        ramp_interval += NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+
+    // stage 0. pick matrix size & transposition
+    if (autotune)
+        do_autotune();
+
+    // stage 1. setup rvs blas
+    setup_blas(error, err_description);
+    if (*error)
+        return false;
+
+    // check if stop signal was received
+    if (rvs::lp::Stopping())
+        return false;
+
+    // stage 3. reduce the SGEMM frequency and try to achieve the desired Gflops
+    // the delay which gives the SGEMM frequency will be dynamically computed
+    delay_target_stress = 0;
+
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+    gst_start_gflops_time = std::chrono::system_clock::now();
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        gst_end_time = std::chrono::system_clock::now();
+        if (time_diff(gst_end_time,  gst_start_time) >
+                            ramp_interval - NMAX_MS_GPU_RUN_PEAK_PERFORMANCE)
+            return false;
+
+        gst_last_sgemm_start_time = std::chrono::system_clock::now();
+
+        // run GEMM(s) & wait for completion
+        if (!run_timed_gemms(&num_last_sgemm, &gflops_interval, error,
+                             err_description))
+            return false;
+
+        gst_last_sgemm_end_time = std::chrono::system_clock::now();
+        millis_last_sgemm =
+                time_diff(gst_last_sgemm_end_time, gst_last_sgemm_start_time);
+        if (static_cast<double>(
+                (1000 * gpu_blas->gemm_gflop_count() * num_last_sgemm) /
+                    target_stress) <
+                        millis_last_sgemm) {
+            // last SGEMM timed-out (it took more than it should)
+            dyn_delay_target_stress = 1;
+        }
+
+
+        num_sgemm_ops += num_last_sgemm;
+        num_sgemm_ops_log_interval += num_last_sgemm;
+
+        gst_end_time = std::chrono::system_clock::now();
+        millis_sgemm_ops =
+                    time_diff(gst_end_time, gst_start_gflops_time);
+        if (millis_sgemm_ops >= NMAX_MS_SGEMM_OPS_RAMP_SUB_INTERVAL) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double>
+                                (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed > 0) {
+                curr_gflops = static_cast<double>(
+                                    gpu_blas->gemm_gflop_count() *
+                                    num_sgemm_ops) / seconds_elapsed;
+                if (curr_gflops >= target_stress && curr_gflops <
+                        target_stress + target_stress * tolerance/2) {
+                    ramp_actual_time =
+                                time_diff(gst_end_time,  gst_start_time) +
+                                NMAX_MS_GPU_RUN_PEAK_PERFORMANCE;
+                    delay_target_stress /= num_sgemm_ops;
+                    return true;
+                }
+            }
+            proc_delay +=
+                (delay_target_stress * PROC_DEC_INC_SGEMM_FREQ_DELAY) / 100;
+            num_sgemm_ops = 0;
+            delay_target_stress = 0;
+            gst_start_gflops_time = std::chrono::system_clock::now();
+        }
+
+        millis_sgemm_ops =
+                    time_diff(gst_end_time, gst_log_interval_time);
+        if (millis_sgemm_ops >= log_interval) {
+            // compute the GFLOPS
+            seconds_elapsed = static_cast<double>
+                                (millis_sgemm_ops) / 1000;
+            if (seconds_elapsed > 0) {
+                curr_gflops = static_cast<double>(
+                                gpu_blas->gemm_gflop_count() *
+                                num_sgemm_ops_log_interval) / seconds_elapsed;
+                log_interval_gflops(gflops_interval);
+            }
+
+            num_sgemm_ops_log_interval = 0;
+            gst_log_interval_time = std::chrono::system_clock::now();
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief logs the final verdict of the stress test
+ *
+ * The test passes if the target stress was met and the sampled
+ * verification found no GEMM result mismatch and no tile it could not check.
+ *
+ * @param gflops_interval the Gflops that the GPU achieved
+ */
+void GSTWorker::check_target_stress(double gflops_interval) {
+    string msg;
+    bool gst_test_passed = gflops_interval >= target_stress &&
+                           verify_errors == 0 && verify_unverified == 0;
+
+    if(gflops_interval >= target_stress){
+         msg = "[" + action_name + "] " + MODULE_NAME + " " +
+               std::to_string(gpu_id) + " " + GST_LOG_GFLOPS_INTERVAL_KEY + " " + std::to_string(gflops_interval) + " " +
+                      "Met target stress :" + " " + std::to_string(target_stress);
+
+    }else{
+         msg = "[" + action_name + "] " + MODULE_NAME + " " +
+               std::to_string(gpu_id) + " " + GST_LOG_GFLOPS_INTERVAL_KEY + " " + std::to_string(gflops_interval) + " " +
+                      "Couldnt meet target stress :" + " " + std::to_string(target_stress);
+    }
+    if (verify_errors > 0)
+        msg += std::string(" ") + GST_VERIFY_ERRORS_KEY + " " +
+               std::to_string(verify_errors);
+    if (verify_unverified > 0)
+        msg += std::string(" ") + GST_VERIFY_UNVERIFIED_KEY + " " +
+               std::to_string(verify_unverified);
+    msg += gst_test_passed ? " PASS" : " FAIL";
+
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_LOG_GFLOPS_INTERVAL_KEY, std::to_string(gflops_interval),
+                rvs::loginfo);
+    log_to_json(GST_PASS_KEY, (gst_test_passed ?
+            GST_RESULT_PASS_MESSAGE : GST_RESULT_FAIL_MESSAGE),
+            rvs::logresults);
+}
+
+
+
+/**
+ * @brief logs the Gflops computed over the last log_interval period 
+ * @param gflops_interval the Gflops that the GPU achieved
+ */
+void GSTWorker::log_interval_gflops(double gflops_interval) {
+    string msg;
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_LOG_GFLOPS_INTERVAL_KEY + " " +
+            std::to_string(gflops_interval);
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_LOG_GFLOPS_INTERVAL_KEY, std::to_string(gflops_interval),
+                rvs::loginfo);
+}
+
+/**
+ * @brief logs the Gflops achieved by each GEMM stream (if more than one)
+ * @param gflops Gflops of each stream
+ */
+void GSTWorker::log_stream_gflops(const std::vector<double>& gflops) {
+    string msg;
+
+    if (gflops.size() < 2)
+        return;
+
+    for (size_t s = 0; s < gflops.size(); s++) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_LOG_STREAM_KEY + " " +
+                std::to_string(s) + " " + GST_LOG_GFLOPS_INTERVAL_KEY + " " +
+                std::to_string(gflops[s]);
+        rvs::lp::Log(msg, rvs::loginfo);
+
+        log_to_json(std::string(GST_LOG_STREAM_KEY) + " " +
+                    std::to_string(s) + " " + GST_LOG_GFLOPS_INTERVAL_KEY,
+                    std::to_string(gflops[s]), rvs::loginfo);
+    }
+}
+
+/**
+ * @brief logs summary of per-interval Gflops of the stress test
+ * @return summary of the series
+ */
+rvs::perfseries::stats_t GSTWorker::log_gflops_stats(void) {
+    rvs::perfseries::stats_t st = gflops_series.get_stats(throttle_threshold);
+    string msg;
+
+    if (st.count == 0)
+        return st;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " +
+            GST_GFLOPS_MEAN_KEY + " " + std::to_string(st.mean) + " " +
+            GST_GFLOPS_MIN_KEY + " " + std::to_string(st.min) + " " +
+            GST_GFLOPS_P5_KEY + " " + std::to_string(st.p5) + " " +
+            GST_GFLOPS_P50_KEY + " " + std::to_string(st.p50) + " " +
+            GST_GFLOPS_P95_KEY + " " + std::to_string(st.p95) + " " +
+            GST_GFLOPS_CV_KEY + " " + std::to_string(st.cv) + " " +
+            GST_TIME_TO_THROTTLE_KEY + " " +
+            (st.throttle_ms < 0 ? "none" : std::to_string(st.throttle_ms));
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_GFLOPS_MEAN_KEY, std::to_string(st.mean), rvs::loginfo);
+    log_to_json(GST_GFLOPS_MIN_KEY, std::to_string(st.min), rvs::loginfo);
+    log_to_json(GST_GFLOPS_P5_KEY, std::to_string(st.p5), rvs::loginfo);
+    log_to_json(GST_GFLOPS_P50_KEY, std::to_string(st.p50), rvs::loginfo);
+    log_to_json(GST_GFLOPS_P95_KEY, std::to_string(st.p95), rvs::loginfo);
+    log_to_json(GST_GFLOPS_CV_KEY, std::to_string(st.cv), rvs::loginfo);
+    log_to_json(GST_TIME_TO_THROTTLE_KEY, st.throttle_ms < 0 ? "none" :
+                std::to_string(st.throttle_ms), rvs::loginfo);
+    return st;
+}
+
+/**
+ * @brief selects Gflops the target stress is checked against
+ * @param st summary of per-interval Gflops
+ * @return peak Gflops for pass_metric "max" (or if no interval completed),
+ * otherwise the selected statistic of the series
+ */
+double GSTWorker::get_pass_gflops(const rvs::perfseries::stats_t& st) {
+    double gflops = max_gflops;
+
+    if (st.count > 0) {
+        if (pass_metric == "mean")
+            gflops = st.mean;
+        else if (pass_metric == "min")
+            gflops = st.min;
+        else if (pass_metric == "p5")
+            gflops = st.p5;
+        else if (pass_metric == "p50")
+            gflops = st.p50;
+        else if (pass_metric == "p95")
+            gflops = st.p95;
+    }
+
+    log_to_json(GST_PASS_METRIC_KEY, pass_metric, rvs::loginfo);
+    return gflops;
+}
+
+/**
+ * @brief logs host to device bandwidth achieved by the copy pipeline
+ * @param bytes bytes uploaded
+ * @param seconds time the uploads took (sec)
+ */
+void GSTWorker::log_copy_bandwidth(uint64_t bytes, double seconds) {
+    string msg;
+
+    if (seconds <= 0)
+        return;
+
+    double gbps = static_cast<double>(bytes) / seconds / 1e9;
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_COPY_BANDWIDTH_KEY + " " +
+            std::to_string(gbps);
+    rvs::lp::Log(msg, rvs::loginfo);
+
+    log_to_json(GST_COPY_BANDWIDTH_KEY, std::to_string(gbps), rvs::loginfo);
+}
+
+/**
+ * @brief checks a sampled tile of C against the host reference and logs
+ * a mismatch, if any. A tile in which every element was skipped is not
+ * verified and is reported as such.
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if the tile was checked, false if a HIP/rocBlas error
+ * occurred
+ */
+bool GSTWorker::verify_gemm_results(int *error, string *err_description) {
+    rvs_blas::verify_result_t res;
+    string msg;
+
+    if (!gpu_blas->verify_gemm_tile(verify_tiles, &res)) {
+        *error = 1;
+        *err_description = GST_BLAS_ERROR;
+        return false;
+    }
+
+    verify_tiles++;
+    verify_checked += res.checked;
+    verify_skipped += res.skipped;
+    verify_errors += res.errors;
+
+    if (res.checked == 0) {
+        verify_unverified++;
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_VERIFY_UNVERIFIED_MSG +
+                " stream " + std::to_string(res.stream) +
+                " batch " + std::to_string(res.batch) +
+                " tile " + std::to_string(res.row) + "," +
+                std::to_string(res.col) + " " +
+                GST_VERIFY_SKIPPED_KEY + " " + std::to_string(res.skipped);
+        rvs::lp::Log(msg, rvs::logerror);
+        log_to_json(GST_VERIFY_UNVERIFIED_MSG, std::to_string(res.skipped),
+                    rvs::logerror);
+    }
+
+    if (res.errors == 0)
+        return true;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_VERIFY_MISMATCH_MSG +
+            " stream " + std::to_string(res.stream) +
+            " batch " + std::to_string(res.batch) +
+            " tile " + std::to_string(res.row) + "," +
+            std::to_string(res.col) + " " +
+            GST_VERIFY_ERRORS_KEY + " " + std::to_string(res.errors) +
+            " first at " + std::to_string(res.error_row) + "," +
+            std::to_string(res.error_col) +
+            " max error " + std::to_string(res.max_error);
+    rvs::lp::Log(msg, rvs::logerror);
+    log_to_json(GST_VERIFY_MISMATCH_MSG, std::to_string(res.errors),
+                rvs::logerror);
+    return true;
+}
+
+/**
+ * @brief logs totals of GEMM result verification (if enabled)
+ */
+void GSTWorker::log_verify_results(void) {
+    string msg;
+
+    if (verify_interval == 0)
+        return;
+
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " +
+            GST_VERIFY_TILES_KEY + " " + std::to_string(verify_tiles) + " " +
+            GST_VERIFY_CHECKED_KEY + " " + std::to_string(verify_checked) +
+            " " + GST_VERIFY_SKIPPED_KEY + " " +
+            std::to_string(verify_skipped) + " " +
+            GST_VERIFY_ERRORS_KEY + " " + std::to_string(verify_errors) +
+            " " + GST_VERIFY_UNVERIFIED_KEY + " " +
+            std::to_string(verify_unverified) + " " +
+            (verify_errors || verify_unverified ? "FAIL" : "PASS");
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_VERIFY_TILES_KEY, std::to_string(verify_tiles),
+                rvs::loginfo);
+    log_to_json(GST_VERIFY_CHECKED_KEY, std::to_string(verify_checked),
+                rvs::loginfo);
+    log_to_json(GST_VERIFY_SKIPPED_KEY, std::to_string(verify_skipped),
+                rvs::loginfo);
+    log_to_json(GST_VERIFY_ERRORS_KEY, std::to_string(verify_errors),
+                rvs::loginfo);
+    log_to_json(GST_VERIFY_UNVERIFIED_KEY, std::to_string(verify_unverified),
+                rvs::loginfo);
+}
+
+/**
+ * @brief checks for Gflops violation 
+ * @param gflops_interval the Gflops that the GPU achieved over the last
+ * log_interval period
+ * @return true if this gflops violates the bounds, false otherwise
+ */
+bool GSTWorker::check_gflops_violation(double gflops_interval) {
+    string msg;
+
+    if (!(gflops_interval > target_stress - target_stress * tolerance &&
+            gflops_interval < target_stress + target_stress * tolerance)) {
+        msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + GST_STRESS_VIOLATION_MSG + " " +
+                std::to_string(gflops_interval);
+//        rvs::lp::Log(msg, rvs::loginfo);
+
+        //log_to_json(GST_STRESS_VIOLATION_MSG, std::to_string(gflops_interval),
+         //           rvs::loginfo);
+        return true;
+    }
+
+
+    return false;
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ * @param error pointer to a memory location where the error code will be stored
+ * @param err_description stores the error description if any
+ * @return true if stress violations is less than max_violations, false otherwise
+ */
+bool GSTWorker::do_gst_stress_test(int *error, std::string *err_description) {
+    uint64_t num_sgemm_ops = 0, num_last_sgemm;
+    uint64_t total_milliseconds, log_interval_milliseconds;
+    uint64_t copy_bytes;
+    double copy_seconds;
+    double seconds_elapsed, gflops_interval, gflops_sustained;
+    string msg;
+    std::chrono::time_point<std::chrono::system_clock> gst_start_time,
+                                            gst_end_time, gst_log_interval_time,
+                                            gst_verify_time;
+
+    *error = 0;
+    max_gflops = 0;
+    num_sgemm_ops = 0;
+    gflops_series.clear();
+
+    // uploads done during the ramp are not reported
+    gpu_blas->take_copy_stats(&copy_bytes, &copy_seconds);
+
+    gst_start_time = std::chrono::system_clock::now();
+    gst_log_interval_time = std::chrono::system_clock::now();
+    gst_verify_time = gst_log_interval_time;
+
+    for (;;) {
+        // check if stop signal was received
+        if (rvs::lp::Stopping())
+            return false;
+
+        // run GEMM(s) & wait for completion
+        if (!run_timed_gemms(&num_last_sgemm, &gflops_interval, error,
+                             err_description))
+            return false;
+
+        num_sgemm_ops += num_last_sgemm;
+
+        if (verify_interval > 0 &&
+            time_diff(std::chrono::system_clock::now(), gst_verify_time) >=
+                verify_interval) {
+            auto verify_start = std::chrono::system_clock::now();
+            if (!verify_gemm_results(error, err_description))
+                return false;
+            gst_verify_time = std::chrono::system_clock::now();
+            // time spent verifying does not count towards sustained Gflops
+            gst_log_interval_time += gst_verify_time - verify_start;
+        }
+
+        gst_end_time = std::chrono::system_clock::now();
+        total_milliseconds = time_diff(gst_end_time, gst_start_time);
+        log_interval_milliseconds = time_diff(gst_end_time,
+                                              gst_log_interval_time);
+
+        if (log_interval_milliseconds >= log_interval && num_sgemm_ops > 0) {
+            seconds_elapsed = static_cast<double> (log_interval_milliseconds) /
+                                1000;
+            if (seconds_elapsed != 0) {
+                if (gflops_interval > max_gflops)
+                    max_gflops = gflops_interval;
+
+                // throughput over the whole interval, not the last GEMM
+                gflops_sustained = gpu_blas->gemm_gflop_count() *
+                                   num_sgemm_ops / seconds_elapsed / 1e9;
+                gflops_series.add(total_milliseconds,
+                                  log_interval_milliseconds,
+                                  gflops_sustained);
+
+                log_interval_gflops(gflops_sustained);
+                log_stream_gflops(stream_gflops);
+
+                if (gpu_blas->is_copy_pipeline()) {
+                    gpu_blas->take_copy_stats(&copy_bytes, &copy_seconds);
+                    total_copy_bytes += copy_bytes;
+                    total_copy_seconds += copy_seconds;
+                    log_copy_bandwidth(copy_bytes, copy_seconds);
+                }
+
+                // reset time & gflops related data
+                num_sgemm_ops = 0;
+                gst_log_interval_time = gst_end_time;
+            }
+        }
+
+
+        if(!gst_hot_calls) {
+               msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                           std::to_string(gpu_id) + " " + GST_START_MSG + " " +
+                           " Execution time in milliseconds :" + std::to_string(total_milliseconds) +
+                           " run_duration_ms :" + std::to_string(run_duration_ms); 
+               rvs::lp::Log(msg, rvs::logtrace);
+               if (total_milliseconds >= run_duration_ms)
+                      break;
+        }else{
+            msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                   std::to_string(gpu_id) + " " + GST_START_MSG + " " +
+                   " Executing hot calls loop :" + std::to_string(gst_hot_calls); 
+            rvs::lp::Log(msg, rvs::logtrace);
+
+            gst_hot_calls -= std::min(gst_hot_calls, num_last_sgemm);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief performs the stress test on the given GPU
+ */
+void GSTWorker::run() {
+    string msg, err_description;
+    int error = 0;
+    bool gst_test_passed = true;
+
+    max_gflops = 0;
+    gflops_series.clear();
+    stream_gflops.clear();
+    stream_max_gflops.clear();
+    total_copy_bytes = 0;
+    total_copy_seconds = 0;
+    verify_tiles = verify_checked = verify_skipped = verify_errors = 0;
+    verify_unverified = 0;
+
+    // log GST stress test - start message
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_START_MSG + " " +
+            " Starting the GST stress test "; 
+    rvs::lp::Log(msg, rvs::loginfo);
+
+    log_to_json(GST_START_MSG, std::to_string(target_stress), rvs::loginfo);
+    log_to_json(GST_COPY_MATRIX_MSG, (copy_matrix ? "true":"false"),
+                rvs::loginfo);
+    log_to_json(GST_GEMM_TIMING_MSG, per_call_timing ? "per_call" :
+                "event batch of " + std::to_string(batch_size), rvs::loginfo);
+
+    // report seed so that the same matrices can be used in another run
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+            std::to_string(gpu_id) + " " + GST_MATRIX_SEED_MSG + ": " +
+            std::to_string(matrix_seed);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(GST_MATRIX_SEED_MSG, std::to_string(matrix_seed),
+                rvs::loginfo);
+
+    // let the GPU ramp-up and check the result
+    bool ramp_up_success = do_gst_ramp(&error, &err_description);
+
+    // GPU was not able to do the processing (HIP/rocBlas error(s) occurred)
+    if (error) {
+        string msg = "[" + action_name + "] " + MODULE_NAME + " "
+                        + std::to_string(gpu_id) + " " + err_description;
+        rvs::lp::Log(msg, rvs::logerror);
+        log_to_json("err", err_description, rvs::logerror);
+
+        return;
+    }
+
+    // the GPU succeeded to achieve the target_stress GFLOPS
+    // continue with the same workload for the rest of the test duration
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                std::to_string(gpu_id) + " " + " GST ramp completed for interval :" + " " +
+                std::to_string(ramp_interval);
+    rvs::lp::Log(msg, rvs::loginfo);
+    log_to_json(GST_TARGET_ACHIEVED_MSG, std::to_string(target_stress),
+                    rvs::loginfo);
+    if (run_duration_ms > 0) {
+            gst_test_passed = do_gst_stress_test(&error, &err_description);
+            // check if stop signal was received
+            if (rvs::lp::Stopping())
+                return;
+
+            if (error) {
+                // GPU didn't complete the test (HIP/rocBlas error(s) occurred)
+                string msg = "[" + action_name + "] " + MODULE_NAME + " " +
+                                std::to_string(gpu_id) + " " + err_description;
+                rvs::lp::Log(msg, rvs::logerror);
+                log_to_json("err", err_description, rvs::logerror);
+                return;
+            }
+    }
+
+    log_interval_gflops(max_gflops);
+    log_stream_gflops(stream_max_gflops);
+    log_copy_bandwidth(total_copy_bytes, total_copy_seconds);
+    log_verify_results();
+    check_target_stress(get_pass_gflops(log_gflops_stats()));
+}
+
+/**
+ * @brief logs the GST test result
+ * @param gst_test_passed true if test succeeded, false otherwise
+ */
+void GSTWorker::log_gst_test_result(bool gst_test_passed) {
+    string msg;
+
+    // all batches of a strided batched GEMM count as one op
+    double flops_per_op = gpu_blas->gemm_gflop_count() / 1e9;
+    msg = "[" + action_name + "] " + MODULE_NAME + " " +
+        std::to_string(gpu_id) + " " + GST_MAX_GFLOPS_OUTPUT_KEY + ": " +
+        std::to_string(max_gflops) + " " + GST_FLOPS_PER_OP_OUTPUT_KEY + ": " +
+        std::to_string(flops_per_op) + "x1e9" + " " +
+        GST_BYTES_COPIED_PER_OP_OUTPUT_KEY + ": " +
+        std::to_string(gpu_blas->get_bytes_copied_per_op()) +
+        " " + GST_TRY_OPS_PER_SEC_OUTPUT_KEY + ": "+
+        std::to_string(target_stress / gpu_blas->gemm_gflop_count()) +
+        " "  ;
+    rvs::lp::Log(msg, rvs::logresults);
+
+    log_to_json(GST_MAX_GFLOPS_OUTPUT_KEY, std::to_string(max_gflops),
+                rvs::loginfo);
+    log_to_json(GST_FLOPS_PER_OP_OUTPUT_KEY, std::to_string(flops_per_op) +
+                "x1e9", rvs::loginfo);
+    log_to_json(GST_BYTES_COPIED_PER_OP_OUTPUT_KEY,
+                std::to_string(gpu_blas->get_bytes_copied_per_op()),
+                rvs::loginfo);
+    log_to_json(GST_TRY_OPS_PER_SEC_OUTPUT_KEY,
+                std::to_string(target_stress / gpu_blas->gemm_gflop_count()),
+                rvs::loginfo);
+    log_to_json(GST_PASS_KEY, (gst_test_passed ?
+            GST_RESULT_PASS_MESSAGE : GST_RESULT_FAIL_MESSAGE),
+            rvs::logresults);
+}
+
+/**
+ * @brief computes the difference (in milliseconds) between 2 points in time
+ * @param t_end second point in time
+ * @param t_start first point in time
+ * @return time difference in milliseconds
+ */
+uint64_t GSTWorker::time_diff(
+                std::chrono::time_point<std::chrono::system_clock> t_end,
+                std::chrono::time_point<std::chrono::system_clock> t_start) {
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            t_end - t_start);
+    return milliseconds.count();
+}
+
+/**
+ * @brief logs a message to JSON
+ * @param key info type
+ * @param value message to log
+ * @param log_level the level of log (e.g.: info, results, error)
+ */
+void GSTWorker::log_to_json(const std::string &key, const std::string &value,
+                     int log_level) {
+    if (GSTWorker::bjson) {
+        unsigned int sec;
+        unsigned int usec;
+
+        rvs::lp::get_ticks(&sec, &usec);
+        void *json_node = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), log_level, sec, usec);
+        if (json_node) {
+            rvs::lp::AddString(json_node, GST_JSON_LOG_GPU_ID_KEY,
+                            std::to_string(gpu_id));
+            rvs::lp::AddString(json_node, key, value);
+            rvs::lp::LogRecordFlush(json_node);
+        }
+    }
+}
+
+/**
+ * @brief extends the usleep for more than 1000000us
+ * @param microseconds us to sleep
+ */
+void GSTWorker::usleep_ex(uint64_t microseconds) {
+    uint64_t total_microseconds = microseconds;
+    for (;;) {
+         if (total_microseconds > USLEEP_MAX_VAL) {
+            usleep(USLEEP_MAX_VAL);
+            total_microseconds -= USLEEP_MAX_VAL;
+        } else {
+            usleep(total_microseconds);
+            return;
+        }
+    }
+}
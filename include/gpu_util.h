@@ -37,11 +37,13 @@ extern void gpu_get_all_location_id(std::vector<uint16_t>* pgpus_location_id);
 extern void gpu_get_all_gpu_id(std::vector<uint16_t>* pgpus_id);
 extern void gpu_get_all_device_id(std::vector<uint16_t>* pgpus_device_id);
 extern void gpu_get_all_node_id(std::vector<uint16_t>* pgpus_node_id);
+extern void gpu_get_all_domain(std::vector<uint16_t>* pgpus_domain);
 
 
 namespace rvs {
 
   ::std::string bdf2string(uint32_t BDF);
+  ::std::string gpu_get_root_port(uint16_t Domain, uint16_t LocationID);
 
 /**
  * @class gpulist
@@ -62,6 +64,7 @@ class gpulist {
   static int gpu2device(const uint16_t GpuID, uint16_t* pDeviceID);
   static int location2node(const uint16_t LocationID, uint16_t* pNodeID);
   static int gpu2node(const uint16_t GpuID, uint16_t* pNodeID);
+  static int gpu2domain(const uint16_t GpuID, uint16_t* pDomain);
 
  protected:
   //! Array of GPU location IDs
@@ -72,6 +75,8 @@ class gpulist {
   static std::vector<uint16_t> device_id;
   //! Array of node IDs
   static std::vector<uint16_t> node_id;
+  //! Array of PCI domains
+  static std::vector<uint16_t> domain;
 };
 
 
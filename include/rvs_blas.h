@@ -32,16 +32,133 @@
 #include "include/hip/hip_runtime_api.h"
 #include <sys/time.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/rvs_matrixcache.h"
+
+//! max number of rows and columns of C checked by verify_gemm_tile()
+#define RVS_BLAS_VERIFY_TILE            (64)
+
 /**
  * @class rvs_blas
  * @ingroup GST
  *
- * @brief implements the SGEMM logic
+ * @brief implements the SGEMM, DGEMM, HGEMM and mixed precision GEMM logic
+ *
+ * GEMM type is given at construction and resolved once into a gemm_type_t
+ * descriptor, so only device matrices of that type are allocated and no
+ * string compare is done per GEMM. Supported types are "sgemm", "dgemm",
+ * "hgemm" and the rocblas_gemm_ex based "bf16", "int8" and "f16_f32acc".
+ * Any of them with "_strided_batched" suffix runs batch_count GEMMs per
+ * call. Host matrices of one batch are shared through rvs::matrixcache and
+ * replicated on the GPU for each batch.
+ *
+ * GEMMs can be issued on several streams at once. Each stream has its own
+ * rocBlas handle and C matrix, while A and B are shared by all streams.
+ *
+ * A sampled tile of C can be checked against a host reference (see
+ * verify_gemm_tile()).
  *
  */
 class rvs_blas {
  public:
-    rvs_blas(int _gpu_device_index, int _m, int _n, int _k);
+    //! GEMM entry point used for a type
+    enum gemm_kind_t {
+        //! rocblas_sgemm[_strided_batched]
+        GEMM_KIND_SGEMM = 0,
+        //! rocblas_dgemm[_strided_batched]
+        GEMM_KIND_DGEMM,
+        //! rocblas_hgemm[_strided_batched]
+        GEMM_KIND_HGEMM,
+        //! rocblas_gemm[_strided_batched]_ex
+        GEMM_KIND_EX
+    };
+
+    /**
+     * @class gemm_type_s
+     * @ingroup GST
+     *
+     * @brief GEMM type descriptor
+     *
+     */
+    typedef struct gemm_type_s {
+        //! type of host matrices (type name without batched suffix)
+        std::string base;
+        //! GEMM entry point
+        gemm_kind_t kind;
+        //! TRUE for *_strided_batched types
+        bool strided_batched;
+        //! A and B data type
+        rocblas_datatype ab_type;
+        //! C data type
+        rocblas_datatype c_type;
+        //! accumulation type
+        rocblas_datatype compute_type;
+        //! A and B element size in bytes
+        size_t ab_size;
+        //! C element size in bytes
+        size_t c_size;
+    } gemm_type_t;
+
+    /**
+     * @class gemm_stream_s
+     * @ingroup GST
+     *
+     * @brief resources of one GEMM stream
+     *
+     */
+    typedef struct gemm_stream_s {
+        //! HIP stream the GEMMs are issued on
+        hipStream_t stream;
+        //! rocBlas handle bound to stream
+        rocblas_handle handle;
+        //! C matrix (device memory, batch_count strided copies) of this stream
+        void* dc;
+        //! recorded on stream before the first GEMM of a batch
+        hipEvent_t start_event;
+        //! recorded on stream after the last GEMM of a batch
+        hipEvent_t stop_event;
+        //! recorded on stream after GEMMs reading each pipeline slot
+        hipEvent_t slot_done[2];
+        //! recorded on stream once shared A and B are uploaded on it
+        hipEvent_t upload_done;
+    } gemm_stream_t;
+
+    /**
+     * @class verify_result_s
+     * @ingroup GST
+     *
+     * @brief outcome of checking one tile of C
+     *
+     */
+    typedef struct verify_result_s {
+        //! stream whose C matrix was checked
+        int stream;
+        //! batch of C which was checked
+        int batch;
+        //! first row of the tile
+        rocblas_int row;
+        //! first column of the tile
+        rocblas_int col;
+        //! elements compared against the host reference
+        uint64_t checked;
+        //! elements not compared because the reference is not finite
+        uint64_t skipped;
+        //! elements outside of tolerance
+        uint64_t errors;
+        //! row of the first element outside of tolerance
+        rocblas_int error_row;
+        //! column of the first element outside of tolerance
+        rocblas_int error_col;
+        //! largest absolute difference from the reference
+        double max_error;
+    } verify_result_t;
+
+    rvs_blas(int _gpu_device_index, int _m, int _n, int _k,
+             const std::string& _ops_type = "sgemm", int _streams = 1,
+             int _batch_count = 1);
     ~rvs_blas();
 
     //! returns the GPU index
@@ -52,24 +169,54 @@ class rvs_blas {
     rocblas_int get_n(void) { return n; }
     //! returns k (matrix size)
     rocblas_int get_k(void) { return k; }
+    //! returns GEMM type
+    const std::string& get_ops_type(void) { return ops_type; }
+    //! returns seed of generated matrix data
+    uint64_t get_seed(void) { return seed; }
+    //! returns the number of GEMM streams
+    int get_streams(void) { return static_cast<int>(streams.size()); }
+    //! returns the number of GEMMs run by one call
+    int get_batch_count(void) { return batch_count; }
+    //! sets A and B transposition (default is A as is, B transposed)
+    void set_transpose(bool _trans_a, bool _trans_b) {
+        trans_a = _trans_a ? rocblas_operation_transpose :
+                             rocblas_operation_none;
+        trans_b = _trans_b ? rocblas_operation_transpose :
+                             rocblas_operation_none;
+    }
+
+    static bool get_gemm_type(const std::string& _ops_type,
+                              gemm_type_t* pType);
+    static size_t get_element_size(const std::string& _ops_type);
 
     //! computes the number of bytes which are copied to
-    //! the GPU for one SGEMM operation
+    //! the GPU for one GEMM operation (all batches)
     uint64_t get_bytes_copied_per_op(void) {
-        return sizeof(float) * (size_a + size_b + size_c);
+        return static_cast<uint64_t>(batch_count) *
+               (gemm.ab_size * (static_cast<uint64_t>(size_a) + size_b) +
+                gemm.c_size * static_cast<uint64_t>(size_c));
     }
-    //! computes the gflop for a SGEMM operation
+    //! computes the flop (integer op for int8) count of a GEMM operation
+    //! (all batches)
     double gemm_gflop_count(void) {
-        return static_cast<double>(2.0 * m * n * k);
+        return static_cast<double>(2.0 * m * n * k) * batch_count;
     }
 
     double get_time_us(void);
     //! returns TRUE if an error occured
     bool error(void) { return is_error; }
-    void generate_random_matrix_data(void);
-    bool copy_data_to_gpu(std::string);
-    bool run_blass_gemm(std::string);
+    void generate_random_matrix_data(uint64_t _seed,
+                                     const std::string& cache_dir);
+    bool copy_data_to_gpu(bool async = false, int stream = 0);
+    bool enable_copy_pipeline(void);
+    //! returns TRUE if operand uploads are double buffered
+    bool is_copy_pipeline(void) { return is_pipeline; }
+    void take_copy_stats(uint64_t* pBytes, double* pSeconds);
+    bool run_blass_gemm(int stream = 0);
+    bool run_blass_gemm_batch(uint32_t count, bool copy, double* pSeconds,
+                              std::vector<double>* pStreamSeconds = nullptr);
     bool is_gemm_op_complete(void);
+    bool verify_gemm_tile(uint64_t sample, verify_result_t* pResult);
 
  protected:
     //! GPU device index
@@ -80,6 +227,18 @@ class rvs_blas {
     rocblas_int n;
     //! matrix size k
     rocblas_int k;
+    //! GEMM type name
+    std::string ops_type;
+    //! GEMM type descriptor resolved from ops_type
+    gemm_type_t gemm;
+    //! number of GEMMs run by one call (1 if not strided batched)
+    int batch_count;
+    //! A transposition
+    rocblas_operation trans_a;
+    //! B transposition
+    rocblas_operation trans_b;
+    //! seed of generated matrix data
+    uint64_t seed;
     //! amount of memory to allocate for the matrix
     rocblas_int size_a;
     //! amount of memory to allocate for the matrix
@@ -87,71 +246,62 @@ class rvs_blas {
     //! amount of memory to allocate for the matrix
     rocblas_int size_c;
 
-    //SGEMM DECLARAION
-    //! pointer to device (GPU) memory
-    float *da;
-    //! pointer to device (GPU) memory
-    float *db;
-    //! pointer to device (GPU) memory
-    float *dc;
-    //! pointer to host memory
-    float *ha;
-    //! pointer to host memory
-    float *hb;
-    //! pointer to host memory
-    float *hc;
-
-    //DGEMM Declaration
-    //! pointer to device (GPU) memory
-    double *ddbla;
-    //! pointer to device (GPU) memory
-    double *ddblb;
-    //! pointer to device (GPU) memory
-    double *ddblc;
-    //! pointer to host memory
-    double *hdbla;
-    //! pointer to host memory
-    double *hdblb;
-    //! pointer to host memory
-    double *hdblc;
-
-    //HGEMM Declaration
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfa;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfb;
-    //! pointer to device (GPU) memory
-    rocblas_half *dhlfc;
-    //! pointer to host memory
-    rocblas_half *hhlfa;
-    //! pointer to host memory
-    rocblas_half *hhlfb;
-    //! pointer to host memory
-    rocblas_half *hhlfc;
-
-    rocblas_half  hostarrayA;
-    rocblas_half  hostarrayB;
-    rocblas_half  hostarrayC;
-
-
-
-
-    //! HIP API stream - used to query for GEMM completion
-    hipStream_t hip_stream;
-    //! rocBlas related handle
-    rocblas_handle blas_handle;
-    //! TRUE is rocBlas handle was successfully initialized
-    bool is_handle_init;
+    //! A matrix (device memory, batch_count strided copies)
+    void *da;
+    //! B matrix (device memory, batch_count strided copies)
+    void *db;
+
+    //! shared host A, B and C matrices (set by generate_random_matrix_data)
+    std::shared_ptr<const rvs::hostmatrix> host_data;
+
+    //! GEMM streams (only fully initialized streams are kept)
+    std::vector<gemm_stream_t> streams;
     //! rocBlas guard (prevents executing blass_gemm when there are mem errors)
     bool is_error;
 
-    bool init_gpu_device(void);
+    //! TRUE if operand uploads are double buffered
+    bool is_pipeline;
+    //! pinned host copy of A and B uploaded by the pipeline
+    void *pinned;
+    //! A matrices GEMMs alternate between (slot 0 is the original da)
+    void *da_slot[2];
+    //! B matrices GEMMs alternate between (slot 0 is the original db)
+    void *db_slot[2];
+    //! pipeline slot read by the next GEMMs
+    int pipeline_slot;
+    //! stream operand uploads are issued on
+    hipStream_t copy_stream;
+    //! recorded on copy_stream once a slot is uploaded
+    hipEvent_t slot_ready[2];
+    //! start/stop event pair of each upload of a batch
+    std::vector<hipEvent_t> copy_events;
+    //! bytes uploaded since last take_copy_stats()
+    uint64_t copy_bytes;
+    //! time spent uploading since last take_copy_stats() (sec)
+    double copy_seconds;
+
+    bool init_gpu_device(int _streams);
     bool allocate_gpu_matrix_mem(void);
+    bool copy_matrix_to_gpu(const void* src, size_t size, void* dst,
+                            bool async, hipStream_t stream);
+    bool run_pipelined_batch(uint32_t count);
+    bool copy_shared_data_to_gpu(void);
+    bool collect_copy_stats(uint32_t count);
+    void release_copy_pipeline(void);
+    bool init_gemm_stream(gemm_stream_t* pStream);
+    void release_gemm_stream(gemm_stream_t* pStream);
     void release_gpu_matrix_mem(void);
-
-    bool alocate_host_matrix_mem(void);
-    void release_host_matrix_mem(void);
-    float fast_pseudo_rand(u_long *nextr);
+    void get_alpha_beta(double* pAlpha, double* pBeta);
+    double get_verify_tolerance(void);
+    bool copy_tile_from_gpu(const verify_result_t& tile, rocblas_int rows,
+                            rocblas_int cols, void* dst);
+    void compute_tile_reference(const verify_result_t& tile, rocblas_int rows,
+                                rocblas_int cols, std::vector<double>* pRef,
+                                std::vector<double>* pAbs);
+    static double get_unit_roundoff(rocblas_datatype type);
+    static double get_denorm_min(rocblas_datatype type);
+    static double get_element(const void* data, rocblas_datatype type,
+                              size_t ix);
 };
 
 #endif  // INCLUDE_RVS_BLAS_H_
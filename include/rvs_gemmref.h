@@ -0,0 +1,78 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_GEMMREF_H_
+#define INCLUDE_RVS_GEMMREF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//! K dimension is processed in blocks of this many elements
+#define RVS_GEMMREF_K_BLOCK             (256)
+//! number of A rows sharing one load of a B column
+#define RVS_GEMMREF_ROWS                (4)
+//! min number of multiply-adds done by one thread
+#define RVS_GEMMREF_MIN_WORK            (1u << 20)
+//! multiple of sqrt(K) unit roundoffs bounding a K long dot product error
+#define RVS_GEMMREF_LAMBDA              (8)
+
+namespace rvs {
+
+/**
+ * @class gemmref
+ * @ingroup RVS
+ *
+ * @brief Host reference GEMM used to check a tile of a GPU result
+ *
+ * Operands are packed so that each row of op(A) and each column of op(B)
+ * is contiguous, which turns every element of the tile into a dot product
+ * of two contiguous vectors. K is processed in blocks so that the B block
+ * stays in cache while all A rows are run against it, and RVS_GEMMREF_ROWS
+ * rows share each load of B. Along with the dot product, the dot product
+ * of absolute values is returned, which bounds the rounding error of any
+ * summation order. Dot products are vectorized (AVX-512 or AVX2 chosen at
+ * run time, NEON on aarch64) with scalar fallback, and rows are split
+ * across threads.
+ *
+ */
+class gemmref {
+ public:
+  static void multiply(const float* pA, const float* pB, int Rows, int Cols,
+                       int K, float* pC, float* pAbs, unsigned Threads = 0);
+  static void multiply(const double* pA, const double* pB, int Rows,
+                       int Cols, int K, double* pC, double* pAbs,
+                       unsigned Threads = 0);
+
+  static unsigned get_threads(int Rows, int Cols, int K, unsigned Threads);
+  static double get_tolerance(int K, double AccRoundoff, double OutRoundoff);
+  static double get_error_bound(double Tolerance, double Scale,
+                                double OutDenorm);
+  static float half_to_float(uint16_t Value);
+  static float bf16_to_float(uint16_t Value);
+  static const char* simd_name();
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_GEMMREF_H_
@@ -0,0 +1,108 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_GEMMTUNE_H_
+#define INCLUDE_RVS_GEMMTUNE_H_
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! matrix sizes swept if none are given
+#define RVS_GEMMTUNE_DEFAULT_SIZES      "1024 2048 4096 5760 8192"
+
+namespace rvs {
+
+/**
+ * @class gemmtune
+ * @ingroup RVS
+ *
+ * @brief Selection of GEMM size and transposition maximizing throughput
+ *
+ * Candidates (square sizes times all four A/B transpositions) are measured
+ * by the caller and reported with add(). The best candidate is the one with
+ * the highest sustained Gflops. Winners are kept in a line oriented cache
+ * file, one line per key:
+ *
+ *     <key> <m> <n> <k> <trans_a> <trans_b> <gflops>
+ *
+ * Key identifies device (device id and VBIOS) and workload (GEMM type,
+ * streams, batch count), so a run on the same device skips the sweep.
+ *
+ */
+class gemmtune {
+ public:
+/**
+ * @class candidate_t
+ * @ingroup RVS
+ *
+ * @brief GEMM shape and its measured throughput
+ *
+ */
+  struct candidate_t {
+    //! matrix size m
+    uint64_t m;
+    //! matrix size n
+    uint64_t n;
+    //! matrix size k
+    uint64_t k;
+    //! 'true' if A is transposed
+    bool trans_a;
+    //! 'true' if B is transposed
+    bool trans_b;
+    //! sustained Gflops (0 if not measured or failed)
+    double gflops;
+  };
+
+  gemmtune();
+
+  static std::string make_key(const std::string& DeviceId,
+                              const std::string& Vbios,
+                              const std::string& OpsType,
+                              uint32_t Streams, uint32_t BatchCount);
+  static std::vector<candidate_t> get_candidates(
+                                    const std::vector<uint64_t>& Sizes);
+  static bool load(const std::string& File, const std::string& Key,
+                   candidate_t* pBest);
+  static bool save(const std::string& File, const std::string& Key,
+                   const candidate_t& Best);
+
+  void add(const candidate_t& Candidate);
+  bool get_best(candidate_t* pBest) const;
+
+ protected:
+  //! best candidate so far
+  candidate_t best;
+  //! 'true' once a candidate with non-zero Gflops was added
+  bool has_best;
+
+  //! serializes cache file updates of workers running in parallel
+  static std::mutex file_mutex;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_GEMMTUNE_H_
@@ -0,0 +1,96 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_HISTOGRAM_H_
+#define INCLUDE_RVS_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+//! number of buckets per power of two
+#define RVS_HISTOGRAM_SUBBUCKETS        (16)
+//! lowest power of two covered by histogram
+#define RVS_HISTOGRAM_MIN_EXP           (-10)
+//! highest power of two covered by histogram
+#define RVS_HISTOGRAM_MAX_EXP           (30)
+
+namespace rvs {
+
+/**
+ * @class histogram
+ * @ingroup RVS
+ *
+ * @brief Histogram with logarithmically spaced buckets
+ *
+ * Every power of two between 2^RVS_HISTOGRAM_MIN_EXP and
+ * 2^RVS_HISTOGRAM_MAX_EXP is split into RVS_HISTOGRAM_SUBBUCKETS buckets, so
+ * relative resolution is the same for every value. Values outside of the
+ * range are counted in the first or the last bucket. Exact minimum, maximum
+ * and mean are kept alongside.
+ *
+ */
+class histogram {
+ public:
+  histogram();
+
+  void add(double Value);
+  void add(const histogram& Other);
+  void clear();
+
+  //! number of values added
+  uint64_t count() const { return samples; }
+  //! smallest value added (0 if none)
+  double min() const { return samples ? vmin : 0; }
+  //! largest value added (0 if none)
+  double max() const { return samples ? vmax : 0; }
+  //! mean of values added (0 if none)
+  double mean() const { return samples ? sum / samples : 0; }
+  double percentile(double P) const;
+
+  void get_buckets(int PerOctave, std::vector<double>* pLower,
+                   std::vector<uint64_t>* pCount) const;
+  std::string to_string(int PerOctave) const;
+
+ protected:
+  static int bucket(double Value);
+  static double lower_bound(int Bucket);
+
+ protected:
+  //! number of values in each bucket
+  std::vector<uint64_t> buckets;
+  //! number of values added
+  uint64_t samples;
+  //! sum of values added
+  double sum;
+  //! smallest value added
+  double vmin;
+  //! largest value added
+  double vmax;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_HISTOGRAM_H_
@@ -41,11 +41,38 @@
 #define RVS_CONF_B2B_BLOCK_SIZE_KEY     "b2b_block_size"
 #define RVS_CONF_LINK_TYPE_KEY          "link_type"
 #define RVS_CONF_MONITOR_KEY            "monitor"
+#define RVS_CONF_TOPOLOGY_CACHE_KEY     "topology_cache"
+#define RVS_CONF_STRIPES_KEY            "stripes"
+#define RVS_CONF_VERIFY_KEY             "verify"
+#define RVS_CONF_HOST_MEM_KEY           "host_mem"
+#define RVS_CONF_TEST_KEY               "test"
+#define RVS_CONF_TRACE_FILE_KEY         "trace_file"
+#define RVS_CONF_WARMUP_KEY             "warmup"
+#define RVS_CONF_CI_TOLERANCE_KEY       "ci_tolerance"
+#define RVS_CONF_CI_TIME_CAP_KEY        "ci_time_cap"
+#define RVS_CONF_HOST_NODE_KEY          "host_node"
+#define RVS_CONF_SATURATION_GROUP_KEY   "saturation_group"
+#define RVS_CONF_MATRIX_FILE_KEY        "matrix_file"
+#define RVS_CONF_BASELINE_FILE_KEY      "baseline_file"
+#define RVS_CONF_BASELINE_TOLERANCE_KEY "baseline_tolerance"
+#define RVS_CONF_PATTERN_KEY            "pattern"
+#define RVS_CONF_LINK_HEALTH_KEY        "link_health"
+#define RVS_CONF_HEALTH_INTERVAL_KEY    "health_interval"
+#define RVS_CONF_HEALTH_WINDOW_KEY      "health_window"
+#define RVS_CONF_DIP_THRESHOLD_KEY      "dip_threshold"
+#define RVS_CONF_HEALTH_FILE_KEY        "health_file"
+#define RVS_CONF_MATRIX_SEED_KEY        "matrix_seed"
+#define RVS_CONF_MATRIX_CACHE_DIR_KEY   "matrix_cache_dir"
 
 #define DEFAULT_LOG_INTERVAL (1000u)
 #define DEFAULT_DURATION (10000u)
 #define DEFAULT_COUNT (1u)
 #define DEFAULT_WAIT (0u)
+#define DEFAULT_CI_TIME_CAP (1000u)
+#define DEFAULT_BASELINE_TOLERANCE (0.1f)
+#define DEFAULT_HEALTH_INTERVAL (100u)
+#define DEFAULT_HEALTH_WINDOW (50u)
+#define DEFAULT_DIP_THRESHOLD (0.2f)
 
 #define YAML_DEVICE_PROPERTY_ERROR      "Error while parsing <device> property"
 #define YAML_DEVICEID_PROPERTY_ERROR    "Error while parsing <deviceid> "\
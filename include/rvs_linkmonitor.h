@@ -0,0 +1,148 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_LINKMONITOR_H_
+#define INCLUDE_RVS_LINKMONITOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+//! number of bandwidth buckets kept per link (1 hour of 100 ms buckets)
+#define RVS_LINKMONITOR_CAPACITY        (36000u)
+
+namespace rvs {
+
+/**
+ * @class linkmonitor
+ * @ingroup RVS
+ *
+ * @brief Fine grained bandwidth time series of one link with dip detection
+ *
+ * Transfers are accounted into fixed width time buckets, spreading bytes
+ * of each transfer evenly over its duration. Bucket boundaries are derived
+ * from absolute time, so buckets of different links line up. Completed
+ * buckets are kept in a fixed size ring. Each completed bucket is compared
+ * against rolling baseline (mean of the last window buckets which were not
+ * part of a dip); bucket below (1 - threshold) * baseline starts or extends
+ * a dip. Dip ends with the first bucket back above the limit.
+ *
+ * Buckets are filled by the owning worker thread. Series and dips may be
+ * read by other threads at any time.
+ *
+ */
+class linkmonitor {
+ public:
+/**
+ * @class sample_t
+ * @ingroup RVS
+ *
+ * @brief Bandwidth of one completed bucket
+ *
+ */
+  struct sample_t {
+    //! bucket index (bucket start time / bucket width)
+    uint64_t bucket;
+    //! bandwidth in bucket (GBps)
+    float bandwidth;
+  };
+
+/**
+ * @class dip_t
+ * @ingroup RVS
+ *
+ * @brief Single bandwidth dip
+ *
+ */
+  struct dip_t {
+    //! start of the first bucket of the dip (sec)
+    double start;
+    //! end of the last bucket of the dip (sec)
+    double end;
+    //! baseline bandwidth when dip started (GBps)
+    double baseline;
+    //! lowest bucket bandwidth during dip (GBps)
+    double min;
+  };
+
+  linkmonitor();
+
+  void configure(double BucketSec, uint32_t Window, double Threshold,
+                 size_t Capacity = RVS_LINKMONITOR_CAPACITY);
+  //! 'true' if monitor has been configured
+  bool enabled() const { return bucket_sec > 0; }
+  //! bucket width (sec)
+  double get_bucket() const { return bucket_sec; }
+
+  void add(double Start, double End, uint64_t Bytes);
+  void finish();
+
+  void get_series(std::vector<sample_t>* pSeries) const;
+  size_t get_dips(size_t First, std::vector<dip_t>* pDips) const;
+
+ protected:
+  void close_bucket(uint64_t Bucket, double Bytes);
+
+ protected:
+  //! bucket width (sec), 0 if disabled
+  double bucket_sec;
+  //! number of buckets in rolling baseline
+  uint32_t window;
+  //! relative drop below baseline considered a dip
+  double threshold;
+
+  //! index of the first bucket still being filled
+  uint64_t open_first;
+  //! bytes accounted into buckets still being filled
+  std::deque<double> open_bytes;
+  //! end of the last transfer (sec)
+  double last_end;
+  //! 'false' before the first transfer and after finish()
+  bool active;
+
+  //! buckets forming rolling baseline
+  std::deque<double> base_values;
+  //! sum of base_values
+  double base_sum;
+  //! 'true' while in dip
+  bool in_dip;
+  //! dip in progress
+  dip_t current;
+
+  //! ring of completed buckets
+  std::vector<sample_t> series;
+  //! number of buckets ever completed
+  uint64_t completed;
+  //! completed dips
+  std::vector<dip_t> dips;
+  //! protects series and dips
+  mutable std::mutex mtx;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_LINKMONITOR_H_
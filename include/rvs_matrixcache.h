@@ -0,0 +1,155 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_MATRIXCACHE_H_
+#define INCLUDE_RVS_MATRIXCACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace rvs {
+
+/**
+ * @class hostmatrix
+ * @ingroup RVS
+ *
+ * @brief Read-only host copy of A, B and C matrices of one GEMM
+ *
+ * Matrices are kept in one page aligned block, either in heap memory or in
+ * a memory mapped cache file.
+ *
+ */
+class hostmatrix {
+ public:
+  hostmatrix();
+  ~hostmatrix();
+
+  //! returns matrix Ix (0 - A, 1 - B, 2 - C)
+  const void* get(int Ix) const { return base + offset[Ix]; }
+  //! returns size of matrix Ix in bytes
+  size_t get_size(int Ix) const { return size[Ix]; }
+  //! returns total size of all three matrices in bytes
+  size_t get_length() const { return length; }
+  //! 'true' if data is memory mapped cache file
+  bool is_mapped() const { return mapped; }
+
+ protected:
+  friend class matrixcache;
+
+  //! start of the block
+  char* base;
+  //! length of the block
+  size_t length;
+  //! 'true' if block is mmap()-ed file, heap memory otherwise
+  bool mapped;
+  //! offset of each matrix in the block
+  size_t offset[3];
+  //! size of each matrix in bytes
+  size_t size[3];
+};
+
+/**
+ * @class matrixcache
+ * @ingroup RVS
+ *
+ * @brief Process wide cache of generated GEMM host matrices
+ *
+ * Matrices are keyed by (GEMM type, m, n, k, seed) and shared by all users
+ * asking for the same key, so GPUs of one action hold a single host copy.
+ * Data is released when the last user drops it and another key is
+ * requested, so consecutive actions with the same matrices do not
+ * regenerate them.
+ *
+ * If cache directory is given, matrices are stored in a file there and
+ * memory mapped. Later runs using the same key map the file instead of
+ * generating data.
+ *
+ * Matrices are generated outside of the cache lock, so different keys are
+ * generated concurrently, while users of the same key wait for the one
+ * generating it.
+ *
+ */
+class matrixcache {
+ public:
+  static std::shared_ptr<const hostmatrix> acquire(const std::string& Type,
+                                                   uint64_t M, uint64_t N,
+                                                   uint64_t K, uint64_t Seed,
+                                                   const std::string& Dir,
+                                                   bool* pGenerated = nullptr);
+  static size_t get_element_size(const std::string& Type, int Ix = 0);
+  static uint64_t get_default_seed();
+  static std::string get_file_name(const std::string& Type,
+                                   uint64_t M, uint64_t N, uint64_t K,
+                                   uint64_t Seed, const std::string& Dir);
+  static void release_unused();
+
+ protected:
+  //! cache key: GEMM type, m, n, k and seed
+  typedef std::tuple<std::string, uint64_t, uint64_t, uint64_t, uint64_t>
+    key_t;
+
+/**
+ * @class entry_t
+ * @ingroup RVS
+ *
+ * @brief Cached matrices of one key
+ *
+ */
+  struct entry_t {
+    //! runs generation (or mapping) of the matrices once
+    std::once_flag once;
+    //! matrices, NULL until generated or if generation failed
+    std::shared_ptr<hostmatrix> data;
+  };
+
+  static bool layout(const std::string& Type, uint64_t M, uint64_t N,
+                     uint64_t K, hostmatrix* pData);
+  static void generate(const std::string& Type, uint64_t Seed,
+                       hostmatrix* pData);
+  static bool allocate_heap(hostmatrix* pData);
+  static bool map_file(const std::string& Type, uint64_t Seed,
+                       const std::string& Filename, hostmatrix* pData,
+                       bool* pGenerated);
+  static std::shared_ptr<hostmatrix> create(const std::string& Type,
+                                            uint64_t M, uint64_t N,
+                                            uint64_t K, uint64_t Seed,
+                                            const std::string& Dir,
+                                            bool* pGenerated);
+  static void drop_unused();
+
+  //! cached matrices
+  static std::map<key_t, std::shared_ptr<entry_t>> entries;
+  //! protects entries and data of each entry
+  static std::mutex mtx;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_MATRIXCACHE_H_
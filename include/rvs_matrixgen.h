@@ -0,0 +1,88 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_MATRIXGEN_H_
+#define INCLUDE_RVS_MATRIXGEN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//! min number of elements generated by one thread
+#define RVS_MATRIXGEN_MIN_CHUNK         (1u << 20)
+//! number of distinct values generated for float/double matrices
+#define RVS_MATRIXGEN_RANGE             (320000u)
+//! values are scaled by 1/RVS_MATRIXGEN_DIV
+#define RVS_MATRIXGEN_DIV               (0.1234)
+
+namespace rvs {
+
+/**
+ * @class matrixgen
+ * @ingroup RVS
+ *
+ * @brief Parallel counter based generator of GEMM matrix data
+ *
+ * Element i of a matrix is a pure function of (seed, stream, i), mixed with
+ * splitmix64 finalizer. Elements do not depend on each other, so the range
+ * is split across threads and the per element loop has no carried state and
+ * can be vectorized. Generated data is the same for a given seed regardless
+ * of the number of threads used.
+ *
+ * float and double matrices get values in [0, RANGE / DIV), half and bfloat16
+ * matrices get the same values in [-1, 1) (exact in both formats, so no
+ * NaN/Inf and no overflow in 16 bit accumulation), 8 bit integer matrices get
+ * random bytes and 32 bit integer matrices get the same small values as 8 bit
+ * ones so that accumulation does not overflow.
+ *
+ */
+class matrixgen {
+ public:
+  static void fill(float* pData, size_t Count, uint64_t Seed,
+                   uint64_t Stream, unsigned Threads = 0);
+  static void fill(double* pData, size_t Count, uint64_t Seed,
+                   uint64_t Stream, unsigned Threads = 0);
+  static void fill(uint16_t* pData, size_t Count, uint64_t Seed,
+                   uint64_t Stream, unsigned Threads = 0);
+  static void fill_bf16(uint16_t* pData, size_t Count, uint64_t Seed,
+                        uint64_t Stream, unsigned Threads = 0);
+  static void fill(int8_t* pData, size_t Count, uint64_t Seed,
+                   uint64_t Stream, unsigned Threads = 0);
+  static void fill(int32_t* pData, size_t Count, uint64_t Seed,
+                   uint64_t Stream, unsigned Threads = 0);
+
+  static unsigned get_threads(size_t Count, unsigned Threads);
+
+  //! returns random 64 bit value of element Index
+  static inline uint64_t value(uint64_t Key, uint64_t Index) {
+    uint64_t z = Key + (Index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  static uint64_t key(uint64_t Seed, uint64_t Stream);
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_MATRIXGEN_H_
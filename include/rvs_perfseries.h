@@ -0,0 +1,127 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_PERFSERIES_H_
+#define INCLUDE_RVS_PERFSERIES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+//! max number of samples kept (1 hour of 1 s intervals)
+#define RVS_PERFSERIES_CAPACITY         (3600u)
+//! number of leading samples whose median is the throttle baseline
+#define RVS_PERFSERIES_BASELINE         (5u)
+//! number of consecutive low samples needed to report throttling
+#define RVS_PERFSERIES_THROTTLE_RUN     (3u)
+
+namespace rvs {
+
+/**
+ * @class perfseries
+ * @ingroup RVS
+ *
+ * @brief Compact time series of per-interval throughput
+ *
+ * Each sample is the throughput of one interval and its duration. When the
+ * series is full, adjacent samples are merged pairwise (duration weighted),
+ * so memory stays bounded and the whole run remains covered at a coarser
+ * resolution.
+ *
+ * Throttling is detected against the median of the first
+ * RVS_PERFSERIES_BASELINE samples: time to throttle is the start of the
+ * first run of RVS_PERFSERIES_THROTTLE_RUN consecutive samples below
+ * (1 - threshold) * baseline.
+ *
+ */
+class perfseries {
+ public:
+/**
+ * @class sample_t
+ * @ingroup RVS
+ *
+ * @brief Throughput of one interval
+ *
+ */
+  struct sample_t {
+    //! interval end (ms since series start)
+    uint64_t end_ms;
+    //! interval duration (ms)
+    uint64_t duration_ms;
+    //! throughput over the interval
+    double value;
+  };
+
+/**
+ * @class stats_t
+ * @ingroup RVS
+ *
+ * @brief Summary of the series
+ *
+ */
+  struct stats_t {
+    //! number of samples
+    size_t count;
+    //! duration weighted mean
+    double mean;
+    //! smallest sample
+    double min;
+    //! largest sample
+    double max;
+    //! 5th percentile
+    double p5;
+    //! median
+    double p50;
+    //! 95th percentile
+    double p95;
+    //! coefficient of variation (stddev / mean)
+    double cv;
+    //! time to throttle (ms since series start), -1 if not throttled
+    int64_t throttle_ms;
+  };
+
+  explicit perfseries(size_t Capacity = RVS_PERFSERIES_CAPACITY);
+
+  void add(uint64_t EndMs, uint64_t DurationMs, double Value);
+  void clear();
+  //! number of samples kept
+  size_t size() const { return samples.size(); }
+  //! samples kept, oldest first
+  const std::vector<sample_t>& get_samples() const { return samples; }
+  stats_t get_stats(double ThrottleThreshold) const;
+
+ protected:
+  void compact();
+
+ protected:
+  //! samples, oldest first
+  std::vector<sample_t> samples;
+  //! max number of samples kept
+  size_t capacity;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_PERFSERIES_H_
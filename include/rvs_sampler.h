@@ -0,0 +1,73 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_SAMPLER_H_
+#define INCLUDE_RVS_SAMPLER_H_
+
+#include <stdint.h>
+
+//! min number of samples before confidence interval is considered
+#define RVS_SAMPLER_MIN_SAMPLES         (5u)
+
+namespace rvs {
+
+/**
+ * @class sampler
+ * @ingroup RVS
+ *
+ * @brief Running mean and confidence interval of a series of measurements
+ *
+ * Mean and variance are updated incrementally (Welford's method) so that
+ * sampling can stop as soon as the 95% confidence interval of the mean is
+ * narrow enough.
+ *
+ */
+class sampler {
+ public:
+  sampler();
+
+  void add(double Value);
+  void clear();
+
+  //! number of samples added
+  uint64_t count() const { return samples; }
+  //! mean of samples added (0 if none)
+  double mean() const { return avg; }
+  double stddev() const;
+  double ci_halfwidth() const;
+  double ci_relative() const;
+  bool converged(double Tolerance) const;
+
+ protected:
+  //! number of samples added
+  uint64_t samples;
+  //! running mean
+  double avg;
+  //! running sum of squared differences from the mean
+  double m2;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_SAMPLER_H_
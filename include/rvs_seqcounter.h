@@ -0,0 +1,69 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_SEQCOUNTER_H_
+#define INCLUDE_RVS_SEQCOUNTER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace rvs {
+
+/**
+ * @class seqcounter
+ * @ingroup RVS
+ *
+ * @brief Cumulative transfer size and duration shared between one writer
+ * and any number of readers without locking
+ *
+ * Writer (transfer thread) only ever adds to the counters. Readers take a
+ * consistent snapshot of both values using sequence number: writer makes
+ * the sequence odd while updating, reader retries if the sequence was odd
+ * or changed while it was reading. Writer never waits for readers; readers
+ * only spin for the few instructions of an update in progress. Interval
+ * values (e.g. data transferred since last printout) are computed by
+ * readers as a difference of two snapshots.
+ *
+ */
+class seqcounter {
+ public:
+  seqcounter();
+
+  void add(uint64_t Size, double Duration);
+  void clear();
+  void snapshot(uint64_t* pSize, double* pDuration) const;
+
+ protected:
+  //! sequence number, odd while update is in progress
+  std::atomic<uint32_t> seq;
+  //! cumulative size (bytes)
+  std::atomic<uint64_t> size;
+  //! cumulative duration (sec)
+  std::atomic<double> duration;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_SEQCOUNTER_H_
@@ -0,0 +1,117 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_TIMELINE_H_
+#define INCLUDE_RVS_TIMELINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+//! default number of copy events preallocated per timeline
+#define RVS_TIMELINE_DEFAULT_CAPACITY   (65536u)
+
+namespace rvs {
+
+/**
+ * @class timeline
+ * @ingroup RVS
+ *
+ * @brief Recorder of device side copy timestamps
+ *
+ * Keeps start and end timestamp of every individual copy in a buffer
+ * allocated up front, so recording does not allocate memory while the test
+ * is running. Once the buffer is full further events are counted as dropped.
+ * Timeline is filled by the owning worker thread only and is read after the
+ * thread has been joined, so no locking is done. Recorded timelines can be
+ * exported as Chrome trace event JSON, which can be opened in
+ * chrome://tracing or ui.perfetto.dev.
+ *
+ */
+class timeline {
+ public:
+/**
+ * @class event_t
+ * @ingroup RVS
+ *
+ * @brief Single recorded copy
+ *
+ */
+  struct event_t {
+    //! copy start (system timestamp, nsec)
+    uint64_t start;
+    //! copy end (system timestamp, nsec)
+    uint64_t end;
+    //! number of bytes copied
+    uint64_t size;
+    //! source NUMA node
+    uint32_t src;
+    //! destination NUMA node
+    uint32_t dst;
+    //! sequence number of the transfer this copy belongs to
+    uint32_t transfer;
+    //! stripe index within the transfer
+    uint16_t stripe;
+    //! 1 for reverse direction of a bidirectional transfer, 0 otherwise
+    uint16_t reverse;
+  };
+
+  timeline();
+
+  void reserve(size_t Capacity);
+  void clear();
+  //! 'true' if buffer has been allocated
+  bool enabled() const { return !events.empty(); }
+  //! returns sequence number for the next transfer
+  uint32_t next_transfer() { return transfers++; }
+  void record(const event_t& Event);
+
+  //! number of recorded events
+  size_t size() const { return count; }
+  //! recorded event
+  const event_t& at(size_t Ix) const { return events[Ix]; }
+  //! number of events which did not fit into the buffer
+  uint64_t dropped() const { return lost; }
+
+  static int write_chrome_trace(const std::string& Filename,
+                                const std::vector<const timeline*>& Timelines,
+                                const std::vector<std::string>& Names);
+  static std::string json_escape(const std::string& Str);
+
+ protected:
+  //! preallocated event buffer
+  std::vector<event_t> events;
+  //! number of valid entries in events
+  size_t count;
+  //! number of events which did not fit into the buffer
+  uint64_t lost;
+  //! number of transfers started so far
+  uint32_t transfers;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_TIMELINE_H_
@@ -25,10 +25,15 @@
 #ifndef INCLUDE_RVS_UTIL_H_
 #define INCLUDE_RVS_UTIL_H_
 
+#include <stdint.h>
+
 #include <vector>
 #include <string>
 #include <iostream>
 
+//! max number of sizes a sweep may expand into
+#define RVS_SWEEP_MAX_SIZES     (4096u)
+
 extern bool is_positive_integer(const std::string& str_val);
 
 extern std::vector<std::string> str_split(const std::string& str_val,
@@ -92,6 +97,10 @@ int rvs_util_strarr_to_uintarr(const std::vector<std::string>& sArr,
 
 extern int rvs_util_parse(const std::string& buff, bool* pval);
 
+extern int rvs_util_parse_size(const std::string& buff, uint64_t* pval);
+extern int rvs_util_parse_sweep(const std::string& buff,
+                                std::vector<uint64_t>* pval);
+
 /**
  * @brief turns string value into right type of integer, else returns error
  */
@@ -0,0 +1,126 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVS_VERIFY_H_
+#define INCLUDE_RVS_VERIFY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#include "include/rvsthreadbase.h"
+
+//! verify every transfer
+#define RVS_VERIFY_ALL                  (1u)
+//! in sampled mode, verify one transfer out of this many
+#define RVS_VERIFY_SAMPLE_INTERVAL      (16u)
+//! max number of blocks waiting to be checked before submit() blocks
+#define RVS_VERIFY_QUEUE_DEPTH          (4u)
+
+namespace rvs {
+
+/**
+ * @class verifier
+ * @ingroup RVS
+ *
+ * @brief Data integrity checker for transferred buffers
+ *
+ * Source buffers are filled with a pattern derived from a 64-bit seed using
+ * fill(). Host copies of destination buffers are submitted to a background
+ * thread which regenerates the pattern and compares it against the data, so
+ * that checking overlaps subsequent transfers. Both pattern generation and
+ * compare are vectorized (AVX-512 or AVX2, chosen at run time) with scalar
+ * fallback.
+ *
+ */
+class verifier : public ThreadBase {
+ public:
+/**
+ * @class block_t
+ * @ingroup RVS
+ *
+ * @brief Host buffer submitted for checking
+ *
+ */
+  struct block_t {
+    //! host copy of the destination buffer
+    void* data;
+    //! size of data in bytes
+    size_t size;
+    //! seed used to fill the source buffer
+    uint64_t seed;
+    //! called with data once checked (may be NULL)
+    void (*release)(void*);
+  };
+
+  //! default constructor
+  verifier();
+  //! default destructor, stops checking thread
+  virtual ~verifier();
+
+  virtual void start();
+  void stop();
+  void submit(const block_t& Block);
+  void flush();
+  void get_results(uint64_t* pBlocks, uint64_t* pErrors,
+                   uint64_t* pFirstSeed, size_t* pFirstOffset);
+
+  static void fill(void* pBuff, size_t Size, uint64_t Seed);
+  static uint64_t compare(const void* pBuff, size_t Size, uint64_t Seed,
+                          size_t* pFirst);
+  static const char* simd_name();
+
+ protected:
+  virtual void run();
+
+ protected:
+  //! blocks waiting to be checked
+  std::deque<block_t> queue;
+  //! protects queue and results
+  std::mutex mtx;
+  //! signaled when a block is queued or thread is to stop
+  std::condition_variable cv_work;
+  //! signaled when a block has been checked
+  std::condition_variable cv_done;
+  //! 'true' while checking thread is running
+  bool brun;
+  //! number of blocks being checked right now (0 or 1)
+  int busy;
+
+  //! number of checked blocks
+  uint64_t blocks;
+  //! number of mismatched 32-bit words in all checked blocks
+  uint64_t errors;
+  //! seed of the first block with mismatch
+  uint64_t first_seed;
+  //! offset (bytes) of the first mismatch in that block
+  size_t first_offset;
+};
+
+}  // namespace rvs
+
+#endif  // INCLUDE_RVS_VERIFY_H_
@@ -55,6 +55,7 @@ class actionbase {
   bool has_property(const std::string& key, std::string* pval);
   bool has_property(const std::string& key);
   int property_get_device();
+  void get_selected_gpus(std::vector<uint16_t>* pGpuId);
 
   /**
   * @brief Gets uint16_t list from the module's properties collection
@@ -142,6 +143,11 @@ class actionbase {
 
   int property_get(const std::string& prop_name, float* pVal);
 
+  int property_get_size(const std::string& prop_name, uint64_t* pVal);
+
+  int property_get_size_list(const std::string& prop_name,
+                             std::vector<uint64_t>* pVal, bool* pAll);
+
   /**
    * @brief reads key value from the module's properties collection
    * returns 1 for invalid key
@@ -36,6 +36,9 @@
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <utility>
 
 #include "hsa/hsa.h"
 #include "hsa/hsa_ext_amd.h"
@@ -50,8 +53,19 @@ using std::vector;
   #define RVSHSATRACE_
 #endif
 
+//! transfer sizes used if none are given, powers of two from 1KB to 512MB
+#define RVS_HSA_DEFAULT_SIZE_SWEEP      "1K:512M:*2"
+//! latency test transfer sizes, powers of two from 4B to 64KB
+#define RVS_HSA_LATENCY_SIZE_SWEEP      "4:64K:*2"
+//! max number of idle host staging buffers kept per agent for reuse
+#define RVS_HSA_STAGING_SPARE           (8)
+
 namespace rvs {
 
+class verifier;
+class histogram;
+class timeline;
+
 /**
  * @class linkinfo_s
  * @ingroup RVS
@@ -68,6 +82,56 @@ typedef struct linkinfo_s {
   hsa_amd_link_info_type_t etype;
 } linkinfo_t;
 
+/**
+ * @class topology_entry_s
+ * @ingroup RVS
+ *
+ * @brief Utility class used to store connectivity between two HSA agents
+ *
+ */
+typedef struct topology_entry_s {
+  //! sum of NUMA distances over all hops (hsa::NO_CONN if not connected)
+  uint32_t distance;
+  //! 0 - no access, 1 - src can access dst, 2 - both have access
+  int peer_status;
+  //! list of individual hops from source agent to destination pool
+  std::vector<linkinfo_t> hops;
+} topology_entry_t;
+
+/**
+ * @class locked_buffer_s
+ * @ingroup RVS
+ *
+ * @brief Utility class used to store host memory locked for agent access
+ *
+ */
+typedef struct locked_buffer_s {
+  //! host address of the buffer
+  void* host;
+  //! start of the mmap()-ed region
+  void* base;
+  //! length of the mmap()-ed region
+  size_t length;
+} locked_buffer_t;
+
+/**
+ * @class staging_buffer_s
+ * @ingroup RVS
+ *
+ * @brief Utility class used to store host staging buffer of an agent
+ *
+ */
+typedef struct staging_buffer_s {
+  //! host address of the buffer
+  void* ptr;
+  //! index in agent_list of the agent the buffer is accessible by
+  int agent_ix;
+  //! index in agent_list of the CPU agent owning the buffer
+  int host_ix;
+  //! size of the buffer
+  size_t size;
+} staging_buffer_t;
+
 /**
  * @class hsa
  * @ingroup RVS
@@ -106,35 +170,31 @@ class hsa {
     vector<hsa_amd_memory_pool_t> mem_pool_list;
     //! vecor of mem pools max sizes (index alligned with mem_pool_list)
     vector<size_t>                max_size_list;
+    //! vector of mem pools global flags (index alligned with mem_pool_list)
+    vector<uint32_t>              pool_flags_list;
   };
 
   //! constant for "no connection" distance value
   static const uint32_t NO_CONN = 0xFFFFFFFF;
 
-  //! list of test transfer sizes
-  const uint32_t DEFAULT_SIZE_LIST[20] = {  1 * 1024,
-                                            2 * 1024,
-                                            4 * 1024,
-                                            8 * 1024,
-                                            16 * 1024,
-                                            32 * 1024,
-                                            64 * 1024,
-                                            128 * 1024,
-                                            256 * 1024,
-                                            512 * 1024,
-                                            1 * 1024 * 1024,
-                                            2 * 1024 * 1024,
-                                            4 * 1024 * 1024,
-                                            8 * 1024 * 1024,
-                                            16 * 1024 * 1024,
-                                            32 * 1024 * 1024,
-                                            64 * 1024 * 1024,
-                                            128 * 1024 * 1024,
-                                            256 * 1024 * 1024,
-                                            512 * 1024 * 1024 };
-
-  //! same as DEFAULT_SIZE_LIST but as std::vector
-  vector<uint32_t> size_list;
+  //! type of host memory used for host side of a transfer
+  enum host_mem_t {
+    //! first suitable pool of the CPU agent
+    HOST_MEM_DEFAULT = 0,
+    //! coarse-grained CPU memory pool
+    HOST_MEM_COARSE,
+    //! fine-grained CPU memory pool
+    HOST_MEM_FINE,
+    //! pageable memory locked with hsa_amd_memory_lock()
+    HOST_MEM_LOCKED_MALLOC,
+    //! huge page backed memory locked with hsa_amd_memory_lock()
+    HOST_MEM_HUGEPAGE
+  };
+
+  //! list of test transfer sizes (see RVS_HSA_DEFAULT_SIZE_SWEEP)
+  vector<uint64_t> size_list;
+  //! list of latency test transfer sizes (see RVS_HSA_LATENCY_SIZE_SWEEP)
+  vector<uint64_t> latency_size_list;
 
   //! array of all found HSA agents
   vector<AgentInformation> agent_list;
@@ -152,11 +212,24 @@ class hsa {
 
   int Allocate(int SrcAgent, int DstAgent, size_t Size,
                      hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
-                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff);
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     int HostMem = HOST_MEM_DEFAULT);
+  void FreeBuffer(void* pBuff);
+
+  int PingPong(uint32_t SrcNode, uint32_t DstNode, size_t Size,
+               uint32_t Count, rvs::histogram* pDevice,
+               rvs::histogram* pHost, int HostMem = HOST_MEM_DEFAULT);
+
+  int SendPattern(const std::vector<std::pair<uint32_t, uint32_t>>& Copies,
+                  size_t Size, uint32_t Steps,
+                  std::vector<double>* pDurations);
 
   int SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                   size_t   Size,    bool     bidirectional,
-                  double*  Duration);
+                  double*  Duration, uint32_t Stripes = 1,
+                  rvs::verifier* pVerifier = nullptr, uint64_t Seed = 0,
+                  int HostMem = HOST_MEM_DEFAULT,
+                  rvs::timeline* pTimeline = nullptr);
 
   int GetPeerStatus(uint32_t SrcNode, uint32_t DstNode);
   int GetPeerStatusAgent(const AgentInformation& SrcAgent,
@@ -165,6 +238,17 @@ class hsa {
                   uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr);
   double GetCopyTime(bool bidirectional,
                      hsa_signal_t signal_fwd, hsa_signal_t signal_rev);
+  double GetCopyTime(bool bidirectional,
+                     const std::vector<hsa_signal_t>& signal_fwd,
+                     const std::vector<hsa_signal_t>& signal_rev);
+  int GetCopyInterval(const std::vector<hsa_signal_t>& signals,
+                      hsa_amd_profiling_async_copy_time_t* pInterval);
+  int CreateSignals(uint32_t Count, std::vector<hsa_signal_t>* pSignals);
+  void DestroySignals(std::vector<hsa_signal_t>* pSignals);
+
+  int BuildTopology();
+  int SaveTopology(const std::string& Filename);
+  int LoadTopology(const std::string& Filename);
 
   static void print_hsa_status(const char* message, hsa_status_t st);
   static void print_hsa_status(const char* file, int line,
@@ -176,6 +260,9 @@ class hsa {
                                 hsa_status_t st);
   static bool check_link_type(const std::vector<rvs::linkinfo_t>& arrLinkInfo,
                               int LinkType);
+  static std::string link_type_name(hsa_amd_link_info_type_t LinkType);
+  static int host_mem_type(const std::string& Name);
+  static std::string host_mem_name(int HostMem);
 
   void PrintTopology();
 
@@ -185,9 +272,62 @@ class hsa {
   static hsa_status_t ProcessAgent(hsa_agent_t agent, void* data);
   static hsa_status_t ProcessMemPool(hsa_amd_memory_pool_t pool, void* data);
 
+  static void GetStripe(size_t Size, size_t Stripes, size_t Ix,
+                        size_t* pOffset, size_t* pLen);
+  int StartCopy(int DstIx, void* pDst, int SrcIx, void* pSrc,
+                size_t Size, const std::vector<hsa_signal_t>& Signals);
+  void RecordCopies(rvs::timeline* pTimeline, uint32_t Transfer,
+                    uint32_t SrcNode, uint32_t DstNode, size_t Size,
+                    bool Reverse, const std::vector<hsa_signal_t>& Signals);
+
+  bool CheckPoolType(int AgentIx, size_t PoolIx, int HostMem);
+  int AllocateLocked(int SrcAgent, int DstAgent, size_t Size,
+                     hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     int HostMem);
+  void* LockHost(int AgentIx, size_t Size, int HostMem);
+  void* HostPtr(void* pBuff);
+
+  int FindHostAgent(int AgentIx);
+  void* AllocateHost(int AgentIx, size_t Size, int* pHostIx);
+  static void FreeHost(void* pBuff);
+  void* GetStaging(int AgentIx, size_t Size, int* pHostIx);
+  static void ReleaseStaging(void* pBuff);
+  int CopySync(int DstIx, void* pDst, int SrcIx, void* pSrc, size_t Size);
+  int WritePattern(int AgentIx, void* pBuff, size_t Size, uint64_t Seed);
+  int SubmitCheck(rvs::verifier* pVerifier, int AgentIx, void* pBuff,
+                  size_t Size, uint64_t Seed);
+
+  int QueryPeerStatus(const AgentInformation& SrcAgent,
+                      const AgentInformation& DstAgent);
+  int QueryLinkInfo(int SrcIx, int DstIx,
+                    uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr);
+  int GetTopologyEntry(int SrcIx, int DstIx, topology_entry_t* pEntry);
+
  protected:
   //! pointer to RVS HSA singleton
   static rvs::hsa* pDsc;
+
+  //! NUMA node to agent_list index map (-1 if no agent on that node)
+  vector<int> node_index;
+  //! dense agent_list.size() x agent_list.size() connectivity matrix
+  vector<topology_entry_t> topology;
+  //! 'true' once topology matrix is populated (discovered or loaded)
+  bool topology_valid;
+  //! protects lazy topology construction
+  std::mutex topology_mutex;
+
+  //! locked host buffers by agent address
+  std::map<void*, locked_buffer_t> locked_list;
+  //! protects locked_list
+  std::mutex locked_mutex;
+
+  //! host staging buffers in use by address
+  std::map<void*, staging_buffer_t> staging_used;
+  //! idle host staging buffers kept for reuse
+  vector<staging_buffer_t> staging_free;
+  //! protects staging_used and staging_free
+  std::mutex staging_mutex;
 };
 
 }  // namespace rvs
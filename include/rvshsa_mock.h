@@ -0,0 +1,63 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef INCLUDE_RVSHSA_MOCK_H_
+#define INCLUDE_RVSHSA_MOCK_H_
+
+/**
+ * @file rvshsa_mock.h
+ * @ingroup RVS
+ *
+ * Host emulation of the subset of HSA runtime used by rvs::hsa. Built into
+ * rvslib instead of linking against hsa-runtime64 when RVS_HSA_MOCK is set
+ * at configure time.
+ *
+ * System is described by a model file pointed to by RVS_HSA_MOCK_MODEL
+ * environment variable. If the variable is not set, a built-in model of one
+ * CPU and two xGMI connected GPUs is used. Model file is line oriented,
+ * '#' starts a comment:
+ *
+ *     agent <node> <CPU|GPU> <name>
+ *     pool <node> <size in bytes> [kernarg] [fine|coarse]
+ *     link <src node> <dst node> <type> <distance> <GBps> <latency usec>
+ *     copy_data <0|1>
+ *
+ * Link type is one of HyperTransport, QPI, PCIe, InfiniBand or xGMI. A link
+ * is full duplex and is declared once for both directions. Copies issued in
+ * the same direction of a link are serialized, so concurrent transfers share
+ * link bandwidth. Copies within one agent use the local bandwidth below.
+ * With "copy_data 0" only timing is emulated and buffers are not copied.
+ */
+
+//! environment variable holding the path to the mock model file
+#define RVS_HSA_MOCK_MODEL_ENV          "RVS_HSA_MOCK_MODEL"
+
+//! bandwidth (GBps) used for copies within the same agent
+#define RVS_HSA_MOCK_LOCAL_BANDWIDTH    (200.0)
+//! latency (usec) used for copies within the same agent
+#define RVS_HSA_MOCK_LOCAL_LATENCY      (1.0)
+//! NUMA distance reported for the same agent
+#define RVS_HSA_MOCK_LOCAL_DISTANCE     (10u)
+
+#endif  // INCLUDE_RVSHSA_MOCK_H_
@@ -0,0 +1,1326 @@
+/********************************************************************************
+ * 
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+  #include <pci/pci.h>
+  #include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hsa/hsa.h"
+
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvstimer.h"
+
+#include "include/rvs_key_def.h"
+#include "include/rvs_module.h"
+#include "include/worker_b2b.h"
+
+#define MODULE_NAME "pebb"
+#define MODULE_NAME_CAPS "PEBB"
+#define JSON_CREATE_NODE_ERROR "JSON cannot create node"
+
+using std::string;
+using std::vector;
+
+//! Default constructor
+pebb_action::pebb_action() {
+  bjson = false;
+  b2b_block_size = 0;
+  link_type = -1;
+  stripes = 1;
+  verify_interval = 0;
+  prop_test_latency = false;
+  warmup = 0;
+  ci_tolerance = 0;
+  ci_time_cap = DEFAULT_CI_TIME_CAP;
+}
+
+//! Default destructor
+pebb_action::~pebb_action() {
+  property.clear();
+}
+
+/**
+ * @brief reads all PQT related configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pebb_action::get_all_pebb_config_keys(void) {;
+  string msg;
+  int error;
+  bool bsts = true;
+
+  RVSTRACE_
+
+  if (property_get("host_to_device", &prop_h2d, true)) {
+      msg = "invalid 'host_to_device' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  if (property_get("device_to_host", &prop_d2h, true)) {
+      msg = "invalid 'device_to_host' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_size_list(RVS_CONF_BLOCK_SIZE_KEY,
+                                 &block_size, &b_block_size_all);
+  if (error == 1) {
+      msg = "invalid '" + std::string(RVS_CONF_BLOCK_SIZE_KEY) + "' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  } else if (error == 2) {
+    b_block_size_all = true;
+    block_size.clear();
+  }
+
+  error = property_get_size(RVS_CONF_B2B_BLOCK_SIZE_KEY, &b2b_block_size);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_LINK_TYPE_KEY, &link_type);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_LINK_TYPE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_STRIPES_KEY, &stripes, 1u);
+  if (error == 1 || stripes < 1) {
+    msg = "invalid '" + std::string(RVS_CONF_STRIPES_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_WARMUP_KEY, &warmup, 0u);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_WARMUP_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get<float>(RVS_CONF_CI_TOLERANCE_KEY, &ci_tolerance, 0.0f);
+  if (error == 1 || ci_tolerance < 0) {
+    msg = "invalid '" + std::string(RVS_CONF_CI_TOLERANCE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_CI_TIME_CAP_KEY, &ci_time_cap,
+                                     DEFAULT_CI_TIME_CAP);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_CI_TIME_CAP_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  std::string test;
+  error = property_get(RVS_CONF_TEST_KEY, &test, std::string("bandwidth"));
+  if (test == "latency") {
+    prop_test_latency = true;
+  } else if (error == 1 || test != "bandwidth") {
+    msg = "invalid '" + std::string(RVS_CONF_TEST_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  std::string verify;
+  error = property_get(RVS_CONF_VERIFY_KEY, &verify, std::string("false"));
+  if (verify == "true") {
+    verify_interval = RVS_VERIFY_ALL;
+  } else if (verify == "sampled") {
+    verify_interval = RVS_VERIFY_SAMPLE_INTERVAL;
+  } else if (error == 1 || verify != "false") {
+    msg = "invalid '" + std::string(RVS_CONF_VERIFY_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  std::string strmem;
+  host_mem.clear();
+  error = property_get(RVS_CONF_HOST_MEM_KEY, &strmem, std::string(""));
+  if (error == 0) {
+    auto arrmem = str_split(strmem, YAML_DEVICE_PROP_DELIMITER);
+    for (auto it = arrmem.begin(); it != arrmem.end(); ++it) {
+      int type = rvs::hsa::host_mem_type(*it);
+      if (type < 0) {
+        error = 1;
+        break;
+      }
+      host_mem.push_back(type);
+    }
+  }
+  if (error == 1 || (error == 0 && host_mem.empty())) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_MEM_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  std::string strnode;
+  host_node_all = false;
+  host_node.clear();
+  error = property_get(RVS_CONF_HOST_NODE_KEY, &strnode,
+                       std::string("closest"));
+  if (strnode == "all") {
+    host_node_all = true;
+  } else if (error == 0 && strnode != "closest") {
+    auto arrnode = str_split(strnode, YAML_DEVICE_PROP_DELIMITER);
+    if (rvs_util_strarr_to_uintarr<uint32_t>(arrnode, &host_node) < 1) {
+      error = 1;
+    }
+  }
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_HOST_NODE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get(RVS_CONF_SATURATION_GROUP_KEY, &saturation_group,
+                       std::string(""));
+  if (error == 1 || (error == 0 && saturation_group != "cpu" &&
+                     saturation_group != "port")) {
+    msg = "invalid '" + std::string(RVS_CONF_SATURATION_GROUP_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get(RVS_CONF_TOPOLOGY_CACHE_KEY, &topology_cache,
+                       std::string(""));
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_TOPOLOGY_CACHE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  error = property_get(RVS_CONF_TRACE_FILE_KEY, &trace_file, std::string(""));
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_TRACE_FILE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+  }
+
+  // back-to-back transfers do not implement these, so reject them instead
+  // of silently ignoring them
+  if (property_parallel && b2b_block_size > 0) {
+    std::vector<std::string> unsupported;
+    if (prop_test_latency)
+      unsupported.push_back(std::string(RVS_CONF_TEST_KEY) + ": latency");
+    if (stripes > 1)
+      unsupported.push_back(RVS_CONF_STRIPES_KEY);
+    if (verify_interval)
+      unsupported.push_back(RVS_CONF_VERIFY_KEY);
+    if (warmup > 0)
+      unsupported.push_back(RVS_CONF_WARMUP_KEY);
+    if (ci_tolerance > 0)
+      unsupported.push_back(RVS_CONF_CI_TOLERANCE_KEY);
+    if (!trace_file.empty())
+      unsupported.push_back(RVS_CONF_TRACE_FILE_KEY);
+    for (auto it = unsupported.begin(); it != unsupported.end(); ++it) {
+      msg = "'" + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) +
+      "' with 'parallel: true' can not be combined with '" + *it + "'";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsts = false;
+    }
+  }
+
+  return bsts;
+}
+
+/**
+ * @brief reads all common configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pebb_action::get_all_common_config_keys(void) {
+  string msg, sdevid, sdev;
+  int error;
+  int sts;
+  RVSTRACE_
+
+  bool bsts = true;
+  // get the action name
+  if (property_get(RVS_CONF_NAME_KEY, &action_name)) {
+    rvs::lp::Err("Action name missing", MODULE_NAME_CAPS);
+    return false;
+  }
+
+  // get <device> property value (a list of gpu id)
+  if ((sts = property_get_device())) {
+    switch (sts) {
+    case 1:
+      msg = "Invalid 'device' key value.";
+      break;
+    case 2:
+      msg = "Missing 'device' key.";
+      break;
+    }
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  // get the <deviceid> property value if provided
+  if (property_get_int<uint16_t>(RVS_CONF_DEVICEID_KEY,
+                                &property_device_id, 0u)) {
+    msg = "Invalid 'deviceid' key value.";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  // get the other action related properties
+  if (property_get(RVS_CONF_PARALLEL_KEY, &property_parallel, false)) {
+    msg = "invalid '" + std::string(RVS_CONF_PARALLEL_KEY) +
+    "' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<uint64_t>
+  (RVS_CONF_COUNT_KEY, &property_count, DEFAULT_COUNT);
+  if (error == 1) {
+    msg ="invalid '" + std::string(RVS_CONF_COUNT_KEY) +"' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  error = property_get_int<uint64_t>
+  (RVS_CONF_WAIT_KEY, &property_wait, DEFAULT_WAIT);
+  if (error == 1) {
+    msg = "invalid '" + std::string(RVS_CONF_WAIT_KEY) + "' key value";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_DURATION_KEY,
+    &property_duration, DEFAULT_DURATION)) {
+    msg = "Invalid '" + std::string(RVS_CONF_DURATION_KEY) +
+    "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_LOG_INTERVAL_KEY,
+    &property_log_interval, DEFAULT_LOG_INTERVAL)) {
+    msg = "Invalid '" + std::string(RVS_CONF_LOG_INTERVAL_KEY) +
+    "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    bsts = false;
+  }
+
+  return bsts;
+}
+
+/**
+ * @brief Load HSA topology from the file given in topology_cache key
+ *
+ * If the file is missing or does not match this system, topology is
+ * discovered and the file is (re)written for subsequent runs. Failure to
+ * write the file is not fatal.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::load_topology() {
+  rvs::hsa* pHsa = rvs::hsa::Get();
+  std::string msg;
+
+  if (topology_cache.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  if (pHsa->LoadTopology(topology_cache) == 0) {
+    RVSTRACE_
+    msg = "[" + action_name + "] topology loaded from " + topology_cache;
+    rvs::lp::Log(msg, rvs::loginfo);
+    return 0;
+  }
+
+  RVSTRACE_
+  if (pHsa->SaveTopology(topology_cache)) {
+    RVSTRACE_
+    msg = "[" + action_name + "] could not save topology to " +
+          topology_cache + ", it will be discovered again in the next run";
+    rvs::lp::Log(msg, rvs::logerror);
+    return 0;
+  }
+
+  msg = "[" + action_name + "] topology saved to " + topology_cache;
+  rvs::lp::Log(msg, rvs::loginfo);
+  return 0;
+}
+
+/**
+ * @brief Get CPU agents to be paired with a GPU
+ *
+ * Depending on 'host_node' key these are either the CPU agents with the
+ * smallest NUMA distance to the GPU, all CPU agents or explicitly listed
+ * ones. It is an error if no CPU agent is connected to the GPU.
+ *
+ * @param DstNode NUMA node of the GPU
+ * @param pNodes [out] NUMA nodes of selected CPU agents
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::get_host_nodes(uint16_t DstNode,
+                                std::vector<uint32_t>* pNodes) {
+  rvs::hsa* pHsa = rvs::hsa::Get();
+  std::string msg;
+
+  pNodes->clear();
+
+  if (!host_node.empty()) {
+    RVSTRACE_
+    for (auto it = host_node.begin(); it != host_node.end(); ++it) {
+      int ix = pHsa->FindAgent(*it);
+      if (ix < 0 || pHsa->agent_list[ix].agent_device_type != "CPU") {
+        RVSTRACE_
+        msg = "no CPU agent found on node " + std::to_string(*it);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+      pNodes->push_back(*it);
+    }
+    return 0;
+  }
+
+  if (host_node_all) {
+    RVSTRACE_
+    for (auto it = pHsa->cpu_list.begin(); it != pHsa->cpu_list.end(); ++it) {
+      pNodes->push_back(it->node);
+    }
+  } else {
+    RVSTRACE_
+    get_closest_host_nodes(DstNode, pNodes);
+  }
+
+  if (pNodes->empty()) {
+    RVSTRACE_
+    msg = "no CPU agent connected to GPU on node " + std::to_string(DstNode);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get CPU agents with the smallest NUMA distance to a GPU
+ *
+ * @param DstNode NUMA node of the GPU
+ * @param pNodes [out] NUMA nodes of closest CPU agents, empty if no CPU
+ * agent is connected to the GPU
+ *
+ * */
+void pebb_action::get_closest_host_nodes(uint16_t DstNode,
+                                         std::vector<uint32_t>* pNodes) {
+  rvs::hsa* pHsa = rvs::hsa::Get();
+  uint32_t min_distance = rvs::hsa::NO_CONN;
+
+  pNodes->clear();
+  for (auto it = pHsa->cpu_list.begin(); it != pHsa->cpu_list.end(); ++it) {
+    RVSTRACE_
+    // distance in either direction as the copy may be initiated by the GPU
+    uint32_t distance = rvs::hsa::NO_CONN;
+    std::vector<rvs::linkinfo_t> arr_linkinfo;
+    pHsa->GetLinkInfo(it->node, DstNode, &distance, &arr_linkinfo);
+    if (distance == rvs::hsa::NO_CONN) {
+      RVSTRACE_
+      pHsa->GetLinkInfo(DstNode, it->node, &distance, &arr_linkinfo);
+    }
+    if (distance == rvs::hsa::NO_CONN || distance > min_distance) {
+      RVSTRACE_
+      continue;
+    }
+    if (distance < min_distance) {
+      RVSTRACE_
+      min_distance = distance;
+      pNodes->clear();
+    }
+    pNodes->push_back(it->node);
+  }
+}
+
+/**
+ * @brief Create thread objects based on action description in configuation
+ * file.
+ *
+ * Threads are created but are not started. Execution, one by one of parallel,
+ * depends on "parallel" key in configuration file. Pointers to created objects
+ * are stored in "test_array" member
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::create_threads() {
+  std::string msg;
+  std::vector<uint16_t> gpu_id;
+  uint16_t transfer_ix = 0;
+  bool bmatch_found = false;
+
+  RVSTRACE_
+  get_selected_gpus(&gpu_id);
+
+  RVSTRACE_
+  for (size_t i = 0; i < gpu_id.size(); i++) {
+    uint16_t dstnode;
+    int srcnode;
+
+    RVSTRACE_
+    if (rvs::gpulist::gpu2node(gpu_id[i], &dstnode)) {
+      RVSTRACE_
+      msg = "no node found for destination GPU ID "
+        + std::to_string(gpu_id[i]);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    std::vector<uint32_t> src_nodes;
+    if (get_host_nodes(dstnode, &src_nodes)) {
+      RVSTRACE_
+      return -1;
+    }
+
+    RVSTRACE_
+    for (size_t cpu_index = 0; cpu_index < src_nodes.size(); cpu_index++) {
+      RVSTRACE_
+      srcnode = src_nodes[cpu_index];
+
+      // get link info regardless of peer status (just in case...)
+      uint32_t distance = 0;
+      bool b_reverse = false;
+
+      std::vector<rvs::linkinfo_t> arr_linkinfo;
+      rvs::hsa::Get()->GetLinkInfo(srcnode, dstnode,
+                                         &distance, &arr_linkinfo);
+      if (distance == rvs::hsa::NO_CONN) {
+        RVSTRACE_
+        rvs::hsa::Get()->GetLinkInfo(dstnode, srcnode,
+                                    &distance, &arr_linkinfo);
+        if (distance != rvs::hsa::NO_CONN) {
+          RVSTRACE_
+          // there is a path if transfer is initiated by
+          // destination agent:
+          b_reverse = true;
+        }
+      }
+
+      // if link type is specified, check that it matches
+      if (!rvs::hsa::check_link_type(arr_linkinfo, link_type))
+        continue;
+
+      bmatch_found = true;
+      transfer_ix += 1;
+
+      print_link_info(srcnode, dstnode, gpu_id[i],
+                      distance, arr_linkinfo, b_reverse);
+
+      // if GPUs are peers, create transaction for them
+      if (rvs::hsa::Get()->GetPeerStatus(srcnode, dstnode)) {
+        RVSTRACE_
+        // one transfer for each host memory type to compare
+        std::vector<int> mem_types = host_mem;
+        if (mem_types.empty()) {
+          mem_types.push_back(rvs::hsa::HOST_MEM_DEFAULT);
+        }
+        for (size_t m = 0; m < mem_types.size(); m++) {
+          if (m > 0) {
+            transfer_ix += 1;
+          }
+          pebbworker* p = nullptr;
+          if (property_parallel && b2b_block_size > 0) {
+            RVSTRACE_
+            pebbworker_b2b* pb2b = new pebbworker_b2b;
+            if (pb2b == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            pb2b->initialize(srcnode, dstnode,
+                             prop_h2d, prop_d2h, b2b_block_size);
+            p = pb2b;
+          } else {
+            RVSTRACE_
+            p = new pebbworker;
+            if (p == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            p->initialize(srcnode, dstnode, prop_h2d, prop_d2h);
+          }
+          RVSTRACE_
+          p->set_name(action_name);
+          p->set_stop_name(action_name);
+          p->set_transfer_ix(transfer_ix);
+          p->set_block_sizes(block_size);
+          p->set_stripes(stripes);
+          p->set_verify(verify_interval);
+          p->set_latency(prop_test_latency);
+          p->set_warmup(warmup);
+          p->set_convergence(ci_tolerance, ci_time_cap);
+          if (!trace_file.empty()) {
+            p->set_trace(RVS_TIMELINE_DEFAULT_CAPACITY);
+          }
+          p->set_host_mem(mem_types[m]);
+          p->set_loglevel(property_log_level);
+          test_array.push_back(p);
+        }
+      }
+    }
+  }
+
+  RVSTRACE_
+  if (test_array.size() < 1) {
+    std::string diag;
+    if (bmatch_found) {
+      diag = "No peers found";
+    } else {
+      diag = "No devices match criteria from the test configuation";
+    }
+    msg = "[" + action_name + "] pcie-bandwidth  " + diag;
+    rvs::lp::Log(msg, rvs::logerror);
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate("pcie-bandwidth",
+                              action_name.c_str(), rvs::logerror, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson,
+          "message",
+          diag);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    return -1;
+  }
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->set_transfer_num(test_array.size());
+  }
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Delete test thread objects at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::destroy_threads() {
+  RVSTRACE_
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->set_stop_name(action_name);
+    (*it)->stop();
+    delete *it;
+  }
+  return 0;
+}
+
+/**
+ * @brief Collect running average bandwidth data for all the tests and prints
+ * them out.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_running_average() {
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    print_running_average(*it);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Collect running average for this particular transfer.
+ *
+ * @param pWorker ptr to a pebbworker class
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_running_average(pebbworker* pWorker) {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[64];
+  double      bandwidth;
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+
+  if (prop_test_latency) {
+    // latency is reported only at the end of the test
+    return 0;
+  }
+
+  RVSTRACE_
+  // get running average
+  pWorker->get_running_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration);
+
+  if (duration > 0) {
+    RVSTRACE_
+    bandwidth = current_size/duration/1000/1000/1000;
+    if (bidir) {
+      RVSTRACE_
+      bandwidth *=2;
+    }
+    snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+  } else {
+    RVSTRACE_
+    // no running average in this iteration, try getting total so far
+    // (do not reset final totals as this is just intermediate query)
+    pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, false);
+      RVSTRACE_
+      bandwidth = current_size/duration/1000/1000/1000;
+      if (bidir) {
+        RVSTRACE_
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps (*)", bandwidth);
+  }
+
+//  dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(dst_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  RVSTRACE_
+  transfer_ix = pWorker->get_transfer_ix();
+  transfer_num = pWorker->get_transfer_num();
+
+  msg = "[" + action_name + "] pcie-bandwidth  ["
+      + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+      + "] "
+      + std::to_string(src_node) + " " + std::to_string(dst_id)
+      + "  h2d: " + (prop_h2d ? "true" : "false")
+      + "  d2h: " + (prop_d2h ? "true" : "false") + "  "
+      + buff;
+
+  rvs::lp::Log(msg, rvs::loginfo);
+
+  if (bjson) {
+    RVSTRACE_
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::loginfo, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson,
+                          "transfer_ix", std::to_string(transfer_ix));
+      rvs::lp::AddString(pjson,
+                          "transfer_num", std::to_string(transfer_num));
+      rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+      rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+      rvs::lp::AddString(pjson, "pcie-bandwidth (GBps)", buff);
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Collect bandwidth totals for all the tests and prints
+ * them on cout at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_final_average() {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  double      bandwidth;
+  char        buff[128];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+  bool        bverify_failed = false;
+
+  if (prop_test_latency) {
+    RVSTRACE_
+    return print_latency();
+  }
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration);
+
+    if (duration) {
+      RVSTRACE_
+      bandwidth = current_size/duration/1000/1000/1000;
+      if (bidir) {
+        RVSTRACE_
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      RVSTRACE_
+      snprintf( buff, sizeof(buff), "(not measured)");
+    }
+
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    RVSTRACE_
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+
+    std::string verify_str;
+    uint64_t    verify_blocks = 0;
+    uint64_t    verify_errors = 0;
+    if (verify_interval) {
+      RVSTRACE_
+      uint64_t first_seed;
+      size_t   first_offset;
+      (*it)->get_verify_data(&verify_blocks, &verify_errors,
+                             &first_seed, &first_offset);
+      verify_str = "  verified: " + std::to_string(verify_blocks)
+                 + "  errors: " + std::to_string(verify_errors);
+      if (verify_errors) {
+        RVSTRACE_
+        bverify_failed = true;
+        char seed_buff[32];
+        snprintf(seed_buff, sizeof(seed_buff), "0x%016llx",
+                 static_cast<unsigned long long>(first_seed));
+        msg = "data mismatch, src: " + std::to_string(src_node)
+            + "   dst: " + std::to_string(dst_id)
+            + "   mismatched words: " + std::to_string(verify_errors)
+            + "   first at offset " + std::to_string(first_offset)
+            + " of transfer with seed " + seed_buff;
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      }
+    }
+
+    std::string host_mem_name =
+      rvs::hsa::host_mem_name((*it)->get_host_mem());
+
+    msg = "[" + action_name + "] pcie-bandwidth  ["
+        + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+        + "] "
+        + std::to_string(src_node) + " " + std::to_string(dst_id)
+        + "  h2d: " + (prop_h2d ? "true" : "false")
+        + "  d2h: " + (prop_d2h ? "true" : "false")
+        + (host_mem.empty() ? "" : "  host_mem: " + host_mem_name)
+        + "  " + buff
+        + "  duration: " + std::to_string(duration) + " sec"
+        + verify_str;
+
+    rvs::lp::Log(msg, rvs::logresults);
+    if (bjson) {
+      RVSTRACE_
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        RVSTRACE_
+        rvs::lp::AddString(pjson,
+                            "transfer_ix", std::to_string(transfer_ix));
+        rvs::lp::AddString(pjson,
+                            "transfer_num", std::to_string(transfer_num));
+        rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        if (!host_mem.empty()) {
+          rvs::lp::AddString(pjson, "host_mem", host_mem_name);
+        }
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        rvs::lp::AddString(pjson, "duration (sec)",
+                           std::to_string(duration));
+        if (verify_interval) {
+          rvs::lp::AddString(pjson, "verified",
+                             std::to_string(verify_blocks));
+          rvs::lp::AddString(pjson, "verify errors",
+                             std::to_string(verify_errors));
+        }
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    RVSTRACE_
+  }
+  RVSTRACE_
+  return bverify_failed ? -1 : 0;
+}
+
+/**
+ * @brief Print round trip latency statistics for all the tests
+ *
+ * For every transfer and every block size one result line with device and
+ * host measured round trip time is printed, followed by a histogram of
+ * device round trip times at info level.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_latency() {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[256];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+  std::vector<uint64_t>        sizes;
+  std::vector<rvs::histogram>  device;
+  std::vector<rvs::histogram>  host;
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration);
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+    (*it)->get_latency_data(&sizes, &device, &host);
+
+    for (size_t i = 0; i < sizes.size() && i < device.size(); i++) {
+      RVSTRACE_
+      const rvs::histogram& d = device[i];
+      const rvs::histogram& h = host[i];
+      snprintf(buff, sizeof(buff),
+               "device (usec) min: %.2f  mean: %.2f  p50: %.2f  p99: %.2f"
+               "  max: %.2f  host (usec) min: %.2f  mean: %.2f  p50: %.2f"
+               "  p99: %.2f  max: %.2f",
+               d.min(), d.mean(), d.percentile(50), d.percentile(99), d.max(),
+               h.min(), h.mean(), h.percentile(50), h.percentile(99), h.max());
+
+      msg = "[" + action_name + "] pcie-latency  ["
+          + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+          + "] " + std::to_string(src_node) + " " + std::to_string(dst_id)
+          + "  size: " + std::to_string(sizes[i])
+          + "  round trips: " + std::to_string(d.count())
+          + "  " + buff;
+      rvs::lp::Log(msg, rvs::logresults);
+
+      msg = "[" + action_name + "] pcie-latency  ["
+          + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+          + "] size: " + std::to_string(sizes[i])
+          + "  device histogram (usec): " + d.to_string(2);
+      rvs::lp::Log(msg, rvs::loginfo);
+
+      if (bjson) {
+        RVSTRACE_
+        unsigned int sec;
+        unsigned int usec;
+        rvs::lp::get_ticks(&sec, &usec);
+        void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+        if (pjson != NULL) {
+          RVSTRACE_
+          rvs::lp::AddString(pjson,
+                             "transfer_ix", std::to_string(transfer_ix));
+          rvs::lp::AddString(pjson,
+                             "transfer_num", std::to_string(transfer_num));
+          rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+          rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+          rvs::lp::AddString(pjson, "size", std::to_string(sizes[i]));
+          rvs::lp::AddString(pjson, "round trips", std::to_string(d.count()));
+          rvs::lp::AddString(pjson, "device min (usec)",
+                             std::to_string(d.min()));
+          rvs::lp::AddString(pjson, "device mean (usec)",
+                             std::to_string(d.mean()));
+          rvs::lp::AddString(pjson, "device p50 (usec)",
+                             std::to_string(d.percentile(50)));
+          rvs::lp::AddString(pjson, "device p99 (usec)",
+                             std::to_string(d.percentile(99)));
+          rvs::lp::AddString(pjson, "device max (usec)",
+                             std::to_string(d.max()));
+          rvs::lp::AddString(pjson, "host p50 (usec)",
+                             std::to_string(h.percentile(50)));
+          rvs::lp::AddString(pjson, "host p99 (usec)",
+                             std::to_string(h.percentile(99)));
+          rvs::lp::AddString(pjson, "device histogram (usec)",
+                             d.to_string(2));
+          rvs::lp::LogRecordFlush(pjson);
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Write device timestamps of all copies to the file given in
+ * trace_file key
+ *
+ * Output is Chrome trace event JSON with one process per transfer.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::write_trace() {
+  std::vector<const rvs::timeline*> timelines;
+  std::vector<std::string> names;
+  uint64_t dropped = 0;
+  std::string msg;
+
+  if (trace_file.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    const rvs::timeline& tl = (*it)->get_timeline();
+    if (!tl.enabled()) {
+      RVSTRACE_
+      continue;
+    }
+    timelines.push_back(&tl);
+    names.push_back(action_name + " pcie ["
+                    + std::to_string((*it)->get_transfer_ix()) + "/"
+                    + std::to_string((*it)->get_transfer_num()) + "]");
+    dropped += tl.dropped();
+  }
+
+  if (rvs::timeline::write_chrome_trace(trace_file, timelines, names)) {
+    RVSTRACE_
+    msg = "could not write copy timeline to " + trace_file;
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  msg = "[" + action_name + "] copy timeline written to " + trace_file;
+  if (dropped) {
+    msg += ", " + std::to_string(dropped)
+        + " copies not recorded (trace buffer full)";
+  }
+  rvs::lp::Log(msg, rvs::loginfo);
+  return 0;
+}
+
+/**
+ * @brief Print bandwidth per block size for all compared host memory types
+ *
+ * Transfers for all memory types between the same CPU and GPU are created
+ * one after another, so each group of host_mem.size() workers forms one
+ * table.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_host_mem_table() {
+  uint16_t    src_node, dst_node;
+  uint16_t    dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[64];
+
+  for (size_t i = 0; i + host_mem.size() <= test_array.size();
+       i += host_mem.size()) {
+    RVSTRACE_
+    test_array[i]->get_final_data(&src_node, &dst_node, &bidir,
+                                  &current_size, &duration, false);
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      msg = "could not find GPU id for node " + std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    std::string prefix = "[" + action_name + "] pcie-bandwidth host_mem  "
+                       + std::to_string(src_node) + " "
+                       + std::to_string(dst_id) + "  ";
+    msg = prefix + "h2d: " + (prop_h2d ? "true" : "false")
+        + "  d2h: " + (prop_d2h ? "true" : "false");
+    rvs::lp::Log(msg, rvs::logresults);
+
+    // collect per size results of all memory types
+    std::vector<uint64_t> sizes;
+    std::vector<std::vector<size_t>> bytes(host_mem.size());
+    std::vector<std::vector<double>> durations(host_mem.size());
+    for (size_t m = 0; m < host_mem.size(); m++) {
+      test_array[i + m]->get_size_data(&sizes, &bytes[m], &durations[m]);
+    }
+
+    snprintf(buff, sizeof(buff), "%12s", "size");
+    msg = prefix + buff;
+    for (size_t m = 0; m < host_mem.size(); m++) {
+      snprintf(buff, sizeof(buff), "%16s",
+               rvs::hsa::host_mem_name(host_mem[m]).c_str());
+      msg += buff;
+    }
+    rvs::lp::Log(msg, rvs::logresults);
+
+    for (size_t s = 0; s < sizes.size(); s++) {
+      RVSTRACE_
+      void* pjson = nullptr;
+      if (bjson) {
+        unsigned int sec;
+        unsigned int usec;
+        rvs::lp::get_ticks(&sec, &usec);
+        pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+        if (pjson != NULL) {
+          rvs::lp::AddString(pjson, "src", std::to_string(src_node));
+          rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+          rvs::lp::AddString(pjson, "size", std::to_string(sizes[s]));
+        }
+      }
+
+      snprintf(buff, sizeof(buff), "%12llu",
+               static_cast<unsigned long long>(sizes[s]));
+      msg = prefix + buff;
+      for (size_t m = 0; m < host_mem.size(); m++) {
+        std::string bw;
+        if (s < durations[m].size() && durations[m][s] > 0) {
+          double bandwidth = bytes[m][s]/durations[m][s]/1000/1000/1000;
+          if (bidir) {
+            bandwidth *= 2;
+          }
+          snprintf(buff, sizeof(buff), "%.3f GBps", bandwidth);
+          bw = buff;
+        } else {
+          bw = "(not measured)";
+        }
+        snprintf(buff, sizeof(buff), "%16s", bw.c_str());
+        msg += buff;
+        if (pjson != NULL) {
+          rvs::lp::AddString(pjson, rvs::hsa::host_mem_name(host_mem[m])
+                             + " (GBps)", bw);
+        }
+      }
+      rvs::lp::Log(msg, rvs::logresults);
+      if (pjson != NULL) {
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief timer callback used to signal end of test
+ *
+ * timer callback used to signal end of test and to initiate
+ * calculation of final average
+ *
+ * */
+void pebb_action::do_final_average() {
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  rvs::lp::get_ticks(&sec, &usec);
+
+  msg = "[" + action_name + "] pebb in do_final_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "message", "pebb in do_final_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  // signal main thread to stop
+  brun = false;
+
+  // signal worker threads to stop
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+/**
+ * @brief timer callback used to signal end of log interval
+ *
+ * timer callback used to signal end of log interval and to initiate
+ * calculation of moving average
+ *
+ * */
+void pebb_action::do_running_average() {
+  unsigned int sec;
+  unsigned int usec;
+  std::string msg;
+
+  if (!brun) {
+    return;
+  }
+
+  rvs::lp::get_ticks(&sec, &usec);
+  msg = "[" + action_name + "] pebb in do_running_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                         "message",
+                         "in do_running_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+  print_running_average();
+}
+
+/**
+ * @brief Print link information.
+ *
+ * Print link information as list of "hops" between two NUMA nodes.
+ * Each hop is in format \<link_type\>:\<distance\>
+ *
+ * @param SrcNode starting NUMA node
+ * @param DstNode ending NUMA node
+ * @param DstGpuID destination GPU id
+ * @param Distance NUMA distance between the twonodes
+ * @param arrLinkInfo array of hop infos
+ * @param bReverse 'true' if info is for DST to SRC direction
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::print_link_info(int SrcNode, int DstNode, int DstGpuID,
+                      uint32_t Distance,
+                      const std::vector<rvs::linkinfo_t>& arrLinkInfo,
+                      bool bReverse) {
+  RVSTRACE_
+  std::string msg;
+
+  msg = "[" + action_name + "] pcie-bandwidth "
+      + std::to_string(SrcNode)
+      + " " + std::to_string(DstNode)
+      + " " + std::to_string(DstGpuID);
+  if (Distance == rvs::hsa::NO_CONN) {
+    msg += "  distance:-1";
+  } else {
+    msg += "  distance:" + std::to_string(Distance);
+  }
+  // iterate through individual hops
+  for (auto it = arrLinkInfo.begin(); it != arrLinkInfo.end(); it++) {
+    msg += " " + it->strtype + ":";
+    if (it->distance == rvs::hsa::NO_CONN) {
+      msg += "-1";
+    } else {
+      msg +=std::to_string(it->distance);
+    }
+  }
+  if (bReverse) {
+    msg += " (R)";
+  }
+
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson, "Src", std::to_string(SrcNode));
+      rvs::lp::AddString(pjson, "Dst", std::to_string(DstNode));
+      rvs::lp::AddString(pjson, "GPU", std::to_string(DstGpuID));
+      if (Distance == rvs::hsa::NO_CONN) {
+          rvs::lp::AddInt(pjson, "distance", -1);
+      } else {
+          rvs::lp::AddInt(pjson, "distance", Distance);
+      }
+      if (bReverse) {
+        rvs::lp::AddInt(pjson, "Reverse", 1);
+      } else {
+        rvs::lp::AddInt(pjson, "Reverse", 0);
+      }
+
+      void* phops = rvs::lp::CreateNode(pjson, "hops");
+      rvs::lp::AddNode(pjson, phops);
+
+      // iterate through individual hops
+      for (uint i = 0; i < arrLinkInfo.size(); i++) {
+        char sbuff[64];
+        snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+        void* phop = rvs::lp::CreateNode(phops, sbuff);
+        rvs::lp::AddString(phop, "type", arrLinkInfo[i].strtype);
+        if (arrLinkInfo[i].distance == rvs::hsa::NO_CONN) {
+          rvs::lp::AddInt(phop, "distance", -1);
+        } else {
+          rvs::lp::AddInt(phop, "distance", arrLinkInfo[i].distance);
+        }
+        rvs::lp::AddNode(phops, phop);
+      }
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,355 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+
+#include "include/rvs_module.h"
+#include "include/worker_b2b.h"
+
+#define MODULE_NAME "pebb"
+#define MODULE_NAME_CAPS "PEBB"
+
+//! block size used in saturation test if 'b2b_block_size' is not given
+#define PEBB_SATURATION_BLOCK_SIZE      (64u * 1024 * 1024)
+
+namespace {
+
+//! traffic patterns driven through each group
+enum saturation_pattern_t {
+  pattern_h2d = 0,
+  pattern_d2h,
+  pattern_mixed
+};
+
+const char* pattern_name(int Pattern) {
+  switch (Pattern) {
+    case pattern_h2d:
+      return "h2d";
+    case pattern_d2h:
+      return "d2h";
+    default:
+      return "mixed";
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Group selected GPUs by shared upstream path
+ *
+ * With 'saturation_group: port' GPUs are grouped by PCIe root port, with
+ * 'saturation_group: cpu' by the closest CPU agent. GPUs for which root
+ * port can not be determined are grouped by CPU agent.
+ *
+ * @param pGroups [out] map of group name to list of (CPU node, GPU ID) pairs
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::get_saturation_groups(
+      std::map<std::string, std::vector<std::pair<uint32_t, uint16_t>>>*
+      pGroups) {
+  std::vector<uint16_t> gpu_id;
+  std::string msg;
+
+  pGroups->clear();
+  get_selected_gpus(&gpu_id);
+
+  for (size_t i = 0; i < gpu_id.size(); i++) {
+    uint16_t dstnode;
+    uint16_t location;
+    uint16_t domain;
+    std::vector<uint32_t> src_nodes;
+    std::vector<uint32_t> closest;
+
+    RVSTRACE_
+    if (rvs::gpulist::gpu2node(gpu_id[i], &dstnode)) {
+      RVSTRACE_
+      msg = "no node found for destination GPU ID "
+        + std::to_string(gpu_id[i]);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    if (get_host_nodes(dstnode, &src_nodes)) {
+      RVSTRACE_
+      return -1;
+    }
+    if (src_nodes.empty()) {
+      RVSTRACE_
+      continue;
+    }
+
+    std::string group;
+    if (saturation_group == "port" &&
+        rvs::gpulist::gpu2location(gpu_id[i], &location) == 0 &&
+        rvs::gpulist::gpu2domain(gpu_id[i], &domain) == 0) {
+      RVSTRACE_
+      std::string port = rvs::gpu_get_root_port(domain, location);
+      if (!port.empty()) {
+        group = "port " + port;
+      }
+    }
+    if (group.empty()) {
+      RVSTRACE_
+      // CPU agents used for transfers ('host_node') need not be the closest
+      get_closest_host_nodes(dstnode, &closest);
+      group = "cpu " + std::to_string(closest.empty() ? src_nodes[0]
+                                                       : closest[0]);
+    }
+    (*pGroups)[group].push_back(std::make_pair(src_nodes[0], gpu_id[i]));
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Execute root complex saturation test
+ *
+ * For each group all GPUs transfer data at the same time, first all host to
+ * device, then all device to host and then mixed (every other GPU in the
+ * opposite direction, or both directions if the group has a single GPU).
+ * Each pattern runs for 'duration' milliseconds.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run_saturation() {
+  std::map<std::string, std::vector<std::pair<uint32_t, uint16_t>>> groups;
+  std::string msg;
+
+  RVSTRACE_
+  if (get_saturation_groups(&groups)) {
+    RVSTRACE_
+    return -1;
+  }
+
+  if (groups.empty()) {
+    RVSTRACE_
+    msg = "[" + action_name + "] pcie-saturation  "
+        + "No devices match criteria from the test configuation";
+    rvs::lp::Log(msg, rvs::logerror);
+    return -1;
+  }
+
+  for (auto it = groups.begin(); it != groups.end(); ++it) {
+    for (int pattern = pattern_h2d; pattern <= pattern_mixed; pattern++) {
+      RVSTRACE_
+      if (run_saturation_pattern(it->first, it->second, pattern)) {
+        RVSTRACE_
+        return -1;
+      }
+      if (rvs::lp::Stopping()) {
+        RVSTRACE_
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Drive all GPUs of one group at the same time and report results
+ *
+ * @param Group group name
+ * @param Pairs list of (CPU node, GPU ID) pairs in the group
+ * @param Pattern traffic pattern (h2d, d2h or mixed)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebb_action::run_saturation_pattern(const std::string& Group,
+                  const std::vector<std::pair<uint32_t, uint16_t>>& Pairs,
+                  int Pattern) {
+  std::vector<pebbworker_b2b*> workers;
+  std::vector<uint16_t> gpus;
+  std::vector<bool> dir_h2d;
+  std::vector<bool> dir_d2h;
+  size_t size = b2b_block_size ? b2b_block_size : PEBB_SATURATION_BLOCK_SIZE;
+  std::string msg;
+
+  for (size_t i = 0; i < Pairs.size(); i++) {
+    uint16_t dstnode;
+    RVSTRACE_
+    if (rvs::gpulist::gpu2node(Pairs[i].second, &dstnode)) {
+      RVSTRACE_
+      continue;
+    }
+    bool h2d = Pattern == pattern_h2d ||
+               (Pattern == pattern_mixed && (i % 2 == 0 || Pairs.size() == 1));
+    bool d2h = Pattern == pattern_d2h ||
+               (Pattern == pattern_mixed && (i % 2 == 1 || Pairs.size() == 1));
+
+    pebbworker_b2b* p = new pebbworker_b2b;
+    p->initialize(Pairs[i].first, dstnode, h2d, d2h, size);
+    p->set_name(action_name);
+    p->set_stop_name(action_name);
+    p->set_loglevel(property_log_level);
+    workers.push_back(p);
+    gpus.push_back(Pairs[i].second);
+    dir_h2d.push_back(h2d);
+    dir_d2h.push_back(d2h);
+  }
+
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    (*it)->start();
+  }
+
+  // all GPUs of the group run for the same wall clock window, starting once
+  // every worker has allocated its buffers
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    while (!(*it)->is_ready() && !rvs::lp::Stopping()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  bool bsetup = true;
+  for (size_t i = 0; i < workers.size(); i++) {
+    if (workers[i]->is_ready() && workers[i]->get_setup_status()) {
+      RVSTRACE_
+      msg = "pcie-saturation  " + Group + "  pattern: "
+          + pattern_name(Pattern) + "  gpu: " + std::to_string(gpus[i])
+          + "  could not allocate transfer buffers";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      bsetup = false;
+    }
+  }
+  if (!bsetup) {
+    for (auto it = workers.begin(); it != workers.end(); ++it) {
+      (*it)->stop();
+    }
+    for (auto it = workers.begin(); it != workers.end(); ++it) {
+      (*it)->join();
+      delete *it;
+    }
+    return -1;
+  }
+  auto t_start = std::chrono::steady_clock::now();
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    uint16_t src, dst;
+    bool bidir;
+    size_t bytes;
+    double busy;
+    // drop data moved while other workers were still allocating
+    (*it)->get_final_data(&src, &dst, &bidir, &bytes, &busy);
+  }
+  uint64_t duration_ms = property_duration ? property_duration
+                                           : DEFAULT_DURATION;
+  while (!rvs::lp::Stopping() &&
+         std::chrono::steady_clock::now() - t_start <
+         std::chrono::milliseconds(duration_ms)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    (*it)->stop();
+  }
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    (*it)->join();
+  }
+  double wall = std::chrono::duration<double>(
+                  std::chrono::steady_clock::now() - t_start).count();
+
+  // per GPU bandwidth over the common window
+  std::vector<double> bandwidth;
+  double aggregate = 0;
+  for (size_t i = 0; i < workers.size(); i++) {
+    uint16_t src, dst;
+    bool bidir;
+    size_t bytes;
+    double busy;
+    workers[i]->get_final_data(&src, &dst, &bidir, &bytes, &busy);
+    double bw = wall > 0 ? bytes * (bidir ? 2 : 1) / wall / 1e9 : 0;
+    bandwidth.push_back(bw);
+    aggregate += bw;
+  }
+
+  double bw_min = bandwidth.empty() ? 0 :
+                  *std::min_element(bandwidth.begin(), bandwidth.end());
+  double bw_max = bandwidth.empty() ? 0 :
+                  *std::max_element(bandwidth.begin(), bandwidth.end());
+  double fairness = bw_max > 0 ? bw_min / bw_max : 0;
+  char buff[256];
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    snprintf(buff, sizeof(buff), "%.3f GBps", bandwidth[i]);
+    msg = "[" + action_name + "] pcie-saturation  " + Group
+        + "  pattern: " + pattern_name(Pattern)
+        + "  gpu: " + std::to_string(gpus[i])
+        + "  h2d: " + (dir_h2d[i] ? "true" : "false")
+        + "  d2h: " + (dir_d2h[i] ? "true" : "false")
+        + "  " + buff;
+    rvs::lp::Log(msg, rvs::logresults);
+  }
+
+  snprintf(buff, sizeof(buff),
+           "aggregate: %.3f GBps  min: %.3f GBps  max: %.3f GBps"
+           "  fairness: %.3f", aggregate, bw_min, bw_max, fairness);
+  msg = "[" + action_name + "] pcie-saturation  " + Group
+      + "  pattern: " + pattern_name(Pattern)
+      + "  gpus: " + std::to_string(workers.size()) + "  " + buff;
+  rvs::lp::Log(msg, rvs::logresults);
+
+  if (bjson) {
+    RVSTRACE_
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson, "group", Group);
+      rvs::lp::AddString(pjson, "pattern", pattern_name(Pattern));
+      rvs::lp::AddString(pjson, "gpus", std::to_string(workers.size()));
+      rvs::lp::AddString(pjson, "aggregate (GBps)",
+                         std::to_string(aggregate));
+      rvs::lp::AddString(pjson, "min (GBps)", std::to_string(bw_min));
+      rvs::lp::AddString(pjson, "max (GBps)", std::to_string(bw_max));
+      rvs::lp::AddString(pjson, "fairness", std::to_string(fairness));
+      for (size_t i = 0; i < workers.size(); i++) {
+        rvs::lp::AddString(pjson,
+                           "gpu " + std::to_string(gpus[i])
+                           + " (GBps)", std::to_string(bandwidth[i]));
+      }
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    delete *it;
+  }
+
+  return 0;
+}
@@ -0,0 +1,524 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/worker.h"
+
+#ifdef __cplusplus
+extern "C" {
+  #endif
+  #include <pci/pci.h>
+  #include <linux/pci.h>
+  #ifdef __cplusplus
+}
+#endif
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+#include "include/rvs_module.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+
+#define MODULE_NAME "PEBB"
+
+using std::string;
+using std::vector;
+using std::map;
+
+pebbworker::pebbworker() {
+  // set to 'true' so that do_transfer() will also work
+  // when parallel: false
+  brun = true;
+  loglevel = rvs::logerror;
+  stripes = 1;
+  verify_interval = 0;
+  verify_count = 0;
+  latency = false;
+  host_mem = rvs::hsa::HOST_MEM_DEFAULT;
+  warmup = 0;
+  ci_tolerance = 0;
+  ci_time_cap = 0;
+}
+pebbworker::~pebbworker() {}
+
+/**
+ * @brief Thread function
+ *
+ * Loops while brun == TRUE and performs polled monitoring avery 1msec.
+ *
+ * */
+void pebbworker::run() {
+  std::string msg;
+
+  msg = "[" + action_name + "] pebb thread " + std::to_string(src_node) + " "
+  + std::to_string(dst_node) + " has started";
+  rvs::lp::Log(msg, rvs::logdebug);
+
+  brun = true;
+
+  while (brun) {
+    do_transfer();
+    std::this_thread::yield();
+
+    // in adaptive mode one pass samples every block size enough
+    if (ci_tolerance > 0) {
+      brun = false;
+    }
+
+    if (rvs::lp::Stopping()) {
+      brun = false;
+      RVSTRACE_
+    }
+  }
+
+  msg = "[" + action_name + "] pebb thread " + std::to_string(src_node) + " "
+  + std::to_string(dst_node) + " has finished";
+  rvs::lp::Log(msg, rvs::logdebug);
+}
+
+/**
+ * @brief Stop processing
+ *
+ * Sets brun member to FALSE thus signaling end of processing.
+ * Then it waits for std::thread to exit before returning.
+ *
+ * */
+void pebbworker::stop() {
+  std::string msg;
+
+  msg = "[" + stop_action_name + "] pebb transfer " + std::to_string(src_node)
+      + " "       + std::to_string(dst_node) + " in pebbworker::stop()";
+  rvs::lp::Log(msg, rvs::logtrace);
+
+  brun = false;
+}
+
+/**
+ * @brief Init worker object and set transfer parameters
+ *
+ * @param Src source NUMA node
+ * @param Dst destination NUMA node
+ * @param h2d 'true' for host to device transfer
+ * @param d2h 'true' for device to host transfer
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::initialize(uint16_t Src, uint16_t Dst, bool h2d, bool d2h) {
+  src_node = Src;
+  dst_node = Dst;
+  bidirect = d2h && h2d;
+
+  prop_d2h = d2h;
+  prop_h2d = h2d;
+
+  pHsa = rvs::hsa::Get();
+
+  counter.clear();
+  reported_size = 0;
+  reported_duration = 0;
+  reset_size = 0;
+  reset_duration = 0;
+
+  return 0;
+}
+
+/**
+ * @brief Executes data transfer
+ *
+ * Based on transfer parameters, initiates and performs one way or
+ * bidirectional data transfer. Resulting measurements are compounded in running
+ * totals for periodical printout during the test.
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::do_transfer() {
+  double duration;
+  int sts;
+  unsigned int startsec;
+  unsigned int startusec;
+  unsigned int endsec;
+  unsigned int endusec;
+
+  RVSTRACE_
+
+  brun = true;
+  if (loglevel >= rvs::logdebug)
+    rvs::lp::get_ticks(&startsec, &startusec);
+
+  if (block_size.size() == 0) {
+    RVSTRACE_
+    block_size = latency ? pHsa->latency_size_list : pHsa->size_list;
+  }
+
+  if (latency) {
+    RVSTRACE_
+    return do_latency();
+  }
+  if (size_bytes.size() != block_size.size()) {
+    RVSTRACE_
+    std::lock_guard<std::mutex> lk(cntmutex);
+    size_bytes.assign(block_size.size(), 0);
+    size_duration.assign(block_size.size(), 0);
+  }
+  if (warmed_up.size() != block_size.size()) {
+    RVSTRACE_
+    warmed_up.assign(block_size.size(), false);
+  }
+
+  for (size_t i = 0; brun && i < block_size.size(); i++) {
+    RVSTRACE_
+    current_size = block_size[i];
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      return -1;
+    }
+
+    // cold transfers (first touch, queue creation) are not measured
+    for (uint32_t w = 0; !warmed_up[i] && brun && w < warmup; w++) {
+      RVSTRACE_
+      sts = send_block(false, &duration);
+      if (sts) {
+        return sts;
+      }
+    }
+    warmed_up[i] = true;
+
+    // in adaptive mode, sample until mean is known precisely enough
+    rvs::sampler stats;
+    auto t_start = std::chrono::steady_clock::now();
+    do {
+      RVSTRACE_
+      sts = send_block(true, &duration);
+      if (sts) {
+        return sts;
+      }
+      stats.add(duration);
+
+      {
+        RVSTRACE_
+        counter.add(current_size, duration);
+        std::lock_guard<std::mutex> lk(cntmutex);
+        size_bytes[i] += current_size;
+        size_duration[i] += duration;
+      }
+    } while (ci_tolerance > 0 && brun && !stats.converged(ci_tolerance) &&
+             std::chrono::steady_clock::now() - t_start <
+             std::chrono::milliseconds(ci_time_cap));
+
+    if (ci_tolerance > 0) {
+      RVSTRACE_
+      log_convergence(stats);
+    }
+  }
+
+  RVSTRACE_
+  if (loglevel >= rvs::logdebug) {
+    RVSTRACE_
+    std::string msg;
+    msg = "[" + action_name + "] pebb transfer " + std::to_string(src_node)
+        + " " + std::to_string(dst_node) + " ";
+
+    rvs::lp::get_ticks(&endsec, &endusec);
+    rvs::lp::Log(msg + "start", rvs::logdebug, startsec, startusec);
+    rvs::lp::Log(msg + "finish", rvs::logdebug, endsec, endusec);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Performs single transfer of current_size bytes
+ *
+ * @param bMeasured 'false' for warmup transfers, which are neither verified
+ * nor recorded in timeline
+ * @param Duration [out] transfer duration (sec)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::send_block(bool bMeasured, double* Duration) {
+  int sts;
+
+  // seed identifies transfer so that corrupted one can be traced back
+  rvs::verifier* pcheck = nullptr;
+  uint64_t seed = (static_cast<uint64_t>(src_node) << 48)
+                | (static_cast<uint64_t>(dst_node) << 32)
+                | static_cast<uint32_t>(verify_count * 2);
+  if (bMeasured) {
+    if (verify_interval && verify_count % verify_interval == 0) {
+      RVSTRACE_
+      pcheck = &checker;
+    }
+    verify_count++;
+  }
+
+  rvs::timeline* ptimeline =
+    bMeasured && copy_timeline.enabled() ? &copy_timeline : nullptr;
+
+  // if needed, swap source and destination
+  if (!prop_h2d && prop_d2h) {
+    RVSTRACE_
+    sts = pHsa->SendTraffic(dst_node, src_node, current_size,
+                            bidirect, Duration, stripes, pcheck, seed,
+                            host_mem, ptimeline);
+  } else {
+    RVSTRACE_
+    sts = pHsa->SendTraffic(src_node, dst_node, current_size,
+                            bidirect, Duration, stripes, pcheck, seed,
+                            host_mem, ptimeline);
+  }
+  if (sts) {
+    std::string msg = "internal error, src: " + std::to_string(src_node)
+    + "   dst: " +std::to_string(dst_node)
+    + "   current size: " + std::to_string(current_size)
+    + " status "+ std::to_string(sts);
+    rvs::lp::Err(msg, MODULE_NAME, action_name);
+  }
+
+  return sts;
+}
+
+/**
+ * @brief Enable adaptive sampling
+ *
+ * @param Tolerance max relative half width of 95% confidence interval of
+ * mean transfer time (0 - disabled, fixed one transfer per block size)
+ * @param TimeCap max time (msec) spent sampling one block size
+ *
+ * */
+void pebbworker::set_convergence(float Tolerance, uint32_t TimeCap) {
+  ci_tolerance = Tolerance;
+  ci_time_cap = TimeCap;
+}
+
+/**
+ * @brief Log result of adaptive sampling of current block size
+ *
+ * @param Stats transfer time samples
+ *
+ * */
+void pebbworker::log_convergence(const rvs::sampler& Stats) {
+  char buff[128];
+  snprintf(buff, sizeof(buff), "  mean: %.3f usec  ci95: +/-%.2f%%",
+           Stats.mean() * 1e6, Stats.ci_relative() * 100);
+  std::string msg = "[" + action_name + "] pebb sampling "
+      + std::to_string(src_node) + " " + std::to_string(dst_node)
+      + "  size: " + std::to_string(current_size)
+      + "  samples: " + std::to_string(Stats.count()) + buff
+      + "  converged: "
+      + (Stats.converged(ci_tolerance) ? "true" : "false");
+  rvs::lp::Log(msg, rvs::loginfo);
+}
+
+/**
+ * @brief Enable data verification
+ *
+ * Starts checking thread if verification is requested.
+ *
+ * @param Interval verify one out of this many transfers (0 - disabled)
+ *
+ * */
+void pebbworker::set_verify(uint32_t Interval) {
+  verify_interval = Interval;
+  if (verify_interval) {
+    checker.start();
+  }
+}
+
+/**
+ * @brief Get data verification results
+ *
+ * Waits for all submitted blocks to be checked.
+ *
+ * @param Blocks [out] number of checked buffers
+ * @param Errors [out] number of mismatched 32-bit words
+ * @param FirstSeed [out] pattern seed of the first corrupted buffer
+ * @param FirstOffset [out] offset of the first mismatch in that buffer
+ *
+ * */
+void pebbworker::get_verify_data(uint64_t* Blocks, uint64_t* Errors,
+                                 uint64_t* FirstSeed, size_t* FirstOffset) {
+  checker.flush();
+  checker.get_results(Blocks, Errors, FirstSeed, FirstOffset);
+}
+
+/**
+ * @brief Get cumulatives for data transferred and time ellapsed per block size
+ *
+ * @param Sizes [out] list of block sizes
+ * @param Bytes [out] data transferred for each block size (in bytes)
+ * @param Durations [out] duration of transfers for each block size
+ * (in seconds)
+ *
+ * */
+void pebbworker::get_size_data(std::vector<uint64_t>* Sizes,
+                               std::vector<size_t>* Bytes,
+                               std::vector<double>* Durations) {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  *Sizes = block_size;
+  *Bytes = size_bytes;
+  *Durations = size_duration;
+}
+
+/**
+ * @brief Executes round trip latency measurement
+ *
+ * For each block size performs a number of round trips between source and
+ * destination and adds measured times to per size histograms.
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pebbworker::do_latency() {
+  // round trips per block size in one pass
+  const uint32_t round_trips = 16;
+  int sts;
+
+  RVSTRACE_
+  {
+    std::lock_guard<std::mutex> lk(cntmutex);
+    latency_device.resize(block_size.size());
+    latency_host.resize(block_size.size());
+  }
+
+  for (size_t i = 0; brun && i < block_size.size(); i++) {
+    rvs::histogram device;
+    rvs::histogram host;
+
+    if (rvs::lp::Stopping()) {
+      RVSTRACE_
+      return -1;
+    }
+
+    current_size = block_size[i];
+    sts = pHsa->PingPong(src_node, dst_node, current_size, round_trips,
+                         &device, &host, host_mem);
+    if (sts) {
+      std::string msg = "internal error, src: " + std::to_string(src_node)
+                + "   dst: " + std::to_string(dst_node)
+                + "   current size: " + std::to_string(current_size);
+      rvs::lp::Err(msg, MODULE_NAME, action_name);
+      return sts;
+    }
+
+    std::lock_guard<std::mutex> lk(cntmutex);
+    latency_device[i].add(device);
+    latency_host[i].add(host);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get round trip latency histograms
+ *
+ * @param Sizes [out] list of block sizes
+ * @param Device [out] round trip times (usec) from device timestamps
+ * @param Host [out] round trip times (usec) from host clock
+ *
+ * */
+void pebbworker::get_latency_data(std::vector<uint64_t>* Sizes,
+                                  std::vector<rvs::histogram>* Device,
+                                  std::vector<rvs::histogram>* Host) {
+  std::lock_guard<std::mutex> lk(cntmutex);
+  *Sizes = block_size;
+  *Device = latency_device;
+  *Host = latency_host;
+}
+
+/**
+ * @brief Get running cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in this sampling
+ * interval (in bytes)
+ * @param Duration [out] cumulative duration of transfers in this sampling
+ * interval (in seconds)
+ *
+ * */
+void pebbworker::get_running_data(uint16_t* Src,  uint16_t* Dst, bool* Bidirect,
+                                 size_t* Size, double* Duration) {
+  uint64_t size;
+  double duration;
+
+  // readers are serialized, transfer thread is never blocked
+  std::lock_guard<std::mutex> lk(readmutex);
+  counter.snapshot(&size, &duration);
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = size - reported_size;
+  *Duration = duration - reported_duration;
+
+  // start new sampling interval
+  reported_size = size;
+  reported_duration = duration;
+}
+
+/**
+ * @brief Get final cumulatives for data trnasferred and time ellapsed
+ *
+ * @param Src [out] source NUMA node
+ * @param Dst [out] destination NUMA node
+ * @param Bidirect [out] 'true' for bidirectional transfer
+ * @param Size [out] cumulative size of transferred data in
+ * this test (in bytes)
+ * @param Duration [out] cumulative duration of transfers in
+ * this test (in seconds)
+ * @param bReset [in] if 'true' set final totals to zero
+ *
+ * */
+void pebbworker::get_final_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                               size_t* Size, double* Duration, bool bReset) {
+  uint64_t size;
+  double duration;
+
+  // readers are serialized, transfer thread is never blocked
+  std::lock_guard<std::mutex> lk(readmutex);
+  counter.snapshot(&size, &duration);
+
+  *Src = src_node;
+  *Dst = dst_node;
+  *Bidirect = bidirect;
+  *Size = size - reset_size;
+  *Duration = duration - reset_duration;
+
+  // start new sampling interval
+  reported_size = size;
+  reported_duration = duration;
+
+  // reset final totals
+  if (bReset) {
+    reset_size = size;
+    reset_duration = duration;
+  }
+}
@@ -0,0 +1,176 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef PQT_SO_INCLUDE_ACTION_H_
+#define PQT_SO_INCLUDE_ACTION_H_
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+#include "include/rvsactionbase.h"
+#include "include/rvs_linkmonitor.h"
+#include "include/matrix.h"
+#include "include/pattern.h"
+
+class pqtworker;
+
+/**
+ * @class pqt_action
+ * @ingroup PQT
+ *
+ * @brief PQT action implementation class
+ *
+ * Derives from rvs::actionbase and implements actual action functionality
+ * in its run() method.
+ *
+ */
+class pqt_action : public rvs::actionbase {
+ public:
+  pqt_action();
+  virtual ~pqt_action();
+
+  virtual int run(void);
+
+ protected:
+  bool get_all_pqt_config_keys(void);
+  bool get_all_common_config_keys(void);
+
+  // PQT specific config keys
+  bool property_get_peers(int *error);
+  void property_get_test_bandwidth(int *error);
+//  void property_get_log_interval(int *error);
+  void property_get_bidirectional(int *error);
+
+  //! 'true' if "all" is found under "peer" key for this action
+  bool      prop_peer_device_all_selected;
+  //! array of peer GPU IDs to be used in data trasfers
+  std::vector<std::string> prop_peers;
+  //! deviceid of peer GPUs
+  uint32_t  prop_peer_deviceid;
+  //! 'true' if bandwidth test is to be executed for verified peers
+  bool prop_test_bandwidth;
+  //! 'true' if round trip latency is measured instead of bandwidth
+  bool prop_test_latency;
+  //! 'true' if bidirectional data transfer is required
+  bool prop_bidirectional;
+  //! list of test block sizes
+  std::vector<uint64_t> block_size;
+  //! set to 'true' if the default block sizes are to be used
+  bool b_block_size_all;
+  //! test block size for back-to-back transfers
+  uint64_t b2b_block_size;
+  //! link type
+  int link_type;
+  //! number of concurrent copies each transfer is split into
+  uint32_t stripes;
+  //! verify one out of this many transfers (0 - no verification)
+  uint32_t verify_interval;
+  //! number of unmeasured transfers done first for each block size
+  uint32_t warmup;
+  //! max relative 95% confidence interval of mean (0 - fixed sampling)
+  float ci_tolerance;
+  //! max time (msec) spent sampling one block size
+  uint32_t ci_time_cap;
+  //! file used to cache HSA topology between runs (empty if not used)
+  std::string topology_cache;
+  //! file copy timeline is written to (empty if not used)
+  std::string trace_file;
+  //! CSV file bandwidth matrix is written to (empty if not used)
+  std::string matrix_file;
+  //! CSV file with baseline bandwidth matrix (empty if not used)
+  std::string baseline_file;
+  //! max allowed relative deviation from baseline bandwidth
+  float baseline_tolerance;
+  //! bandwidth matrix of all transfers, filled by print_final_average()
+  pqtmatrix matrix;
+  //! collective traffic pattern (pqtpattern::PATTERN_NONE for GPU pairs)
+  int pattern;
+  //! 'true' if per link bandwidth time series is monitored for dips
+  bool link_health;
+  //! width (msec) of link health bandwidth bucket
+  uint32_t health_interval;
+  //! number of buckets forming rolling baseline
+  uint32_t health_window;
+  //! relative drop below baseline reported as bandwidth dip
+  float dip_threshold;
+  //! CSV file link health time series is written to (empty if not used)
+  std::string health_file;
+  //! start of test (sec, steady clock), dip times are relative to it
+  double health_t0;
+  //! number of dips already reported (index alligned with test_array)
+  std::vector<size_t> dips_reported;
+
+ protected:
+  int is_peer(uint16_t Src, uint16_t Dst);
+  int load_topology();
+  int create_threads();
+  int destroy_threads();
+
+  int run_single();
+  int run_parallel();
+
+  int print_running_average();
+  int print_running_average(pqtworker* pWorker);
+
+  int print_final_average();
+  int print_latency();
+  int write_trace();
+  int print_matrix();
+  void start_link_health();
+  std::string format_link_dip(size_t Ix, const rvs::linkmonitor::dip_t& Dip);
+  int print_link_dips();
+  int print_link_health();
+
+  int get_pattern_nodes(std::vector<uint32_t>* pNodes,
+                        std::vector<uint16_t>* pGpuId);
+  int run_pattern();
+  int run_pattern_size(const std::vector<std::pair<uint32_t, uint32_t>>&
+                       Copies, size_t Count, size_t Size);
+
+  //! 'true' for the duration of test
+  bool brun;
+
+  //! bjson field indicates if the json flag is set
+  bool bjson;
+
+ private:
+  void do_running_average(void);
+  void do_final_average(void);
+
+  std::vector<pqtworker*> test_array;
+};
+
+#endif  // PQT_SO_INCLUDE_ACTION_H_
@@ -0,0 +1,107 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef PQT_SO_INCLUDE_MATRIX_H_
+#define PQT_SO_INCLUDE_MATRIX_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class pqtmatrix
+ * @ingroup PQT
+ *
+ * @brief N x N bandwidth matrix of all tested GPU pairs
+ *
+ * Keeps one matrix per transfer direction (unidirectional or bidirectional)
+ * and block size. Size 0 stands for the total over all block sizes. Matrix
+ * can be written to and read from CSV file and compared against a baseline.
+ * CSV file consists of blocks, one per direction and size:
+ *
+ *     # bidirectional: false  size: all
+ *     src\dst,1,2
+ *     1,,41.250
+ *     2,41.118,
+ *
+ * Empty cell means the pair was not tested.
+ *
+ */
+class pqtmatrix {
+ public:
+/**
+ * @class deviation_t
+ * @ingroup PQT
+ *
+ * @brief Cell which differs from baseline
+ *
+ */
+  struct deviation_t {
+    //! 'true' for bidirectional matrix
+    bool bidirect;
+    //! block size (0 - all sizes)
+    uint64_t size;
+    //! source GPU ID
+    uint16_t src;
+    //! destination GPU ID
+    uint16_t dst;
+    //! measured bandwidth (GBps), negative if not measured
+    double measured;
+    //! baseline bandwidth (GBps)
+    double baseline;
+  };
+
+  //! key of single matrix: (bidirectional, block size)
+  typedef std::pair<bool, uint64_t> key_t;
+  //! cells of single matrix: (src, dst) -> bandwidth
+  typedef std::map<std::pair<uint16_t, uint16_t>, double> cells_t;
+
+  void add(bool Bidirect, uint64_t Size, uint16_t Src, uint16_t Dst,
+           double Bandwidth);
+  void clear() { data.clear(); }
+  //! 'true' if no cell is set
+  bool empty() const { return data.empty(); }
+  //! all matrices
+  const std::map<key_t, cells_t>& get_data() const { return data; }
+
+  std::vector<std::string> format(const key_t& Key) const;
+  int write_csv(const std::string& Filename) const;
+  int load_csv(const std::string& Filename);
+  size_t compare(const pqtmatrix& Baseline, double Tolerance,
+                 std::vector<deviation_t>* pDeviations) const;
+
+  static std::string size_name(uint64_t Size);
+
+ protected:
+  std::vector<uint16_t> get_ids(const cells_t& Cells) const;
+
+ protected:
+  //! matrices by direction and block size
+  std::map<key_t, cells_t> data;
+};
+
+#endif  // PQT_SO_INCLUDE_MATRIX_H_
@@ -0,0 +1,73 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef PQT_SO_INCLUDE_PATTERN_H_
+#define PQT_SO_INCLUDE_PATTERN_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class pqtpattern
+ * @ingroup PQT
+ *
+ * @brief Collective traffic patterns between a set of GPUs
+ *
+ * Each pattern is a set of copies run together in one synchronized step.
+ * For message size S (data per GPU):
+ *
+ *   - ring: every GPU sends S to the next one
+ *   - all_to_all: every GPU sends S/N to every other GPU
+ *   - broadcast: root sends S to every other GPU
+ *   - fan_in: every other GPU sends S to root
+ *
+ * Algorithm bandwidth is S over step time. Bus bandwidth is algorithm
+ * bandwidth scaled the same way collective benchmarks do, so that it can
+ * be compared against link speed: (N-1)/N for all_to_all and 1 otherwise.
+ *
+ */
+class pqtpattern {
+ public:
+  //! supported patterns
+  enum pattern_t {
+    PATTERN_NONE = 0,
+    PATTERN_RING,
+    PATTERN_ALL_TO_ALL,
+    PATTERN_BROADCAST,
+    PATTERN_FAN_IN
+  };
+
+  static int get_type(const std::string& Name);
+  static std::string get_name(int Pattern);
+
+  static int build(int Pattern, const std::vector<uint32_t>& Nodes,
+                   std::vector<std::pair<uint32_t, uint32_t>>* pCopies);
+  static size_t copy_size(int Pattern, size_t Size, size_t Count);
+  static double bus_factor(int Pattern, size_t Count);
+};
+
+#endif  // PQT_SO_INCLUDE_PATTERN_H_
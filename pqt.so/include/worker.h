@@ -0,0 +1,205 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#ifndef PQT_SO_INCLUDE_WORKER_H_
+#define PQT_SO_INCLUDE_WORKER_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "include/rvsthreadbase.h"
+#include "include/rvs_verify.h"
+#include "include/rvs_histogram.h"
+#include "include/rvs_sampler.h"
+#include "include/rvs_seqcounter.h"
+#include "include/rvs_linkmonitor.h"
+#include "include/rvs_timeline.h"
+
+
+/**
+ * @class pqtworker
+ * @ingroup PQT
+ *
+ * @brief Bandwidth test implementation class
+ *
+ * Derives from rvs::ThreadBase and implements actual test functionality
+ * in its run() method.
+ *
+ */
+
+namespace rvs {
+class hsa;
+}
+
+class pqtworker : public rvs::ThreadBase {
+ public:
+  //! default constructor
+  pqtworker();
+  //! default destructor
+  virtual ~pqtworker();
+
+  //! stop thread loop and exit thread
+  void stop();
+  //! Sets initiating action name
+  void set_name(const std::string& name) { action_name = name; }
+  //! sets stopping action name
+  void set_stop_name(const std::string& name) { stop_action_name = name; }
+  //! Sets JSON flag
+  void json(const bool flag) { bjson = flag; }
+  //! Returns initiating action name
+  const std::string& get_name(void) { return action_name; }
+
+  int initialize(uint16_t Src, uint16_t Dst, bool Bidirect);
+  int do_transfer();
+  void get_running_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                        size_t* Size, double* Duration);
+  void get_final_data(uint16_t* Src, uint16_t* Dst, bool* Bidirect,
+                      size_t* Size, double* Duration, bool bReset = true);
+  //! Set transfer index
+  void set_transfer_ix(uint16_t val) { transfer_ix = val; }
+  //! Get transfer index
+  uint16_t get_transfer_ix() { return transfer_ix; }
+  //! Set total number of transfers
+  void set_transfer_num(uint16_t val) { transfer_num = val; }
+  //! Get total number of transfers
+  uint16_t get_transfer_num() { return transfer_num; }
+  //! Set list of test sizes
+  void set_block_sizes(const std::vector<uint64_t>& val) { block_size = val; }
+  //! sets number of concurrent copies each transfer is split into
+  void set_stripes(uint32_t val) { stripes = val; }
+  void set_verify(uint32_t Interval);
+  void get_verify_data(uint64_t* Blocks, uint64_t* Errors,
+                       uint64_t* FirstSeed, size_t* FirstOffset);
+  //! sets latency test mode
+  void set_latency(bool val) { latency = val; }
+  void get_latency_data(std::vector<uint64_t>* Sizes,
+                        std::vector<rvs::histogram>* Device,
+                        std::vector<rvs::histogram>* Host);
+  void get_size_data(std::vector<uint64_t>* Sizes,
+                     std::vector<size_t>* Bytes,
+                     std::vector<double>* Durations);
+  //! enables link health monitoring (used by back-to-back transfers)
+  void set_health(double BucketSec, uint32_t Window, double Threshold) {
+    monitor.configure(BucketSec, Window, Threshold);
+  }
+  //! returns source NUMA node
+  uint16_t get_src_node() const { return src_node; }
+  //! returns destination NUMA node
+  uint16_t get_dst_node() const { return dst_node; }
+  //! returns link health monitor
+  const rvs::linkmonitor& get_monitor() const { return monitor; }
+  //! sets number of unmeasured transfers done first for each block size
+  void set_warmup(uint32_t val) { warmup = val; }
+  void set_convergence(float Tolerance, uint32_t TimeCap);
+  //! enables recording of copy timestamps into preallocated buffer
+  void set_trace(size_t Capacity) { copy_timeline.reserve(Capacity); }
+  //! returns recorded copy timestamps (valid once thread is joined)
+  const rvs::timeline& get_timeline() { return copy_timeline; }
+
+ protected:
+  virtual void run(void);
+  int do_latency();
+  int send_block(bool bMeasured, double* Duration);
+  void log_convergence(const rvs::sampler& Stats);
+
+ protected:
+  //! TRUE if JSON output is required
+  bool    bjson;
+  //! Loops while TRUE
+  bool    brun;
+  //! Name of the action which initiated thread
+  std::string  action_name;
+  //! Name of the action which stops thread
+  std::string  stop_action_name;
+
+  //! ptr to RVS HSA singleton wrapper
+  rvs::hsa* pHsa;
+  //! source NUMA node
+  uint16_t src_node;
+  //! destination NUMA node
+  uint16_t dst_node;
+  //! 'true' for bidirectional transfer
+  bool bidirect;
+
+  //! Current size of transfer data
+  size_t current_size;
+
+  //! cumulative size and duration of measured transfers
+  rvs::seqcounter counter;
+  //! counter snapshot at the end of last sampling interval (bytes)
+  uint64_t reported_size;
+  //! counter snapshot at the end of last sampling interval (sec)
+  double reported_duration;
+  //! counter snapshot at last reset of final totals (bytes)
+  uint64_t reset_size;
+  //! counter snapshot at last reset of final totals (sec)
+  double reset_duration;
+
+  //! transfer index
+  uint16_t transfer_ix;
+  //! total number of transfers
+  uint16_t transfer_num;
+
+  //! list of test block sizes
+  std::vector<uint64_t> block_size;
+  //! number of concurrent copies each transfer is split into
+  uint32_t stripes;
+  //! verify one out of this many transfers (0 - no verification)
+  uint32_t verify_interval;
+  //! number of transfers done so far, used for sampling and pattern seed
+  uint64_t verify_count;
+  //! checks transferred data in background
+  rvs::verifier checker;
+  //! 'true' if round trip latency is measured instead of bandwidth
+  bool latency;
+  //! round trip times (usec) from device timestamps, per block size
+  std::vector<rvs::histogram> latency_device;
+  //! round trip times (usec) from host clock, per block size
+  std::vector<rvs::histogram> latency_host;
+  //! device timestamps of individual copies (enabled by set_trace())
+  rvs::timeline copy_timeline;
+  //! number of unmeasured transfers done first for each block size
+  uint32_t warmup;
+  //! 'true' once warmup is done (index alligned with block_size)
+  std::vector<bool> warmed_up;
+  //! max relative 95% confidence interval of mean (0 - fixed sampling)
+  float ci_tolerance;
+  //! max time (msec) spent sampling one block size
+  uint32_t ci_time_cap;
+  //! total size transferred per block size (index alligned with block_size)
+  std::vector<size_t> size_bytes;
+  //! total duration per block size (index alligned with block_size)
+  std::vector<double> size_duration;
+
+  //! bandwidth time series and dips (enabled by set_health())
+  rvs::linkmonitor monitor;
+
+  //! protects per block size results (not taken for running totals)
+  std::mutex cntmutex;
+  //! serializes readers of running and final totals
+  std::mutex readmutex;
+};
+
+#endif  // PQT_SO_INCLUDE_WORKER_H_
@@ -0,0 +1,1500 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+extern "C" {
+#include <pci/pci.h>
+#include <linux/pci.h>
+}
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/pci_caps.h"
+#include "include/gpu_util.h"
+#include "include/rvs_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+#include "include/rvstimer.h"
+
+#include "include/rvs_module.h"
+#include "include/worker.h"
+#include "include/worker_b2b.h"
+
+
+#define MODULE_NAME "pqt"
+#define MODULE_NAME_CAPS "PQT"
+#define JSON_CREATE_NODE_ERROR "JSON cannot create node"
+
+using std::string;
+using std::vector;
+
+//! Default constructor
+pqt_action::pqt_action() {
+  prop_peer_deviceid = 0u;
+  b2b_block_size = 0;
+  stripes = 1;
+  verify_interval = 0;
+  prop_test_latency = false;
+  warmup = 0;
+  ci_tolerance = 0;
+  ci_time_cap = DEFAULT_CI_TIME_CAP;
+  baseline_tolerance = DEFAULT_BASELINE_TOLERANCE;
+  pattern = pqtpattern::PATTERN_NONE;
+  link_health = false;
+  health_interval = DEFAULT_HEALTH_INTERVAL;
+  health_window = DEFAULT_HEALTH_WINDOW;
+  dip_threshold = DEFAULT_DIP_THRESHOLD;
+  health_t0 = 0;
+  bjson = false;
+}
+
+//! Default destructor
+pqt_action::~pqt_action() {
+  property.clear();
+}
+
+/**
+ * gets the peer gpu_id list from the module's properties collection
+ * @param error pointer to a memory location where the error code will be stored
+ * @return true if "all" is selected, false otherwise
+ */
+bool pqt_action::property_get_peers(int *error) {
+    *error = 0;  // init with 'no error'
+    auto it = property.find("peers");
+    if (it != property.end()) {
+        if (it->second == "all") {
+            return true;
+        } else {
+            // split the list of gpu_id
+            prop_peers = str_split(it->second,
+                    YAML_DEVICE_PROP_DELIMITER);
+            if (prop_peers.empty()) {
+                *error = 1;  // list of gpu_id cannot be empty
+            } else {
+                for (vector<string>::iterator it_gpu_id =
+                        prop_peers.begin();
+                        it_gpu_id != prop_peers.end(); ++it_gpu_id)
+                    if (!is_positive_integer(*it_gpu_id)) {
+                        *error = 1;
+                        break;
+                    }
+            }
+            return false;
+        }
+
+    } else {
+        *error = 1;
+        // when error is set, it doesn't really matter whether the method
+        // returns true or false
+        return false;
+    }
+}
+
+/**
+ * gets the peer deviceid from the module's properties collection
+ * @param error pointer to a memory location where the error code will be stored
+ * @return deviceid value if valid, -1 otherwise
+ */
+/*int pqt_action::property_get_peer_deviceid(int *error) {
+    auto it = property.find("peer_deviceid");
+    int deviceid = -1;
+    *error = 0;  // init with 'no error'
+
+    if (it != property.end()) {
+        if (it->second != "") {
+            if (is_positive_integer(it->second)) {
+                deviceid = std::stoi(it->second);
+            } else {
+                *error = 1;  // we have something but it's not a number
+            }
+        } else {
+            *error = 1;  // we have an empty string
+        }
+    }
+    return deviceid;
+}*/
+
+/**
+ * @brief reads the module's properties collection to see whether bandwidth
+ * tests should be run after peer check
+ */
+void pqt_action::property_get_test_bandwidth(int *error) {
+  prop_test_bandwidth = false;
+  auto it = property.find("test_bandwidth");
+  if (it != property.end()) {
+    if (it->second == "true") {
+      prop_test_bandwidth = true;
+      *error = 0;
+    } else if (it->second == "false") {
+      *error = 0;
+    } else {
+      *error = 1;
+    }
+  } else {
+    *error = 2;
+  }
+}
+
+/**
+ * @brief reads the module's properties collection to see whether bandwidth
+ * tests should be run in both directions
+ */
+void pqt_action::property_get_bidirectional(int *error) {
+  prop_bidirectional = false;
+  auto it = property.find("bidirectional");
+  if (it != property.end()) {
+    if (it->second == "true") {
+      prop_bidirectional = true;
+      *error = 0;
+    } else if (it->second == "false") {
+      *error = 0;
+    } else {
+      *error = 1;
+    }
+  } else {
+    *error = 2;
+  }
+}
+
+/**
+ * @brief reads all PQT related configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pqt_action::get_all_pqt_config_keys(void) {
+  int    error;
+  string msg;
+  bool   res;
+  res = true;
+
+  prop_peer_device_all_selected = property_get_peers(&error);
+  if (error) {
+    msg =  "invalid peers";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  if (property_get_int<uint32_t>("peer_deviceid", &prop_peer_deviceid, 0u)) {
+    msg = "invalid 'peer_deviceid ' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  property_get_test_bandwidth(&error);
+  if (error) {
+    msg = "invalid 'test_bandwidth'";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  property_get_bidirectional(&error);
+  if (error) {
+    if (prop_test_bandwidth == true) {
+      msg = "invalid 'bidirectional'";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+    }
+  }
+
+  error = property_get_size_list(RVS_CONF_BLOCK_SIZE_KEY,
+                                 &block_size, &b_block_size_all);
+  if (error == 1) {
+      msg =  "invalid '" + std::string(RVS_CONF_BLOCK_SIZE_KEY) + "' key";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  } else if (error == 2) {
+    b_block_size_all = true;
+    block_size.clear();
+  }
+
+  error = property_get_size(RVS_CONF_B2B_BLOCK_SIZE_KEY, &b2b_block_size);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<int>(RVS_CONF_LINK_TYPE_KEY, &link_type);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_LINK_TYPE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_STRIPES_KEY, &stripes, 1u);
+  if (error == 1 || stripes < 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_STRIPES_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_WARMUP_KEY, &warmup, 0u);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_WARMUP_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get<float>(RVS_CONF_CI_TOLERANCE_KEY, &ci_tolerance, 0.0f);
+  if (error == 1 || ci_tolerance < 0) {
+    msg =  "invalid '" + std::string(RVS_CONF_CI_TOLERANCE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_CI_TIME_CAP_KEY, &ci_time_cap,
+                                     DEFAULT_CI_TIME_CAP);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_CI_TIME_CAP_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  std::string test;
+  error = property_get(RVS_CONF_TEST_KEY, &test, std::string("bandwidth"));
+  if (test == "latency") {
+    prop_test_latency = true;
+  } else if (error == 1 || test != "bandwidth") {
+    msg =  "invalid '" + std::string(RVS_CONF_TEST_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  std::string pattern_name;
+  error = property_get(RVS_CONF_PATTERN_KEY, &pattern_name, std::string(""));
+  pattern = pqtpattern::get_type(pattern_name);
+  if (error == 1 || pattern < 0) {
+    msg =  "invalid '" + std::string(RVS_CONF_PATTERN_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  std::string verify;
+  error = property_get(RVS_CONF_VERIFY_KEY, &verify, std::string("false"));
+  if (verify == "true") {
+    verify_interval = RVS_VERIFY_ALL;
+  } else if (verify == "sampled") {
+    verify_interval = RVS_VERIFY_SAMPLE_INTERVAL;
+  } else if (error == 1 || verify != "false") {
+    msg =  "invalid '" + std::string(RVS_CONF_VERIFY_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_TOPOLOGY_CACHE_KEY, &topology_cache,
+                       std::string(""));
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_TOPOLOGY_CACHE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_TRACE_FILE_KEY, &trace_file, std::string(""));
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_TRACE_FILE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_MATRIX_FILE_KEY, &matrix_file,
+                       std::string(""));
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_MATRIX_FILE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_BASELINE_FILE_KEY, &baseline_file,
+                       std::string(""));
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_BASELINE_FILE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get<float>(RVS_CONF_BASELINE_TOLERANCE_KEY,
+                              &baseline_tolerance,
+                              DEFAULT_BASELINE_TOLERANCE);
+  if (error == 1 || baseline_tolerance < 0) {
+    msg =  "invalid '" + std::string(RVS_CONF_BASELINE_TOLERANCE_KEY)
+        + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_LINK_HEALTH_KEY, &link_health, false);
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_LINK_HEALTH_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_HEALTH_INTERVAL_KEY,
+                                     &health_interval,
+                                     DEFAULT_HEALTH_INTERVAL);
+  if (error == 1 || health_interval == 0) {
+    msg =  "invalid '" + std::string(RVS_CONF_HEALTH_INTERVAL_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get_int<uint32_t>(RVS_CONF_HEALTH_WINDOW_KEY,
+                                     &health_window,
+                                     DEFAULT_HEALTH_WINDOW);
+  if (error == 1 || health_window == 0) {
+    msg =  "invalid '" + std::string(RVS_CONF_HEALTH_WINDOW_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get<float>(RVS_CONF_DIP_THRESHOLD_KEY, &dip_threshold,
+                              DEFAULT_DIP_THRESHOLD);
+  if (error == 1 || dip_threshold <= 0 || dip_threshold >= 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_DIP_THRESHOLD_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  error = property_get(RVS_CONF_HEALTH_FILE_KEY, &health_file,
+                       std::string(""));
+  if (error == 1) {
+    msg =  "invalid '" + std::string(RVS_CONF_HEALTH_FILE_KEY) + "' key";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // time series needs continuous back-to-back transfers
+  if (link_health && (b2b_block_size == 0 || !property_parallel)) {
+    msg =  "'" + std::string(RVS_CONF_LINK_HEALTH_KEY) + "' requires '"
+        + std::string(RVS_CONF_B2B_BLOCK_SIZE_KEY) + "' and '"
+        + std::string(RVS_CONF_PARALLEL_KEY) + "' keys";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  return res;
+}
+
+/**
+ * @brief reads all common configuration keys from
+ * the module's properties collection
+ * @return true if no fatal error occured, false otherwise
+ */
+bool pqt_action::get_all_common_config_keys(void) {
+  string msg, sdevid, sdev;
+  int    error;
+  bool   res;
+  res = true;
+
+  // get the action name
+  if (property_get(RVS_CONF_NAME_KEY, &action_name)) {
+    rvs::lp::Err("Action name missing", MODULE_NAME_CAPS);
+    res = false;
+  }
+
+  // get <device> property value (a list of gpu id)
+  if ((error = property_get_device())) {
+    switch (error) {
+    case 1:
+      msg = "Invalid 'device' key value.";
+      break;
+    case 2:
+      msg = "Missing 'device' key.";
+      break;
+    }
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // get the <deviceid> property value if provided
+  if (property_get_int<uint16_t>(RVS_CONF_DEVICEID_KEY,
+                                &property_device_id, 0u)) {
+    msg = "Invalid 'deviceid' key value.";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  // get the other action/GST related properties
+  if (property_get(RVS_CONF_PARALLEL_KEY, &property_parallel, false)) {
+      msg = "invalid '" + std::string(RVS_CONF_PARALLEL_KEY) +
+          "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_COUNT_KEY, &property_count, 1)) {
+      msg = "invalid '" + std::string(RVS_CONF_COUNT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_WAIT_KEY, &property_wait, 0)) {
+      msg = "invalid '" + std::string(RVS_CONF_WAIT_KEY) + "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_DURATION_KEY,
+                                 &property_duration, DEFAULT_DURATION)) {
+      msg = "invalid '" + std::string(RVS_CONF_DURATION_KEY) +
+          "' key value";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      res = false;
+  }
+
+  if (property_get_int<uint64_t>(RVS_CONF_LOG_INTERVAL_KEY,
+                            &property_log_interval, DEFAULT_LOG_INTERVAL)) {
+    msg = "invalid '" + std::string(RVS_CONF_LOG_INTERVAL_KEY) + "'";
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    res = false;
+  }
+
+  return res;
+}
+
+/**
+ * @brief Load HSA topology from the file given in topology_cache key
+ *
+ * If the file is missing or does not match this system, topology is
+ * discovered and the file is (re)written for subsequent runs. Failure to
+ * write the file is not fatal.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::load_topology() {
+  rvs::hsa* pHsa = rvs::hsa::Get();
+  std::string msg;
+
+  if (topology_cache.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  if (pHsa->LoadTopology(topology_cache) == 0) {
+    RVSTRACE_
+    msg = "[" + action_name + "] topology loaded from " + topology_cache;
+    rvs::lp::Log(msg, rvs::loginfo);
+    return 0;
+  }
+
+  RVSTRACE_
+  if (pHsa->SaveTopology(topology_cache)) {
+    RVSTRACE_
+    msg = "[" + action_name + "] could not save topology to " +
+          topology_cache + ", it will be discovered again in the next run";
+    rvs::lp::Log(msg, rvs::logerror);
+    return 0;
+  }
+
+  msg = "[" + action_name + "] topology saved to " + topology_cache;
+  rvs::lp::Log(msg, rvs::loginfo);
+  return 0;
+}
+
+/**
+ * @brief Create thread objects based on action description in configuation
+ * file.
+ *
+ * Threads are created but are not started. Execution, one by one of parallel,
+ * depends on "parallel" key in configuration file. Pointers to created objects
+ * are stored in "test_array" member
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::create_threads() {
+  std::string msg;
+
+  std::vector<uint16_t> gpu_id;
+  std::vector<uint16_t> gpu_device_id;
+  uint16_t transfer_ix = 0;
+  bool bmatch_found = false;
+
+  gpu_get_all_gpu_id(&gpu_id);
+  gpu_get_all_device_id(&gpu_device_id);
+
+  for (size_t i = 0; i < gpu_id.size(); i++) {    // all possible sources
+    // filter out by source device id
+    if (property_device_id > 0) {
+      if (property_device_id != gpu_device_id[i]) {
+        continue;
+      }
+    }
+
+    // filter out by listed sources
+    if (!property_device_all) {
+      const auto it = std::find(property_device.cbegin(),
+                                property_device.cend(),
+                                gpu_id[i]);
+      if (it == property_device.cend()) {
+            continue;
+      }
+    }
+
+    for (size_t j = 0; j < gpu_id.size(); j++) {  // all possible peers
+      RVSTRACE_
+      // filter out by peer id
+      if (prop_peer_deviceid > 0) {
+        RVSTRACE_
+        if (prop_peer_deviceid != gpu_device_id[j]) {
+          RVSTRACE_
+          continue;
+        }
+      }
+
+      RVSTRACE_
+      // filter out by listed peers
+      if (!prop_peer_device_all_selected) {
+        RVSTRACE_
+        const auto it = std::find(prop_peers.cbegin(),
+                                  prop_peers.cend(),
+                                  std::to_string(gpu_id[j]));
+        if (it == prop_peers.cend()) {
+          RVSTRACE_
+          continue;
+        }
+      }
+
+      RVSTRACE_
+      // signal that at lease one matching src-dst combination
+      // has been found:
+      bmatch_found = true;
+
+      // get NUMA nodes
+      uint16_t srcnode;
+      if (rvs::gpulist::gpu2node(gpu_id[i], &srcnode)) {
+        msg + "no node found for GPU ID " + std::to_string(gpu_id[i]);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+
+      uint16_t dstnode;
+      if (rvs::gpulist::gpu2node(gpu_id[j], &dstnode)) {
+        RVSTRACE_
+        msg = "no node found for GPU ID " + std::to_string(gpu_id[j]);
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+        return -1;
+      }
+
+      RVSTRACE_
+      uint32_t distance = 0;
+      std::vector<rvs::linkinfo_t> arr_linkinfo;
+      rvs::hsa::Get()->GetLinkInfo(srcnode, dstnode,
+                                         &distance, &arr_linkinfo);
+
+      // perform peer check
+      if (is_peer(gpu_id[i], gpu_id[j])) {
+        RVSTRACE_
+        msg = "[" + action_name + "] p2p "
+            + std::to_string(gpu_id[i]) + " "
+            + std::to_string(gpu_id[j]) + " peers:true ";
+
+        if (distance == rvs::hsa::NO_CONN) {
+          msg += "distance:-1";
+        } else {
+          msg += "distance:" + std::to_string(distance);
+        }
+        // iterate through individual hops
+        for (auto it = arr_linkinfo.begin(); it != arr_linkinfo.end(); it++) {
+          msg += " " + it->strtype + ":";
+          if (it->distance == rvs::hsa::NO_CONN) {
+            msg += "-1";
+          } else {
+            msg +=std::to_string(it->distance);
+          }
+        }
+        rvs::lp::Log(msg, rvs::logresults);
+
+        if (bjson) {
+          RVSTRACE_
+          unsigned int sec;
+          unsigned int usec;
+          rvs::lp::get_ticks(&sec, &usec);
+          void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+          if (pjson != NULL) {
+            RVSTRACE_
+            rvs::lp::AddString(pjson, "src",
+                               std::to_string(gpu_id[i]));
+            rvs::lp::AddString(pjson, "dst",
+                               std::to_string(gpu_id[j]));
+            rvs::lp::AddString(pjson, "p2p", "true");
+            if (distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(pjson, "distance", -1);
+            } else {
+                rvs::lp::AddInt(pjson, "distance", distance);
+            }
+
+            void* phops = rvs::lp::CreateNode(pjson, "hops");
+            rvs::lp::AddNode(pjson, phops);
+
+            // iterate through individual hops
+            for (uint i = 0; i < arr_linkinfo.size(); i++) {
+              char sbuff[64];
+              snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+             void* phop = rvs::lp::CreateNode(phops, sbuff);
+              rvs::lp::AddString(phop, "type", arr_linkinfo[i].strtype);
+              if (arr_linkinfo[i].distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(phop, "distance", -1);
+              } else {
+                rvs::lp::AddInt(phop, "distance", arr_linkinfo[i].distance);
+              }
+             rvs::lp::AddNode(phops, phop);
+            }
+
+            rvs::lp::LogRecordFlush(pjson);
+          }
+        }
+
+        RVSTRACE_
+        // GPUs are peers, create transaction for them
+        if (prop_test_bandwidth) {
+          RVSTRACE_
+          pqtworker* p = nullptr;
+
+          transfer_ix += 1;
+          if (b2b_block_size > 0 && property_parallel) {
+            RVSTRACE_
+            pqtworker_b2b* pb2b = new pqtworker_b2b;
+            if (pb2b == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            pb2b->initialize(srcnode, dstnode, prop_bidirectional,
+                             b2b_block_size);
+            p = pb2b;
+
+          } else {
+            RVSTRACE_
+            p = new pqtworker;
+            if (p == nullptr) {
+              RVSTRACE_
+              msg = "internal error";
+              rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+              return -1;
+            }
+            p->initialize(srcnode, dstnode, prop_bidirectional);
+          }
+          RVSTRACE_
+          p->set_name(action_name);
+          p->set_stop_name(action_name);
+          p->set_transfer_ix(transfer_ix);
+          p->set_block_sizes(block_size);
+          p->set_stripes(stripes);
+          p->set_verify(verify_interval);
+          p->set_latency(prop_test_latency);
+          p->set_warmup(warmup);
+          p->set_convergence(ci_tolerance, ci_time_cap);
+          if (!trace_file.empty()) {
+            p->set_trace(RVS_TIMELINE_DEFAULT_CAPACITY);
+          }
+          if (link_health) {
+            p->set_health(health_interval / 1000.0, health_window,
+                          dip_threshold);
+          }
+          test_array.push_back(p);
+        }
+
+      } else {
+        RVSTRACE_
+        msg = "[" + action_name + "] p2p "
+            + std::to_string(gpu_id[i]) + " "
+            + std::to_string(gpu_id[j]) + " peers:false ";
+
+        if (distance == rvs::hsa::NO_CONN) {
+          msg += "distance:-1";
+        } else {
+          msg += "distance:" + std::to_string(distance);
+        }
+        // iterate through individual hops
+        for (auto it = arr_linkinfo.begin(); it != arr_linkinfo.end(); it++) {
+          msg += " " + it->strtype + ":";
+          if (it->distance == rvs::hsa::NO_CONN) {
+            msg += "-1";
+          } else {
+            msg +=std::to_string(it->distance);
+          }
+        }
+
+        rvs::lp::Log(msg, rvs::logresults);
+
+        if (bjson) {
+          RVSTRACE_
+          unsigned int sec;
+          unsigned int usec;
+          rvs::lp::get_ticks(&sec, &usec);
+          void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+          if (pjson != NULL) {
+            RVSTRACE_
+            rvs::lp::AddString(pjson,
+                               "src", std::to_string(gpu_id[i]));
+            rvs::lp::AddString(pjson,
+                               "dst", std::to_string(gpu_id[j]));
+            rvs::lp::AddString(pjson,
+                               "p2p", "false");
+            if (distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(pjson, "distance", -1);
+            } else {
+                rvs::lp::AddInt(pjson, "distance", distance);
+            }
+
+            void* phops = rvs::lp::CreateNode(pjson, "hops");
+            rvs::lp::AddNode(pjson, phops);
+
+            // iterate through individual hops
+            for (uint i = 0; i < arr_linkinfo.size(); i++) {
+              char sbuff[64];
+              snprintf(sbuff, sizeof(sbuff), "hop%d", i);
+             void* phop = rvs::lp::CreateNode(phops, sbuff);
+              rvs::lp::AddString(phop, "type", arr_linkinfo[i].strtype);
+              if (arr_linkinfo[i].distance == rvs::hsa::NO_CONN) {
+                rvs::lp::AddInt(phop, "distance", -1);
+              } else {
+                rvs::lp::AddInt(phop, "distance", arr_linkinfo[i].distance);
+              }
+             rvs::lp::AddNode(phops, phop);
+            }
+
+            rvs::lp::LogRecordFlush(pjson);
+          }
+        }
+      }
+    }
+  }
+
+  RVSTRACE_
+  if (prop_test_bandwidth && test_array.size() < 1) {
+    RVSTRACE_
+    std::string diag;
+    if (bmatch_found) {
+      RVSTRACE_
+      diag = "No peers found";
+    } else {
+      RVSTRACE_
+      diag = "No devices match criteria from the test configuation";
+    }
+    RVSTRACE_
+    msg = "[" + action_name + "] p2p-bandwidth " + diag;
+    rvs::lp::Log(msg, rvs::logerror);
+    if (bjson) {
+      RVSTRACE_
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate("p2p-bandwidth",
+                              action_name.c_str(), rvs::logerror, sec, usec);
+      if (pjson != NULL) {
+        RVSTRACE_
+        rvs::lp::AddString(pjson,
+          "message",
+          diag);
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    RVSTRACE_
+    return 0;
+  }
+
+  RVSTRACE_
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->set_transfer_num(test_array.size());
+  }
+
+  RVSTRACE_
+  return 0;
+}
+
+/**
+ * @brief Delete test thread objects at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::destroy_threads() {
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->set_stop_name(action_name);
+    (*it)->stop();
+    delete *it;
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Check if two GPU can access each other memory
+ *
+ * @param Src GPU ID of the source GPU
+ * @param Dst GPU ID of the destination GPU
+ *
+ * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
+ *
+ * */
+int pqt_action::is_peer(uint16_t Src, uint16_t Dst) {
+  //! ptr to RVS HSA singleton wrapper
+  rvs::hsa* pHsa;
+  string msg;
+
+  if (Src == Dst) {
+    return 0;
+  }
+  pHsa = rvs::hsa::Get();
+
+  // GPUs are peers, create transaction for them
+  // get NUMA nodes
+  uint16_t srcnode;
+  if (rvs::gpulist::gpu2node(Src, &srcnode)) {
+    msg + "no node found for GPU ID " + std::to_string(Src);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  uint16_t dstnode;
+  if (rvs::gpulist::gpu2node(Dst, &dstnode)) {
+    RVSTRACE_
+    msg = "no node found for GPU ID " + std::to_string(Dst);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  return pHsa->rvs::hsa::GetPeerStatus(srcnode, dstnode);
+}
+
+/**
+ * @brief Collect running average bandwidth data for all the tests and prints
+ * them out every log_interval msecs.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_running_average() {
+  for (auto it = test_array.begin(); brun && it != test_array.end(); ++it) {
+    print_running_average(*it);
+  }
+  print_link_dips();
+
+  return 0;
+}
+
+/**
+ * @brief Collect running average for this particular transfer.
+ *
+ * @param pWorker ptr to a pqtworker class
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_running_average(pqtworker* pWorker) {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[64];
+  double      bandwidth;
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+
+  if (prop_test_latency) {
+    // latency is reported only at the end of the test
+    return 0;
+  }
+
+  // get running average
+  pWorker->get_running_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration);
+
+  if (duration > 0) {
+    bandwidth = current_size/duration/1000 / 1000 / 1000;
+    if (bidir) {
+      bandwidth *=2;
+    }
+    snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+  } else {
+    // no running average in this iteration, try getting total so far
+    // (do not reset final totals as this is just intermediate query)
+    pWorker->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration, false);
+    if (duration > 0) {
+      bandwidth = current_size/duration/1000 / 1000 / 1000;
+      if (bidir) {
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps (*)", bandwidth);
+    } else {
+      // not transfers at all - print "pending"
+      snprintf( buff, sizeof(buff), "(pending)");
+    }
+  }
+
+//   src_id = rvs::gpulist::GetGpuIdFromNodeId(src_node);
+//   dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(src_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  RVSTRACE_
+  if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+    RVSTRACE_
+    std::string msg = "could not find GPU id for node " +
+                      std::to_string(dst_node);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  transfer_ix = pWorker->get_transfer_ix();
+  transfer_num = pWorker->get_transfer_num();
+
+  msg = "[" + action_name + "] p2p-bandwidth  ["
+      + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+      + "] " + std::to_string(src_id) + " " + std::to_string(dst_id)
+      + "  bidirectional: " + std::string(bidir ? "true" : "false")
+      + "  " + buff;
+  rvs::lp::Log(msg, rvs::loginfo);
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::loginfo, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                          "transfer_ix", std::to_string(transfer_ix));
+      rvs::lp::AddString(pjson,
+                          "transfer_num", std::to_string(transfer_num));
+      rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+      rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+      rvs::lp::AddString(pjson, "p2p", "true");
+      rvs::lp::AddString(pjson, "bidirectional",
+                          std::string(bidir ? "true" : "false"));
+      rvs::lp::AddString(pjson, "bandwidth (GBs)", buff);
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Collect bandwidth totals for all the tests and prints
+ * them out at the end of action execution
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_final_average() {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  double      bandwidth;
+  char        buff[128];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+  bool        bverify_failed = false;
+
+  if (prop_test_latency) {
+    RVSTRACE_
+    return print_latency();
+  }
+
+  matrix.clear();
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                            &current_size, &duration);
+
+    if (duration) {
+      bandwidth = current_size/duration/1000 / 1000 / 1000;
+      if (bidir) {
+        bandwidth *=2;
+      }
+      snprintf( buff, sizeof(buff), "%.3f GBps", bandwidth);
+    } else {
+      snprintf( buff, sizeof(buff), "(not measured)");
+    }
+//     src_id = rvs::gpulist::GetGpuIdFromNodeId(src_node);
+//     dst_id = rvs::gpulist::GetGpuIdFromNodeId(dst_node);
+
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(src_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    RVSTRACE_
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+
+    if (duration) {
+      RVSTRACE_
+      matrix.add(bidir, 0, src_id, dst_id, bandwidth);
+      std::vector<uint64_t> sizes;
+      std::vector<size_t> bytes;
+      std::vector<double> durations;
+      (*it)->get_size_data(&sizes, &bytes, &durations);
+      for (size_t i = 0; i < sizes.size() && i < durations.size(); i++) {
+        if (durations[i] > 0) {
+          matrix.add(bidir, sizes[i], src_id, dst_id,
+                     bytes[i] / durations[i] / 1e9 * (bidir ? 2 : 1));
+        }
+      }
+    }
+
+    std::string verify_str;
+    uint64_t    verify_blocks = 0;
+    uint64_t    verify_errors = 0;
+    if (verify_interval) {
+      RVSTRACE_
+      uint64_t first_seed;
+      size_t   first_offset;
+      (*it)->get_verify_data(&verify_blocks, &verify_errors,
+                             &first_seed, &first_offset);
+      verify_str = "  verified: " + std::to_string(verify_blocks)
+                 + "  errors: " + std::to_string(verify_errors);
+      if (verify_errors) {
+        RVSTRACE_
+        bverify_failed = true;
+        char seed_buff[32];
+        snprintf(seed_buff, sizeof(seed_buff), "0x%016llx",
+                 static_cast<unsigned long long>(first_seed));
+        msg = "data mismatch, src: " + std::to_string(src_id)
+            + "   dst: " + std::to_string(dst_id)
+            + "   mismatched words: " + std::to_string(verify_errors)
+            + "   first at offset " + std::to_string(first_offset)
+            + " of transfer with seed " + seed_buff;
+        rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      }
+    }
+
+    msg = "[" + action_name + "] p2p-bandwidth  ["
+        + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+        + "] " + std::to_string(src_id) + " " + std::to_string(dst_id)
+        + "  bidirectional: " + std::string(bidir ? "true" : "false")
+        + "  " + buff + "  duration: " + std::to_string(duration) + " sec"
+        + verify_str;
+
+    rvs::lp::Log(msg, rvs::logresults);
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson,
+                            "transfer_ix", std::to_string(transfer_ix));
+        rvs::lp::AddString(pjson,
+                            "transfer_num", std::to_string(transfer_num));
+        rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        rvs::lp::AddString(pjson, "p2p", "true");
+        rvs::lp::AddString(pjson, "bidirectional",
+                           std::string(bidir ? "true" : "false"));
+        rvs::lp::AddString(pjson, "bandwidth (GBps)", buff);
+        rvs::lp::AddString(pjson, "duration (sec)",
+                           std::to_string(duration));
+        if (verify_interval) {
+          rvs::lp::AddString(pjson, "verified",
+                             std::to_string(verify_blocks));
+          rvs::lp::AddString(pjson, "verify errors",
+                             std::to_string(verify_errors));
+        }
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+    sleep(1);
+  }
+
+  return bverify_failed ? -1 : 0;
+}
+
+/**
+ * @brief Print round trip latency statistics for all the tests
+ *
+ * For every transfer and every block size one result line with device and
+ * host measured round trip time is printed, followed by a histogram of
+ * device round trip times at info level.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_latency() {
+  uint16_t    src_node, dst_node;
+  uint16_t    src_id, dst_id;
+  bool        bidir;
+  size_t      current_size;
+  double      duration;
+  std::string msg;
+  char        buff[256];
+  uint16_t    transfer_ix;
+  uint16_t    transfer_num;
+  std::vector<uint64_t>        sizes;
+  std::vector<rvs::histogram>  device;
+  std::vector<rvs::histogram>  host;
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    RVSTRACE_
+    (*it)->get_final_data(&src_node, &dst_node, &bidir,
+                          &current_size, &duration);
+    if (rvs::gpulist::node2gpu(src_node, &src_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(src_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    if (rvs::gpulist::node2gpu(dst_node, &dst_id)) {
+      RVSTRACE_
+      std::string msg = "could not find GPU id for node " +
+                        std::to_string(dst_node);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    transfer_ix = (*it)->get_transfer_ix();
+    transfer_num = (*it)->get_transfer_num();
+    (*it)->get_latency_data(&sizes, &device, &host);
+
+    for (size_t i = 0; i < sizes.size() && i < device.size(); i++) {
+      RVSTRACE_
+      const rvs::histogram& d = device[i];
+      const rvs::histogram& h = host[i];
+      snprintf(buff, sizeof(buff),
+               "device (usec) min: %.2f  mean: %.2f  p50: %.2f  p99: %.2f"
+               "  max: %.2f  host (usec) min: %.2f  mean: %.2f  p50: %.2f"
+               "  p99: %.2f  max: %.2f",
+               d.min(), d.mean(), d.percentile(50), d.percentile(99), d.max(),
+               h.min(), h.mean(), h.percentile(50), h.percentile(99), h.max());
+
+      msg = "[" + action_name + "] p2p-latency  ["
+          + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+          + "] " + std::to_string(src_id) + " " + std::to_string(dst_id)
+          + "  size: " + std::to_string(sizes[i])
+          + "  round trips: " + std::to_string(d.count())
+          + "  " + buff;
+      rvs::lp::Log(msg, rvs::logresults);
+
+      msg = "[" + action_name + "] p2p-latency  ["
+          + std::to_string(transfer_ix) + "/" + std::to_string(transfer_num)
+          + "] size: " + std::to_string(sizes[i])
+          + "  device histogram (usec): " + d.to_string(2);
+      rvs::lp::Log(msg, rvs::loginfo);
+
+      if (bjson) {
+        RVSTRACE_
+        unsigned int sec;
+        unsigned int usec;
+        rvs::lp::get_ticks(&sec, &usec);
+        void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                          action_name.c_str(), rvs::logresults, sec, usec);
+        if (pjson != NULL) {
+          RVSTRACE_
+          rvs::lp::AddString(pjson,
+                             "transfer_ix", std::to_string(transfer_ix));
+          rvs::lp::AddString(pjson,
+                             "transfer_num", std::to_string(transfer_num));
+          rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+          rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+          rvs::lp::AddString(pjson, "size", std::to_string(sizes[i]));
+          rvs::lp::AddString(pjson, "round trips", std::to_string(d.count()));
+          rvs::lp::AddString(pjson, "device min (usec)",
+                             std::to_string(d.min()));
+          rvs::lp::AddString(pjson, "device mean (usec)",
+                             std::to_string(d.mean()));
+          rvs::lp::AddString(pjson, "device p50 (usec)",
+                             std::to_string(d.percentile(50)));
+          rvs::lp::AddString(pjson, "device p99 (usec)",
+                             std::to_string(d.percentile(99)));
+          rvs::lp::AddString(pjson, "device max (usec)",
+                             std::to_string(d.max()));
+          rvs::lp::AddString(pjson, "host p50 (usec)",
+                             std::to_string(h.percentile(50)));
+          rvs::lp::AddString(pjson, "host p99 (usec)",
+                             std::to_string(h.percentile(99)));
+          rvs::lp::AddString(pjson, "device histogram (usec)",
+                             d.to_string(2));
+          rvs::lp::LogRecordFlush(pjson);
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Write device timestamps of all copies to the file given in
+ * trace_file key
+ *
+ * Output is Chrome trace event JSON with one process per transfer.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::write_trace() {
+  std::vector<const rvs::timeline*> timelines;
+  std::vector<std::string> names;
+  uint64_t dropped = 0;
+  std::string msg;
+
+  if (trace_file.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    const rvs::timeline& tl = (*it)->get_timeline();
+    if (!tl.enabled()) {
+      RVSTRACE_
+      continue;
+    }
+    timelines.push_back(&tl);
+    names.push_back(action_name + " p2p ["
+                    + std::to_string((*it)->get_transfer_ix()) + "/"
+                    + std::to_string((*it)->get_transfer_num()) + "]");
+    dropped += tl.dropped();
+  }
+
+  if (rvs::timeline::write_chrome_trace(trace_file, timelines, names)) {
+    RVSTRACE_
+    msg = "could not write copy timeline to " + trace_file;
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  msg = "[" + action_name + "] copy timeline written to " + trace_file;
+  if (dropped) {
+    msg += ", " + std::to_string(dropped)
+        + " copies not recorded (trace buffer full)";
+  }
+  rvs::lp::Log(msg, rvs::loginfo);
+  return 0;
+}
+
+/**
+ * @brief Print bandwidth matrix of all transfers and compare it against
+ * baseline
+ *
+ * Matrix totalled over all block sizes is printed at results level and
+ * matrices for individual block sizes at info level. Matrix is optionally
+ * written to the file given in matrix_file key. If baseline_file key is
+ * given, every baseline cell is checked against measured bandwidth and
+ * each one deviating by more than baseline_tolerance is reported as error.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_matrix() {
+  std::string msg;
+  char buff[128];
+
+  if (prop_test_latency || matrix.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  const auto& data = matrix.get_data();
+  for (auto it = data.begin(); it != data.end(); ++it) {
+    std::string title = "[" + action_name + "] p2p-matrix"
+                      + "  bidirectional: "
+                      + std::string(it->first.first ? "true" : "false")
+                      + "  size: " + pqtmatrix::size_name(it->first.second)
+                      + "  (GBps)";
+    int level = it->first.second ? rvs::loginfo : rvs::logresults;
+    rvs::lp::Log(title, level);
+    std::vector<std::string> lines = matrix.format(it->first);
+    for (auto lit = lines.begin(); lit != lines.end(); ++lit) {
+      rvs::lp::Log("[" + action_name + "] p2p-matrix  " + *lit, level);
+    }
+  }
+
+  if (bjson) {
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      void* pmatrices = rvs::lp::CreateNode(pjson, "bandwidth matrix");
+      rvs::lp::AddNode(pjson, pmatrices);
+      for (auto it = data.begin(); it != data.end(); ++it) {
+        std::string name = std::string(it->first.first ? "bidir" : "unidir")
+                         + " size " + pqtmatrix::size_name(it->first.second);
+        void* pmatrix = rvs::lp::CreateNode(pmatrices, name.c_str());
+        for (auto cit = it->second.begin(); cit != it->second.end(); ++cit) {
+          snprintf(buff, sizeof(buff), "%.3f", cit->second);
+          rvs::lp::AddString(pmatrix,
+                             std::to_string(cit->first.first) + "-"
+                             + std::to_string(cit->first.second), buff);
+        }
+        rvs::lp::AddNode(pmatrices, pmatrix);
+      }
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  if (!matrix_file.empty()) {
+    if (matrix.write_csv(matrix_file)) {
+      RVSTRACE_
+      msg = "could not write bandwidth matrix to " + matrix_file;
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    msg = "[" + action_name + "] bandwidth matrix written to " + matrix_file;
+    rvs::lp::Log(msg, rvs::loginfo);
+  }
+
+  if (baseline_file.empty()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  pqtmatrix baseline;
+  if (baseline.load_csv(baseline_file)) {
+    RVSTRACE_
+    msg = "could not load baseline bandwidth matrix from " + baseline_file;
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  std::vector<pqtmatrix::deviation_t> deviations;
+  matrix.compare(baseline, baseline_tolerance, &deviations);
+  for (auto it = deviations.begin(); it != deviations.end(); ++it) {
+    msg = "bandwidth deviates from baseline, src: " + std::to_string(it->src)
+        + "   dst: " + std::to_string(it->dst)
+        + "   bidirectional: " + std::string(it->bidirect ? "true" : "false")
+        + "   size: " + pqtmatrix::size_name(it->size);
+    if (it->measured < 0) {
+      snprintf(buff, sizeof(buff),
+               "   measured: (not measured)   baseline: %.3f GBps",
+               it->baseline);
+    } else {
+      snprintf(buff, sizeof(buff),
+               "   measured: %.3f GBps   baseline: %.3f GBps",
+               it->measured, it->baseline);
+    }
+    msg += buff;
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+  }
+
+  snprintf(buff, sizeof(buff), "%.1f%%", baseline_tolerance * 100);
+  msg = "[" + action_name + "] p2p-baseline  " + baseline_file
+      + "  tolerance: " + buff
+      + "  deviations: " + std::to_string(deviations.size())
+      + "  pass: " + std::string(deviations.empty() ? "true" : "false");
+  rvs::lp::Log(msg, rvs::logresults);
+
+  return deviations.empty() ? 0 : -1;
+}
+
+/**
+ * @brief timer callback used to signal end of test
+ *
+ * timer callback used to signal end of test and to initiate
+ * calculation of final average
+ *
+ * */
+void pqt_action::do_final_average() {
+  std::string msg;
+  unsigned int sec;
+  unsigned int usec;
+  rvs::lp::get_ticks(&sec, &usec);
+
+  msg = "[" + action_name + "] pqt in do_final_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson, "message", "pqt in do_final_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  brun = false;
+
+  // signal worker threads to stop
+  for (auto it = test_array.begin(); it != test_array.end(); ++it) {
+    (*it)->stop();
+  }
+}
+
+/**
+ * @brief timer callback used to signal end of log interval
+ *
+ * timer callback used to signal end of log interval and to initiate
+ * calculation of moving average
+ *
+ * */
+void pqt_action::do_running_average() {
+  unsigned int sec;
+  unsigned int usec;
+  std::string msg;
+
+  rvs::lp::get_ticks(&sec, &usec);
+  msg = "[" + action_name + "] pqt in do_running_average";
+  rvs::lp::Log(msg, rvs::logtrace, sec, usec);
+  if (bjson) {
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                            action_name.c_str(), rvs::logtrace, sec, usec);
+    if (pjson != NULL) {
+      rvs::lp::AddString(pjson,
+                         "message",
+                         "in do_running_average");
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+  print_running_average();
+}
@@ -0,0 +1,297 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/worker.h"
+
+#include "include/rvs_module.h"
+
+#define MODULE_NAME "pqt"
+#define MODULE_NAME_CAPS "PQT"
+
+/**
+ * @brief Get GPU IDs of transfer end points
+ *
+ * @param pWorker transfer
+ * @param pSrcId [out] source GPU ID
+ * @param pDstId [out] destination GPU ID
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+static int get_link_ids(const pqtworker* pWorker,
+                        uint16_t* pSrcId, uint16_t* pDstId) {
+  if (rvs::gpulist::node2gpu(pWorker->get_src_node(), pSrcId)) {
+    return -1;
+  }
+  if (rvs::gpulist::node2gpu(pWorker->get_dst_node(), pDstId)) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Start link health monitoring for this run
+ *
+ * Records test start time all dip times are reported against.
+ *
+ * */
+void pqt_action::start_link_health() {
+  health_t0 = std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  dips_reported.assign(test_array.size(), 0);
+}
+
+/**
+ * @brief Format single dip together with other GPUs dipping at the same time
+ *
+ * @param Ix index of transfer in test_array
+ * @param Dip dip to format
+ * @return formatted dip description
+ *
+ * */
+std::string pqt_action::format_link_dip(size_t Ix,
+                                        const rvs::linkmonitor::dip_t& Dip) {
+  uint16_t src_id = 0;
+  uint16_t dst_id = 0;
+  char buff[192];
+  std::vector<uint16_t> concurrent;
+  std::vector<rvs::linkmonitor::dip_t> other;
+
+  get_link_ids(test_array[Ix], &src_id, &dst_id);
+
+  // collect GPUs of other links with overlapping dips
+  for (size_t i = 0; i < test_array.size(); i++) {
+    if (i == Ix) {
+      continue;
+    }
+    test_array[i]->get_monitor().get_dips(0, &other);
+    for (auto it = other.begin(); it != other.end(); ++it) {
+      if (it->start < Dip.end && Dip.start < it->end) {
+        uint16_t other_src, other_dst;
+        if (get_link_ids(test_array[i], &other_src, &other_dst) == 0) {
+          concurrent.push_back(other_src);
+          concurrent.push_back(other_dst);
+        }
+        break;
+      }
+    }
+  }
+  std::sort(concurrent.begin(), concurrent.end());
+  concurrent.erase(std::unique(concurrent.begin(), concurrent.end()),
+                   concurrent.end());
+
+  double depth = Dip.baseline > 0 ? 1 - Dip.min / Dip.baseline : 0;
+  snprintf(buff, sizeof(buff), "start: %.3f s  end: %.3f s  "
+           "baseline: %.3f GBps  min: %.3f GBps  depth: %.1f%%",
+           Dip.start - health_t0, Dip.end - health_t0,
+           Dip.baseline, Dip.min, depth * 100);
+
+  std::string msg = std::to_string(src_id) + " " + std::to_string(dst_id)
+                  + "  " + buff + "  concurrent:";
+  if (concurrent.empty()) {
+    msg += " none";
+  }
+  for (auto it = concurrent.begin(); it != concurrent.end(); ++it) {
+    msg += " " + std::to_string(*it);
+  }
+  return msg;
+}
+
+/**
+ * @brief Log bandwidth dips completed since the last call
+ *
+ * Called together with running average so dips are visible while test is
+ * still running.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::print_link_dips() {
+  std::vector<rvs::linkmonitor::dip_t> dips;
+
+  if (!link_health || dips_reported.size() != test_array.size()) {
+    RVSTRACE_
+    return 0;
+  }
+
+  for (size_t i = 0; i < test_array.size(); i++) {
+    size_t total = test_array[i]->get_monitor().get_dips(dips_reported[i],
+                                                         &dips);
+    for (auto it = dips.begin(); it != dips.end(); ++it) {
+      rvs::lp::Log("[" + action_name + "] link-dip  "
+                   + format_link_dip(i, *it), rvs::loginfo);
+    }
+    dips_reported[i] = total;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Print link health summary and all bandwidth dips
+ *
+ * For each transfer mean and lowest bucket bandwidth and number of dips
+ * are printed. Every dip is reported as error. Bandwidth time series of
+ * all transfers is optionally written to the CSV file given in health_file
+ * key, one row per bucket and one column per transfer.
+ *
+ * @return 0 - if no dips were found, non-zero otherwise
+ *
+ * */
+int pqt_action::print_link_health() {
+  std::string msg;
+  char buff[128];
+  int sts = 0;
+  std::vector<rvs::linkmonitor::sample_t> series;
+  std::vector<rvs::linkmonitor::dip_t> dips;
+  // bucket index -> bandwidth per transfer (NAN if not sampled)
+  std::map<uint64_t, std::vector<float>> rows;
+  std::string header = "time_sec";
+
+  if (!link_health) {
+    RVSTRACE_
+    return 0;
+  }
+
+  for (size_t i = 0; i < test_array.size(); i++) {
+    const rvs::linkmonitor& monitor = test_array[i]->get_monitor();
+    uint16_t src_id = 0;
+    uint16_t dst_id = 0;
+
+    get_link_ids(test_array[i], &src_id, &dst_id);
+    monitor.get_series(&series);
+    monitor.get_dips(0, &dips);
+
+    double sum = 0;
+    double min = 0;
+    for (auto it = series.begin(); it != series.end(); ++it) {
+      sum += it->bandwidth;
+      min = it == series.begin() ? it->bandwidth
+                                 : std::min<double>(min, it->bandwidth);
+      auto rit = rows.find(it->bucket);
+      if (rit == rows.end()) {
+        rit = rows.emplace(it->bucket,
+                           std::vector<float>(test_array.size(), NAN)).first;
+      }
+      rit->second[i] = it->bandwidth;
+    }
+    double mean = series.empty() ? 0 : sum / series.size();
+    header += "," + std::to_string(src_id) + "-" + std::to_string(dst_id);
+
+    snprintf(buff, sizeof(buff), "buckets: %zu  mean: %.3f GBps  "
+             "min: %.3f GBps  dips: %zu",
+             series.size(), mean, min, dips.size());
+    msg = "[" + action_name + "] link-health  "
+        + std::to_string(src_id) + " " + std::to_string(dst_id)
+        + "  bidirectional: "
+        + std::string(prop_bidirectional ? "true" : "false")
+        + "  " + buff;
+    rvs::lp::Log(msg, rvs::logresults);
+
+    for (auto it = dips.begin(); it != dips.end(); ++it) {
+      msg = "link bandwidth dip, " + format_link_dip(i, *it);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      sts = -1;
+    }
+
+    if (bjson) {
+      unsigned int sec;
+      unsigned int usec;
+      rvs::lp::get_ticks(&sec, &usec);
+      void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                              action_name.c_str(), rvs::logresults, sec, usec);
+      if (pjson != NULL) {
+        rvs::lp::AddString(pjson, "src", std::to_string(src_id));
+        rvs::lp::AddString(pjson, "dst", std::to_string(dst_id));
+        rvs::lp::AddString(pjson, "buckets", std::to_string(series.size()));
+        snprintf(buff, sizeof(buff), "%.3f", mean);
+        rvs::lp::AddString(pjson, "mean_bandwidth", buff);
+        snprintf(buff, sizeof(buff), "%.3f", min);
+        rvs::lp::AddString(pjson, "min_bandwidth", buff);
+        void* pdips = rvs::lp::CreateNode(pjson, "dips");
+        rvs::lp::AddNode(pjson, pdips);
+        for (size_t d = 0; d < dips.size(); d++) {
+          void* pdip = rvs::lp::CreateNode(pdips, std::to_string(d).c_str());
+          snprintf(buff, sizeof(buff), "%.3f", dips[d].start - health_t0);
+          rvs::lp::AddString(pdip, "start", buff);
+          snprintf(buff, sizeof(buff), "%.3f", dips[d].end - health_t0);
+          rvs::lp::AddString(pdip, "end", buff);
+          snprintf(buff, sizeof(buff), "%.3f", dips[d].baseline);
+          rvs::lp::AddString(pdip, "baseline", buff);
+          snprintf(buff, sizeof(buff), "%.3f", dips[d].min);
+          rvs::lp::AddString(pdip, "min", buff);
+          rvs::lp::AddNode(pdips, pdip);
+        }
+        rvs::lp::LogRecordFlush(pjson);
+      }
+    }
+  }
+
+  if (health_file.empty() || test_array.empty()) {
+    RVSTRACE_
+    return sts;
+  }
+
+  std::ofstream out(health_file);
+  if (!out) {
+    RVSTRACE_
+    msg = "could not write link health time series to " + health_file;
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  double bucket_sec = test_array[0]->get_monitor().get_bucket();
+  out << header << "\n";
+  for (auto it = rows.begin(); it != rows.end(); ++it) {
+    snprintf(buff, sizeof(buff), "%.3f", it->first * bucket_sec - health_t0);
+    out << buff;
+    for (auto vit = it->second.begin(); vit != it->second.end(); ++vit) {
+      out << ",";
+      if (!std::isnan(*vit)) {
+        snprintf(buff, sizeof(buff), "%.3f", *vit);
+        out << buff;
+      }
+    }
+    out << "\n";
+  }
+
+  msg = "[" + action_name + "] link health time series written to "
+      + health_file;
+  rvs::lp::Log(msg, rvs::loginfo);
+  return sts;
+}
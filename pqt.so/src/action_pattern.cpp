@@ -0,0 +1,249 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/action.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/rvs_key_def.h"
+#include "include/gpu_util.h"
+#include "include/rvsloglp.h"
+#include "include/rvshsa.h"
+
+#include "include/rvs_module.h"
+
+#define MODULE_NAME "pqt"
+#define MODULE_NAME_CAPS "PQT"
+
+//! number of measured steps for each message size
+#define PQT_PATTERN_STEPS       (20u)
+
+/**
+ * @brief Get GPUs participating in collective pattern
+ *
+ * GPUs are selected by 'device' and 'deviceid' keys, in ascending GPU ID
+ * order. The first one is root of broadcast and fan_in patterns.
+ *
+ * @param pNodes [out] NUMA nodes of selected GPUs
+ * @param pGpuId [out] IDs of selected GPUs
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::get_pattern_nodes(std::vector<uint32_t>* pNodes,
+                                  std::vector<uint16_t>* pGpuId) {
+  std::string msg;
+
+  get_selected_gpus(pGpuId);
+  pNodes->clear();
+
+  for (size_t i = 0; i < pGpuId->size(); i++) {
+    uint16_t node;
+    if (rvs::gpulist::gpu2node((*pGpuId)[i], &node)) {
+      RVSTRACE_
+      msg = "no node found for GPU ID " + std::to_string((*pGpuId)[i]);
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+    pNodes->push_back(node);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Execute collective pattern test
+ *
+ * All copies of the pattern selected in 'pattern' key are run together in
+ * synchronized steps, for each block size in turn. Every copy must be
+ * between peer GPUs.
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_pattern() {
+  std::vector<uint32_t> nodes;
+  std::vector<uint16_t> gpus;
+  std::vector<std::pair<uint32_t, uint32_t>> copies;
+  std::string msg;
+  rvs::hsa* pHsa = rvs::hsa::Get();
+
+  RVSTRACE_
+  if (get_pattern_nodes(&nodes, &gpus)) {
+    RVSTRACE_
+    return -1;
+  }
+
+  if (pqtpattern::build(pattern, nodes, &copies)) {
+    RVSTRACE_
+    msg = "[" + action_name + "] p2p-pattern  "
+        + "pattern " + pqtpattern::get_name(pattern)
+        + " needs at least two GPUs selected by the test configuration";
+    rvs::lp::Log(msg, rvs::logerror);
+    return -1;
+  }
+
+  std::string gpu_list;
+  for (size_t i = 0; i < gpus.size(); i++) {
+    gpu_list += (i ? " " : "") + std::to_string(gpus[i]);
+  }
+
+  // every copy must be possible without staging through host
+  for (auto it = copies.begin(); it != copies.end(); ++it) {
+    if (pHsa->GetPeerStatus(it->first, it->second) < 1) {
+      RVSTRACE_
+      uint16_t src_id = 0;
+      uint16_t dst_id = 0;
+      rvs::gpulist::node2gpu(it->first, &src_id);
+      rvs::gpulist::node2gpu(it->second, &dst_id);
+      msg = "pattern " + pqtpattern::get_name(pattern)
+          + " needs GPU " + std::to_string(src_id)
+          + " to access GPU " + std::to_string(dst_id)
+          + " but they are not peers";
+      rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+      return -1;
+    }
+  }
+
+  msg = "[" + action_name + "] p2p-pattern  "
+      + pqtpattern::get_name(pattern) + "  gpus: " + gpu_list
+      + "  copies per step: " + std::to_string(copies.size());
+  rvs::lp::Log(msg, rvs::loginfo);
+
+  std::vector<uint64_t> sizes(block_size);
+  if (sizes.empty()) {
+    RVSTRACE_
+    sizes = pHsa->size_list;
+  }
+
+  for (size_t i = 0; i < sizes.size() && !rvs::lp::Stopping(); i++) {
+    if (run_pattern_size(copies, nodes.size(), sizes[i])) {
+      RVSTRACE_
+      return -1;
+    }
+  }
+
+  return rvs::lp::Stopping() ? -1 : 0;
+}
+
+/**
+ * @brief Run collective pattern for one message size and report results
+ *
+ * @param Copies copies done in each step
+ * @param Count number of participating GPUs
+ * @param Size message size (data per GPU)
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqt_action::run_pattern_size(
+                  const std::vector<std::pair<uint32_t, uint32_t>>& Copies,
+                  size_t Count, size_t Size) {
+  std::vector<double> durations;
+  std::string msg;
+  char buff[256];
+  rvs::hsa* pHsa = rvs::hsa::Get();
+
+  size_t copy_size = pqtpattern::copy_size(pattern, Size, Count);
+  if (copy_size == 0) {
+    RVSTRACE_
+    return 0;
+  }
+  // message size actually moved (all_to_all rounds down to N chunks)
+  size_t msg_size = pattern == pqtpattern::PATTERN_ALL_TO_ALL ?
+                    copy_size * Count : copy_size;
+
+  if (warmup > 0 &&
+      pHsa->SendPattern(Copies, copy_size, warmup, &durations)) {
+    RVSTRACE_
+    msg = "pattern " + pqtpattern::get_name(pattern)
+        + " failed for size " + std::to_string(Size);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+  if (pHsa->SendPattern(Copies, copy_size, PQT_PATTERN_STEPS, &durations) ||
+      durations.empty()) {
+    RVSTRACE_
+    msg = "pattern " + pqtpattern::get_name(pattern)
+        + " failed for size " + std::to_string(Size);
+    rvs::lp::Err(msg, MODULE_NAME_CAPS, action_name);
+    return -1;
+  }
+
+  double total = 0;
+  for (auto it = durations.begin(); it != durations.end(); ++it) {
+    total += *it;
+  }
+  double mean = total / durations.size();
+  double tmin = *std::min_element(durations.begin(), durations.end());
+  double tmax = *std::max_element(durations.begin(), durations.end());
+  double algbw = mean > 0 ? msg_size / mean / 1e9 : 0;
+  double busbw = algbw * pqtpattern::bus_factor(pattern, Count);
+
+  snprintf(buff, sizeof(buff),
+           "time: %.3f usec  algbw: %.3f GBps  busbw: %.3f GBps",
+           mean * 1e6, algbw, busbw);
+  msg = "[" + action_name + "] p2p-pattern  "
+      + pqtpattern::get_name(pattern)
+      + "  gpus: " + std::to_string(Count)
+      + "  size: " + std::to_string(msg_size) + "  " + buff;
+  rvs::lp::Log(msg, rvs::logresults);
+
+  snprintf(buff, sizeof(buff),
+           "steps: %zu  min: %.3f usec  max: %.3f usec",
+           durations.size(), tmin * 1e6, tmax * 1e6);
+  msg = "[" + action_name + "] p2p-pattern  "
+      + pqtpattern::get_name(pattern)
+      + "  size: " + std::to_string(msg_size) + "  " + buff;
+  rvs::lp::Log(msg, rvs::loginfo);
+
+  if (bjson) {
+    RVSTRACE_
+    unsigned int sec;
+    unsigned int usec;
+    rvs::lp::get_ticks(&sec, &usec);
+    void* pjson = rvs::lp::LogRecordCreate(MODULE_NAME,
+                        action_name.c_str(), rvs::logresults, sec, usec);
+    if (pjson != NULL) {
+      RVSTRACE_
+      rvs::lp::AddString(pjson, "pattern", pqtpattern::get_name(pattern));
+      rvs::lp::AddString(pjson, "gpus", std::to_string(Count));
+      rvs::lp::AddString(pjson, "size", std::to_string(msg_size));
+      rvs::lp::AddString(pjson, "steps", std::to_string(durations.size()));
+      rvs::lp::AddString(pjson, "time (usec)", std::to_string(mean * 1e6));
+      rvs::lp::AddString(pjson, "min time (usec)",
+                         std::to_string(tmin * 1e6));
+      rvs::lp::AddString(pjson, "max time (usec)",
+                         std::to_string(tmax * 1e6));
+      rvs::lp::AddString(pjson, "algbw (GBps)", std::to_string(algbw));
+      rvs::lp::AddString(pjson, "busbw (GBps)", std::to_string(busbw));
+      rvs::lp::LogRecordFlush(pjson);
+    }
+  }
+
+  return 0;
+}
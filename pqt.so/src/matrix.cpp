@@ -0,0 +1,286 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/matrix.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+/**
+ * @brief Set matrix cell
+ *
+ * @param Bidirect 'true' for bidirectional transfer
+ * @param Size block size (0 - all sizes)
+ * @param Src source GPU ID
+ * @param Dst destination GPU ID
+ * @param Bandwidth bandwidth in GBps
+ *
+ * */
+void pqtmatrix::add(bool Bidirect, uint64_t Size, uint16_t Src, uint16_t Dst,
+                    double Bandwidth) {
+  data[key_t(Bidirect, Size)][std::make_pair(Src, Dst)] = Bandwidth;
+}
+
+/**
+ * @brief Get block size as printed in reports
+ *
+ * @param Size block size (0 - all sizes)
+ * @return size in bytes or "all"
+ *
+ * */
+std::string pqtmatrix::size_name(uint64_t Size) {
+  return Size ? std::to_string(Size) : std::string("all");
+}
+
+/**
+ * @brief Get sorted list of all GPU IDs appearing in a matrix
+ *
+ * @param Cells matrix cells
+ * @return list of GPU IDs
+ *
+ * */
+std::vector<uint16_t> pqtmatrix::get_ids(const cells_t& Cells) const {
+  std::vector<uint16_t> ids;
+  for (auto it = Cells.begin(); it != Cells.end(); ++it) {
+    ids.push_back(it->first.first);
+    ids.push_back(it->first.second);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
+/**
+ * @brief Format one matrix as text table
+ *
+ * @param Key direction and block size of the matrix
+ * @return table lines, first one is header with destination IDs
+ *
+ * */
+std::vector<std::string> pqtmatrix::format(const key_t& Key) const {
+  std::vector<std::string> lines;
+  auto it = data.find(Key);
+  if (it == data.end()) {
+    return lines;
+  }
+
+  std::vector<uint16_t> ids = get_ids(it->second);
+  char buff[32];
+  std::string line = "src\\dst";
+  for (size_t d = 0; d < ids.size(); d++) {
+    snprintf(buff, sizeof(buff), "%10u", ids[d]);
+    line += buff;
+  }
+  lines.push_back(line);
+
+  for (size_t s = 0; s < ids.size(); s++) {
+    snprintf(buff, sizeof(buff), "%7u", ids[s]);
+    line = buff;
+    for (size_t d = 0; d < ids.size(); d++) {
+      auto cell = it->second.find(std::make_pair(ids[s], ids[d]));
+      if (cell == it->second.end()) {
+        snprintf(buff, sizeof(buff), "%10s", "-");
+      } else {
+        snprintf(buff, sizeof(buff), "%10.3f", cell->second);
+      }
+      line += buff;
+    }
+    lines.push_back(line);
+  }
+
+  return lines;
+}
+
+/**
+ * @brief Write all matrices to CSV file
+ *
+ * @param Filename output file
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtmatrix::write_csv(const std::string& Filename) const {
+  std::ofstream ofs(Filename.c_str());
+  if (!ofs.good()) {
+    return -1;
+  }
+
+  char buff[32];
+  for (auto it = data.begin(); it != data.end(); ++it) {
+    std::vector<uint16_t> ids = get_ids(it->second);
+
+    ofs << "# bidirectional: " << (it->first.first ? "true" : "false")
+        << "  size: " << size_name(it->first.second) << "\n";
+    ofs << "src\\dst";
+    for (size_t d = 0; d < ids.size(); d++) {
+      ofs << "," << ids[d];
+    }
+    ofs << "\n";
+
+    for (size_t s = 0; s < ids.size(); s++) {
+      ofs << ids[s];
+      for (size_t d = 0; d < ids.size(); d++) {
+        ofs << ",";
+        auto cell = it->second.find(std::make_pair(ids[s], ids[d]));
+        if (cell != it->second.end()) {
+          snprintf(buff, sizeof(buff), "%.3f", cell->second);
+          ofs << buff;
+        }
+      }
+      ofs << "\n";
+    }
+    ofs << "\n";
+  }
+
+  ofs.close();
+  return ofs.fail() ? -1 : 0;
+}
+
+/**
+ * @brief Load matrices from CSV file written by write_csv()
+ *
+ * @param Filename input file
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtmatrix::load_csv(const std::string& Filename) {
+  std::ifstream ifs(Filename.c_str());
+  if (!ifs.good()) {
+    return -1;
+  }
+
+  clear();
+  bool bkey = false;
+  key_t key(false, 0);
+  std::vector<uint16_t> dst_ids;
+  std::string line;
+
+  while (std::getline(ifs, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+      line.erase(line.size() - 1);
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    if (line[0] == '#') {
+      char bidir[16];
+      char size[32];
+      if (sscanf(line.c_str(), "# bidirectional: %15s size: %31s",
+                 bidir, size) != 2) {
+        return -1;
+      }
+      key.first = std::string(bidir) == "true";
+      key.second = std::string(size) == "all" ? 0 : std::stoull(size);
+      bkey = true;
+      dst_ids.clear();
+      continue;
+    }
+
+    // str_split() drops empty fields so split here to keep cell positions
+    std::vector<std::string> fields;
+    std::istringstream iss(line);
+    std::string field;
+    while (std::getline(iss, field, ',')) {
+      fields.push_back(field);
+    }
+    if (!bkey || fields.empty()) {
+      return -1;
+    }
+
+    try {
+      if (fields[0] == "src\\dst") {
+        for (size_t d = 1; d < fields.size(); d++) {
+          dst_ids.push_back(std::stoul(fields[d]));
+        }
+        continue;
+      }
+
+      uint16_t src = std::stoul(fields[0]);
+      for (size_t d = 1; d < fields.size() && d <= dst_ids.size(); d++) {
+        if (!fields[d].empty()) {
+          add(key.first, key.second, src, dst_ids[d - 1],
+              std::stod(fields[d]));
+        }
+      }
+    } catch (...) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Compare against baseline
+ *
+ * A cell deviates if measured value differs from baseline by more than
+ * Tolerance relative to baseline, or if it is present in baseline but was
+ * not measured. Cells without baseline are not checked.
+ *
+ * @param Baseline baseline matrices
+ * @param Tolerance max allowed relative difference
+ * @param pDeviations [out] deviating cells
+ * @return number of deviating cells
+ *
+ * */
+size_t pqtmatrix::compare(const pqtmatrix& Baseline, double Tolerance,
+                          std::vector<deviation_t>* pDeviations) const {
+  pDeviations->clear();
+
+  for (auto it = Baseline.data.begin(); it != Baseline.data.end(); ++it) {
+    // matrices not measured in this run are not compared
+    auto mit = data.find(it->first);
+    if (mit == data.end()) {
+      continue;
+    }
+
+    for (auto bit = it->second.begin(); bit != it->second.end(); ++bit) {
+      deviation_t dev;
+      dev.bidirect = it->first.first;
+      dev.size = it->first.second;
+      dev.src = bit->first.first;
+      dev.dst = bit->first.second;
+      dev.baseline = bit->second;
+
+      auto cell = mit->second.find(bit->first);
+      if (cell == mit->second.end()) {
+        dev.measured = -1;
+        pDeviations->push_back(dev);
+        continue;
+      }
+
+      dev.measured = cell->second;
+      if (std::fabs(dev.measured - dev.baseline) >
+          Tolerance * std::fabs(dev.baseline)) {
+        pDeviations->push_back(dev);
+      }
+    }
+  }
+
+  return pDeviations->size();
+}
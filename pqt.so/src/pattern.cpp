@@ -0,0 +1,155 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/pattern.h"
+
+/**
+ * @brief Get pattern type from its configuration name
+ *
+ * @param Name pattern name as given in 'pattern' key
+ * @return pattern type, -1 if name is not recognized
+ *
+ * */
+int pqtpattern::get_type(const std::string& Name) {
+  if (Name.empty() || Name == "none") {
+    return PATTERN_NONE;
+  }
+  if (Name == "ring") {
+    return PATTERN_RING;
+  }
+  if (Name == "all_to_all") {
+    return PATTERN_ALL_TO_ALL;
+  }
+  if (Name == "broadcast") {
+    return PATTERN_BROADCAST;
+  }
+  if (Name == "fan_in") {
+    return PATTERN_FAN_IN;
+  }
+  return -1;
+}
+
+/**
+ * @brief Get pattern configuration name
+ *
+ * @param Pattern pattern type
+ * @return pattern name
+ *
+ * */
+std::string pqtpattern::get_name(int Pattern) {
+  switch (Pattern) {
+    case PATTERN_RING:
+      return "ring";
+    case PATTERN_ALL_TO_ALL:
+      return "all_to_all";
+    case PATTERN_BROADCAST:
+      return "broadcast";
+    case PATTERN_FAN_IN:
+      return "fan_in";
+    default:
+      return "none";
+  }
+}
+
+/**
+ * @brief Build list of copies done in one step of the pattern
+ *
+ * @param Pattern pattern type
+ * @param Nodes NUMA nodes of participating GPUs, root is the first one
+ * @param pCopies [out] list of (source node, destination node) pairs
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int pqtpattern::build(int Pattern, const std::vector<uint32_t>& Nodes,
+                      std::vector<std::pair<uint32_t, uint32_t>>* pCopies) {
+  size_t n = Nodes.size();
+
+  pCopies->clear();
+  if (n < 2) {
+    return -1;
+  }
+
+  switch (Pattern) {
+    case PATTERN_RING:
+      // with two GPUs ring degenerates into a bidirectional pair
+      for (size_t i = 0; i < n; i++) {
+        pCopies->push_back(std::make_pair(Nodes[i], Nodes[(i + 1) % n]));
+      }
+      break;
+    case PATTERN_ALL_TO_ALL:
+      for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+          if (i != j) {
+            pCopies->push_back(std::make_pair(Nodes[i], Nodes[j]));
+          }
+        }
+      }
+      break;
+    case PATTERN_BROADCAST:
+      for (size_t i = 1; i < n; i++) {
+        pCopies->push_back(std::make_pair(Nodes[0], Nodes[i]));
+      }
+      break;
+    case PATTERN_FAN_IN:
+      for (size_t i = 1; i < n; i++) {
+        pCopies->push_back(std::make_pair(Nodes[i], Nodes[0]));
+      }
+      break;
+    default:
+      return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Get size of a single copy for given message size
+ *
+ * @param Pattern pattern type
+ * @param Size message size (data per GPU)
+ * @param Count number of participating GPUs
+ * @return copy size in bytes
+ *
+ * */
+size_t pqtpattern::copy_size(int Pattern, size_t Size, size_t Count) {
+  if (Pattern == PATTERN_ALL_TO_ALL && Count > 0) {
+    return Size / Count;
+  }
+  return Size;
+}
+
+/**
+ * @brief Get factor converting algorithm bandwidth into bus bandwidth
+ *
+ * @param Pattern pattern type
+ * @param Count number of participating GPUs
+ * @return bus bandwidth factor
+ *
+ * */
+double pqtpattern::bus_factor(int Pattern, size_t Count) {
+  if (Pattern == PATTERN_ALL_TO_ALL && Count > 0) {
+    return static_cast<double>(Count - 1) / Count;
+  }
+  return 1.0;
+}
@@ -0,0 +1,497 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvshsa.h"
+#include "include/rvshsa_mock.h"
+#include "include/rvs_histogram.h"
+#include "include/rvs_timeline.h"
+#include "include/rvs_verify.h"
+#include "include/pattern.h"
+#include "include/worker.h"
+
+#define MOCK_MODEL_FILE "pqt_hsa_mock.model"
+#define MOCK_TOPOLOGY_FILE "pqt_hsa_mock.topology"
+
+class HsaMockTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::ofstream model(MOCK_MODEL_FILE);
+    model << "# node 3 is reachable from the CPU only\n"
+          << "agent 0 CPU Mock CPU\n"
+          << "agent 1 GPU gfx906\n"
+          << "agent 2 GPU gfx906\n"
+          << "agent 3 GPU gfx906\n"
+          << "pool 0 1073741824 kernarg fine\n"
+          << "pool 0 1073741824 coarse\n"
+          << "pool 1 1073741824 coarse\n"
+          << "pool 2 1073741824 coarse\n"
+          << "pool 3 1073741824 coarse\n"
+          << "link 0 1 PCIe 20 10 2\n"
+          << "link 0 2 PCIe 20 10 2\n"
+          << "link 0 3 PCIe 20 10 2\n"
+          << "link 1 2 xGMI 15 40 1\n"
+          << "copy_data 1\n";
+    model.close();
+    setenv(RVS_HSA_MOCK_MODEL_ENV, MOCK_MODEL_FILE, 1);
+    rvs::hsa::Init();
+    pHsa = rvs::hsa::Get();
+  }
+
+  // expected duration (sec) of a single transfer
+  double model_duration(size_t size, double gbps, double latency_us) {
+    return size / (gbps * 1e9) + latency_us * 1e-6;
+  }
+
+  rvs::hsa* pHsa;
+};
+
+TEST_F(HsaMockTest, topology) {
+  uint32_t distance;
+  std::vector<rvs::linkinfo_t> hops;
+
+  ASSERT_NE(pHsa, nullptr);
+  EXPECT_EQ(pHsa->cpu_list.size(), 1u);
+  EXPECT_EQ(pHsa->gpu_list.size(), 3u);
+
+  EXPECT_EQ(pHsa->GetLinkInfo(1, 2, &distance, &hops), 0);
+  EXPECT_EQ(distance, 15u);
+  ASSERT_EQ(hops.size(), 1u);
+  EXPECT_EQ(hops[0].etype, HSA_AMD_LINK_INFO_TYPE_XGMI);
+  EXPECT_EQ(hops[0].strtype, "xGMI");
+
+  EXPECT_EQ(pHsa->GetLinkInfo(1, 3, &distance, &hops), 0);
+  EXPECT_EQ(distance, rvs::hsa::NO_CONN);
+  EXPECT_TRUE(hops.empty());
+
+  EXPECT_EQ(pHsa->GetLinkInfo(1, 7, &distance, &hops), -1);
+
+  EXPECT_EQ(pHsa->GetPeerStatus(1, 2), 2);
+  EXPECT_EQ(pHsa->GetPeerStatus(1, 3), 0);
+  EXPECT_GT(pHsa->GetPeerStatus(0, 3), 0);
+}
+
+TEST_F(HsaMockTest, topology_cache) {
+  EXPECT_EQ(pHsa->SaveTopology(MOCK_TOPOLOGY_FILE), 0);
+  EXPECT_EQ(pHsa->LoadTopology(MOCK_TOPOLOGY_FILE), 0);
+  EXPECT_EQ(pHsa->GetPeerStatus(1, 2), 2);
+
+  // file describing a different system must be rejected
+  std::ofstream stale(MOCK_TOPOLOGY_FILE);
+  stale << "rvs-hsa-topology 1\nagents 2\n";
+  stale.close();
+  EXPECT_NE(pHsa->LoadTopology(MOCK_TOPOLOGY_FILE), 0);
+  EXPECT_NE(pHsa->LoadTopology("no_such_file.topology"), 0);
+}
+
+TEST_F(HsaMockTest, send_traffic) {
+  const size_t size = 64 * 1024 * 1024;
+  double duration;
+
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, false, &duration), 0);
+  EXPECT_NEAR(duration, model_duration(size, 40, 1),
+              model_duration(size, 40, 1) * 0.01);
+
+  // links are full duplex, bidirectional copy takes as long as one way
+  // (plus the gap between issuing forward and reverse copy)
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, true, &duration), 0);
+  EXPECT_NEAR(duration, model_duration(size, 40, 1),
+              model_duration(size, 40, 1) * 0.05);
+
+  ASSERT_EQ(pHsa->SendTraffic(0, 1, size, false, &duration), 0);
+  EXPECT_NEAR(duration, model_duration(size, 10, 2),
+              model_duration(size, 10, 2) * 0.01);
+
+  // no path between GPU 1 and GPU 3
+  EXPECT_NE(pHsa->SendTraffic(1, 3, size, false, &duration), 0);
+}
+
+TEST_F(HsaMockTest, send_traffic_stripes) {
+  const size_t size = 64 * 1024 * 1024;
+  double duration;
+
+  // stripes share the link, so total time stays the same as for one copy
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, false, &duration, 4), 0);
+  EXPECT_NEAR(duration, model_duration(size, 40, 1),
+              model_duration(size, 40, 1) * 0.01);
+
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, true, &duration, 4), 0);
+  EXPECT_NEAR(duration, model_duration(size, 40, 1),
+              model_duration(size, 40, 1) * 0.05);
+
+  // transfer smaller than a page is not split at all
+  ASSERT_EQ(pHsa->SendTraffic(0, 1, 1024, false, &duration, 8), 0);
+  EXPECT_NEAR(duration, model_duration(1024, 10, 2),
+              model_duration(1024, 10, 2) * 0.01);
+}
+
+TEST_F(HsaMockTest, send_traffic_verify) {
+  const size_t size = 1024 * 1024 + 5;
+  rvs::verifier checker;
+  double duration;
+  uint64_t blocks;
+  uint64_t errors;
+  uint64_t first_seed;
+  size_t first_offset;
+
+  checker.start();
+  // GPU to GPU, CPU to GPU and GPU to CPU
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, true, &duration, 4,
+                              &checker, 10), 0);
+  ASSERT_EQ(pHsa->SendTraffic(0, 1, size, false, &duration, 1,
+                              &checker, 12), 0);
+  ASSERT_EQ(pHsa->SendTraffic(2, 0, size, false, &duration, 1,
+                              &checker, 14), 0);
+  checker.flush();
+  checker.get_results(&blocks, &errors, &first_seed, &first_offset);
+  EXPECT_EQ(blocks, 4u);
+  EXPECT_EQ(errors, 0u);
+
+  // verification must not change reported transfer time
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, false, &duration, 1,
+                              &checker, 16), 0);
+  EXPECT_NEAR(duration, model_duration(size, 40, 1),
+              model_duration(size, 40, 1) * 0.01);
+}
+
+TEST_F(HsaMockTest, timeline) {
+  const size_t size = 1024 * 1024;
+  rvs::timeline tl;
+  double duration;
+
+  tl.reserve(16);
+  ASSERT_EQ(pHsa->SendTraffic(1, 2, size, true, &duration, 2, nullptr, 0,
+                              rvs::hsa::HOST_MEM_DEFAULT, &tl), 0);
+  ASSERT_EQ(pHsa->SendTraffic(0, 1, size, false, &duration, 1, nullptr, 0,
+                              rvs::hsa::HOST_MEM_DEFAULT, &tl), 0);
+
+  // two stripes in both directions, then one copy
+  ASSERT_EQ(tl.size(), 5u);
+  EXPECT_EQ(tl.dropped(), 0u);
+  size_t total[2] = {0, 0};
+  for (size_t i = 0; i < 4; i++) {
+    const rvs::timeline::event_t& e = tl.at(i);
+    EXPECT_EQ(e.transfer, 0u);
+    EXPECT_EQ(e.src, e.reverse ? 2u : 1u);
+    EXPECT_EQ(e.dst, e.reverse ? 1u : 2u);
+    EXPECT_LT(e.start, e.end);
+    total[e.reverse] += e.size;
+  }
+  EXPECT_EQ(total[0], size);
+  EXPECT_EQ(total[1], size);
+
+  // directions of a bidirectional transfer run concurrently
+  EXPECT_LT(tl.at(2).start, tl.at(1).end);
+  EXPECT_EQ(tl.at(4).transfer, 1u);
+  EXPECT_EQ(tl.at(4).src, 0u);
+  EXPECT_NEAR((tl.at(4).end - tl.at(4).start) * 1e-9,
+              model_duration(size, 10, 2), model_duration(size, 10, 2) * 0.01);
+}
+
+TEST_F(HsaMockTest, ping_pong) {
+  rvs::histogram device;
+  rvs::histogram host;
+
+  // GPU to GPU and CPU to GPU round trips, sizes are large enough for the
+  // return copy to be issued before the forward one completes
+  ASSERT_EQ(pHsa->PingPong(1, 2, 1024 * 1024, 8, &device, &host), 0);
+  EXPECT_EQ(device.count(), 8u);
+  EXPECT_EQ(host.count(), 8u);
+  EXPECT_NEAR(device.mean(), 2 * model_duration(1024 * 1024, 40, 1) * 1e6,
+              2 * model_duration(1024 * 1024, 40, 1) * 1e6 * 0.05);
+  EXPECT_GE(host.min(), device.min() * 0.95);
+
+  device.clear();
+  host.clear();
+  ASSERT_EQ(pHsa->PingPong(0, 1, 256 * 1024, 4, &device, &host), 0);
+  EXPECT_EQ(device.count(), 4u);
+  double expected = 2 * model_duration(256 * 1024, 10, 2) * 1e6;
+  EXPECT_NEAR(device.percentile(50), expected, expected * 0.05);
+}
+
+TEST_F(HsaMockTest, send_pattern) {
+  // large enough for the gap between issuing copies to be negligible
+  const size_t size = 16 * 1024 * 1024;
+  std::vector<std::pair<uint32_t, uint32_t>> copies;
+  std::vector<uint32_t> nodes = {1, 2};
+  std::vector<double> durations;
+
+  // two GPU ring uses both directions of the full duplex xGMI link
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_RING, nodes, &copies), 0);
+  ASSERT_EQ(pHsa->SendPattern(copies, size, 4, &durations), 0);
+  ASSERT_EQ(durations.size(), 4u);
+  for (size_t i = 0; i < durations.size(); i++) {
+    EXPECT_NEAR(durations[i], model_duration(size, 40, 1),
+                model_duration(size, 40, 1) * 0.05);
+  }
+
+  // copies sharing one direction of a link are serialized
+  copies.assign(2, std::make_pair(1u, 2u));
+  ASSERT_EQ(pHsa->SendPattern(copies, size, 2, &durations), 0);
+  EXPECT_NEAR(durations[0], 2 * model_duration(size, 40, 1),
+              2 * model_duration(size, 40, 1) * 0.05);
+
+  // broadcast over separate links takes as long as the slowest copy
+  nodes = {0, 1, 2, 3};
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_BROADCAST, nodes, &copies),
+            0);
+  ASSERT_EQ(pHsa->SendPattern(copies, size, 2, &durations), 0);
+  EXPECT_NEAR(durations[1], model_duration(size, 10, 2),
+              model_duration(size, 10, 2) * 0.05);
+}
+
+TEST_F(HsaMockTest, host_mem) {
+  const size_t size = 3 * 1024 * 1024 + 12;
+  rvs::verifier checker;
+  double duration;
+  uint64_t blocks;
+  uint64_t errors;
+  uint64_t first_seed;
+  size_t first_offset;
+  hsa_amd_memory_pool_t src_pool;
+  hsa_amd_memory_pool_t dst_pool;
+  void* src;
+  void* dst;
+  int cpu = pHsa->FindAgent(0);
+  int gpu = pHsa->FindAgent(1);
+
+  EXPECT_EQ(rvs::hsa::host_mem_type("hugepage"), rvs::hsa::HOST_MEM_HUGEPAGE);
+  EXPECT_EQ(rvs::hsa::host_mem_type("pinned"), -1);
+  EXPECT_EQ(rvs::hsa::host_mem_name(rvs::hsa::HOST_MEM_LOCKED_MALLOC),
+            "locked_malloc");
+
+  // CPU pools: 0 - kernarg fine-grained, 1 - coarse-grained
+  ASSERT_EQ(pHsa->Allocate(cpu, gpu, size, &src_pool, &src, &dst_pool, &dst,
+                           rvs::hsa::HOST_MEM_COARSE), 0);
+  EXPECT_EQ(src_pool.handle,
+            pHsa->agent_list[cpu].mem_pool_list[1].handle);
+  pHsa->FreeBuffer(src);
+  pHsa->FreeBuffer(dst);
+  ASSERT_EQ(pHsa->Allocate(gpu, cpu, size, &src_pool, &src, &dst_pool, &dst,
+                           rvs::hsa::HOST_MEM_FINE), 0);
+  EXPECT_EQ(dst_pool.handle,
+            pHsa->agent_list[cpu].mem_pool_list[0].handle);
+  pHsa->FreeBuffer(src);
+  pHsa->FreeBuffer(dst);
+
+  checker.start();
+  for (int type = rvs::hsa::HOST_MEM_DEFAULT;
+       type <= rvs::hsa::HOST_MEM_HUGEPAGE; type++) {
+    ASSERT_EQ(pHsa->SendTraffic(0, 1, size, true, &duration, 2,
+                                &checker, type * 2, type), 0);
+    EXPECT_GT(duration, 0);
+  }
+  checker.flush();
+  checker.get_results(&blocks, &errors, &first_seed, &first_offset);
+  EXPECT_EQ(blocks, 10u);
+  EXPECT_EQ(errors, 0u);
+
+  // latency mode uses the same host memory types
+  for (int type = rvs::hsa::HOST_MEM_DEFAULT;
+       type <= rvs::hsa::HOST_MEM_HUGEPAGE; type++) {
+    rvs::histogram device;
+    rvs::histogram host;
+    ASSERT_EQ(pHsa->PingPong(0, 1, 4096, 2, &device, &host, type), 0);
+    EXPECT_EQ(host.count(), 2u);
+  }
+}
+
+TEST_F(HsaMockTest, async_copy_data) {
+  const size_t size = 1024 * 1024;
+  hsa_amd_memory_pool_t src_pool, dst_pool;
+  void* src = nullptr;
+  void* dst = nullptr;
+  hsa_signal_t signal;
+
+  int srcix = pHsa->FindAgent(1);
+  int dstix = pHsa->FindAgent(2);
+  ASSERT_EQ(pHsa->Allocate(srcix, dstix, size,
+                           &src_pool, &src, &dst_pool, &dst), 0);
+  memset(src, 0x5A, size);
+  memset(dst, 0, size);
+
+  ASSERT_EQ(hsa_signal_create(1, 0, NULL, &signal), HSA_STATUS_SUCCESS);
+  ASSERT_EQ(hsa_amd_memory_async_copy(dst, pHsa->agent_list[dstix].agent,
+                                      src, pHsa->agent_list[srcix].agent,
+                                      size, 0, NULL, signal),
+            HSA_STATUS_SUCCESS);
+  hsa_signal_wait_acquire(signal, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
+                          HSA_WAIT_STATE_ACTIVE);
+  EXPECT_EQ(memcmp(src, dst, size), 0);
+
+  hsa_signal_destroy(signal);
+  hsa_amd_memory_pool_free(src);
+  hsa_amd_memory_pool_free(dst);
+}
+
+TEST_F(HsaMockTest, async_copy_host_dependency) {
+  const size_t size = 1024 * 1024;
+  hsa_amd_memory_pool_t src_pool, dst_pool;
+  void* src = nullptr;
+  void* dst = nullptr;
+  hsa_signal_t dep, signal;
+
+  int srcix = pHsa->FindAgent(1);
+  int dstix = pHsa->FindAgent(2);
+  ASSERT_EQ(pHsa->Allocate(srcix, dstix, size,
+                           &src_pool, &src, &dst_pool, &dst), 0);
+  memset(src, 0x3C, size);
+  memset(dst, 0, size);
+
+  // copy is submitted before the host releases its dependency, so the call
+  // must return without waiting
+  ASSERT_EQ(hsa_signal_create(1, 0, NULL, &dep), HSA_STATUS_SUCCESS);
+  ASSERT_EQ(hsa_signal_create(1, 0, NULL, &signal), HSA_STATUS_SUCCESS);
+  ASSERT_EQ(hsa_amd_memory_async_copy(dst, pHsa->agent_list[dstix].agent,
+                                      src, pHsa->agent_list[srcix].agent,
+                                      size, 1, &dep, signal),
+            HSA_STATUS_SUCCESS);
+  EXPECT_EQ(hsa_signal_load_relaxed(signal), 1);
+
+  hsa_signal_store_relaxed(dep, 0);
+  hsa_signal_wait_acquire(signal, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1),
+                          HSA_WAIT_STATE_ACTIVE);
+  EXPECT_EQ(memcmp(src, dst, size), 0);
+
+  hsa_signal_destroy(dep);
+  hsa_signal_destroy(signal);
+  hsa_amd_memory_pool_free(src);
+  hsa_amd_memory_pool_free(dst);
+}
+
+TEST_F(HsaMockTest, worker) {
+  std::vector<uint64_t> sizes = {1024 * 1024, 4 * 1024 * 1024};
+  uint16_t src, dst;
+  bool bidir;
+  size_t size;
+  double duration;
+
+  pqtworker worker;
+  worker.initialize(1, 2, false);
+  worker.set_name("unit_test");
+  worker.set_block_sizes(sizes);
+  ASSERT_EQ(worker.do_transfer(), 0);
+
+  worker.get_final_data(&src, &dst, &bidir, &size, &duration);
+  EXPECT_EQ(src, 1);
+  EXPECT_EQ(dst, 2);
+  EXPECT_FALSE(bidir);
+  EXPECT_EQ(size, static_cast<size_t>(5 * 1024 * 1024));
+  double expected = model_duration(sizes[0], 40, 1) +
+                    model_duration(sizes[1], 40, 1);
+  EXPECT_NEAR(duration, expected, expected * 0.01);
+}
+
+TEST_F(HsaMockTest, worker_convergence) {
+  std::vector<uint64_t> sizes = {1024 * 1024, 4 * 1024 * 1024};
+  uint16_t src, dst;
+  bool bidir;
+  size_t size;
+  double duration;
+
+  pqtworker worker;
+  worker.initialize(1, 2, false);
+  worker.set_name("unit_test");
+  worker.set_block_sizes(sizes);
+  worker.set_trace(64);
+  worker.set_warmup(3);
+  worker.set_convergence(0.01, 1000);
+  ASSERT_EQ(worker.do_transfer(), 0);
+
+  // modeled transfer times do not vary, so sampling stops at the minimum
+  // number of samples; warmup transfers are not counted
+  worker.get_final_data(&src, &dst, &bidir, &size, &duration);
+  EXPECT_EQ(size, RVS_SAMPLER_MIN_SAMPLES * 5 * 1024 * 1024);
+  EXPECT_EQ(worker.get_timeline().size(), 2 * RVS_SAMPLER_MIN_SAMPLES);
+  double expected = RVS_SAMPLER_MIN_SAMPLES *
+                    (model_duration(sizes[0], 40, 1) +
+                     model_duration(sizes[1], 40, 1));
+  EXPECT_NEAR(duration, expected, expected * 0.01);
+
+  // warmup is done only once
+  ASSERT_EQ(worker.do_transfer(), 0);
+  EXPECT_EQ(worker.get_timeline().size(), 4 * RVS_SAMPLER_MIN_SAMPLES);
+}
+
+TEST_F(HsaMockTest, worker_snapshots) {
+  std::vector<uint64_t> sizes = {4096, 64 * 1024};
+  std::atomic<bool> done(false);
+  uint16_t src;
+  uint16_t dst;
+  bool bidir;
+  size_t size;
+  double duration;
+  size_t sum_size = 0;
+  double sum_duration = 0;
+  uint64_t reads = 0;
+
+  pqtworker worker;
+  worker.initialize(1, 2, true);
+  worker.set_name("unit_test");
+  worker.set_block_sizes(sizes);
+
+  // transfers run at full rate while running totals are polled back to back
+  std::thread transfer([&]() {
+    for (int i = 0; i < 200; i++) {
+      worker.do_transfer();
+    }
+    done = true;
+  });
+  while (!done) {
+    worker.get_running_data(&src, &dst, &bidir, &size, &duration);
+    sum_size += size;
+    sum_duration += duration;
+    reads++;
+  }
+  transfer.join();
+  worker.get_running_data(&src, &dst, &bidir, &size, &duration);
+  sum_size += size;
+  sum_duration += duration;
+
+  // every transfer is counted in exactly one sampling interval
+  EXPECT_GT(reads, 1u);
+  EXPECT_EQ(sum_size, 200 * (4096 + 64 * 1024));
+  worker.get_final_data(&src, &dst, &bidir, &size, &duration, false);
+  EXPECT_EQ(size, sum_size);
+  EXPECT_NEAR(duration, sum_duration, duration * 1e-9);
+
+  // final totals are kept until reset
+  worker.get_final_data(&src, &dst, &bidir, &size, &duration);
+  EXPECT_EQ(size, sum_size);
+  worker.get_final_data(&src, &dst, &bidir, &size, &duration);
+  EXPECT_EQ(size, 0u);
+  worker.get_running_data(&src, &dst, &bidir, &size, &duration);
+  EXPECT_EQ(size, 0u);
+}
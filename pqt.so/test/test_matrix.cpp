@@ -0,0 +1,104 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/matrix.h"
+
+#define MATRIX_FILE "pqt_matrix.csv"
+
+TEST(PqtMatrix, format) {
+  pqtmatrix m;
+  m.add(false, 0, 1, 2, 40.5);
+  m.add(false, 0, 2, 1, 39.25);
+
+  std::vector<std::string> lines = m.format(pqtmatrix::key_t(false, 0));
+  ASSERT_EQ(lines.size(), 3u);
+  EXPECT_NE(lines[1].find("40.500"), std::string::npos);
+  EXPECT_NE(lines[2].find("39.250"), std::string::npos);
+  // diagonal is not tested
+  EXPECT_NE(lines[1].find("-"), std::string::npos);
+
+  EXPECT_TRUE(m.format(pqtmatrix::key_t(true, 0)).empty());
+}
+
+TEST(PqtMatrix, csv_round_trip) {
+  pqtmatrix m;
+  m.add(false, 0, 1, 2, 40.5);
+  m.add(false, 0, 2, 1, 39.25);
+  m.add(false, 0, 1, 3, 12.125);
+  m.add(true, 1048576, 1, 2, 80.75);
+  ASSERT_EQ(m.write_csv(MATRIX_FILE), 0);
+
+  pqtmatrix loaded;
+  ASSERT_EQ(loaded.load_csv(MATRIX_FILE), 0);
+  EXPECT_EQ(loaded.get_data(), m.get_data());
+
+  std::vector<pqtmatrix::deviation_t> dev;
+  EXPECT_EQ(m.compare(loaded, 0, &dev), 0u);
+  remove(MATRIX_FILE);
+}
+
+TEST(PqtMatrix, load_invalid) {
+  pqtmatrix m;
+  EXPECT_NE(m.load_csv("pqt_matrix_missing.csv"), 0);
+
+  std::ofstream ofs(MATRIX_FILE);
+  ofs << "1,2,3\n";
+  ofs.close();
+  EXPECT_NE(m.load_csv(MATRIX_FILE), 0);
+  remove(MATRIX_FILE);
+}
+
+TEST(PqtMatrix, compare) {
+  pqtmatrix baseline;
+  baseline.add(false, 0, 1, 2, 40.0);
+  baseline.add(false, 0, 2, 1, 40.0);
+  baseline.add(false, 0, 1, 3, 12.0);
+  // not measured in this run, not compared
+  baseline.add(true, 0, 1, 2, 80.0);
+
+  pqtmatrix m;
+  m.add(false, 0, 1, 2, 37.0);
+  m.add(false, 0, 2, 1, 35.0);
+
+  std::vector<pqtmatrix::deviation_t> dev;
+  ASSERT_EQ(m.compare(baseline, 0.1, &dev), 2u);
+  // 2 -> 1 is 12.5% below baseline
+  EXPECT_EQ(dev[0].src, 1);
+  EXPECT_EQ(dev[0].dst, 3);
+  EXPECT_LT(dev[0].measured, 0);
+  EXPECT_EQ(dev[1].src, 2);
+  EXPECT_EQ(dev[1].dst, 1);
+  EXPECT_DOUBLE_EQ(dev[1].measured, 35.0);
+  EXPECT_DOUBLE_EQ(dev[1].baseline, 40.0);
+
+  EXPECT_EQ(m.compare(baseline, 0.2, &dev), 1u);
+}
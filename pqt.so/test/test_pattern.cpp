@@ -0,0 +1,79 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/pattern.h"
+
+typedef std::vector<std::pair<uint32_t, uint32_t>> copies_t;
+
+TEST(PqtPattern, names) {
+  EXPECT_EQ(pqtpattern::get_type(""), pqtpattern::PATTERN_NONE);
+  EXPECT_EQ(pqtpattern::get_type("all_to_all"),
+            pqtpattern::PATTERN_ALL_TO_ALL);
+  EXPECT_EQ(pqtpattern::get_type("alltoall"), -1);
+  for (int p = pqtpattern::PATTERN_NONE; p <= pqtpattern::PATTERN_FAN_IN;
+       p++) {
+    EXPECT_EQ(pqtpattern::get_type(pqtpattern::get_name(p)), p);
+  }
+}
+
+TEST(PqtPattern, build) {
+  std::vector<uint32_t> nodes = {4, 5, 6};
+  copies_t copies;
+
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_RING, nodes, &copies), 0);
+  EXPECT_EQ(copies, copies_t({{4, 5}, {5, 6}, {6, 4}}));
+
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_ALL_TO_ALL, nodes,
+                              &copies), 0);
+  EXPECT_EQ(copies, copies_t({{4, 5}, {4, 6}, {5, 4}, {5, 6}, {6, 4},
+                              {6, 5}}));
+
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_BROADCAST, nodes,
+                              &copies), 0);
+  EXPECT_EQ(copies, copies_t({{4, 5}, {4, 6}}));
+
+  ASSERT_EQ(pqtpattern::build(pqtpattern::PATTERN_FAN_IN, nodes, &copies),
+            0);
+  EXPECT_EQ(copies, copies_t({{5, 4}, {6, 4}}));
+
+  nodes.resize(1);
+  EXPECT_NE(pqtpattern::build(pqtpattern::PATTERN_RING, nodes, &copies), 0);
+  EXPECT_TRUE(copies.empty());
+}
+
+TEST(PqtPattern, bandwidth_factors) {
+  EXPECT_EQ(pqtpattern::copy_size(pqtpattern::PATTERN_ALL_TO_ALL, 1000, 4),
+            250u);
+  EXPECT_EQ(pqtpattern::copy_size(pqtpattern::PATTERN_RING, 1000, 4), 1000u);
+  EXPECT_DOUBLE_EQ(pqtpattern::bus_factor(pqtpattern::PATTERN_ALL_TO_ALL, 4),
+                   0.75);
+  EXPECT_DOUBLE_EQ(pqtpattern::bus_factor(pqtpattern::PATTERN_BROADCAST, 4),
+                   1.0);
+}
@@ -0,0 +1,223 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_gemmref.h"
+#include "include/rvs_matrixgen.h"
+
+namespace {
+
+//! plain triple loop over the same packed operands
+template <typename T>
+void naive(const std::vector<T>& A, const std::vector<T>& B, int Rows,
+           int Cols, int K, std::vector<double>* pC) {
+  pC->assign(static_cast<size_t>(Rows) * Cols, 0);
+  for (int i = 0; i < Rows; i++) {
+    for (int j = 0; j < Cols; j++) {
+      double s = 0;
+      for (int k = 0; k < K; k++) {
+        s += static_cast<double>(A[i * K + k]) * B[j * K + k];
+      }
+      (*pC)[i * Cols + j] = s;
+    }
+  }
+}
+
+//! float rounded to the nearest half precision value (no overflow)
+float round_half(float x) {
+  if (x == 0) {
+    return x;
+  }
+  int e = std::max(std::ilogb(x), -14);
+  return std::ldexp(std::nearbyint(std::ldexp(x, 10 - e)), e - 10);
+}
+
+}  // namespace
+
+TEST(gemmref, float_tile) {
+  // odd sizes exercise partial row groups, K blocks and SIMD tails
+  const int rows = 13, cols = 7, k = 2 * RVS_GEMMREF_K_BLOCK + 37;
+  std::vector<float> a(rows * k), b(cols * k), c(rows * cols);
+  std::vector<float> abs(rows * cols);
+  std::vector<double> ref;
+
+  rvs::matrixgen::fill(a.data(), a.size(), 7, 0, 1);
+  rvs::matrixgen::fill(b.data(), b.size(), 7, 1, 1);
+  // negative values make the absolute sum differ from the sum
+  for (size_t i = 0; i < b.size(); i += 3) {
+    b[i] = -b[i];
+  }
+  naive(a, b, rows, cols, k, &ref);
+
+  for (unsigned threads : {1u, 3u}) {
+    rvs::gemmref::multiply(a.data(), b.data(), rows, cols, k, c.data(),
+                           abs.data(), threads);
+    for (int i = 0; i < rows * cols; i++) {
+      EXPECT_NEAR(c[i], ref[i], 1e-5 * abs[i]) << rvs::gemmref::simd_name();
+      EXPECT_GE(abs[i], std::fabs(c[i]) * (1 - 1e-6));
+    }
+  }
+}
+
+TEST(gemmref, double_exact) {
+  // small integers are summed exactly, as for int8 GEMM
+  const int rows = 8, cols = 5, k = 1000;
+  std::vector<double> a(rows * k), b(cols * k), c(rows * cols);
+  std::vector<double> abs(rows * cols);
+  std::vector<double> ref;
+
+  for (size_t i = 0; i < a.size(); i++) {
+    a[i] = static_cast<int8_t>(rvs::matrixgen::value(1, i) >> 56);
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    b[i] = static_cast<int8_t>(rvs::matrixgen::value(2, i) >> 56);
+  }
+  naive(a, b, rows, cols, k, &ref);
+
+  rvs::gemmref::multiply(a.data(), b.data(), rows, cols, k, c.data(),
+                         abs.data(), 2);
+  for (int i = 0; i < rows * cols; i++) {
+    EXPECT_EQ(c[i], ref[i]);
+  }
+}
+
+TEST(gemmref, conversion) {
+  EXPECT_EQ(rvs::gemmref::half_to_float(0x3c00), 1.0f);
+  EXPECT_EQ(rvs::gemmref::half_to_float(0xc000), -2.0f);
+  EXPECT_EQ(rvs::gemmref::half_to_float(0x7bff), 65504.0f);
+  EXPECT_EQ(rvs::gemmref::half_to_float(0x0001), std::ldexp(1.0f, -24));
+  EXPECT_TRUE(std::isinf(rvs::gemmref::half_to_float(0x7c00)));
+  EXPECT_TRUE(std::isnan(rvs::gemmref::half_to_float(0x7e00)));
+  EXPECT_EQ(rvs::gemmref::bf16_to_float(0x3f80), 1.0f);
+  EXPECT_EQ(rvs::gemmref::bf16_to_float(0xc040), -3.0f);
+
+  EXPECT_EQ(rvs::gemmref::get_threads(64, 64, 16, 8), 1u);
+  EXPECT_EQ(rvs::gemmref::get_threads(8, 64, 8192, 8), 2u);
+}
+
+TEST(gemmref, hgemm_tolerance) {
+  // hgemm tile at the default GST matrix size
+  const int rows = 32, cols = 32, k = 5760;
+  const double tol = rvs::gemmref::get_tolerance(k, std::ldexp(1.0, -24),
+                                                 std::ldexp(1.0, -11));
+  std::vector<uint16_t> ha(rows * k), hb(cols * k);
+  std::vector<float> a(ha.size()), b(hb.size());
+  std::vector<float> c(rows * cols), abs(rows * cols), gpu(rows * cols);
+
+  rvs::matrixgen::fill(ha.data(), ha.size(), 5, 0);
+  rvs::matrixgen::fill(hb.data(), hb.size(), 5, 1);
+  for (size_t i = 0; i < a.size(); i++) {
+    a[i] = rvs::gemmref::half_to_float(ha[i]);
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    b[i] = rvs::gemmref::half_to_float(hb[i]);
+  }
+  rvs::gemmref::multiply(a.data(), b.data(), rows, cols, k, c.data(),
+                         abs.data());
+
+  // GPU result: single precision sum in another order, stored as half
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      float s = 0;
+      for (int l = k - 1; l >= 0; l--) {
+        s += a[i * k + l] * b[j * k + l];
+      }
+      gpu[i * cols + j] = round_half(s);
+    }
+  }
+
+  size_t largest = 0, caught = 0;
+  for (size_t i = 0; i < gpu.size(); i++) {
+    ASSERT_LE(std::fabs(gpu[i] - c[i]), tol * abs[i]) << i;
+    if (std::fabs(gpu[i]) > std::fabs(gpu[largest])) {
+      largest = i;
+    }
+    // single sign flip
+    if (std::fabs(-gpu[i] - c[i]) > tol * abs[i]) {
+      caught++;
+    }
+  }
+  EXPECT_GT(caught, gpu.size() * 9 / 10);
+
+  // flip of the most significant mantissa bit of the largest element
+  float v = std::fabs(gpu[largest]);
+  float msb = std::ldexp(1.0f, std::ilogb(v) - 1);
+  float flipped = v >= 3 * msb ? v - msb : v + msb;
+  EXPECT_GT(std::fabs(std::copysign(flipped, gpu[largest]) - c[largest]),
+            tol * abs[largest]);
+}
+
+TEST(gemmref, hgemm_denormal) {
+  // hgemm alpha and beta are the half bit patterns 11 and 2 (denormals)
+  const int rows = 32, cols = 32, k = 16;
+  const double alpha = rvs::gemmref::half_to_float(11);
+  const double beta = rvs::gemmref::half_to_float(2);
+  const double denorm = std::ldexp(1.0, -24);
+  const double tol = rvs::gemmref::get_tolerance(k, std::ldexp(1.0, -24),
+                                                 std::ldexp(1.0, -11));
+  std::vector<uint16_t> ha(rows * k), hb(cols * k), hc(rows * cols);
+  std::vector<float> a(ha.size()), b(hb.size());
+  std::vector<float> c(rows * cols), abs(rows * cols);
+  size_t relative_only = 0;
+
+  rvs::matrixgen::fill(ha.data(), ha.size(), 9, 0);
+  rvs::matrixgen::fill(hb.data(), hb.size(), 9, 1);
+  rvs::matrixgen::fill(hc.data(), hc.size(), 9, 2);
+  for (size_t i = 0; i < a.size(); i++) {
+    a[i] = rvs::gemmref::half_to_float(ha[i]);
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    b[i] = rvs::gemmref::half_to_float(hb[i]);
+  }
+  rvs::gemmref::multiply(a.data(), b.data(), rows, cols, k, c.data(),
+                         abs.data());
+
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      size_t r = i * cols + j;
+      double c0 = rvs::gemmref::half_to_float(hc[r]);
+      float s = 0;
+      for (int l = 0; l < k; l++) {
+        s += a[i * k + l] * b[j * k + l];
+      }
+      // GPU result: beta * C and the sum each rounded to half
+      float gpu = round_half(alpha * s + round_half(beta * c0));
+      double expected = alpha * c[r] + beta * c0;
+      double scale = std::fabs(alpha) * abs[r] + std::fabs(beta * c0);
+      double error = std::fabs(gpu - expected);
+
+      EXPECT_LE(error, rvs::gemmref::get_error_bound(tol, scale, denorm)) << r;
+      if (error > rvs::gemmref::get_error_bound(tol, scale, 0)) {
+        relative_only++;
+      }
+    }
+  }
+  // a purely relative bound reports false mismatches
+  EXPECT_GT(relative_only, 0u);
+}
@@ -0,0 +1,99 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_gemmtune.h"
+
+TEST(gemmtune, candidates) {
+  auto c = rvs::gemmtune::get_candidates({1024, 4096});
+  ASSERT_EQ(c.size(), 8u);
+  EXPECT_EQ(c[0].m, 1024u);
+  EXPECT_EQ(c[7].k, 4096u);
+
+  // all four transpositions of each size
+  int mask = 0;
+  for (int i = 0; i < 4; i++) {
+    mask |= 1 << ((c[i].trans_a ? 2 : 0) | (c[i].trans_b ? 1 : 0));
+  }
+  EXPECT_EQ(mask, 0xF);
+
+  EXPECT_EQ(rvs::gemmtune::make_key("738c", "113-D34 01", "sgemm", 2, 1),
+            "738c:113-D34_01:sgemm:s2:b1");
+}
+
+TEST(gemmtune, best) {
+  rvs::gemmtune tune;
+  rvs::gemmtune::candidate_t best;
+  EXPECT_FALSE(tune.get_best(&best));
+
+  tune.add({1024, 1024, 1024, false, false, 100});
+  tune.add({2048, 2048, 2048, false, true, 300});
+  tune.add({4096, 4096, 4096, true, false, 200});
+  // failed candidate is ignored
+  tune.add({8192, 8192, 8192, true, true, 0});
+
+  ASSERT_TRUE(tune.get_best(&best));
+  EXPECT_EQ(best.m, 2048u);
+  EXPECT_TRUE(best.trans_b);
+  EXPECT_DOUBLE_EQ(best.gflops, 300);
+}
+
+TEST(gemmtune, cache_file) {
+  char dir[] = "/tmp/rvs_gemmtune_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  std::string file = std::string(dir) + "/autotune.cache";
+
+  rvs::gemmtune::candidate_t c;
+  EXPECT_FALSE(rvs::gemmtune::load(file, "a", &c));
+
+  EXPECT_TRUE(rvs::gemmtune::save(file, "a", {1024, 1024, 1024, 0, 1, 10}));
+  EXPECT_TRUE(rvs::gemmtune::save(file, "b", {2048, 2048, 2048, 1, 0, 20}));
+  // new winner replaces the line of the same key only
+  EXPECT_TRUE(rvs::gemmtune::save(file, "a", {4096, 4096, 4096, 1, 1, 30}));
+
+  ASSERT_TRUE(rvs::gemmtune::load(file, "a", &c));
+  EXPECT_EQ(c.m, 4096u);
+  EXPECT_TRUE(c.trans_a && c.trans_b);
+  ASSERT_TRUE(rvs::gemmtune::load(file, "b", &c));
+  EXPECT_EQ(c.m, 2048u);
+
+  std::ifstream in(file);
+  std::string line;
+  int lines = 0;
+  while (std::getline(in, line)) {
+    lines++;
+  }
+  EXPECT_EQ(lines, 2);
+
+  unlink(file.c_str());
+  rmdir(dir);
+}
@@ -39,6 +39,7 @@ class GpuUtilTest : public ::testing::Test , public rvs::gpulist {
     gpu_id      = {1, 2, 5, 4, 9, 7};
     device_id   = {3, 0, 2, 7, 5, 1};
     node_id     = {2, 1, 3, 7, 4, 9};
+    domain      = {0, 0, 1, 1, 0, 2};
   }
 
   void TearDown() override {
@@ -46,6 +47,7 @@ class GpuUtilTest : public ::testing::Test , public rvs::gpulist {
     gpu_id.clear();
     device_id.clear();
     node_id.clear();
+    domain.clear();
   }
 };
 
@@ -115,5 +117,14 @@ TEST_F(GpuUtilTest, gpu_util) {
   }
   return_value = gpu2node(100, &result_id);
   EXPECT_EQ(return_value, -1);
+
+  // gpu2domain
+  for (int i = 0; i < static_cast<int>(gpu_id.size()); i++) {
+    return_value = gpu2domain(gpu_id[i], &result_id);
+    EXPECT_EQ(result_id, domain[i]);
+    EXPECT_EQ(return_value, 0);
+  }
+  return_value = gpu2domain(100, &result_id);
+  EXPECT_EQ(return_value, -1);
 }
 
@@ -0,0 +1,99 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_histogram.h"
+
+TEST(histogram, empty) {
+  rvs::histogram h;
+
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.min(), 0);
+  EXPECT_EQ(h.max(), 0);
+  EXPECT_EQ(h.mean(), 0);
+  EXPECT_EQ(h.percentile(50), 0);
+  EXPECT_EQ(h.to_string(1), "");
+}
+
+TEST(histogram, stats) {
+  rvs::histogram h;
+
+  for (int i = 1; i <= 1000; i++) {
+    h.add(i);
+  }
+  EXPECT_EQ(h.count(), 1000u);
+  EXPECT_EQ(h.min(), 1);
+  EXPECT_EQ(h.max(), 1000);
+  EXPECT_DOUBLE_EQ(h.mean(), 500.5);
+
+  // bucket width is 2^(1/16), about 4.4% of the value
+  EXPECT_NEAR(h.percentile(50), 500, 500 * 0.045);
+  EXPECT_NEAR(h.percentile(99), 990, 990 * 0.045);
+  EXPECT_EQ(h.percentile(0), 1);
+  EXPECT_EQ(h.percentile(100), 1000);
+}
+
+TEST(histogram, merge) {
+  rvs::histogram a;
+  rvs::histogram b;
+
+  a.add(2);
+  a.add(4);
+  b.add(8);
+  b.add(0.5);
+  a.add(b);
+  EXPECT_EQ(a.count(), 4u);
+  EXPECT_EQ(a.min(), 0.5);
+  EXPECT_EQ(a.max(), 8);
+  EXPECT_DOUBLE_EQ(a.mean(), 3.625);
+
+  // one bucket per power of two
+  std::vector<double> lower;
+  std::vector<uint64_t> cnt;
+  a.get_buckets(1, &lower, &cnt);
+  ASSERT_EQ(lower.size(), 4u);
+  EXPECT_DOUBLE_EQ(lower[0], 0.5);
+  EXPECT_DOUBLE_EQ(lower[3], 8);
+  EXPECT_EQ(cnt[0], 1u);
+  EXPECT_EQ(a.to_string(1), "0.5:1 2:1 4:1 8:1");
+
+  a.clear();
+  EXPECT_EQ(a.count(), 0u);
+}
+
+TEST(histogram, range) {
+  rvs::histogram h;
+
+  // values outside of the range go to the first and the last bucket
+  h.add(0);
+  h.add(1e-9);
+  h.add(1e12);
+  EXPECT_EQ(h.count(), 3u);
+  EXPECT_EQ(h.max(), 1e12);
+  EXPECT_EQ(h.percentile(100), 1e12);
+}
@@ -0,0 +1,145 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_linkmonitor.h"
+
+// bucket and transfer widths are exact binary fractions so bucket
+// boundaries do not suffer from rounding
+#define BUCKET  (0.125)
+#define XFER    (0.0625)
+
+// add Count back-to-back transfers at Bandwidth GBps starting at *pTime
+static void add_traffic(rvs::linkmonitor* pMon, double* pTime,
+                        int Count, double Bandwidth) {
+  for (int i = 0; i < Count; i++) {
+    pMon->add(*pTime, *pTime + XFER,
+              static_cast<uint64_t>(Bandwidth * 1e9 * XFER));
+    *pTime += XFER;
+  }
+}
+
+TEST(linkmonitor, disabled) {
+  rvs::linkmonitor mon;
+  std::vector<rvs::linkmonitor::sample_t> series;
+  std::vector<rvs::linkmonitor::dip_t> dips;
+
+  EXPECT_FALSE(mon.enabled());
+  mon.add(1.0, 2.0, 1000);
+  mon.finish();
+  mon.get_series(&series);
+  EXPECT_TRUE(series.empty());
+  EXPECT_EQ(mon.get_dips(0, &dips), 0u);
+}
+
+TEST(linkmonitor, dip) {
+  rvs::linkmonitor mon;
+  std::vector<rvs::linkmonitor::sample_t> series;
+  std::vector<rvs::linkmonitor::dip_t> dips;
+  double t = 100;
+
+  mon.configure(BUCKET, 8, 0.2);
+  EXPECT_TRUE(mon.enabled());
+
+  // 20 buckets at 10 GBps, 6 buckets at 4 GBps, 20 buckets at 10 GBps
+  add_traffic(&mon, &t, 40, 10);
+  EXPECT_EQ(mon.get_dips(0, &dips), 0u);
+  add_traffic(&mon, &t, 12, 4);
+  add_traffic(&mon, &t, 40, 10);
+
+  ASSERT_EQ(mon.get_dips(0, &dips), 1u);
+  EXPECT_DOUBLE_EQ(dips[0].start, 100 + 20 * BUCKET);
+  EXPECT_DOUBLE_EQ(dips[0].end, 100 + 26 * BUCKET);
+  EXPECT_NEAR(dips[0].baseline, 10, 1e-6);
+  EXPECT_NEAR(dips[0].min, 4, 1e-6);
+
+  // already reported dips are skipped
+  EXPECT_EQ(mon.get_dips(1, &dips), 1u);
+  EXPECT_TRUE(dips.empty());
+
+  mon.finish();
+  mon.get_series(&series);
+  ASSERT_EQ(series.size(), 46u);
+  EXPECT_EQ(series[0].bucket, 800u);
+  EXPECT_NEAR(series[0].bandwidth, 10, 1e-3);
+  EXPECT_NEAR(series[22].bandwidth, 4, 1e-3);
+  EXPECT_EQ(series[45].bucket, 845u);
+}
+
+TEST(linkmonitor, small_drop_ignored) {
+  rvs::linkmonitor mon;
+  std::vector<rvs::linkmonitor::dip_t> dips;
+  double t = 100;
+
+  mon.configure(BUCKET, 8, 0.2);
+  add_traffic(&mon, &t, 40, 10);
+  add_traffic(&mon, &t, 12, 8.5);
+  add_traffic(&mon, &t, 40, 10);
+  mon.finish();
+
+  EXPECT_EQ(mon.get_dips(0, &dips), 0u);
+}
+
+TEST(linkmonitor, finish_closes_dip) {
+  rvs::linkmonitor mon;
+  std::vector<rvs::linkmonitor::dip_t> dips;
+  double t = 100;
+
+  mon.configure(BUCKET, 8, 0.2);
+  add_traffic(&mon, &t, 40, 10);
+  add_traffic(&mon, &t, 8, 2);
+  EXPECT_EQ(mon.get_dips(0, &dips), 0u);
+
+  mon.finish();
+  ASSERT_EQ(mon.get_dips(0, &dips), 1u);
+  EXPECT_DOUBLE_EQ(dips[0].start, 100 + 20 * BUCKET);
+  EXPECT_DOUBLE_EQ(dips[0].end, 100 + 24 * BUCKET);
+  EXPECT_NEAR(dips[0].min, 2, 1e-6);
+
+  // pause between segments is not a dip
+  t += 10;
+  add_traffic(&mon, &t, 40, 10);
+  mon.finish();
+  EXPECT_EQ(mon.get_dips(0, &dips), 1u);
+}
+
+TEST(linkmonitor, ring) {
+  rvs::linkmonitor mon;
+  std::vector<rvs::linkmonitor::sample_t> series;
+  double t = 0;
+
+  mon.configure(BUCKET, 4, 0.2, 8);
+  add_traffic(&mon, &t, 40, 10);
+  mon.finish();
+
+  // only the last 8 of 20 buckets are kept, oldest first
+  mon.get_series(&series);
+  ASSERT_EQ(series.size(), 8u);
+  for (size_t i = 0; i < series.size(); i++) {
+    EXPECT_EQ(series[i].bucket, 12 + i);
+  }
+}
@@ -0,0 +1,183 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_matrixcache.h"
+#include "include/rvs_matrixgen.h"
+
+TEST(matrixcache, layout) {
+  auto data = rvs::matrixcache::acquire("sgemm", 30, 20, 10, 1, "");
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(data->get_size(0), 30u * 10 * sizeof(float));
+  EXPECT_EQ(data->get_size(1), 20u * 10 * sizeof(float));
+  EXPECT_EQ(data->get_size(2), 30u * 20 * sizeof(float));
+  EXPECT_FALSE(data->is_mapped());
+
+  // matrices are generated from streams 0, 1 and 2 of the seed
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data->get(i)) % 4096, 0u);
+    std::vector<float> ref(data->get_size(i) / sizeof(float));
+    rvs::matrixgen::fill(ref.data(), ref.size(), 1, i);
+    EXPECT_EQ(memcmp(ref.data(), data->get(i), data->get_size(i)), 0);
+  }
+
+  EXPECT_EQ(rvs::matrixcache::acquire("xgemm", 30, 20, 10, 1, ""), nullptr);
+  EXPECT_EQ(rvs::matrixcache::acquire("sgemm", 0, 20, 10, 1, ""), nullptr);
+}
+
+TEST(matrixcache, mixed_precision) {
+  // int8 GEMM accumulates into 32 bit integer C
+  auto data = rvs::matrixcache::acquire("int8", 30, 20, 10, 1, "");
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(data->get_size(0), 30u * 10);
+  EXPECT_EQ(data->get_size(1), 20u * 10);
+  EXPECT_EQ(data->get_size(2), 30u * 20 * sizeof(int32_t));
+
+  std::vector<int8_t> a(data->get_size(0));
+  rvs::matrixgen::fill(a.data(), a.size(), 1, 0);
+  EXPECT_EQ(memcmp(a.data(), data->get(0), a.size()), 0);
+
+  // C values stay within 8 bit range
+  const int32_t* c = static_cast<const int32_t*>(data->get(2));
+  for (size_t i = 0; i < 30u * 20; i++) {
+    EXPECT_GE(c[i], -128);
+    EXPECT_LE(c[i], 127);
+  }
+
+  EXPECT_EQ(rvs::matrixcache::get_element_size("bf16", 2), 2u);
+  EXPECT_EQ(rvs::matrixcache::get_element_size("f16_f32acc", 0), 2u);
+}
+
+TEST(matrixcache, shared) {
+  bool generated;
+  rvs::matrixcache::release_unused();
+
+  auto first = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 7, "",
+                                         &generated);
+  EXPECT_TRUE(generated);
+  auto second = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 7, "",
+                                          &generated);
+  EXPECT_FALSE(generated);
+  EXPECT_EQ(first, second);
+
+  // different key gets its own matrices
+  auto other = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 8, "",
+                                         &generated);
+  EXPECT_TRUE(generated);
+  EXPECT_NE(other->get(0), first->get(0));
+
+  // unused matrices stay cached until a new key is requested
+  first.reset();
+  second.reset();
+  other.reset();
+  first = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 8, "", &generated);
+  EXPECT_FALSE(generated);
+  second = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 9, "", &generated);
+  EXPECT_TRUE(generated);
+  // seed 7 was dropped when seed 9 was generated, seed 8 was in use
+  other = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 7, "", &generated);
+  EXPECT_TRUE(generated);
+  other = rvs::matrixcache::acquire("dgemm", 64, 64, 64, 8, "", &generated);
+  EXPECT_FALSE(generated);
+}
+
+TEST(matrixcache, file) {
+  char dir[] = "/tmp/rvs_matrixcache_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  bool generated;
+
+  rvs::matrixcache::release_unused();
+  auto data = rvs::matrixcache::acquire("hgemm", 100, 50, 30, 3, dir,
+                                        &generated);
+  ASSERT_NE(data, nullptr);
+  EXPECT_TRUE(generated);
+  EXPECT_TRUE(data->is_mapped());
+  std::vector<char> copy(static_cast<const char*>(data->get(0)),
+                         static_cast<const char*>(data->get(2))
+                         + data->get_size(2));
+
+  // once released, matrices are mapped from file instead of generated
+  data.reset();
+  rvs::matrixcache::release_unused();
+  data = rvs::matrixcache::acquire("hgemm", 100, 50, 30, 3, dir, &generated);
+  ASSERT_NE(data, nullptr);
+  EXPECT_FALSE(generated);
+  EXPECT_TRUE(data->is_mapped());
+  EXPECT_EQ(memcmp(copy.data(), data->get(0), copy.size()), 0);
+  data.reset();
+  rvs::matrixcache::release_unused();
+
+  std::string name = rvs::matrixcache::get_file_name("hgemm", 100, 50, 30,
+                                                     3, dir);
+  EXPECT_EQ(unlink(name.c_str()), 0);
+  EXPECT_EQ(rmdir(dir), 0);
+
+  // not writable directory falls back to heap memory
+  data = rvs::matrixcache::acquire("hgemm", 100, 50, 30, 3,
+                                   "/nonexistent/dir", &generated);
+  ASSERT_NE(data, nullptr);
+  EXPECT_TRUE(generated);
+  EXPECT_FALSE(data->is_mapped());
+}
+
+TEST(matrixcache, concurrent) {
+  const int threads = 4;
+  std::vector<std::shared_ptr<const rvs::hostmatrix>> data(2 * threads);
+  std::atomic<int> generated(0);
+  std::vector<std::thread> workers;
+
+  rvs::matrixcache::release_unused();
+  // two keys requested at the same time, each generated exactly once
+  for (int i = 0; i < 2 * threads; i++) {
+    workers.emplace_back([&data, &generated, i]() {
+      bool gen;
+      data[i] = rvs::matrixcache::acquire("sgemm", 256, 256, 256,
+                                          100 + i % 2, "", &gen);
+      if (gen) {
+        generated++;
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  EXPECT_EQ(generated, 2);
+  for (int i = 0; i < 2 * threads; i++) {
+    ASSERT_NE(data[i], nullptr);
+    EXPECT_EQ(data[i], data[i % 2]);
+  }
+  EXPECT_NE(data[0], data[1]);
+}
@@ -0,0 +1,182 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_gemmref.h"
+#include "include/rvs_matrixgen.h"
+
+// large enough to be split across several threads
+#define ELEMENTS  (5 * RVS_MATRIXGEN_MIN_CHUNK + 12345)
+
+namespace {
+
+//! best of several fill() runs, in elements per second
+double fill_rate(std::vector<float>* pData, unsigned Threads) {
+  double best = 0;
+  for (int run = 0; run < 5; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    rvs::matrixgen::fill(pData->data(), pData->size(), 7, 0, Threads);
+    auto t1 = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(t1 - t0).count();
+    best = std::max(best, pData->size() / sec);
+  }
+  return best;
+}
+
+}  // namespace
+
+TEST(matrixgen, threads) {
+  EXPECT_EQ(rvs::matrixgen::get_threads(100, 8), 1u);
+  EXPECT_EQ(rvs::matrixgen::get_threads(3 * RVS_MATRIXGEN_MIN_CHUNK, 8), 3u);
+  EXPECT_EQ(rvs::matrixgen::get_threads(64 * RVS_MATRIXGEN_MIN_CHUNK, 8),
+            8u);
+  EXPECT_GE(rvs::matrixgen::get_threads(64 * RVS_MATRIXGEN_MIN_CHUNK, 0),
+            1u);
+}
+
+TEST(matrixgen, deterministic) {
+  std::vector<float> ref(ELEMENTS);
+  std::vector<float> data(ELEMENTS);
+
+  rvs::matrixgen::fill(ref.data(), ref.size(), 1234, 0, 1);
+  for (unsigned threads : {2u, 3u, 5u, 0u}) {
+    rvs::matrixgen::fill(data.data(), data.size(), 1234, 0, threads);
+    EXPECT_EQ(data, ref) << "threads: " << threads;
+  }
+
+  // prefix of longer matrix is the same as shorter matrix
+  std::vector<float> shorter(1000);
+  rvs::matrixgen::fill(shorter.data(), shorter.size(), 1234, 0);
+  EXPECT_TRUE(std::equal(shorter.begin(), shorter.end(), ref.begin()));
+
+  // double matrix has the same values
+  std::vector<double> dbl(1000);
+  rvs::matrixgen::fill(dbl.data(), dbl.size(), 1234, 0);
+  for (size_t i = 0; i < dbl.size(); i++) {
+    EXPECT_EQ(dbl[i], static_cast<double>(ref[i]));
+  }
+
+  std::vector<uint16_t> half_ref(ELEMENTS);
+  std::vector<uint16_t> half(ELEMENTS);
+  rvs::matrixgen::fill(half_ref.data(), half_ref.size(), 99, 2, 1);
+  rvs::matrixgen::fill(half.data(), half.size(), 99, 2, 4);
+  EXPECT_EQ(half, half_ref);
+}
+
+TEST(matrixgen, streams_and_seeds) {
+  const size_t count = 4096;
+  std::vector<float> a(count), b(count), c(count);
+
+  rvs::matrixgen::fill(a.data(), count, 1, 0);
+  rvs::matrixgen::fill(b.data(), count, 1, 1);
+  rvs::matrixgen::fill(c.data(), count, 2, 0);
+
+  size_t same_ab = 0;
+  size_t same_ac = 0;
+  for (size_t i = 0; i < count; i++) {
+    same_ab += a[i] == b[i];
+    same_ac += a[i] == c[i];
+  }
+  EXPECT_LT(same_ab, count / 100);
+  EXPECT_LT(same_ac, count / 100);
+}
+
+TEST(matrixgen, range) {
+  std::vector<float> data(1 << 16);
+  const double max = RVS_MATRIXGEN_RANGE / RVS_MATRIXGEN_DIV;
+  double sum = 0;
+
+  rvs::matrixgen::fill(data.data(), data.size(), 42, 0);
+  for (auto it = data.begin(); it != data.end(); ++it) {
+    ASSERT_GE(*it, 0);
+    ASSERT_LT(*it, max);
+    sum += *it;
+  }
+  // uniform distribution
+  EXPECT_NEAR(sum / data.size(), max / 2, max / 50);
+}
+
+TEST(matrixgen, range_16bit) {
+  std::vector<uint16_t> half(1 << 16);
+  std::vector<uint16_t> bf16(half.size());
+  double sum = 0;
+
+  rvs::matrixgen::fill(half.data(), half.size(), 42, 0);
+  rvs::matrixgen::fill_bf16(bf16.data(), bf16.size(), 42, 0);
+  for (size_t i = 0; i < half.size(); i++) {
+    float h = rvs::gemmref::half_to_float(half[i]);
+    ASSERT_TRUE(std::isfinite(h));
+    ASSERT_GE(h, -1.0f);
+    ASSERT_LT(h, 1.0f);
+    // same value in both formats
+    ASSERT_EQ(h, rvs::gemmref::bf16_to_float(bf16[i]));
+    sum += h;
+  }
+  // symmetric distribution
+  EXPECT_NEAR(sum / half.size(), 0, 0.02);
+}
+
+TEST(matrixgen, benchmark) {
+  const size_t count = 16 * RVS_MATRIXGEN_MIN_CHUNK;
+  std::vector<float> single(count), parallel(count);
+  unsigned all = std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned threads = rvs::matrixgen::get_threads(count, all);
+
+  // previous generator: sequential LCG with modulo and division per element
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t nextr = 7;
+  for (size_t i = 0; i < count; i++) {
+    nextr = nextr * 1103515245 + 12345;
+    single[i] = static_cast<float>(static_cast<uint32_t>
+                ((nextr / 65536) % RVS_MATRIXGEN_RANGE)) / RVS_MATRIXGEN_DIV;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double sec = std::chrono::duration<double>(t1 - t0).count();
+  printf("scalar LCG: %zu floats: %.1f M/s\n", count, count / sec / 1e6);
+
+  double single_rate = fill_rate(&single, 1);
+  double parallel_rate = fill_rate(&parallel, all);
+  printf("matrixgen: %zu floats, 1 thread: %.1f M/s, %u thread(s): %.1f M/s\n",
+         count, single_rate / 1e6, threads, parallel_rate / 1e6);
+
+  // bit for bit the same data regardless of the number of threads
+  EXPECT_EQ(memcmp(single.data(), parallel.data(), count * sizeof(float)), 0);
+  rvs::matrixgen::fill(parallel.data(), count, 7, 0, 3);
+  EXPECT_EQ(memcmp(single.data(), parallel.data(), count * sizeof(float)), 0);
+
+  // with a single CPU both runs take the same single threaded path
+  if (threads > 1) {
+    EXPECT_GE(parallel_rate, single_rate);
+  }
+}
@@ -0,0 +1,90 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_perfseries.h"
+
+TEST(perfseries, stats) {
+  rvs::perfseries series;
+  auto st = series.get_stats(0.1);
+  EXPECT_EQ(st.count, 0u);
+  EXPECT_EQ(st.throttle_ms, -1);
+
+  // 100 one second intervals with values 1..100
+  for (int i = 1; i <= 100; i++) {
+    series.add(i * 1000, 1000, i);
+  }
+  st = series.get_stats(0.1);
+  EXPECT_EQ(st.count, 100u);
+  EXPECT_DOUBLE_EQ(st.mean, 50.5);
+  EXPECT_DOUBLE_EQ(st.min, 1);
+  EXPECT_DOUBLE_EQ(st.max, 100);
+  EXPECT_DOUBLE_EQ(st.p5, 5);
+  EXPECT_DOUBLE_EQ(st.p50, 50);
+  EXPECT_DOUBLE_EQ(st.p95, 95);
+  EXPECT_NEAR(st.cv, 28.866 / 50.5, 1e-3);
+  // rising throughput never throttles
+  EXPECT_EQ(st.throttle_ms, -1);
+}
+
+TEST(perfseries, throttle) {
+  rvs::perfseries series;
+  uint64_t t = 0;
+  for (int i = 0; i < 10; i++) {
+    series.add(t += 1000, 1000, 100);
+  }
+  // single dip is jitter, not throttling
+  series.add(t += 1000, 1000, 50);
+  series.add(t += 1000, 1000, 100);
+  // sustained drop starts at 12 s
+  for (int i = 0; i < 5; i++) {
+    series.add(t += 1000, 1000, 80);
+  }
+
+  EXPECT_EQ(series.get_stats(0.1).throttle_ms, 12000);
+  // drop within threshold
+  EXPECT_EQ(series.get_stats(0.25).throttle_ms, -1);
+  EXPECT_DOUBLE_EQ(series.get_stats(0.1).min, 50);
+}
+
+TEST(perfseries, compact) {
+  rvs::perfseries series(8);
+  for (int i = 1; i <= 9; i++) {
+    series.add(i * 1000, 1000, i % 2 ? 10 : 20);
+  }
+
+  // full series merged pairwise before the 9th sample
+  ASSERT_EQ(series.size(), 5u);
+  const auto& s = series.get_samples();
+  EXPECT_EQ(s[0].end_ms, 2000u);
+  EXPECT_EQ(s[0].duration_ms, 2000u);
+  EXPECT_DOUBLE_EQ(s[0].value, 15);
+  EXPECT_EQ(s[4].end_ms, 9000u);
+
+  // duration weighted mean is preserved
+  EXPECT_NEAR(series.get_stats(0.1).mean, (5 * 10 + 4 * 20) / 9.0, 1e-9);
+}
@@ -0,0 +1,81 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_sampler.h"
+
+TEST(sampler, empty) {
+  rvs::sampler s;
+
+  EXPECT_EQ(s.count(), 0u);
+  EXPECT_EQ(s.mean(), 0);
+  EXPECT_EQ(s.stddev(), 0);
+  EXPECT_TRUE(std::isinf(s.ci_halfwidth()));
+  EXPECT_FALSE(s.converged(1.0));
+}
+
+TEST(sampler, stats) {
+  rvs::sampler s;
+  const double values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+
+  for (double v : values) {
+    s.add(v);
+  }
+  EXPECT_EQ(s.count(), 8u);
+  EXPECT_DOUBLE_EQ(s.mean(), 5);
+  EXPECT_NEAR(s.stddev(), std::sqrt(32.0 / 7), 1e-12);
+  // t(0.975, 7) = 2.365
+  EXPECT_NEAR(s.ci_halfwidth(), 2.365 * std::sqrt(32.0 / 7) / std::sqrt(8),
+              1e-9);
+  EXPECT_NEAR(s.ci_relative(), s.ci_halfwidth() / 5, 1e-12);
+
+  s.clear();
+  EXPECT_EQ(s.count(), 0u);
+}
+
+TEST(sampler, converged) {
+  rvs::sampler s;
+
+  // identical values converge once the minimum count is reached
+  for (unsigned i = 1; i < RVS_SAMPLER_MIN_SAMPLES; i++) {
+    s.add(10);
+    EXPECT_FALSE(s.converged(0.01));
+  }
+  s.add(10);
+  EXPECT_TRUE(s.converged(0.01));
+
+  // noisy values need more samples for the same tolerance
+  rvs::sampler n;
+  unsigned count = 0;
+  while (!n.converged(0.01) && count < 100000) {
+    n.add(count % 2 ? 9 : 11);
+    count++;
+  }
+  EXPECT_GT(count, 100u);
+  EXPECT_LT(count, 10000u);
+  EXPECT_LE(n.ci_relative(), 0.01);
+}
@@ -0,0 +1,94 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_seqcounter.h"
+
+TEST(seqcounter, basic) {
+  rvs::seqcounter c;
+  uint64_t size;
+  double duration;
+
+  c.snapshot(&size, &duration);
+  EXPECT_EQ(size, 0u);
+  EXPECT_EQ(duration, 0);
+
+  c.add(4096, 0.5);
+  c.add(1024, 0.25);
+  c.snapshot(&size, &duration);
+  EXPECT_EQ(size, 5120u);
+  EXPECT_DOUBLE_EQ(duration, 0.75);
+
+  c.clear();
+  c.snapshot(&size, &duration);
+  EXPECT_EQ(size, 0u);
+  EXPECT_EQ(duration, 0);
+}
+
+TEST(seqcounter, concurrent) {
+  const uint64_t updates = 2000000;
+  rvs::seqcounter c;
+  std::atomic<bool> done(false);
+  uint64_t reads = 0;
+  uint64_t torn = 0;
+  uint64_t backwards = 0;
+  uint64_t last = 0;
+
+  // writer updates at full rate, size is always 8x duration so a snapshot
+  // mixing two different updates is detected
+  std::thread writer([&]() {
+    for (uint64_t i = 0; i < updates; i++) {
+      c.add(8, 1.0);
+    }
+    done = true;
+  });
+
+  while (!done) {
+    uint64_t size;
+    double duration;
+    c.snapshot(&size, &duration);
+    if (static_cast<double>(size) != 8 * duration) {
+      torn++;
+    }
+    if (size < last) {
+      backwards++;
+    }
+    last = size;
+    reads++;
+  }
+  writer.join();
+
+  uint64_t size;
+  double duration;
+  c.snapshot(&size, &duration);
+  EXPECT_EQ(size, 8 * updates);
+  EXPECT_DOUBLE_EQ(duration, updates);
+  EXPECT_GT(reads, 0u);
+  EXPECT_EQ(torn, 0u);
+  EXPECT_EQ(backwards, 0u);
+}
@@ -0,0 +1,102 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_util.h"
+
+TEST(sweep, parse_size) {
+  uint64_t val = 0;
+
+  EXPECT_EQ(rvs_util_parse_size("4096", &val), 0);
+  EXPECT_EQ(val, 4096u);
+  EXPECT_EQ(rvs_util_parse_size("2M", &val), 0);
+  EXPECT_EQ(val, 2u * 1024 * 1024);
+  EXPECT_EQ(rvs_util_parse_size("6g", &val), 0);
+  EXPECT_EQ(val, 6ull * 1024 * 1024 * 1024);
+  EXPECT_EQ(rvs_util_parse_size("", &val), 2);
+  EXPECT_EQ(rvs_util_parse_size("M", &val), 1);
+  EXPECT_EQ(rvs_util_parse_size("1.5M", &val), 1);
+  EXPECT_EQ(rvs_util_parse_size("-1", &val), 1);
+  EXPECT_EQ(rvs_util_parse_size("99999999999T", &val), 1);
+}
+
+TEST(sweep, list) {
+  std::vector<uint64_t> sizes;
+
+  // explicit sizes are sorted and duplicates removed
+  ASSERT_EQ(rvs_util_parse_sweep("8K 1024 8192 5G", &sizes), 0);
+  EXPECT_EQ(sizes, std::vector<uint64_t>({1024, 8192,
+                                           5ull * 1024 * 1024 * 1024}));
+}
+
+TEST(sweep, linear) {
+  std::vector<uint64_t> sizes;
+
+  // dense sweep around 2MB page boundary
+  ASSERT_EQ(rvs_util_parse_sweep("1984K:2112K:64K", &sizes), 0);
+  EXPECT_EQ(sizes, std::vector<uint64_t>({1984 * 1024, 2048 * 1024,
+                                           2112 * 1024}));
+
+  // stop need not be reached exactly
+  ASSERT_EQ(rvs_util_parse_sweep("10:35:10", &sizes), 0);
+  EXPECT_EQ(sizes, std::vector<uint64_t>({10, 20, 30}));
+}
+
+TEST(sweep, geometric) {
+  std::vector<uint64_t> sizes;
+
+  ASSERT_EQ(rvs_util_parse_sweep("1K:512M:*2", &sizes), 0);
+  ASSERT_EQ(sizes.size(), 20u);
+  EXPECT_EQ(sizes.front(), 1024u);
+  EXPECT_EQ(sizes.back(), 512u * 1024 * 1024);
+
+  // beyond 4GB
+  ASSERT_EQ(rvs_util_parse_sweep("1G:16G:*4 2M", &sizes), 0);
+  EXPECT_EQ(sizes, std::vector<uint64_t>({2 * 1024 * 1024,
+                                           1ull << 30, 1ull << 32,
+                                           1ull << 34}));
+
+  ASSERT_EQ(rvs_util_parse_sweep("100:300:*1.5", &sizes), 0);
+  EXPECT_EQ(sizes, std::vector<uint64_t>({100, 150, 225}));
+}
+
+TEST(sweep, invalid) {
+  std::vector<uint64_t> sizes;
+
+  EXPECT_EQ(rvs_util_parse_sweep("", &sizes), 2);
+  EXPECT_EQ(rvs_util_parse_sweep("0", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:512M", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("2M:1M:4K", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:2K:0", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:2K:*1", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:2K:*x", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:2K:*2x", &sizes), 1);
+  EXPECT_EQ(rvs_util_parse_sweep("1K:2K:4K:8K", &sizes), 1);
+  // too many sizes
+  EXPECT_EQ(rvs_util_parse_sweep("1:1G:1", &sizes), 1);
+}
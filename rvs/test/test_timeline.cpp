@@ -0,0 +1,119 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdio.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_timeline.h"
+
+namespace {
+
+rvs::timeline::event_t make_event(uint64_t start, uint64_t end,
+                                  uint16_t stripe, uint16_t reverse) {
+  rvs::timeline::event_t e;
+  e.start = start;
+  e.end = end;
+  e.size = 4096;
+  e.src = reverse ? 2 : 1;
+  e.dst = reverse ? 1 : 2;
+  e.transfer = 0;
+  e.stripe = stripe;
+  e.reverse = reverse;
+  return e;
+}
+
+}  // namespace
+
+TEST(timeline, record) {
+  rvs::timeline tl;
+
+  EXPECT_FALSE(tl.enabled());
+  tl.reserve(2);
+  EXPECT_TRUE(tl.enabled());
+  EXPECT_EQ(tl.next_transfer(), 0u);
+  EXPECT_EQ(tl.next_transfer(), 1u);
+
+  tl.record(make_event(100, 200, 0, 0));
+  tl.record(make_event(150, 250, 0, 1));
+  // buffer is full
+  tl.record(make_event(300, 400, 0, 0));
+  EXPECT_EQ(tl.size(), 2u);
+  EXPECT_EQ(tl.dropped(), 1u);
+  EXPECT_EQ(tl.at(1).start, 150u);
+  EXPECT_EQ(tl.at(1).reverse, 1);
+
+  tl.clear();
+  EXPECT_EQ(tl.size(), 0u);
+  EXPECT_EQ(tl.dropped(), 0u);
+  EXPECT_EQ(tl.next_transfer(), 0u);
+}
+
+TEST(timeline, chrome_trace) {
+  const char* filename = "test_timeline.json";
+  rvs::timeline a;
+  rvs::timeline b;
+
+  a.reserve(16);
+  b.reserve(16);
+  a.record(make_event(10000, 12000, 0, 0));
+  a.record(make_event(10500, 12500, 0, 1));
+  b.record(make_event(11000, 11500, 1, 0));
+
+  ASSERT_EQ(rvs::timeline::write_chrome_trace(filename, {&a, &b},
+                                              {"first", "second"}), 0);
+
+  std::ifstream ifs(filename);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  std::string json = ss.str();
+  remove(filename);
+
+  // timestamps are in usec relative to the earliest copy
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"first\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"second\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"pid\":0,\"tid\":0,\"ts\":0.000,\"dur\":2.000"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"pid\":0,\"tid\":1,\"ts\":0.500,\"dur\":2.000"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"pid\":1,\"tid\":2,\"ts\":1.000,\"dur\":0.500"),
+            std::string::npos);
+  EXPECT_NE(json.find("rev 2->1 stripe 0"), std::string::npos);
+  EXPECT_EQ(json.back(), '\n');
+
+  EXPECT_NE(rvs::timeline::write_chrome_trace("/nonexistent/dir/file.json",
+                                              {&a}, {"a"}), 0);
+}
+
+TEST(timeline, json_escape) {
+  EXPECT_EQ(rvs::timeline::json_escape("gpu 1"), "gpu 1");
+  EXPECT_EQ(rvs::timeline::json_escape("a\"b\\c"), "a\\\"b\\\\c");
+  EXPECT_EQ(rvs::timeline::json_escape("a\nb"), "a\\u000ab");
+}
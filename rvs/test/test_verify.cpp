@@ -0,0 +1,136 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "include/rvs_verify.h"
+
+namespace {
+
+// number of buffers released by the verifier
+int released = 0;
+
+void release_buffer(void* p) {
+  free(p);
+  released++;
+}
+
+}  // namespace
+
+TEST(verify, pattern) {
+  // odd sizes exercise both vector and scalar tails
+  const size_t sizes[] = {1, 3, 4, 60, 64, 4096 + 7, 1024 * 1024 + 2};
+
+  for (size_t size : sizes) {
+    std::vector<char> buff(size);
+    size_t first;
+
+    rvs::verifier::fill(buff.data(), size, 0x1234567890abcdefull);
+    EXPECT_EQ(rvs::verifier::compare(buff.data(), size,
+                                     0x1234567890abcdefull, &first), 0u);
+    EXPECT_EQ(first, size);
+
+    // different seed must not match
+    if (size >= 64) {
+      EXPECT_GT(rvs::verifier::compare(buff.data(), size,
+                                       0x1234567890abcdeeull, &first),
+                size / 8);
+      EXPECT_EQ(first, 0u);
+    }
+
+    // single flipped bit in the last byte
+    buff[size - 1] ^= 0x10;
+    EXPECT_EQ(rvs::verifier::compare(buff.data(), size,
+                                     0x1234567890abcdefull, &first), 1u);
+    EXPECT_EQ(first, (size - 1) / 4 * 4);
+  }
+}
+
+TEST(verify, first_mismatch) {
+  const size_t size = 64 * 1024;
+  std::vector<uint32_t> buff(size / 4);
+  size_t first;
+
+  rvs::verifier::fill(buff.data(), size, 42);
+  buff[1001] = ~buff[1001];
+  buff[5000] = ~buff[5000];
+  buff[5001] = ~buff[5001];
+  EXPECT_EQ(rvs::verifier::compare(buff.data(), size, 42, &first), 3u);
+  EXPECT_EQ(first, 1001u * 4);
+}
+
+TEST(verify, checker) {
+  const size_t size = 256 * 1024;
+  rvs::verifier checker;
+  uint64_t blocks;
+  uint64_t errors;
+  uint64_t first_seed;
+  size_t first_offset;
+
+  released = 0;
+  checker.start();
+  for (uint64_t seed = 0; seed < 16; seed++) {
+    rvs::verifier::block_t block;
+    block.data = malloc(size);
+    block.size = size;
+    block.seed = seed;
+    block.release = &release_buffer;
+    rvs::verifier::fill(block.data, size, seed);
+    // corrupt one word in block 7
+    if (seed == 7) {
+      static_cast<uint32_t*>(block.data)[100] ^= 1;
+    }
+    checker.submit(block);
+  }
+  checker.flush();
+  checker.get_results(&blocks, &errors, &first_seed, &first_offset);
+  EXPECT_EQ(blocks, 16u);
+  EXPECT_EQ(errors, 1u);
+  EXPECT_EQ(first_seed, 7u);
+  EXPECT_EQ(first_offset, 400u);
+  EXPECT_EQ(released, 16);
+  checker.stop();
+
+  // with thread stopped, blocks are checked synchronously
+  rvs::verifier::block_t block;
+  block.data = malloc(size);
+  block.size = size;
+  block.seed = 99;
+  block.release = &release_buffer;
+  rvs::verifier::fill(block.data, size, 99);
+  checker.submit(block);
+  checker.get_results(&blocks, &errors, &first_seed, &first_offset);
+  EXPECT_EQ(blocks, 17u);
+  EXPECT_EQ(released, 17);
+}
+
+TEST(verify, simd_name) {
+  std::string name = rvs::verifier::simd_name();
+  EXPECT_TRUE(name == "avx512" || name == "avx2" || name == "scalar");
+}
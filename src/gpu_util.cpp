@@ -37,6 +37,7 @@ std::vector<uint16_t> rvs::gpulist::location_id;
 std::vector<uint16_t> rvs::gpulist::gpu_id;
 std::vector<uint16_t> rvs::gpulist::device_id;
 std::vector<uint16_t> rvs::gpulist::node_id;
+std::vector<uint16_t> rvs::gpulist::domain;
 
 using std::vector;
 using std::string;
@@ -210,6 +211,51 @@ void gpu_get_all_node_id(std::vector<uint16_t>* pgpus_node_id) {
   }
 }
 
+/**
+ * gets all GPUS PCI domain
+ * @param pgpus_domain ptr to vector that will store all the GPU PCI domains
+ * @return
+ */
+void gpu_get_all_domain(std::vector<uint16_t>* pgpus_domain) {
+  ifstream f_id, f_prop;
+  char path[KFD_PATH_MAX_LENGTH];
+
+  std::string prop_name;
+  int gpu_id;
+  uint32_t prop_val;
+
+  // Discover the number of nodes: Inside nodes folder there are only folders
+  // that represent the node number
+  int num_nodes = gpu_num_subdirs(KFD_SYS_PATH_NODES, "");
+
+  // get all GPUs PCI domain
+  for (int node_id = 0; node_id < num_nodes; node_id++) {
+    snprintf(path, KFD_PATH_MAX_LENGTH, "%s/%d/gpu_id", KFD_SYS_PATH_NODES,
+             node_id);
+    f_id.open(path);
+    snprintf(path, KFD_PATH_MAX_LENGTH, "%s/%d/properties",
+             KFD_SYS_PATH_NODES, node_id);
+    f_prop.open(path);
+
+    f_id >> gpu_id;
+
+    if (gpu_id != 0) {
+      // older kernels do not report domain, only domain 0 was supported
+      prop_val = 0;
+      while (f_prop >> prop_name) {
+        if (prop_name == "domain") {
+          f_prop >> prop_val;
+          break;
+        }
+      }
+      (*pgpus_domain).push_back(prop_val);
+    }
+
+    f_id.close();
+    f_prop.close();
+  }
+}
+
 /**
  * @brief Initialize gpulist helper class
  * @return 0 if successful, -1 otherwise
@@ -219,6 +265,7 @@ int rvs::gpulist::Initialize() {
   gpu_get_all_gpu_id(&gpu_id);
   gpu_get_all_device_id(&device_id);
   gpu_get_all_node_id(&node_id);
+  gpu_get_all_domain(&domain);
   return 0;
 }
 
@@ -334,6 +381,24 @@ int rvs::gpulist::gpu2node(const uint16_t GpuID, uint16_t* pNodeID) {
   return 0;
 }
 
+/**
+ * @brief Given Gpu ID return PCI domain
+ * @param GpuID Gpu ID of a GPU
+ * @param pDomain PCI domain of the GPU
+ * @return 0 if found, -1 otherwise
+ **/
+int rvs::gpulist::gpu2domain(const uint16_t GpuID, uint16_t* pDomain) {
+  const auto it = std::find(gpu_id.cbegin(),
+                            gpu_id.cend(), GpuID);
+  if (it == gpu_id.cend()) {
+    return -1;
+  }
+
+  size_t pos = std::distance(gpu_id.cbegin(), it);
+  *pDomain = domain[pos];
+  return 0;
+}
+
 
 /**
  * @brief Given Location ID return GPU node ID
@@ -360,3 +425,43 @@ std::string rvs::bdf2string(uint32_t BDF) {
            BDF>>8, (BDF & 0xFF), 0);
   return buff;
 }
+
+/**
+ * @brief Get PCIe root port a GPU is connected through
+ *
+ * Follows the sysfs device path of the GPU up to the root complex. GPUs
+ * behind the same switch share the root port and thus the upstream link.
+ *
+ * @param Domain PCI domain of a GPU
+ * @param LocationID Location ID of a GPU
+ * @return root port address (e.g. "0000:00:03.1"), empty if not found
+ **/
+std::string rvs::gpu_get_root_port(uint16_t Domain, uint16_t LocationID) {
+  char path[KFD_PATH_MAX_LENGTH];
+  snprintf(path, sizeof(path), "/sys/bus/pci/devices/%04x:%02x:%02x.%x",
+           Domain, LocationID >> 8, (LocationID >> 3) & 0x1F,
+           LocationID & 0x7);
+
+  char* real = realpath(path, nullptr);
+  if (real == nullptr) {
+    return "";
+  }
+
+  // e.g. /sys/devices/pci0000:00/0000:00:03.1/0000:21:00.0/...
+  std::string devpath(real);
+  free(real);
+  size_t pos = devpath.find("/pci");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos = devpath.find('/', pos + 1);
+  if (pos == std::string::npos) {
+    return "";
+  }
+  size_t end = devpath.find('/', pos + 1);
+  if (end == std::string::npos) {
+    // GPU is integrated in the root complex
+    return devpath.substr(pos + 1);
+  }
+  return devpath.substr(pos + 1, end - pos - 1);
+}
@@ -24,14 +24,34 @@
  *******************************************************************************/
 #include "include/rvs_blas.h"
 
-#include <time.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-
-#define RANDOM_CT               320000
-#define RANDOM_DIV_CT           0.1234
-
-rocblas_operation transa = rocblas_operation_none;
-rocblas_operation transb = rocblas_operation_transpose;
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "include/rvsloglp.h"
+#include "include/rvs_gemmref.h"
+#include "include/rvs_matrixcache.h"
+#include "include/rvs_matrixgen.h"
+
+//! suffix of strided batched GEMM types
+#define RVS_BLAS_BATCHED_SUFFIX         "_strided_batched"
+
+//! alpha of floating point GEMMs
+#define RVS_BLAS_ALPHA                  1.1
+//! beta of floating point GEMMs
+#define RVS_BLAS_BETA                   0.9
+//! alpha of hgemm (half precision bit pattern)
+#define RVS_BLAS_HALF_ALPHA             11
+//! beta of hgemm (half precision bit pattern)
+#define RVS_BLAS_HALF_BETA              2
+//! alpha of integer GEMMs
+#define RVS_BLAS_INT_ALPHA              1
+//! beta of integer GEMMs, D does not depend on the previous C
+#define RVS_BLAS_INT_BETA               0
 
 /**
  * @brief class constructor
@@ -39,26 +59,60 @@ rocblas_operation transb = rocblas_operation_transpose;
  * @param _m matrix size
  * @param _n matrix size
  * @param _k matrix size
+ * @param _ops_type GEMM type (see get_gemm_type())
+ * @param _streams number of streams GEMMs are issued on
+ * @param _batch_count number of GEMMs per call of strided batched types
  */
-rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k) :
+rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k,
+                   const std::string& _ops_type, int _streams,
+                   int _batch_count) :
                              gpu_device_index(_gpu_device_index),
                              m(_m),
                              n(_n),
-                             k(_k) {
-    is_handle_init = false;
+                             k(_k),
+                             ops_type(_ops_type) {
     is_error = false;
-    da = db = dc = NULL;
-    ha = hb = hc = nullptr;
+    seed = 0;
+    batch_count = 1;
+    trans_a = rocblas_operation_none;
+    trans_b = rocblas_operation_transpose;
+    da = db = nullptr;
+    is_pipeline = false;
+    pinned = nullptr;
+    da_slot[0] = da_slot[1] = db_slot[0] = db_slot[1] = nullptr;
+    pipeline_slot = 0;
+    copy_stream = nullptr;
+    slot_ready[0] = slot_ready[1] = nullptr;
+    copy_bytes = 0;
+    copy_seconds = 0;
 
     size_a = k * m;
     size_b = k * n;
     size_c = n * m;
 
-    if (alocate_host_matrix_mem()) {
-        if (!init_gpu_device())
-            is_error = true;
-    } else {
+    if (!get_gemm_type(ops_type, &gemm) || _streams < 1 ||
+        _batch_count < 1) {
+        // unknown GEMM type or no stream to run on
+        is_error = true;
+        return;
+    }
+    batch_count = gemm.strided_batched ? _batch_count : 1;
+
+    if (!init_gpu_device(_streams)) {
         is_error = true;
+    } else {
+        uint64_t footprint = static_cast<uint64_t>(batch_count)
+            * (gemm.ab_size * (static_cast<uint64_t>(size_a) + size_b)
+               + gemm.c_size * static_cast<uint64_t>(size_c)
+                 * streams.size());
+        std::string msg = "[rvs_blas] " + ops_type + " on GPU "
+            + std::to_string(gpu_device_index) + " m: " + std::to_string(m)
+            + " n: " + std::to_string(n) + " k: " + std::to_string(k)
+            + " batch: " + std::to_string(batch_count)
+            + " streams: " + std::to_string(streams.size())
+            + " device memory footprint: " + std::to_string(footprint)
+            + " bytes";
+        rvs::lp::Log(msg, rvs::logdebug);
     }
 }
 
@@ -66,155 +120,263 @@ rvs_blas::rvs_blas(int _gpu_device_index, int _m, int _n, int _k) :
  * @brief class destructor
  */
 rvs_blas::~rvs_blas() {
-    release_host_matrix_mem();
     release_gpu_matrix_mem();
 }
 
 /**
- * @brief selects GPU device, allocates GPU memory, creates a rocBlas
- * handle and get a reference to the rocBlas's stream
+ * @brief resolves GEMM type name into its descriptor
+ * @param _ops_type GEMM type ("sgemm", "dgemm", "hgemm", "bf16", "int8" or
+ * "f16_f32acc", optionally followed by "_strided_batched")
+ * @param pType [out] GEMM type descriptor
+ * @return true if GEMM type is supported, otherwise false
+ */
+bool rvs_blas::get_gemm_type(const std::string& _ops_type,
+                             gemm_type_t* pType) {
+    const std::string suffix(RVS_BLAS_BATCHED_SUFFIX);
+
+    pType->base = _ops_type;
+    pType->strided_batched = false;
+    if (_ops_type.size() > suffix.size() &&
+        _ops_type.compare(_ops_type.size() - suffix.size(), suffix.size(),
+                          suffix) == 0) {
+        pType->base = _ops_type.substr(0, _ops_type.size() - suffix.size());
+        pType->strided_batched = true;
+    }
+
+    pType->ab_type = pType->c_type = pType->compute_type =
+        rocblas_datatype_f32_r;
+
+    if (pType->base == "sgemm") {
+        pType->kind = GEMM_KIND_SGEMM;
+    } else if (pType->base == "dgemm") {
+        pType->kind = GEMM_KIND_DGEMM;
+        pType->ab_type = pType->c_type = pType->compute_type =
+            rocblas_datatype_f64_r;
+    } else if (pType->base == "hgemm") {
+        pType->kind = GEMM_KIND_HGEMM;
+        pType->ab_type = pType->c_type = pType->compute_type =
+            rocblas_datatype_f16_r;
+    } else if (pType->base == "bf16") {
+        pType->kind = GEMM_KIND_EX;
+        pType->ab_type = pType->c_type = rocblas_datatype_bf16_r;
+    } else if (pType->base == "f16_f32acc") {
+        pType->kind = GEMM_KIND_EX;
+        pType->ab_type = pType->c_type = rocblas_datatype_f16_r;
+    } else if (pType->base == "int8") {
+        pType->kind = GEMM_KIND_EX;
+        pType->ab_type = rocblas_datatype_i8_r;
+        pType->c_type = pType->compute_type = rocblas_datatype_i32_r;
+    } else {
+        return false;
+    }
+
+    pType->ab_size = rvs::matrixcache::get_element_size(pType->base, 0);
+    pType->c_size = rvs::matrixcache::get_element_size(pType->base, 2);
+    return pType->ab_size != 0 && pType->c_size != 0;
+}
+
+/**
+ * @brief returns size of A and B matrix element for the given GEMM type
+ * @param _ops_type GEMM type
+ * @return element size in bytes, 0 if GEMM type is not supported
+ */
+size_t rvs_blas::get_element_size(const std::string& _ops_type) {
+    gemm_type_t type;
+    if (!get_gemm_type(_ops_type, &type))
+        return 0;
+    return type.ab_size;
+}
+
+/**
+ * @brief selects GPU device, allocates GPU memory and creates the GEMM
+ * streams
+ * @param _streams number of GEMM streams to create
  * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::init_gpu_device(void) {
+bool rvs_blas::init_gpu_device(int _streams) {
     // select GPU device & allocate memory
     if (hipSetDevice(gpu_device_index) != hipSuccess) {
         // cannot select the given GPU device
         return false;
-    } else {
-        if (!allocate_gpu_matrix_mem())
-            return false;
-        if (rocblas_create_handle(&blas_handle) == rocblas_status_success) {
-            is_handle_init = true;
-            if (rocblas_get_stream(blas_handle, &hip_stream)
-                 != rocblas_status_success)
-                return false;
-        } else {
+    }
+
+    if (!allocate_gpu_matrix_mem())
+        return false;
+
+    for (int i = 0; i < _streams; i++) {
+        gemm_stream_t s;
+        if (!init_gemm_stream(&s))
             return false;
-        }
+        streams.push_back(s);
     }
+
     return true;
 }
 
 /**
- * @brief copy data matrix from host to gpu
- * @return true if everything went fine, otherwise false
+ * @brief creates the HIP stream, rocBlas handle, C matrix and timing
+ * events of one GEMM stream
+ * @param pStream [out] stream resources
+ * @return true if everything went fine, otherwise false (nothing is left
+ * allocated in that case)
  */
-bool rvs_blas::copy_data_to_gpu(std::string ops_type) {
-
-      if(ops_type == "sgemm") {
-
-            if (da) {
-                 if (hipMemcpy(da, ha, sizeof(float) * size_a, hipMemcpyHostToDevice)
-                                 != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
+bool rvs_blas::init_gemm_stream(gemm_stream_t* pStream) {
+    pStream->stream = nullptr;
+    pStream->handle = nullptr;
+    pStream->dc = nullptr;
+    pStream->start_event = nullptr;
+    pStream->stop_event = nullptr;
+    pStream->slot_done[0] = pStream->slot_done[1] = nullptr;
+    pStream->upload_done = nullptr;
+
+    if (hipStreamCreateWithFlags(&pStream->stream, hipStreamNonBlocking)
+            != hipSuccess) {
+        pStream->stream = nullptr;
+        return false;
+    }
 
-            if (db) {
-                if (hipMemcpy(db, hb, sizeof(float) * size_b, hipMemcpyHostToDevice)
-                                != hipSuccess) {
-                      is_error = true;
-                      return false;
-                  }
-            }
+    if (rocblas_create_handle(&pStream->handle) != rocblas_status_success) {
+        pStream->handle = nullptr;
+        release_gemm_stream(pStream);
+        return false;
+    }
 
-            if (dc) {
-                  if (hipMemcpy(dc, hc, sizeof(float) * size_c, hipMemcpyHostToDevice)
-                          != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-             }
-      }
+    if (rocblas_set_stream(pStream->handle, pStream->stream)
+            != rocblas_status_success ||
+        hipMalloc(&pStream->dc, static_cast<size_t>(size_c) * gemm.c_size *
+                  batch_count) != hipSuccess) {
+        release_gemm_stream(pStream);
+        return false;
+    }
 
+    if (hipEventCreate(&pStream->start_event) != hipSuccess) {
+        pStream->start_event = nullptr;
+        release_gemm_stream(pStream);
+        return false;
+    }
 
-      if(ops_type == "dgemm") {
+    if (hipEventCreate(&pStream->stop_event) != hipSuccess) {
+        pStream->stop_event = nullptr;
+        release_gemm_stream(pStream);
+        return false;
+    }
 
-            if (ddbla) {
-                  if (hipMemcpy(ddbla, hdbla, sizeof(double) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    for (int i = 0; i < 2; i++) {
+        if (hipEventCreate(&pStream->slot_done[i]) != hipSuccess) {
+            pStream->slot_done[i] = nullptr;
+            release_gemm_stream(pStream);
+            return false;
+        }
+    }
 
-            if (ddblb) {
-                  if (hipMemcpy(ddblb, hdblb, sizeof(double) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (hipEventCreate(&pStream->upload_done) != hipSuccess) {
+        pStream->upload_done = nullptr;
+        release_gemm_stream(pStream);
+        return false;
+    }
 
-            if (ddblc) {
-                  if (hipMemcpy(ddblc, hdblc, sizeof(double) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
+    return true;
+}
 
-      }
+/**
+ * @brief releases the resources of one GEMM stream
+ * @param pStream stream resources
+ */
+void rvs_blas::release_gemm_stream(gemm_stream_t* pStream) {
+    if (pStream->start_event)
+        hipEventDestroy(pStream->start_event);
+    if (pStream->stop_event)
+        hipEventDestroy(pStream->stop_event);
+    for (int i = 0; i < 2; i++) {
+        if (pStream->slot_done[i])
+            hipEventDestroy(pStream->slot_done[i]);
+    }
+    if (pStream->upload_done)
+        hipEventDestroy(pStream->upload_done);
+    if (pStream->dc)
+        hipFree(pStream->dc);
+    if (pStream->handle)
+        rocblas_destroy_handle(pStream->handle);
+    if (pStream->stream)
+        hipStreamDestroy(pStream->stream);
+}
 
-      if(ops_type == "hgemm") {
+/**
+ * @brief copy data matrix from host to gpu
+ * @param async if true, copies are queued on the stream (ordered with its
+ * GEMMs) instead of waiting for them to complete
+ * @param stream index of the stream whose C matrix is copied
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::copy_data_to_gpu(bool async, int stream) {
+    void *dst[3] = {da, db, nullptr};
 
-            if (dhlfa) {
-                  if (hipMemcpy(dhlfa, hhlfa, sizeof(rocblas_half) * size_a, hipMemcpyHostToDevice)
-                                     != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (!host_data)
+        return true;  // nothing generated yet
 
-            if (dhlfb) {
-                  if (hipMemcpy(dhlfb, hhlfb, sizeof(rocblas_half) * size_b, hipMemcpyHostToDevice)
-                                    != hipSuccess) {
-                        is_error = true;
-                        return false;
-                  }
-            }
+    if (stream < 0 || stream >= get_streams())
+        return false;
 
-            if (dhlfc) {
-                  if (hipMemcpy(dhlfc, hhlfc, sizeof(rocblas_half) * size_c, hipMemcpyHostToDevice)
-                                  != hipSuccess) {
-                       is_error = true;
-                       return false;
-                  }
-            }
+    dst[2] = streams[stream].dc;
 
-      }
+    for (int i = 0; i < 3; i++) {
+        if (!copy_matrix_to_gpu(host_data->get(i), host_data->get_size(i),
+                                dst[i], async, streams[stream].stream))
+            return false;
+    }
 
+    // C matrices of the other streams start from the same data
+    for (int i = 0; i < get_streams() && !async; i++) {
+        if (i != stream &&
+            !copy_matrix_to_gpu(host_data->get(2), host_data->get_size(2),
+                                streams[i].dc, false, streams[i].stream))
+            return false;
+    }
 
     is_error = false;
     return true;
 }
 
 /**
- * @brief allocates memory (for matrix multiplication) on the selected GPU
+ * @brief copies one host matrix to each batch of its device matrix
+ * @param src host matrix
+ * @param size host matrix size in bytes
+ * @param dst device matrix
+ * @param async if true, copies are queued on the stream
+ * @param stream stream used for async copies
  * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::allocate_gpu_matrix_mem(void) {
-    if (hipMalloc(&da, size_a * sizeof(float)) != hipSuccess)
-        return false;
-    if (hipMalloc(&db, size_b * sizeof(float)) != hipSuccess)
-        return false;
-    if (hipMalloc(&dc, size_c * sizeof(float)) != hipSuccess)
-        return false;
-
-    if (hipMalloc(&ddbla, size_a * sizeof(double)) != hipSuccess)
-        return false;
-    if (hipMalloc(&ddblb, size_b * sizeof(double)) != hipSuccess)
-        return false;
-    if (hipMalloc(&ddblc, size_c * sizeof(double)) != hipSuccess)
-        return false;
+bool rvs_blas::copy_matrix_to_gpu(const void* src, size_t size, void* dst,
+                                  bool async, hipStream_t stream) {
+    for (int b = 0; b < batch_count; b++) {
+        char* p = static_cast<char*>(dst) + b * size;
+        hipError_t sts = async ?
+            hipMemcpyAsync(p, src, size, hipMemcpyHostToDevice, stream) :
+            hipMemcpy(p, src, size, hipMemcpyHostToDevice);
+        if (sts != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (hipMalloc(&dhlfa, size_a * sizeof(rocblas_half)) != hipSuccess)
-        return false;
-    if (hipMalloc(&dhlfb, size_b * sizeof(rocblas_half)) != hipSuccess)
+/**
+ * @brief allocates A and B matrices (for matrix multiplication) on the
+ * selected GPU, C matrices are allocated per stream
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::allocate_gpu_matrix_mem(void) {
+    if (hipMalloc(&da, static_cast<size_t>(size_a) * gemm.ab_size *
+                  batch_count) != hipSuccess) {
+        da = nullptr;
         return false;
-    if (hipMalloc(&dhlfc, size_c * sizeof(rocblas_half)) != hipSuccess)
+    }
+    if (hipMalloc(&db, static_cast<size_t>(size_b) * gemm.ab_size *
+                  batch_count) != hipSuccess) {
+        db = nullptr;
         return false;
+    }
 
     return true;
 }
@@ -232,211 +394,806 @@ double rvs_blas::get_time_us(void)
  
 
 /**
- * @brief releases GPU mem & destroys the rocBlas handle
+ * @brief releases GPU mem & destroys the GEMM streams
  */
 void rvs_blas::release_gpu_matrix_mem(void) {
+    release_copy_pipeline();
+
     if (da)
         hipFree(da);
     if (db)
         hipFree(db);
-    if (dc)
-        hipFree(dc);
-
-    if (ddbla)
-        hipFree(ddbla);
-    if (ddblb)
-        hipFree(ddblb);
-    if (ddblc)
-        hipFree(ddblc);
-
-    if (dhlfa)
-        hipFree(dhlfa);
-    if (dhlfb)
-        hipFree(dhlfb);
-    if (dhlfc)
-        hipFree(dhlfc);
-
-    if (is_handle_init)
-        rocblas_destroy_handle(blas_handle);
+
+    for (size_t i = 0; i < streams.size(); i++)
+        release_gemm_stream(&streams[i]);
+    streams.clear();
 }
 
 /**
- * @brief allocate host matrix memory
- * @return true if everything went fine, otherwise false
+ * @brief checks whether the matrix multiplication completed
+ * @return true if GPU finished with matrix multiplication on all streams,
+ * otherwise false
  */
-bool rvs_blas::alocate_host_matrix_mem(void) {
+bool rvs_blas::is_gemm_op_complete(void) {
+    if (is_error)
+        return true;  // avoid blocking the calling thread
+    for (size_t i = 0; i < streams.size(); i++) {
+        if (hipStreamQuery(streams[i].stream) != hipSuccess)
+            return false;
+    }
+    return true;
+}
 
-    try {
-        ha = new float[size_a];
-        hb = new float[size_b];
-        hc = new float[size_c];
+/**
+ * @brief performs the GEMM matrix multiplication
+ * @param stream index of the stream the GEMM is issued on
+ * @return true if GPU was able to enqueue the GEMM operation, otherwise false
+ */
+bool rvs_blas::run_blass_gemm(int stream) {
+    if (is_error || stream < 0 || stream >= get_streams())
+        return false;
 
-        hdbla = new double[size_a];
-        hdblb = new double[size_b];
-        hdblc = new double[size_c];
+    rocblas_handle blas_handle = streams[stream].handle;
+    void* dc = streams[stream].dc;
+    // leading dimensions of A and B as stored
+    rocblas_int lda = trans_a == rocblas_operation_none ? m : k;
+    rocblas_int ldb = trans_b == rocblas_operation_none ? k : n;
+    rocblas_status sts = rocblas_status_not_implemented;
+
+    switch (gemm.kind) {
+    case GEMM_KIND_SGEMM: {
+        float alpha = RVS_BLAS_ALPHA, beta = RVS_BLAS_BETA;
+        float* a = static_cast<float*>(da);
+        float* b = static_cast<float*>(db);
+        float* c = static_cast<float*>(dc);
+        sts = gemm.strided_batched ?
+            rocblas_sgemm_strided_batched(blas_handle, trans_a, trans_b,
+                m, n, k, &alpha, a, lda, size_a, b, ldb, size_b,
+                &beta, c, m, size_c, batch_count) :
+            rocblas_sgemm(blas_handle, trans_a, trans_b, m, n, k,
+                &alpha, a, lda, b, ldb, &beta, c, m);
+        break;
+    }
+    case GEMM_KIND_DGEMM: {
+        double alpha = RVS_BLAS_ALPHA, beta = RVS_BLAS_BETA;
+        double* a = static_cast<double*>(da);
+        double* b = static_cast<double*>(db);
+        double* c = static_cast<double*>(dc);
+        sts = gemm.strided_batched ?
+            rocblas_dgemm_strided_batched(blas_handle, trans_a, trans_b,
+                m, n, k, &alpha, a, lda, size_a, b, ldb, size_b,
+                &beta, c, m, size_c, batch_count) :
+            rocblas_dgemm(blas_handle, trans_a, trans_b, m, n, k,
+                &alpha, a, lda, b, ldb, &beta, c, m);
+        break;
+    }
+    case GEMM_KIND_HGEMM: {
+        rocblas_half alpha, beta;
+        alpha.data = RVS_BLAS_HALF_ALPHA;
+        beta.data = RVS_BLAS_HALF_BETA;
+        rocblas_half* a = static_cast<rocblas_half*>(da);
+        rocblas_half* b = static_cast<rocblas_half*>(db);
+        rocblas_half* c = static_cast<rocblas_half*>(dc);
+        sts = gemm.strided_batched ?
+            rocblas_hgemm_strided_batched(blas_handle, trans_a, trans_b,
+                m, n, k, &alpha, a, lda, size_a, b, ldb, size_b,
+                &beta, c, m, size_c, batch_count) :
+            rocblas_hgemm(blas_handle, trans_a, trans_b, m, n, k,
+                &alpha, a, lda, b, ldb, &beta, c, m);
+        break;
+    }
+    case GEMM_KIND_EX: {
+        // alpha/beta are of compute type, D is written in place of C
+        float falpha = RVS_BLAS_ALPHA, fbeta = RVS_BLAS_BETA;
+        int32_t ialpha = RVS_BLAS_INT_ALPHA, ibeta = RVS_BLAS_INT_BETA;
+        bool int_compute = gemm.compute_type == rocblas_datatype_i32_r;
+        const void* alpha = int_compute ?
+            static_cast<const void*>(&ialpha) : &falpha;
+        const void* beta = int_compute ?
+            static_cast<const void*>(&ibeta) : &fbeta;
+        sts = gemm.strided_batched ?
+            rocblas_gemm_strided_batched_ex(blas_handle, trans_a, trans_b,
+                m, n, k, alpha, da, gemm.ab_type, lda, size_a,
+                db, gemm.ab_type, ldb, size_b, beta,
+                dc, gemm.c_type, m, size_c, dc, gemm.c_type, m, size_c,
+                batch_count, gemm.compute_type, rocblas_gemm_algo_standard,
+                0, rocblas_gemm_flags_none) :
+            rocblas_gemm_ex(blas_handle, trans_a, trans_b, m, n, k,
+                alpha, da, gemm.ab_type, lda, db, gemm.ab_type, ldb, beta,
+                dc, gemm.c_type, m, dc, gemm.c_type, m,
+                gemm.compute_type, rocblas_gemm_algo_standard,
+                0, rocblas_gemm_flags_none);
+        break;
+    }
+    }
 
-        hhlfa = new rocblas_half[size_a];
-        hhlfb = new rocblas_half[size_b];
-        hhlfc = new rocblas_half[size_c];
+    if (sts != rocblas_status_success) {
+        is_error = true;  // GPU cannot enqueue the gemm
+        return false;
+    }
+    return true;
+}
 
-        return true;
-    } catch (std::bad_alloc&) {
+/**
+ * @brief enqueues a batch of GEMMs on every stream and times it with HIP
+ * events
+ *
+ * GEMMs are queued back to back between two events on each stream, so the
+ * device is not drained after each GEMM. They are issued round robin so
+ * that all streams are kept busy. The calling thread waits only for the
+ * last GEMM of each stream.
+ *
+ * @param count number of GEMMs in the batch of each stream
+ * @param copy if true, matrices are copied to the GPU before each GEMM
+ * @param pSeconds [out] time between the start of the first and the end of
+ * the last batch as measured by the device (sec)
+ * @param pStreamSeconds [out] optional, duration of the batch of each
+ * stream (sec)
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::run_blass_gemm_batch(uint32_t count, bool copy,
+                                    double* pSeconds,
+                                    std::vector<double>* pStreamSeconds) {
+    float millis = 0;
+    double span = 0;
+
+    if (is_error || streams.empty())
         return false;
+
+    for (size_t s = 0; s < streams.size(); s++) {
+        if (hipEventRecord(streams[s].start_event, streams[s].stream)
+                != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+    }
+
+    if (copy && is_pipeline) {
+        if (!run_pipelined_batch(count))
+            return false;
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            if (copy && !copy_shared_data_to_gpu())
+                return false;
+            for (int s = 0; s < get_streams(); s++) {
+                if (!run_blass_gemm(s))
+                    return false;
+                if (copy &&
+                    hipEventRecord(streams[s].slot_done[0], streams[s].stream)
+                        != hipSuccess) {
+                    is_error = true;
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (size_t s = 0; s < streams.size(); s++) {
+        if (hipEventRecord(streams[s].stop_event, streams[s].stream)
+                != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+    }
+
+    if (pStreamSeconds)
+        pStreamSeconds->assign(streams.size(), 0);
+
+    for (size_t s = 0; s < streams.size(); s++) {
+        if (hipEventSynchronize(streams[s].stop_event) != hipSuccess ||
+            hipEventElapsedTime(&millis, streams[s].start_event,
+                                streams[s].stop_event) != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+        if (pStreamSeconds)
+            (*pStreamSeconds)[s] = static_cast<double>(millis) / 1000;
+
+        // all batches are measured from the start of the first stream
+        if (hipEventElapsedTime(&millis, streams[0].start_event,
+                                streams[s].stop_event) != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+        if (millis / 1000 > span)
+            span = static_cast<double>(millis) / 1000;
     }
+
+    if (copy && is_pipeline && !collect_copy_stats(count))
+        return false;
+
+    *pSeconds = span;
+    return true;
 }
 
 /**
- * @brief releases the host matrix memory
+ * @brief uploads matrices of one step of a non pipelined batch
+ *
+ * A and B are shared by all streams, so they are uploaded once, on the
+ * first stream, after GEMMs of the previous step on every stream are done
+ * (slot_done[0]). Other streams wait for the upload before their GEMMs and
+ * upload their own C.
+ *
+ * @return true if everything went fine, otherwise false
  */
-void rvs_blas::release_host_matrix_mem(void) {
-    if (ha)
-        delete []ha;
-    if (hb)
-        delete []hb;
-    if (hc)
-        delete []hc;
-
-    if (hdbla)
-        delete []hdbla;
-    if (hdblb)
-        delete []hdblb;
-    if (hdblc)
-        delete []hdblc;
-
-    if (hhlfa)
-        delete []hhlfa;
-    if (hhlfb)
-        delete []hhlfb;
-    if (hhlfc)
-        delete []hhlfc;
+bool rvs_blas::copy_shared_data_to_gpu(void) {
+    if (!host_data)
+        return true;  // nothing generated yet
+
+    for (int s = 1; s < get_streams(); s++) {
+        if (hipStreamWaitEvent(streams[0].stream, streams[s].slot_done[0], 0)
+                != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+    }
+
+    if (!copy_data_to_gpu(true, 0))
+        return false;
+    if (hipEventRecord(streams[0].upload_done, streams[0].stream)
+            != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+
+    for (int s = 1; s < get_streams(); s++) {
+        if (hipStreamWaitEvent(streams[s].stream, streams[0].upload_done, 0)
+                != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+        if (!copy_matrix_to_gpu(host_data->get(2), host_data->get_size(2),
+                                streams[s].dc, true, streams[s].stream))
+            return false;
+    }
+
+    return true;
 }
 
 /**
- * @brief checks whether the matrix multiplication completed
- * @return true if GPU finished with matrix multiplication, otherwise false
+ * @brief sets up double buffered operand uploads
+ *
+ * A and B are staged in pinned host memory and a second device slot is
+ * allocated for each. Uploads are issued on a separate copy stream, so
+ * while GEMMs read one slot the next operands are uploaded into the other.
+ * Must be called after generate_random_matrix_data(). Slot 0 is uploaded
+ * before returning.
+ *
+ * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::is_gemm_op_complete(void) {
-    if (is_error)
-        return true;  // avoid blocking the calling thread
-    if (hipStreamQuery(hip_stream) != hipSuccess)
+bool rvs_blas::enable_copy_pipeline(void) {
+    if (is_error || !host_data)
+        return false;
+    if (is_pipeline)
+        return true;
+
+    size_t size_ab = host_data->get_size(0) + host_data->get_size(1);
+
+    da_slot[0] = da;
+    db_slot[0] = db;
+    is_pipeline = true;
+
+    if (hipHostMalloc(&pinned, size_ab, 0) != hipSuccess) {
+        pinned = nullptr;
+        release_copy_pipeline();
+        return false;
+    }
+    memcpy(pinned, host_data->get(0), host_data->get_size(0));
+    memcpy(static_cast<char*>(pinned) + host_data->get_size(0),
+           host_data->get(1), host_data->get_size(1));
+
+    if (hipMalloc(&da_slot[1], host_data->get_size(0) * batch_count)
+            != hipSuccess) {
+        da_slot[1] = nullptr;
+        release_copy_pipeline();
+        return false;
+    }
+    if (hipMalloc(&db_slot[1], host_data->get_size(1) * batch_count)
+            != hipSuccess) {
+        db_slot[1] = nullptr;
+        release_copy_pipeline();
+        return false;
+    }
+
+    if (hipStreamCreateWithFlags(&copy_stream, hipStreamNonBlocking)
+            != hipSuccess) {
+        copy_stream = nullptr;
+        release_copy_pipeline();
         return false;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (hipEventCreate(&slot_ready[i]) != hipSuccess) {
+            slot_ready[i] = nullptr;
+            release_copy_pipeline();
+            return false;
+        }
+    }
+
+    // both slots start with the same operands
+    for (int i = 0; i < 2; i++) {
+        if (!copy_matrix_to_gpu(pinned, host_data->get_size(0), da_slot[i],
+                                false, copy_stream) ||
+            !copy_matrix_to_gpu(static_cast<char*>(pinned) +
+                                host_data->get_size(0),
+                                host_data->get_size(1), db_slot[i],
+                                false, copy_stream)) {
+            release_copy_pipeline();
+            return false;
+        }
+    }
+
+    pipeline_slot = 0;
+    da = da_slot[0];
+    db = db_slot[0];
     return true;
 }
 
 /**
- * @brief performs the SGEMM matrix multiplication
- * @return true if GPU was able to enqueue the GEMM operation, otherwise false
+ * @brief releases double buffering resources, slot 0 becomes da/db again
+ */
+void rvs_blas::release_copy_pipeline(void) {
+    if (!is_pipeline)
+        return;
+
+    if (copy_stream)
+        hipStreamSynchronize(copy_stream);
+    for (size_t i = 0; i < copy_events.size(); i++)
+        hipEventDestroy(copy_events[i]);
+    copy_events.clear();
+    for (int i = 0; i < 2; i++) {
+        if (slot_ready[i])
+            hipEventDestroy(slot_ready[i]);
+        slot_ready[i] = nullptr;
+    }
+    if (copy_stream)
+        hipStreamDestroy(copy_stream);
+    copy_stream = nullptr;
+
+    if (da_slot[1])
+        hipFree(da_slot[1]);
+    if (db_slot[1])
+        hipFree(db_slot[1]);
+    if (pinned)
+        hipHostFree(pinned);
+    pinned = nullptr;
+
+    da = da_slot[0];
+    db = db_slot[0];
+    da_slot[0] = da_slot[1] = db_slot[0] = db_slot[1] = nullptr;
+    is_pipeline = false;
+}
+
+/**
+ * @brief enqueues GEMMs of a batch together with double buffered uploads
+ *
+ * For each step, the copy stream uploads operands of the next step into
+ * the idle slot once GEMMs which last read that slot are done, while GEMM
+ * streams wait for the current slot to be uploaded and run on it. Each
+ * upload is bracketed by an event pair in copy_events.
+ *
+ * @param count number of steps (GEMMs per stream)
+ * @return true if everything went fine, otherwise false
  */
-bool rvs_blas::run_blass_gemm(std::string ops_type) {
-    if (!is_error) {
-      
-        if(ops_type == "sgemm") {
-
-                 float alpha = 1.1, beta = 0.9;
-
-                 if (rocblas_sgemm(blas_handle, transa, transb,
-                         rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                         &alpha, da, rvs_blas::m,
-                         db, rvs_blas::n, &beta,
-                         dc, rvs_blas::m) != rocblas_status_success) {
-                 is_error = true;  // GPU cannot enqueue the gemm
-                 return false;
-                 } else {
-                      return true;
-                 }
+bool rvs_blas::run_pipelined_batch(uint32_t count) {
+    size_t size_a_host = host_data->get_size(0);
+    size_t size_b_host = host_data->get_size(1);
+
+    while (copy_events.size() < 2 * static_cast<size_t>(count)) {
+        hipEvent_t e;
+        if (hipEventCreate(&e) != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+        copy_events.push_back(e);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        int cur = pipeline_slot;
+        int next = cur ^ 1;
+
+        // upload next operands once GEMMs reading the idle slot are done
+        for (size_t s = 0; s < streams.size(); s++) {
+            if (hipStreamWaitEvent(copy_stream, streams[s].slot_done[next], 0)
+                    != hipSuccess) {
+                is_error = true;
+                return false;
+            }
+        }
+        if (hipEventRecord(copy_events[2 * i], copy_stream) != hipSuccess ||
+            !copy_matrix_to_gpu(pinned, size_a_host, da_slot[next], true,
+                                copy_stream) ||
+            !copy_matrix_to_gpu(static_cast<char*>(pinned) + size_a_host,
+                                size_b_host, db_slot[next], true,
+                                copy_stream) ||
+            hipEventRecord(copy_events[2 * i + 1], copy_stream)
+                != hipSuccess ||
+            hipEventRecord(slot_ready[next], copy_stream) != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+
+        // run GEMMs on the current slot once it is uploaded
+        da = da_slot[cur];
+        db = db_slot[cur];
+        for (int s = 0; s < get_streams(); s++) {
+            if (hipStreamWaitEvent(streams[s].stream, slot_ready[cur], 0)
+                    != hipSuccess) {
+                is_error = true;
+                return false;
+            }
+            if (!run_blass_gemm(s))
+                return false;
+            if (hipEventRecord(streams[s].slot_done[cur], streams[s].stream)
+                    != hipSuccess) {
+                is_error = true;
+                return false;
+            }
         }
 
-       if(ops_type == "dgemm") {
-                  double alpha = 1.1, beta = 0.9;
-
-                  if (rocblas_dgemm(blas_handle, transa, transb,
-                          rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, ddbla, rvs_blas::m,
-                          ddblb, rvs_blas::n, &beta,
-                          ddblc, rvs_blas::m) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
-
-      if(ops_type == "hgemm") {
-                  rocblas_half alpha;
-                  rocblas_half beta;
-
-                  alpha.data = 11;
-                  beta.data = 2;
-
-                  if (rocblas_hgemm(blas_handle, transa, transb,
-                          rvs_blas::m, rvs_blas::n, rvs_blas::k,
-                          &alpha, dhlfa, rvs_blas::m,
-                          dhlfb, rvs_blas::n, &beta,
-                          dhlfc, rvs_blas::m) != rocblas_status_success) {
-                  is_error = true;  // GPU cannot enqueue the gemm
-                  return false;
-                  } else {
-                       return true;
-                  }
-       }
+        pipeline_slot = next;
+    }
 
+    return true;
+}
 
-    } else {
+/**
+ * @brief waits for uploads of the last pipelined batch and accounts them
+ * @param count number of steps of the batch
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::collect_copy_stats(uint32_t count) {
+    float millis = 0;
+    uint64_t bytes_per_step = static_cast<uint64_t>(batch_count) *
+        (host_data->get_size(0) + host_data->get_size(1));
+
+    if (count == 0)
+        return true;
+
+    if (hipEventSynchronize(copy_events[2 * count - 1]) != hipSuccess) {
+        is_error = true;
         return false;
     }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (hipEventElapsedTime(&millis, copy_events[2 * i],
+                                copy_events[2 * i + 1]) != hipSuccess) {
+            is_error = true;
+            return false;
+        }
+        copy_seconds += static_cast<double>(millis) / 1000;
+        copy_bytes += bytes_per_step;
+    }
+
+    return true;
 }
 
 /**
- * @brief generate matrix random data
- * it should be called before rocBlas GEMM
+ * @brief returns upload statistics accumulated since the previous call
+ * @param pBytes [out] bytes uploaded by the copy pipeline
+ * @param pSeconds [out] time the uploads took (sec), excluding time spent
+ * waiting for GEMMs
  */
-void rvs_blas::generate_random_matrix_data(void) {
-    int i;
-    if (!is_error) {
-        uint64_t nextr = time(NULL);
+void rvs_blas::take_copy_stats(uint64_t* pBytes, double* pSeconds) {
+    *pBytes = copy_bytes;
+    *pSeconds = copy_seconds;
+    copy_bytes = 0;
+    copy_seconds = 0;
+}
 
-        //SGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            ha[i] = fast_pseudo_rand(&nextr);
+/**
+ * @brief checks a sampled tile of C against a host reference
+ *
+ * The GEMM streams are drained and the tile is read before and after one
+ * more GEMM on the checked stream, so the reference alpha * A * B + beta *
+ * C is computed from the C the GPU actually started from. Tile position,
+ * stream and batch are derived from sample, so consecutive samples cover
+ * different parts of C.
+ *
+ * An element is outside of tolerance if it differs from the reference by
+ * more than get_verify_tolerance() times alpha * |A| * |B| + |beta * C|
+ * plus the smallest denormal of C (see rvs::gemmref::get_error_bound()).
+ * Elements whose reference is not finite are skipped.
+ *
+ * @param sample sample number
+ * @param pResult [out] tile and outcome of the check
+ * @return true if the tile was checked, false if a HIP/rocBlas error
+ * occurred
+ */
+bool rvs_blas::verify_gemm_tile(uint64_t sample, verify_result_t* pResult) {
+    double alpha, beta, tolerance, denorm;
+    std::vector<double> ref, ref_abs;
 
-        for (i = 0; i < size_b; ++i)
-            hb[i] = fast_pseudo_rand(&nextr);
+    if (is_error || !host_data || streams.empty())
+        return false;
 
-        for (int i = 0; i < size_c; ++i)
-            hc[i] = fast_pseudo_rand(&nextr);
+    rocblas_int rows = std::min<rocblas_int>(RVS_BLAS_VERIFY_TILE, m);
+    rocblas_int cols = std::min<rocblas_int>(RVS_BLAS_VERIFY_TILE, n);
+    uint64_t pos = rvs::matrixgen::value(seed, sample);
+    std::vector<char> prev(static_cast<size_t>(rows) * cols * gemm.c_size);
+    std::vector<char> cur(prev.size());
+
+    pResult->stream = static_cast<int>(sample % streams.size());
+    pResult->batch = static_cast<int>(sample / streams.size() % batch_count);
+    pResult->row = static_cast<rocblas_int>(
+        static_cast<uint32_t>(pos) % (m - rows + 1));
+    pResult->col = static_cast<rocblas_int>((pos >> 32) % (n - cols + 1));
+    pResult->checked = pResult->skipped = pResult->errors = 0;
+    pResult->error_row = pResult->error_col = 0;
+    pResult->max_error = 0;
+
+    gemm_stream_t& gs = streams[pResult->stream];
+
+    // pending uploads must not change operands under the checked GEMM
+    if (is_pipeline && hipStreamSynchronize(copy_stream) != hipSuccess) {
+        is_error = true;
+        return false;
+    }
+    if (hipStreamSynchronize(gs.stream) != hipSuccess ||
+        !copy_tile_from_gpu(*pResult, rows, cols, prev.data()) ||
+        !run_blass_gemm(pResult->stream) ||
+        hipStreamSynchronize(gs.stream) != hipSuccess ||
+        !copy_tile_from_gpu(*pResult, rows, cols, cur.data())) {
+        is_error = true;
+        return false;
+    }
 
-        //DGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            hdbla[i] = (double)fast_pseudo_rand(&nextr);
+    compute_tile_reference(*pResult, rows, cols, &ref, &ref_abs);
+    get_alpha_beta(&alpha, &beta);
+    tolerance = get_verify_tolerance();
+    denorm = get_denorm_min(gemm.c_type);
+
+    // tile read from the GPU is column major, reference is row major
+    for (rocblas_int j = 0; j < cols; j++) {
+        for (rocblas_int i = 0; i < rows; i++) {
+            size_t t = static_cast<size_t>(j) * rows + i;
+            size_t r = static_cast<size_t>(i) * cols + j;
+            double c0 = get_element(prev.data(), gemm.c_type, t);
+            double c1 = get_element(cur.data(), gemm.c_type, t);
+            double expected = alpha * ref[r] + beta * c0;
+            double bound = rvs::gemmref::get_error_bound(tolerance,
+                std::fabs(alpha) * ref_abs[r] + std::fabs(beta * c0), denorm);
+
+            if (!std::isfinite(expected) || !std::isfinite(bound)) {
+                pResult->skipped++;
+                continue;
+            }
 
-        for (i = 0; i < size_b; ++i)
-            hdblb[i] = (double)fast_pseudo_rand(&nextr);
+            pResult->checked++;
+            double error = std::fabs(c1 - expected);
+            if (!(error <= pResult->max_error))
+                pResult->max_error = error;  // NaN is kept
+            if (error <= bound)
+                continue;
+            if (pResult->errors++ == 0) {
+                pResult->error_row = pResult->row + i;
+                pResult->error_col = pResult->col + j;
+            }
+        }
+    }
 
-        for (int i = 0; i < size_c; ++i)
-            hdblc[i] = (double)fast_pseudo_rand(&nextr);
+    return true;
+}
 
-        //DGEMM stuff
-        for (i = 0; i < size_a; ++i)
-            hhlfa[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+/**
+ * @brief copies a tile of C of the stream and batch given in tile
+ * @param tile tile position
+ * @param rows number of tile rows
+ * @param cols number of tile columns
+ * @param dst host buffer, column major with rows leading dimension
+ * @return true if everything went fine, otherwise false
+ */
+bool rvs_blas::copy_tile_from_gpu(const verify_result_t& tile,
+                                  rocblas_int rows, rocblas_int cols,
+                                  void* dst) {
+    const char* src = static_cast<const char*>(streams[tile.stream].dc) +
+        (static_cast<size_t>(tile.batch) * size_c + tile.row +
+         static_cast<size_t>(tile.col) * m) * gemm.c_size;
+
+    return hipMemcpy2D(dst, rows * gemm.c_size, src, m * gemm.c_size,
+                       rows * gemm.c_size, cols, hipMemcpyDeviceToHost)
+           == hipSuccess;
+}
 
-        for (i = 0; i < size_b; ++i)
-            hhlfb[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+/**
+ * @brief computes op(A) * op(B) of a tile from the host matrices
+ *
+ * Rows of op(A) and columns of op(B) are packed contiguously and passed to
+ * rvs::gemmref, in double precision for double and integer GEMMs (exact for
+ * int8) and in single precision otherwise.
+ *
+ * @param tile tile position
+ * @param rows number of tile rows
+ * @param cols number of tile columns
+ * @param pRef [out] rows x cols products, row major
+ * @param pAbs [out] rows x cols sums of absolute values of the products
+ */
+void rvs_blas::compute_tile_reference(const verify_result_t& tile,
+                                      rocblas_int rows, rocblas_int cols,
+                                      std::vector<double>* pRef,
+                                      std::vector<double>* pAbs) {
+    const void* a = host_data->get(0);
+    const void* b = host_data->get(1);
+    size_t kk = static_cast<size_t>(k);
+    std::vector<double> pa(rows * kk), pb(cols * kk);
+
+    for (rocblas_int i = 0; i < rows; i++) {
+        size_t row = static_cast<size_t>(tile.row) + i;
+        for (size_t l = 0; l < kk; l++) {
+            pa[i * kk + l] = get_element(a, gemm.ab_type,
+                trans_a == rocblas_operation_none ? row + l * m :
+                                                    l + row * kk);
+        }
+    }
+    for (rocblas_int j = 0; j < cols; j++) {
+        size_t col = static_cast<size_t>(tile.col) + j;
+        for (size_t l = 0; l < kk; l++) {
+            pb[j * kk + l] = get_element(b, gemm.ab_type,
+                trans_b == rocblas_operation_none ? l + col * kk :
+                                                    col + l * n);
+        }
+    }
+
+    pRef->resize(static_cast<size_t>(rows) * cols);
+    pAbs->resize(pRef->size());
+    if (gemm.compute_type == rocblas_datatype_f64_r ||
+        gemm.compute_type == rocblas_datatype_i32_r) {
+        rvs::gemmref::multiply(pa.data(), pb.data(), rows, cols, k,
+                               pRef->data(), pAbs->data());
+        return;
+    }
 
-        for (int i = 0; i < size_c; ++i)
-            hhlfc[i].data = (uint16_t)fast_pseudo_rand(&nextr);
+    std::vector<float> fa(pa.begin(), pa.end()), fb(pb.begin(), pb.end());
+    std::vector<float> fref(pRef->size()), fref_abs(pRef->size());
+    rvs::gemmref::multiply(fa.data(), fb.data(), rows, cols, k,
+                           fref.data(), fref_abs.data());
+    pRef->assign(fref.begin(), fref.end());
+    pAbs->assign(fref_abs.begin(), fref_abs.end());
+}
 
+/**
+ * @brief returns alpha and beta used by run_blass_gemm()
+ * @param pAlpha [out] alpha
+ * @param pBeta [out] beta
+ */
+void rvs_blas::get_alpha_beta(double* pAlpha, double* pBeta) {
+    switch (gemm.kind) {
+    case GEMM_KIND_DGEMM:
+        *pAlpha = RVS_BLAS_ALPHA;
+        *pBeta = RVS_BLAS_BETA;
+        break;
+    case GEMM_KIND_HGEMM:
+        *pAlpha = rvs::gemmref::half_to_float(RVS_BLAS_HALF_ALPHA);
+        *pBeta = rvs::gemmref::half_to_float(RVS_BLAS_HALF_BETA);
+        break;
+    default:
+        if (gemm.compute_type == rocblas_datatype_i32_r) {
+            *pAlpha = RVS_BLAS_INT_ALPHA;
+            *pBeta = RVS_BLAS_INT_BETA;
+        } else {
+            *pAlpha = static_cast<float>(RVS_BLAS_ALPHA);
+            *pBeta = static_cast<float>(RVS_BLAS_BETA);
+        }
+        break;
     }
 }
 
+/**
+ * @brief returns relative tolerance of verify_gemm_tile()
+ *
+ * See rvs::gemmref::get_tolerance(). 16 bit GEMMs are accumulated in
+ * single precision, as rocBLAS does on GPUs with packed dot product and
+ * matrix instructions and as the host reference does; a bound with half
+ * precision accumulation would exceed 100% of the result for k > 1024.
+ * Integer GEMMs are exact.
+ *
+ * @return tolerance relative to alpha * |A| * |B| + |beta * C|
+ */
+double rvs_blas::get_verify_tolerance(void) {
+    double acc = std::min(get_unit_roundoff(gemm.compute_type),
+                          get_unit_roundoff(rocblas_datatype_f32_r));
+    return rvs::gemmref::get_tolerance(k, acc,
+                                       get_unit_roundoff(gemm.c_type));
+}
 
+/**
+ * @brief returns unit roundoff of a data type
+ * @param type data type
+ * @return unit roundoff, 0 for integer types
+ */
+double rvs_blas::get_unit_roundoff(rocblas_datatype type) {
+    switch (type) {
+    case rocblas_datatype_f64_r:
+        return std::ldexp(1.0, -53);
+    case rocblas_datatype_f32_r:
+        return std::ldexp(1.0, -24);
+    case rocblas_datatype_f16_r:
+        return std::ldexp(1.0, -11);
+    case rocblas_datatype_bf16_r:
+        return std::ldexp(1.0, -8);
+    default:
+        return 0;
+    }
+}
 
 /**
- * @brief fast pseudo random generator 
- * @return floating point random number
+ * @brief returns smallest denormal of a data type
+ * @param type data type
+ * @return smallest positive denormal, 0 for integer types
  */
-float rvs_blas::fast_pseudo_rand(u_long *nextr) {
-    *nextr = *nextr * 1103515245 + 12345;
-    return static_cast<float>(static_cast<uint32_t>
-                    ((*nextr / 65536) % RANDOM_CT)) / RANDOM_DIV_CT;
+double rvs_blas::get_denorm_min(rocblas_datatype type) {
+    switch (type) {
+    case rocblas_datatype_f64_r:
+        return std::numeric_limits<double>::denorm_min();
+    case rocblas_datatype_f32_r:
+        return std::numeric_limits<float>::denorm_min();
+    case rocblas_datatype_f16_r:
+        return std::ldexp(1.0, -24);
+    case rocblas_datatype_bf16_r:
+        return std::ldexp(1.0, -133);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief returns element of a matrix as double
+ * @param data matrix
+ * @param type data type of the matrix
+ * @param ix element index
+ * @return element value
+ */
+double rvs_blas::get_element(const void* data, rocblas_datatype type,
+                             size_t ix) {
+    switch (type) {
+    case rocblas_datatype_f64_r:
+        return static_cast<const double*>(data)[ix];
+    case rocblas_datatype_f32_r:
+        return static_cast<const float*>(data)[ix];
+    case rocblas_datatype_f16_r:
+        return rvs::gemmref::half_to_float(
+            static_cast<const uint16_t*>(data)[ix]);
+    case rocblas_datatype_bf16_r:
+        return rvs::gemmref::bf16_to_float(
+            static_cast<const uint16_t*>(data)[ix]);
+    case rocblas_datatype_i8_r:
+        return static_cast<const int8_t*>(data)[ix];
+    case rocblas_datatype_i32_r:
+        return static_cast<const int32_t*>(data)[ix];
+    default:
+        return 0;
+    }
 }
 
+/**
+ * @brief generate matrix random data
+ * it should be called before rocBlas GEMM
+ *
+ * Host matrices are shared with all other rvs_blas instances using the
+ * same GEMM type, sizes and seed (see rvs::matrixcache).
+ *
+ * @param _seed data seed
+ * @param cache_dir directory of matrix cache files (empty if not used)
+ */
+void rvs_blas::generate_random_matrix_data(uint64_t _seed,
+                                           const std::string& cache_dir) {
+    bool generated = false;
+
+    if (is_error)
+        return;
+
+    seed = _seed;
+    host_data = rvs::matrixcache::acquire(gemm.base, m, n, k, seed,
+                                          cache_dir, &generated);
+    if (!host_data) {
+        is_error = true;
+        return;
+    }
+
+    std::string msg = "[rvs_blas] " + ops_type + " on GPU "
+        + std::to_string(gpu_device_index) + " seed: " + std::to_string(seed)
+        + " host memory footprint: "
+        + std::to_string(host_data->get_length()) + " bytes ("
+        + std::string(generated ? "generated" : "shared")
+        + (host_data->is_mapped() ? ", mapped file)" : ")");
+    rvs::lp::Log(msg, rvs::logdebug);
+}
@@ -0,0 +1,523 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_gemmref.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RVS_GEMMREF_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define RVS_GEMMREF_NEON
+#endif
+
+namespace {
+
+//! SIMD instruction set used for dot products
+enum simd_level_t {
+  simd_scalar = 0,
+  simd_neon,
+  simd_avx2,
+  simd_avx512
+};
+
+//! sum of Count values
+template <typename T>
+inline T hsum(const T* p, int Count) {
+  T s = 0;
+  for (int i = 0; i < Count; i++) {
+    s += p[i];
+  }
+  return s;
+}
+
+/**
+ * @brief Dot products of RVS_GEMMREF_ROWS rows with one column
+ *
+ * Adds products of elements [i, n) to sum and their absolute values to abs.
+ *
+ * */
+template <typename T>
+void dot_scalar(const T* const* a, const T* b, size_t i, size_t n,
+                T* sum, T* abs) {
+  for (; i < n; i++) {
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      T p = a[r][i] * b[i];
+      sum[r] += p;
+      abs[r] += std::fabs(p);
+    }
+  }
+}
+
+#ifdef RVS_GEMMREF_X86
+
+__attribute__((target("avx2,fma")))
+size_t dot_avx2(const float* const* a, const float* b, size_t n,
+                float* sum, float* abs) {
+  const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  float t[8];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = _mm256_setzero_ps();
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m256 vb = _mm256_loadu_ps(b + i);
+    __m256 vbabs = _mm256_and_ps(vb, mask);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      __m256 x = _mm256_loadu_ps(a[r] + i);
+      vs[r] = _mm256_fmadd_ps(x, vb, vs[r]);
+      va[r] = _mm256_fmadd_ps(_mm256_and_ps(x, mask), vbabs, va[r]);
+    }
+  }
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    _mm256_storeu_ps(t, vs[r]);
+    sum[r] += hsum(t, 8);
+    _mm256_storeu_ps(t, va[r]);
+    abs[r] += hsum(t, 8);
+  }
+  return i;
+}
+
+__attribute__((target("avx2,fma")))
+size_t dot_avx2(const double* const* a, const double* b, size_t n,
+                double* sum, double* abs) {
+  const __m256d mask =
+    _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffll));
+  __m256d vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  double t[4];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = _mm256_setzero_pd();
+  }
+  for (; i + 4 <= n; i += 4) {
+    __m256d vb = _mm256_loadu_pd(b + i);
+    __m256d vbabs = _mm256_and_pd(vb, mask);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      __m256d x = _mm256_loadu_pd(a[r] + i);
+      vs[r] = _mm256_fmadd_pd(x, vb, vs[r]);
+      va[r] = _mm256_fmadd_pd(_mm256_and_pd(x, mask), vbabs, va[r]);
+    }
+  }
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    _mm256_storeu_pd(t, vs[r]);
+    sum[r] += hsum(t, 4);
+    _mm256_storeu_pd(t, va[r]);
+    abs[r] += hsum(t, 4);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f")))
+size_t dot_avx512(const float* const* a, const float* b, size_t n,
+                  float* sum, float* abs) {
+  __m512 vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  float t[16];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = _mm512_setzero_ps();
+  }
+  for (; i + 16 <= n; i += 16) {
+    __m512 vb = _mm512_loadu_ps(b + i);
+    __m512 vbabs = _mm512_abs_ps(vb);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      __m512 x = _mm512_loadu_ps(a[r] + i);
+      vs[r] = _mm512_fmadd_ps(x, vb, vs[r]);
+      va[r] = _mm512_fmadd_ps(_mm512_abs_ps(x), vbabs, va[r]);
+    }
+  }
+  // _mm512_reduce_add_*() triggers spurious uninitialized value warnings
+  // in some GCC versions
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    _mm512_storeu_ps(t, vs[r]);
+    sum[r] += hsum(t, 16);
+    _mm512_storeu_ps(t, va[r]);
+    abs[r] += hsum(t, 16);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f")))
+size_t dot_avx512(const double* const* a, const double* b, size_t n,
+                  double* sum, double* abs) {
+  __m512d vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  double t[8];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = _mm512_setzero_pd();
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m512d vb = _mm512_loadu_pd(b + i);
+    __m512d vbabs = _mm512_abs_pd(vb);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      __m512d x = _mm512_loadu_pd(a[r] + i);
+      vs[r] = _mm512_fmadd_pd(x, vb, vs[r]);
+      va[r] = _mm512_fmadd_pd(_mm512_abs_pd(x), vbabs, va[r]);
+    }
+  }
+  // _mm512_reduce_add_*() triggers spurious uninitialized value warnings
+  // in some GCC versions
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    _mm512_storeu_pd(t, vs[r]);
+    sum[r] += hsum(t, 8);
+    _mm512_storeu_pd(t, va[r]);
+    abs[r] += hsum(t, 8);
+  }
+  return i;
+}
+
+#endif  // RVS_GEMMREF_X86
+
+#ifdef RVS_GEMMREF_NEON
+
+size_t dot_neon(const float* const* a, const float* b, size_t n,
+                float* sum, float* abs) {
+  float32x4_t vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = vdupq_n_f32(0);
+  }
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t vb = vld1q_f32(b + i);
+    float32x4_t vbabs = vabsq_f32(vb);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      float32x4_t x = vld1q_f32(a[r] + i);
+      vs[r] = vfmaq_f32(vs[r], x, vb);
+      va[r] = vfmaq_f32(va[r], vabsq_f32(x), vbabs);
+    }
+  }
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    sum[r] += vaddvq_f32(vs[r]);
+    abs[r] += vaddvq_f32(va[r]);
+  }
+  return i;
+}
+
+size_t dot_neon(const double* const* a, const double* b, size_t n,
+                double* sum, double* abs) {
+  float64x2_t vs[RVS_GEMMREF_ROWS], va[RVS_GEMMREF_ROWS];
+  size_t i = 0;
+
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    vs[r] = va[r] = vdupq_n_f64(0);
+  }
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t vb = vld1q_f64(b + i);
+    float64x2_t vbabs = vabsq_f64(vb);
+    for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+      float64x2_t x = vld1q_f64(a[r] + i);
+      vs[r] = vfmaq_f64(vs[r], x, vb);
+      va[r] = vfmaq_f64(va[r], vabsq_f64(x), vbabs);
+    }
+  }
+  for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+    sum[r] += vaddvq_f64(vs[r]);
+    abs[r] += vaddvq_f64(va[r]);
+  }
+  return i;
+}
+
+#endif  // RVS_GEMMREF_NEON
+
+//! detects best instruction set supported by this CPU
+simd_level_t detect_simd() {
+#if defined(RVS_GEMMREF_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return simd_avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return simd_avx2;
+  }
+  return simd_scalar;
+#elif defined(RVS_GEMMREF_NEON)
+  return simd_neon;  // part of the aarch64 base instruction set
+#else
+  return simd_scalar;
+#endif
+}
+
+simd_level_t simd_level() {
+  static const simd_level_t level = detect_simd();
+  return level;
+}
+
+/**
+ * @brief Vectorized part of dot products of rows with one column
+ *
+ * @return number of leading elements done, the rest is left for
+ * dot_scalar()
+ *
+ * */
+template <typename T>
+size_t dot_simd(const T* const* a, const T* b, size_t n, T* sum, T* abs) {
+#if defined(RVS_GEMMREF_X86)
+  if (simd_level() == simd_avx512) {
+    return dot_avx512(a, b, n, sum, abs);
+  }
+  if (simd_level() == simd_avx2) {
+    return dot_avx2(a, b, n, sum, abs);
+  }
+  return 0;
+#elif defined(RVS_GEMMREF_NEON)
+  return dot_neon(a, b, n, sum, abs);
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Computes rows [First, Last) of the tile
+ *
+ * For each block of K, the B block is run against all rows of the range,
+ * RVS_GEMMREF_ROWS rows at a time.
+ *
+ * */
+template <typename T>
+void multiply_rows(const T* pA, const T* pB, int First, int Last, int Cols,
+                   int K, T* pC, T* pAbs) {
+  size_t cols = static_cast<size_t>(Cols);
+
+  std::fill(pC + First * cols, pC + Last * cols, T(0));
+  std::fill(pAbs + First * cols, pAbs + Last * cols, T(0));
+
+  for (int k0 = 0; k0 < K; k0 += RVS_GEMMREF_K_BLOCK) {
+    size_t n = static_cast<size_t>(std::min(RVS_GEMMREF_K_BLOCK, K - k0));
+    for (int i = First; i < Last; i += RVS_GEMMREF_ROWS) {
+      int rows = std::min(RVS_GEMMREF_ROWS, Last - i);
+      const T* a[RVS_GEMMREF_ROWS];
+      // rows past the end repeat the last one and are not stored
+      for (int r = 0; r < RVS_GEMMREF_ROWS; r++) {
+        a[r] = pA + static_cast<size_t>(i + std::min(r, rows - 1)) * K + k0;
+      }
+      for (size_t j = 0; j < cols; j++) {
+        const T* b = pB + j * K + k0;
+        T sum[RVS_GEMMREF_ROWS] = {0};
+        T abs[RVS_GEMMREF_ROWS] = {0};
+        dot_scalar(a, b, dot_simd(a, b, n, sum, abs), n, sum, abs);
+        for (int r = 0; r < rows; r++) {
+          pC[(i + r) * cols + j] += sum[r];
+          pAbs[(i + r) * cols + j] += abs[r];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Split tile rows into ranges and compute them in parallel
+ *
+ * */
+template <typename T>
+void multiply_parallel(const T* pA, const T* pB, int Rows, int Cols, int K,
+                       T* pC, T* pAbs, unsigned Threads) {
+  unsigned nthreads = rvs::gemmref::get_threads(Rows, Cols, K, Threads);
+  if (nthreads <= 1) {
+    multiply_rows(pA, pB, 0, Rows, Cols, K, pC, pAbs);
+    return;
+  }
+
+  // ranges are whole groups of rows sharing B loads
+  int groups = (Rows + RVS_GEMMREF_ROWS - 1) / RVS_GEMMREF_ROWS;
+  int chunk = (groups + nthreads - 1) / nthreads * RVS_GEMMREF_ROWS;
+  std::vector<std::thread> workers;
+  for (int first = chunk; first < Rows; first += chunk) {
+    int last = std::min(first + chunk, Rows);
+    workers.emplace_back([=]() {
+      multiply_rows(pA, pB, first, last, Cols, K, pC, pAbs);
+    });
+  }
+  // calling thread does the first range
+  multiply_rows(pA, pB, 0, std::min(chunk, Rows), Cols, K, pC, pAbs);
+  for (auto& w : workers) {
+    w.join();
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Computes a tile of op(A) * op(B)
+ *
+ * @param pA Rows x K rows of op(A), each row contiguous
+ * @param pB Cols x K columns of op(B), each column contiguous
+ * @param Rows number of tile rows
+ * @param Cols number of tile columns
+ * @param K inner dimension
+ * @param pC [out] Rows x Cols tile, row major
+ * @param pAbs [out] Rows x Cols sums of absolute values of the products,
+ * row major
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::gemmref::multiply(const float* pA, const float* pB, int Rows,
+                            int Cols, int K, float* pC, float* pAbs,
+                            unsigned Threads) {
+  multiply_parallel(pA, pB, Rows, Cols, K, pC, pAbs, Threads);
+}
+
+/**
+ * @brief Computes a tile of op(A) * op(B) in double precision
+ *
+ * See multiply(const float*, ...) for parameters.
+ *
+ * */
+void rvs::gemmref::multiply(const double* pA, const double* pB, int Rows,
+                            int Cols, int K, double* pC, double* pAbs,
+                            unsigned Threads) {
+  multiply_parallel(pA, pB, Rows, Cols, K, pC, pAbs, Threads);
+}
+
+/**
+ * @brief Get number of threads used to compute a tile
+ *
+ * @param Rows number of tile rows
+ * @param Cols number of tile columns
+ * @param K inner dimension
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ * @return number of threads, each doing at least RVS_GEMMREF_MIN_WORK
+ * multiply-adds and at least one group of RVS_GEMMREF_ROWS rows
+ *
+ * */
+unsigned rvs::gemmref::get_threads(int Rows, int Cols, int K,
+                                   unsigned Threads) {
+  if (Threads == 0) {
+    Threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  uint64_t work = static_cast<uint64_t>(Rows) * Cols * K;
+  uint64_t max_threads = std::max<uint64_t>(work / RVS_GEMMREF_MIN_WORK, 1);
+  uint64_t groups = (Rows + RVS_GEMMREF_ROWS - 1) / RVS_GEMMREF_ROWS;
+  max_threads = std::min(max_threads, std::max<uint64_t>(groups, 1));
+  return static_cast<unsigned>(std::min<uint64_t>(Threads, max_threads));
+}
+
+/**
+ * @brief Get relative tolerance of a tile computed by the GPU
+ *
+ * Rounding errors of a K long dot product behave as independent random
+ * variables, so the error stays within RVS_GEMMREF_LAMBDA * sqrt(K) unit
+ * roundoffs of the sum of absolute products with overwhelming probability
+ * (Higham & Mary, probabilistic error analysis), capped at the K unit
+ * roundoffs that hold in any case. The bound is taken twice, for the GPU
+ * and for this reference, and the result adds two roundings of its output
+ * type.
+ *
+ * @param K inner dimension
+ * @param AccRoundoff unit roundoff of the accumulation
+ * @param OutRoundoff unit roundoff of the result type
+ * @return tolerance relative to the sum of absolute products
+ *
+ * */
+double rvs::gemmref::get_tolerance(int K, double AccRoundoff,
+                                   double OutRoundoff) {
+  double n = std::min(RVS_GEMMREF_LAMBDA * std::sqrt(static_cast<double>(K)),
+                      static_cast<double>(K));
+  return 2.0 * n * AccRoundoff + 2.0 * OutRoundoff;
+}
+
+/**
+ * @brief Get max error of one element of a tile computed by the GPU
+ *
+ * Results in the denormal range of the output type are rounded to a fixed
+ * absolute step, which a bound relative to Scale does not cover for small
+ * results (e.g. hgemm with denormal alpha and beta). Two roundings of the
+ * output type add at most one step, the smallest denormal.
+ *
+ * @param Tolerance relative tolerance (see get_tolerance())
+ * @param Scale |alpha| * sum of absolute products + |beta * C|
+ * @param OutDenorm smallest denormal of the result type (0 for integers)
+ * @return max absolute difference from the reference
+ *
+ * */
+double rvs::gemmref::get_error_bound(double Tolerance, double Scale,
+                                     double OutDenorm) {
+  return Tolerance * Scale + OutDenorm;
+}
+
+/**
+ * @brief Converts IEEE half precision value to float
+ *
+ * */
+float rvs::gemmref::half_to_float(uint16_t Value) {
+  uint32_t sign = static_cast<uint32_t>(Value & 0x8000) << 16;
+  uint32_t exponent = (Value >> 10) & 0x1f;
+  uint32_t mantissa = Value & 0x3ff;
+  uint32_t bits;
+  float f;
+
+  if (exponent == 0) {
+    // zero or denormal, exactly representable as float
+    f = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -f : f;
+  }
+  if (exponent == 0x1f) {
+    bits = sign | 0x7f800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/**
+ * @brief Converts bfloat16 value to float
+ *
+ * */
+float rvs::gemmref::bf16_to_float(uint16_t Value) {
+  uint32_t bits = static_cast<uint32_t>(Value) << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+/**
+ * @brief Name of the instruction set used for dot products
+ *
+ * @return "avx512", "avx2", "neon" or "scalar"
+ *
+ * */
+const char* rvs::gemmref::simd_name() {
+  switch (simd_level()) {
+  case simd_avx512:
+    return "avx512";
+  case simd_avx2:
+    return "avx2";
+  case simd_neon:
+    return "neon";
+  default:
+    return "scalar";
+  }
+}
@@ -0,0 +1,202 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_gemmtune.h"
+
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+std::mutex rvs::gemmtune::file_mutex;
+
+//! Default constructor
+rvs::gemmtune::gemmtune() {
+  best = candidate_t{0, 0, 0, false, false, 0};
+  has_best = false;
+}
+
+/**
+ * @brief Build cache key
+ *
+ * Whitespace in key parts is replaced so that the key is a single word of
+ * the cache file line.
+ *
+ * @param DeviceId device id
+ * @param Vbios VBIOS version (empty if not known)
+ * @param OpsType GEMM type
+ * @param Streams number of GEMM streams
+ * @param BatchCount number of GEMMs per call
+ * @return cache key
+ *
+ * */
+std::string rvs::gemmtune::make_key(const std::string& DeviceId,
+                                    const std::string& Vbios,
+                                    const std::string& OpsType,
+                                    uint32_t Streams, uint32_t BatchCount) {
+  std::string key = DeviceId + ":" + (Vbios.empty() ? "unknown" : Vbios)
+                    + ":" + OpsType + ":s" + std::to_string(Streams)
+                    + ":b" + std::to_string(BatchCount);
+  for (auto it = key.begin(); it != key.end(); ++it) {
+    if (isspace(static_cast<unsigned char>(*it))) {
+      *it = '_';
+    }
+  }
+  return key;
+}
+
+/**
+ * @brief Get candidates to sweep
+ *
+ * @param Sizes square matrix sizes
+ * @return each size with all four A/B transpositions
+ *
+ * */
+std::vector<rvs::gemmtune::candidate_t> rvs::gemmtune::get_candidates(
+                                        const std::vector<uint64_t>& Sizes) {
+  std::vector<candidate_t> res;
+  for (auto it = Sizes.begin(); it != Sizes.end(); ++it) {
+    for (int t = 0; t < 4; t++) {
+      res.push_back(candidate_t{*it, *it, *it, (t & 2) != 0, (t & 1) != 0,
+                                0});
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief Add measured candidate
+ *
+ * @param Candidate candidate with measured Gflops
+ *
+ * */
+void rvs::gemmtune::add(const candidate_t& Candidate) {
+  if (Candidate.gflops > 0 && (!has_best || Candidate.gflops > best.gflops)) {
+    best = Candidate;
+    has_best = true;
+  }
+}
+
+/**
+ * @brief Get best candidate
+ *
+ * @param pBest [out] best candidate
+ * @return true if any candidate was measured successfully, false otherwise
+ *
+ * */
+bool rvs::gemmtune::get_best(candidate_t* pBest) const {
+  if (has_best) {
+    *pBest = best;
+  }
+  return has_best;
+}
+
+/**
+ * @brief Look up cached winner
+ *
+ * @param File cache file
+ * @param Key cache key (see make_key())
+ * @param pBest [out] cached winner
+ * @return true if key was found, false otherwise
+ *
+ * */
+bool rvs::gemmtune::load(const std::string& File, const std::string& Key,
+                         candidate_t* pBest) {
+  std::lock_guard<std::mutex> lk(file_mutex);
+  std::ifstream in(File);
+  std::string line;
+
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    candidate_t c;
+    if (!(ss >> key >> c.m >> c.n >> c.k >> c.trans_a >> c.trans_b
+             >> c.gflops)) {
+      continue;
+    }
+    if (key == Key && c.m > 0 && c.n > 0 && c.k > 0) {
+      *pBest = c;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Store winner in cache file
+ *
+ * Lines of other keys are kept. File is written to a temporary file which
+ * is then renamed, so readers never see a partial file.
+ *
+ * @param File cache file
+ * @param Key cache key (see make_key())
+ * @param Best winner
+ * @return true if successful, false otherwise
+ *
+ * */
+bool rvs::gemmtune::save(const std::string& File, const std::string& Key,
+                         const candidate_t& Best) {
+  std::lock_guard<std::mutex> lk(file_mutex);
+  std::vector<std::string> lines;
+  std::string line;
+
+  {
+    std::ifstream in(File);
+    while (std::getline(in, line)) {
+      std::istringstream ss(line);
+      std::string key;
+      if (ss >> key && key != Key) {
+        lines.push_back(line);
+      }
+    }
+  }
+
+  std::ostringstream entry;
+  entry << Key << " " << Best.m << " " << Best.n << " " << Best.k << " "
+        << Best.trans_a << " " << Best.trans_b << " " << Best.gflops;
+  lines.push_back(entry.str());
+
+  std::string tmpname = File + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream out(tmpname, std::ios::trunc);
+    for (auto it = lines.begin(); it != lines.end(); ++it) {
+      out << *it << "\n";
+    }
+    if (!out.good()) {
+      out.close();
+      std::remove(tmpname.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(tmpname.c_str(), File.c_str())) {
+    std::remove(tmpname.c_str());
+    return false;
+  }
+  return true;
+}
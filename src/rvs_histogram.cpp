@@ -0,0 +1,216 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_histogram.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+
+//! total number of buckets
+#define RVS_HISTOGRAM_BUCKETS \
+  ((RVS_HISTOGRAM_MAX_EXP - RVS_HISTOGRAM_MIN_EXP) * RVS_HISTOGRAM_SUBBUCKETS)
+
+//! Default constructor.
+rvs::histogram::histogram() {
+  clear();
+}
+
+/**
+ * @brief Reset histogram
+ *
+ * */
+void rvs::histogram::clear() {
+  buckets.assign(RVS_HISTOGRAM_BUCKETS, 0);
+  samples = 0;
+  sum = 0;
+  vmin = 0;
+  vmax = 0;
+}
+
+/**
+ * @brief Get bucket index for value
+ *
+ * @param Value value
+ * @return bucket index
+ *
+ * */
+int rvs::histogram::bucket(double Value) {
+  if (!(Value > 0)) {
+    return 0;
+  }
+  double ix = std::floor((std::log2(Value) - RVS_HISTOGRAM_MIN_EXP)
+                         * RVS_HISTOGRAM_SUBBUCKETS);
+  if (ix < 0) {
+    return 0;
+  }
+  if (ix >= RVS_HISTOGRAM_BUCKETS) {
+    return RVS_HISTOGRAM_BUCKETS - 1;
+  }
+  return static_cast<int>(ix);
+}
+
+/**
+ * @brief Get lower bound of bucket
+ *
+ * @param Bucket bucket index
+ * @return smallest value falling into the bucket
+ *
+ * */
+double rvs::histogram::lower_bound(int Bucket) {
+  return std::exp2(static_cast<double>(Bucket) / RVS_HISTOGRAM_SUBBUCKETS
+                   + RVS_HISTOGRAM_MIN_EXP);
+}
+
+/**
+ * @brief Add value
+ *
+ * @param Value value to add
+ *
+ * */
+void rvs::histogram::add(double Value) {
+  buckets[bucket(Value)]++;
+  if (samples == 0 || Value < vmin) {
+    vmin = Value;
+  }
+  if (samples == 0 || Value > vmax) {
+    vmax = Value;
+  }
+  sum += Value;
+  samples++;
+}
+
+/**
+ * @brief Merge another histogram into this one
+ *
+ * @param Other histogram to merge
+ *
+ * */
+void rvs::histogram::add(const histogram& Other) {
+  if (Other.samples == 0) {
+    return;
+  }
+  for (size_t i = 0; i < buckets.size(); i++) {
+    buckets[i] += Other.buckets[i];
+  }
+  if (samples == 0 || Other.vmin < vmin) {
+    vmin = Other.vmin;
+  }
+  if (samples == 0 || Other.vmax > vmax) {
+    vmax = Other.vmax;
+  }
+  sum += Other.sum;
+  samples += Other.samples;
+}
+
+/**
+ * @brief Estimate percentile
+ *
+ * Value is interpolated within the bucket holding the percentile and
+ * clamped to the exact minimum and maximum.
+ *
+ * @param P percentile (0 - 100)
+ * @return estimated value (0 if histogram is empty)
+ *
+ * */
+double rvs::histogram::percentile(double P) const {
+  if (samples == 0) {
+    return 0;
+  }
+
+  if (P <= 0) {
+    return vmin;
+  }
+  if (P >= 100) {
+    return vmax;
+  }
+
+  double rank = P / 100 * samples;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    if (buckets[i] == 0) {
+      continue;
+    }
+    if (seen + buckets[i] >= rank) {
+      double lo = lower_bound(i);
+      double hi = lower_bound(i + 1);
+      double val = lo + (hi - lo) * (rank - seen) / buckets[i];
+      return std::min(std::max(val, vmin), vmax);
+    }
+    seen += buckets[i];
+  }
+
+  return vmax;
+}
+
+/**
+ * @brief Get non empty buckets at given resolution
+ *
+ * @param PerOctave buckets per power of two, must divide
+ * RVS_HISTOGRAM_SUBBUCKETS
+ * @param pLower [out] lower bound of each non empty bucket
+ * @param pCount [out] number of values in each non empty bucket
+ *
+ * */
+void rvs::histogram::get_buckets(int PerOctave, std::vector<double>* pLower,
+                                 std::vector<uint64_t>* pCount) const {
+  int step = RVS_HISTOGRAM_SUBBUCKETS / std::max(PerOctave, 1);
+  step = std::max(step, 1);
+
+  pLower->clear();
+  pCount->clear();
+  for (size_t i = 0; i < buckets.size(); i += step) {
+    uint64_t cnt = 0;
+    for (size_t j = i; j < i + step && j < buckets.size(); j++) {
+      cnt += buckets[j];
+    }
+    if (cnt) {
+      pLower->push_back(lower_bound(i));
+      pCount->push_back(cnt);
+    }
+  }
+}
+
+/**
+ * @brief Format non empty buckets as "lower:count" pairs
+ *
+ * @param PerOctave buckets per power of two
+ * @return space separated list of buckets
+ *
+ * */
+std::string rvs::histogram::to_string(int PerOctave) const {
+  std::vector<double> lower;
+  std::vector<uint64_t> cnt;
+  std::string str;
+  char buff[64];
+
+  get_buckets(PerOctave, &lower, &cnt);
+  for (size_t i = 0; i < lower.size(); i++) {
+    snprintf(buff, sizeof(buff), "%s%.3g:%llu", i ? " " : "", lower[i],
+             static_cast<unsigned long long>(cnt[i]));
+    str += buff;
+  }
+  return str;
+}
@@ -0,0 +1,236 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_linkmonitor.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+//! Default constructor
+rvs::linkmonitor::linkmonitor() {
+  bucket_sec = 0;
+  window = 0;
+  threshold = 0;
+  open_first = 0;
+  last_end = 0;
+  active = false;
+  base_sum = 0;
+  in_dip = false;
+  current = dip_t{0, 0, 0, 0};
+  completed = 0;
+}
+
+/**
+ * @brief Enable monitoring
+ *
+ * @param BucketSec bucket width (sec)
+ * @param Window number of buckets in rolling baseline
+ * @param Threshold relative drop below baseline considered a dip
+ * @param Capacity number of completed buckets kept
+ *
+ * */
+void rvs::linkmonitor::configure(double BucketSec, uint32_t Window,
+                                 double Threshold, size_t Capacity) {
+  std::lock_guard<std::mutex> lk(mtx);
+  bucket_sec = BucketSec;
+  window = std::max<uint32_t>(Window, 1);
+  threshold = Threshold;
+  series.assign(Capacity, sample_t{0, 0});
+  completed = 0;
+  dips.clear();
+  open_bytes.clear();
+  base_values.clear();
+  base_sum = 0;
+  in_dip = false;
+  active = false;
+}
+
+/**
+ * @brief Account one completed transfer
+ *
+ * Transfers have to be added in order of their start time. Buckets which
+ * end before start of this transfer are completed.
+ *
+ * @param Start transfer start (sec, steady clock)
+ * @param End transfer end (sec, steady clock)
+ * @param Bytes number of bytes transferred
+ *
+ * */
+void rvs::linkmonitor::add(double Start, double End, uint64_t Bytes) {
+  if (!enabled()) {
+    return;
+  }
+  End = std::max(Start, End);
+
+  uint64_t first = static_cast<uint64_t>(floor(Start / bucket_sec));
+  uint64_t last = static_cast<uint64_t>(floor(End / bucket_sec));
+
+  if (!active) {
+    // first transfer after start or pause, gap is not a dip
+    open_first = first;
+    open_bytes.clear();
+    active = true;
+  }
+
+  // buckets before this transfer are complete
+  while (open_first < first) {
+    close_bucket(open_first, open_bytes.empty() ? 0 : open_bytes.front());
+    if (!open_bytes.empty()) {
+      open_bytes.pop_front();
+    }
+    open_first++;
+  }
+
+  // transfer overlapping already completed bucket is accounted from the
+  // first open one
+  last = std::max(last, open_first);
+  if (open_bytes.size() < last - open_first + 1) {
+    open_bytes.resize(last - open_first + 1, 0);
+  }
+
+  // spread bytes over transfer duration
+  double span = End - Start;
+  for (uint64_t b = first; b <= last; b++) {
+    double share;
+    if (span <= 0) {
+      share = 1;
+    } else {
+      double lo = std::max(Start, b * bucket_sec);
+      double hi = std::min(End, (b + 1) * bucket_sec);
+      share = std::max(hi - lo, 0.0) / span;
+    }
+    open_bytes[b < open_first ? 0 : b - open_first] += Bytes * share;
+  }
+
+  last_end = End;
+}
+
+/**
+ * @brief Complete all buckets fully covered by transfers added so far
+ *
+ * Called when transfers stop. Trailing partially covered bucket is
+ * discarded and dip in progress is closed. Next add() starts a new segment
+ * without reporting the pause as a dip.
+ *
+ * */
+void rvs::linkmonitor::finish() {
+  if (!active) {
+    return;
+  }
+
+  uint64_t end = static_cast<uint64_t>(floor(last_end / bucket_sec));
+  while (open_first < end && !open_bytes.empty()) {
+    close_bucket(open_first, open_bytes.front());
+    open_bytes.pop_front();
+    open_first++;
+  }
+  open_bytes.clear();
+  active = false;
+
+  if (in_dip) {
+    std::lock_guard<std::mutex> lk(mtx);
+    dips.push_back(current);
+    in_dip = false;
+  }
+}
+
+/**
+ * @brief Store completed bucket and update dip detection
+ *
+ * @param Bucket bucket index
+ * @param Bytes bytes accounted into bucket
+ *
+ * */
+void rvs::linkmonitor::close_bucket(uint64_t Bucket, double Bytes) {
+  double bandwidth = Bytes / bucket_sec / 1e9;
+  double start = Bucket * bucket_sec;
+  std::lock_guard<std::mutex> lk(mtx);
+
+  series[completed % series.size()] =
+    sample_t{Bucket, static_cast<float>(bandwidth)};
+  completed++;
+
+  // no detection until baseline is established
+  if (base_values.size() >= window) {
+    double baseline = base_sum / base_values.size();
+    if (bandwidth < (1 - threshold) * baseline) {
+      if (!in_dip) {
+        in_dip = true;
+        current = dip_t{start, start + bucket_sec, baseline, bandwidth};
+      } else {
+        current.end = start + bucket_sec;
+        current.min = std::min(current.min, bandwidth);
+      }
+      return;
+    }
+    if (in_dip) {
+      dips.push_back(current);
+      in_dip = false;
+    }
+  }
+
+  base_values.push_back(bandwidth);
+  base_sum += bandwidth;
+  if (base_values.size() > window) {
+    base_sum -= base_values.front();
+    base_values.pop_front();
+  }
+}
+
+/**
+ * @brief Get completed buckets still held in the ring
+ *
+ * @param pSeries [out] buckets, oldest first
+ *
+ * */
+void rvs::linkmonitor::get_series(std::vector<sample_t>* pSeries) const {
+  std::lock_guard<std::mutex> lk(mtx);
+  pSeries->clear();
+  if (series.empty()) {
+    return;
+  }
+  uint64_t count = std::min<uint64_t>(completed, series.size());
+  for (uint64_t i = completed - count; i < completed; i++) {
+    pSeries->push_back(series[i % series.size()]);
+  }
+}
+
+/**
+ * @brief Get completed dips
+ *
+ * @param First index of the first dip to return
+ * @param pDips [out] dips from First on
+ * @return total number of completed dips
+ *
+ * */
+size_t rvs::linkmonitor::get_dips(size_t First,
+                                  std::vector<dip_t>* pDips) const {
+  std::lock_guard<std::mutex> lk(mtx);
+  pDips->clear();
+  for (size_t i = First; i < dips.size(); i++) {
+    pDips->push_back(dips[i]);
+  }
+  return dips.size();
+}
@@ -0,0 +1,400 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_matrixcache.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "include/rvs_matrixgen.h"
+
+//! alignment of each matrix within the block
+#define RVS_MATRIXCACHE_ALIGN           (4096u)
+
+std::map<rvs::matrixcache::key_t,
+         std::shared_ptr<rvs::matrixcache::entry_t>> rvs::matrixcache::entries;
+std::mutex rvs::matrixcache::mtx;
+
+//! Default constructor
+rvs::hostmatrix::hostmatrix() {
+  base = nullptr;
+  length = 0;
+  mapped = false;
+  for (int i = 0; i < 3; i++) {
+    offset[i] = 0;
+    size[i] = 0;
+  }
+}
+
+//! Default destructor
+rvs::hostmatrix::~hostmatrix() {
+  if (base == nullptr) {
+    return;
+  }
+  if (mapped) {
+    munmap(base, length);
+  } else {
+    free(base);
+  }
+}
+
+/**
+ * @brief Get size of matrix element
+ *
+ * Mixed precision types have A and B of input type and C of output type
+ * ("int8" has 32 bit integer C, all others have C of the input type).
+ *
+ * @param Type GEMM type ("sgemm", "dgemm", "hgemm", "bf16", "int8" or
+ * "f16_f32acc")
+ * @param Ix matrix index (0 - A, 1 - B, 2 - C)
+ * @return element size in bytes, 0 if type is not supported
+ *
+ * */
+size_t rvs::matrixcache::get_element_size(const std::string& Type, int Ix) {
+  if (Type == "sgemm") {
+    return sizeof(float);
+  }
+  if (Type == "dgemm") {
+    return sizeof(double);
+  }
+  if (Type == "hgemm" || Type == "bf16" || Type == "f16_f32acc") {
+    return sizeof(uint16_t);
+  }
+  if (Type == "int8") {
+    return Ix == 2 ? sizeof(int32_t) : sizeof(int8_t);
+  }
+  return 0;
+}
+
+/**
+ * @brief Get seed used when none is configured
+ *
+ * Seed is chosen once per process, so all GPUs and actions of a run share
+ * the same matrices.
+ *
+ * @return default seed
+ *
+ * */
+uint64_t rvs::matrixcache::get_default_seed() {
+  static const uint64_t seed = static_cast<uint32_t>(time(NULL));
+  return seed;
+}
+
+/**
+ * @brief Get name of cache file holding matrices of the given key
+ *
+ * @param Type GEMM type
+ * @param M matrix size m
+ * @param N matrix size n
+ * @param K matrix size k
+ * @param Seed data seed
+ * @param Dir cache directory
+ * @return full path of cache file
+ *
+ * */
+std::string rvs::matrixcache::get_file_name(const std::string& Type,
+                                            uint64_t M, uint64_t N,
+                                            uint64_t K, uint64_t Seed,
+                                            const std::string& Dir) {
+  return Dir + "/rvs_" + Type + "_" + std::to_string(M) + "x"
+       + std::to_string(N) + "x" + std::to_string(K) + "_"
+       + std::to_string(Seed) + ".bin";
+}
+
+/**
+ * @brief Get matrices for the given key, generating them if needed
+ *
+ * A is m x k, B is n x k and C is m x n matrix. Matrices are generated by
+ * rvs::matrixgen using streams 0, 1 and 2 of the seed. Concurrent callers
+ * asking for the same key wait until the first one has generated it.
+ *
+ * @param Type GEMM type (see get_element_size())
+ * @param M matrix size m
+ * @param N matrix size n
+ * @param K matrix size k
+ * @param Seed data seed
+ * @param Dir cache directory (empty - heap memory only)
+ * @param pGenerated [out] 'true' if data was generated by this call
+ * @return shared matrices, nullptr on failure
+ *
+ * */
+std::shared_ptr<const rvs::hostmatrix> rvs::matrixcache::acquire(
+                                          const std::string& Type,
+                                          uint64_t M, uint64_t N, uint64_t K,
+                                          uint64_t Seed,
+                                          const std::string& Dir,
+                                          bool* pGenerated) {
+  key_t key(Type, M, N, K, Seed);
+  std::shared_ptr<entry_t> entry;
+  bool generated = false;
+
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      entry = it->second;
+    } else {
+      // drop matrices nobody uses any more before allocating new ones
+      drop_unused();
+      entry = std::make_shared<entry_t>();
+      entries[key] = entry;
+    }
+  }
+
+  std::call_once(entry->once, [&]() {
+    std::shared_ptr<hostmatrix> data = create(Type, M, N, K, Seed, Dir,
+                                              &generated);
+    std::lock_guard<std::mutex> lk(mtx);
+    entry->data = data;
+    if (!data) {
+      // let a later call try again
+      auto it = entries.find(key);
+      if (it != entries.end() && it->second == entry) {
+        entries.erase(it);
+      }
+    }
+  });
+
+  if (pGenerated) {
+    *pGenerated = generated;
+  }
+  return entry->data;
+}
+
+/**
+ * @brief Release matrices not used by anybody
+ *
+ * */
+void rvs::matrixcache::release_unused() {
+  std::lock_guard<std::mutex> lk(mtx);
+  drop_unused();
+}
+
+/**
+ * @brief Drop cached matrices not used by anybody, mtx must be held
+ *
+ * Entries still being generated are kept.
+ *
+ * */
+void rvs::matrixcache::drop_unused() {
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second->data && it->second->data.use_count() == 1) {
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Generate or map matrices of the given key
+ *
+ * See acquire() for parameters.
+ *
+ * @return matrices, nullptr on failure
+ *
+ * */
+std::shared_ptr<rvs::hostmatrix> rvs::matrixcache::create(
+                                   const std::string& Type,
+                                   uint64_t M, uint64_t N, uint64_t K,
+                                   uint64_t Seed, const std::string& Dir,
+                                   bool* pGenerated) {
+  std::shared_ptr<hostmatrix> data = std::make_shared<hostmatrix>();
+  if (!layout(Type, M, N, K, data.get())) {
+    return nullptr;
+  }
+
+  *pGenerated = true;
+  if (Dir.empty() ||
+      !map_file(Type, Seed, get_file_name(Type, M, N, K, Seed, Dir),
+                data.get(), pGenerated)) {
+    if (!allocate_heap(data.get())) {
+      return nullptr;
+    }
+    generate(Type, Seed, data.get());
+    *pGenerated = true;
+  }
+  return data;
+}
+
+/**
+ * @brief Compute offsets and sizes of matrices in the block
+ *
+ * @param Type GEMM type
+ * @param M matrix size m
+ * @param N matrix size n
+ * @param K matrix size k
+ * @param pData [out] matrices to lay out
+ * @return true if type and sizes are valid, false otherwise
+ *
+ * */
+bool rvs::matrixcache::layout(const std::string& Type, uint64_t M,
+                              uint64_t N, uint64_t K, hostmatrix* pData) {
+  if (get_element_size(Type) == 0 || M == 0 || N == 0 || K == 0) {
+    return false;
+  }
+
+  pData->size[0] = M * K * get_element_size(Type, 0);
+  pData->size[1] = N * K * get_element_size(Type, 1);
+  pData->size[2] = M * N * get_element_size(Type, 2);
+
+  size_t pos = 0;
+  for (int i = 0; i < 3; i++) {
+    pData->offset[i] = pos;
+    pos += (pData->size[i] + RVS_MATRIXCACHE_ALIGN - 1)
+           / RVS_MATRIXCACHE_ALIGN * RVS_MATRIXCACHE_ALIGN;
+  }
+  pData->length = pData->offset[2] + pData->size[2];
+  return true;
+}
+
+/**
+ * @brief Fill matrices with random data
+ *
+ * @param Type GEMM type
+ * @param Seed data seed
+ * @param pData matrices to fill
+ *
+ * */
+void rvs::matrixcache::generate(const std::string& Type, uint64_t Seed,
+                                hostmatrix* pData) {
+  for (int i = 0; i < 3; i++) {
+    void* p = pData->base + pData->offset[i];
+    if (Type == "sgemm") {
+      rvs::matrixgen::fill(static_cast<float*>(p),
+                           pData->size[i] / sizeof(float), Seed, i);
+    } else if (Type == "dgemm") {
+      rvs::matrixgen::fill(static_cast<double*>(p),
+                           pData->size[i] / sizeof(double), Seed, i);
+    } else if (Type == "bf16") {
+      rvs::matrixgen::fill_bf16(static_cast<uint16_t*>(p),
+                                pData->size[i] / sizeof(uint16_t), Seed, i);
+    } else if (Type == "hgemm" || Type == "f16_f32acc") {
+      rvs::matrixgen::fill(static_cast<uint16_t*>(p),
+                           pData->size[i] / sizeof(uint16_t), Seed, i);
+    } else if (Type == "int8" && i < 2) {
+      rvs::matrixgen::fill(static_cast<int8_t*>(p),
+                           pData->size[i] / sizeof(int8_t), Seed, i);
+    } else if (Type == "int8") {
+      rvs::matrixgen::fill(static_cast<int32_t*>(p),
+                           pData->size[i] / sizeof(int32_t), Seed, i);
+    }
+  }
+}
+
+/**
+ * @brief Allocate matrix block in heap memory
+ *
+ * @param pData matrices
+ * @return true if successful, false otherwise
+ *
+ * */
+bool rvs::matrixcache::allocate_heap(hostmatrix* pData) {
+  void* p = nullptr;
+  if (posix_memalign(&p, RVS_MATRIXCACHE_ALIGN, pData->length)) {
+    return false;
+  }
+  pData->base = static_cast<char*>(p);
+  pData->mapped = false;
+  return true;
+}
+
+/**
+ * @brief Map matrices from cache file, creating the file if needed
+ *
+ * Existing file of the expected size is mapped read-only. Otherwise data
+ * is generated into a temporary file which is then renamed, so other
+ * processes never see a partially written file. Blocks of the file are
+ * reserved before it is mapped, so a full disk fails here (and the caller
+ * falls back to heap memory) instead of raising SIGBUS while generating.
+ *
+ * @param Type GEMM type
+ * @param Seed data seed
+ * @param Filename cache file
+ * @param pData matrices
+ * @param pGenerated [out] 'true' if data had to be generated
+ * @return true if matrices are mapped, false otherwise
+ *
+ * */
+bool rvs::matrixcache::map_file(const std::string& Type, uint64_t Seed,
+                                const std::string& Filename,
+                                hostmatrix* pData, bool* pGenerated) {
+  struct stat st;
+  void* p;
+
+  int fd = open(Filename.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    if (fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) == pData->length) {
+      p = mmap(nullptr, pData->length, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (p != MAP_FAILED) {
+        pData->base = static_cast<char*>(p);
+        pData->mapped = true;
+        *pGenerated = false;
+        return true;
+      }
+    } else {
+      close(fd);
+    }
+  }
+
+  std::string tmpname = Filename + "." + std::to_string(getpid()) + ".tmp";
+  fd = open(tmpname.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  if (posix_fallocate(fd, 0, pData->length)) {
+    close(fd);
+    unlink(tmpname.c_str());
+    return false;
+  }
+  p = mmap(nullptr, pData->length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    unlink(tmpname.c_str());
+    return false;
+  }
+
+  pData->base = static_cast<char*>(p);
+  pData->mapped = true;
+  generate(Type, Seed, pData);
+
+  // mapping stays valid even if file could not be published
+  if (msync(p, pData->length, MS_SYNC) ||
+      rename(tmpname.c_str(), Filename.c_str())) {
+    unlink(tmpname.c_str());
+  }
+  mprotect(p, pData->length, PROT_READ);
+
+  *pGenerated = true;
+  return true;
+}
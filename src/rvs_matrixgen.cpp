@@ -0,0 +1,271 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_matrixgen.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//! float value of random 64 bit number, in [0, RANGE / DIV)
+inline float to_float(uint64_t R) {
+  // multiply-shift instead of modulo keeps the loop free of divisions
+  return static_cast<float>(((R >> 32) * RVS_MATRIXGEN_RANGE) >> 32)
+         * static_cast<float>(1.0 / RVS_MATRIXGEN_DIV);
+}
+
+void fill_range(float* pData, size_t First, size_t Last, uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = to_float(rvs::matrixgen::value(Key, i));
+  }
+}
+
+void fill_range(double* pData, size_t First, size_t Last, uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = to_float(rvs::matrixgen::value(Key, i));
+  }
+}
+
+//! small value of random 64 bit number, in [-1, 1) with 8 significant bits
+inline float to_small_float(uint64_t R) {
+  return static_cast<float>(static_cast<int8_t>(R >> 56)) * (1.0f / 128);
+}
+
+//! float bit pattern
+inline uint32_t float_bits(float F) {
+  uint32_t bits;
+  memcpy(&bits, &F, sizeof(bits));
+  return bits;
+}
+
+//! half of a value with at most 11 significant bits and exponent >= -14
+inline uint16_t to_half(float F) {
+  uint32_t bits = float_bits(F);
+  if ((bits & 0x7FFFFFFFu) == 0) {
+    return static_cast<uint16_t>(bits >> 16);
+  }
+  return static_cast<uint16_t>(((bits >> 16) & 0x8000u) |
+                               ((((bits >> 23) & 0xFFu) - 112) << 10) |
+                               ((bits >> 13) & 0x3FFu));
+}
+
+//! bfloat16 of a value with at most 8 significant bits
+inline uint16_t to_bf16(float F) {
+  return static_cast<uint16_t>(float_bits(F) >> 16);
+}
+
+void fill_range(uint16_t* pData, size_t First, size_t Last, uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = to_half(to_small_float(rvs::matrixgen::value(Key, i)));
+  }
+}
+
+void fill_range_bf16(uint16_t* pData, size_t First, size_t Last,
+                     uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = to_bf16(to_small_float(rvs::matrixgen::value(Key, i)));
+  }
+}
+
+void fill_range(int8_t* pData, size_t First, size_t Last, uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = static_cast<int8_t>(rvs::matrixgen::value(Key, i) >> 56);
+  }
+}
+
+void fill_range(int32_t* pData, size_t First, size_t Last, uint64_t Key) {
+  for (size_t i = First; i < Last; i++) {
+    pData[i] = static_cast<int8_t>(rvs::matrixgen::value(Key, i) >> 56);
+  }
+}
+
+/**
+ * @brief Split matrix into contiguous ranges and fill them in parallel
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Key generator key (see matrixgen::key())
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ * @param Range function filling one range of elements
+ *
+ * */
+template <typename T>
+void fill_parallel(T* pData, size_t Count, uint64_t Key, unsigned Threads,
+                   void (*Range)(T*, size_t, size_t, uint64_t) = fill_range) {
+  unsigned nthreads = rvs::matrixgen::get_threads(Count, Threads);
+  if (nthreads <= 1) {
+    Range(pData, 0, Count, Key);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  size_t chunk = (Count + nthreads - 1) / nthreads;
+  for (unsigned t = 1; t < nthreads; t++) {
+    size_t first = std::min(Count, t * chunk);
+    size_t last = std::min(Count, first + chunk);
+    workers.emplace_back([=]() { Range(pData, first, last, Key); });
+  }
+  // calling thread does the first range
+  Range(pData, 0, std::min(Count, chunk), Key);
+
+  for (auto it = workers.begin(); it != workers.end(); ++it) {
+    it->join();
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Get number of threads used to generate matrix
+ *
+ * @param Count number of elements
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ * @return number of threads, each generating at least
+ * RVS_MATRIXGEN_MIN_CHUNK elements
+ *
+ * */
+unsigned rvs::matrixgen::get_threads(size_t Count, unsigned Threads) {
+  if (Threads == 0) {
+    Threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  size_t max_threads = std::max<size_t>(Count / RVS_MATRIXGEN_MIN_CHUNK, 1);
+  return static_cast<unsigned>(std::min<size_t>(Threads, max_threads));
+}
+
+/**
+ * @brief Get generator key of one matrix
+ *
+ * @param Seed run seed
+ * @param Stream matrix index, different matrices generated from the same
+ * seed get independent data
+ * @return generator key
+ *
+ * */
+uint64_t rvs::matrixgen::key(uint64_t Seed, uint64_t Stream) {
+  return value(Seed, Stream);
+}
+
+/**
+ * @brief Fill float matrix
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill(float* pData, size_t Count, uint64_t Seed,
+                          uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads);
+}
+
+/**
+ * @brief Fill double matrix
+ *
+ * Values are the same as for float matrix with the same seed and stream.
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill(double* pData, size_t Count, uint64_t Seed,
+                          uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads);
+}
+
+/**
+ * @brief Fill half matrix
+ *
+ * Values are in [-1, 1) with at most 8 significant bits, so they are finite
+ * and exact in half precision, and sums over k stay far from overflow.
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill(uint16_t* pData, size_t Count, uint64_t Seed,
+                          uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads);
+}
+
+/**
+ * @brief Fill bfloat16 matrix
+ *
+ * Values are the same as for half matrix with the same seed and stream.
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill_bf16(uint16_t* pData, size_t Count, uint64_t Seed,
+                               uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads, fill_range_bf16);
+}
+
+/**
+ * @brief Fill 8 bit integer matrix with random bytes
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill(int8_t* pData, size_t Count, uint64_t Seed,
+                          uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads);
+}
+
+/**
+ * @brief Fill 32 bit integer matrix
+ *
+ * Values are the same as for 8 bit integer matrix with the same seed and
+ * stream.
+ *
+ * @param pData matrix
+ * @param Count number of elements
+ * @param Seed run seed
+ * @param Stream matrix index
+ * @param Threads requested number of threads (0 - hardware concurrency)
+ *
+ * */
+void rvs::matrixgen::fill(int32_t* pData, size_t Count, uint64_t Seed,
+                          uint64_t Stream, unsigned Threads) {
+  fill_parallel(pData, Count, key(Seed, Stream), Threads);
+}
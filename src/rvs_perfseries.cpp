@@ -0,0 +1,162 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_perfseries.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+//! nearest rank percentile of sorted values
+double percentile(const std::vector<double>& Sorted, double P) {
+  if (Sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(std::ceil(P / 100 * Sorted.size()));
+  return Sorted[rank ? rank - 1 : 0];
+}
+
+}  // namespace
+
+/**
+ * @brief Constructor
+ *
+ * @param Capacity max number of samples kept (at least 2)
+ *
+ * */
+rvs::perfseries::perfseries(size_t Capacity) {
+  capacity = std::max<size_t>(Capacity, 2);
+}
+
+/**
+ * @brief Add throughput of one interval
+ *
+ * @param EndMs interval end (ms since series start)
+ * @param DurationMs interval duration (ms)
+ * @param Value throughput over the interval
+ *
+ * */
+void rvs::perfseries::add(uint64_t EndMs, uint64_t DurationMs,
+                          double Value) {
+  if (samples.size() >= capacity) {
+    compact();
+  }
+  samples.push_back(sample_t{EndMs, DurationMs, Value});
+}
+
+//! Remove all samples
+void rvs::perfseries::clear() {
+  samples.clear();
+}
+
+/**
+ * @brief Halve number of samples by merging adjacent pairs
+ *
+ * */
+void rvs::perfseries::compact() {
+  size_t out = 0;
+  for (size_t i = 0; i < samples.size(); i += 2, out++) {
+    if (i + 1 == samples.size()) {
+      samples[out] = samples[i];
+      break;
+    }
+    const sample_t& a = samples[i];
+    const sample_t& b = samples[i + 1];
+    uint64_t duration = a.duration_ms + b.duration_ms;
+    double value = duration ?
+      (a.value * a.duration_ms + b.value * b.duration_ms) / duration :
+      (a.value + b.value) / 2;
+    samples[out] = sample_t{b.end_ms, duration, value};
+  }
+  samples.resize((samples.size() + 1) / 2);
+}
+
+/**
+ * @brief Compute summary of the series
+ *
+ * @param ThrottleThreshold relative drop below baseline considered
+ * throttling (e.g. 0.1 - 10%)
+ * @return series summary (all zeros and throttle_ms -1 if series is empty)
+ *
+ * */
+rvs::perfseries::stats_t rvs::perfseries::get_stats(
+                                            double ThrottleThreshold) const {
+  stats_t st = {0, 0, 0, 0, 0, 0, 0, 0, -1};
+  if (samples.empty()) {
+    return st;
+  }
+
+  std::vector<double> sorted;
+  double weighted = 0;
+  double total_ms = 0;
+  for (auto it = samples.begin(); it != samples.end(); ++it) {
+    sorted.push_back(it->value);
+    weighted += it->value * it->duration_ms;
+    total_ms += it->duration_ms;
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  st.count = samples.size();
+  st.min = sorted.front();
+  st.max = sorted.back();
+  st.p5 = percentile(sorted, 5);
+  st.p50 = percentile(sorted, 50);
+  st.p95 = percentile(sorted, 95);
+
+  double plain_mean = 0;
+  for (auto it = sorted.begin(); it != sorted.end(); ++it) {
+    plain_mean += *it;
+  }
+  plain_mean /= sorted.size();
+  st.mean = total_ms > 0 ? weighted / total_ms : plain_mean;
+
+  double var = 0;
+  for (auto it = sorted.begin(); it != sorted.end(); ++it) {
+    var += (*it - plain_mean) * (*it - plain_mean);
+  }
+  var /= sorted.size();
+  st.cv = plain_mean != 0 ? std::sqrt(var) / plain_mean : 0;
+
+  // baseline is the median of the leading samples
+  std::vector<double> head;
+  for (size_t i = 0; i < samples.size() && i < RVS_PERFSERIES_BASELINE; i++) {
+    head.push_back(samples[i].value);
+  }
+  std::sort(head.begin(), head.end());
+  double limit = percentile(head, 50) * (1 - ThrottleThreshold);
+
+  size_t run = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    run = samples[i].value < limit ? run + 1 : 0;
+    if (run == RVS_PERFSERIES_THROTTLE_RUN) {
+      const sample_t& first = samples[i + 1 - run];
+      st.throttle_ms = static_cast<int64_t>(first.end_ms - first.duration_ms);
+      break;
+    }
+  }
+
+  return st;
+}
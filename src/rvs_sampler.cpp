@@ -0,0 +1,132 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_sampler.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Two sided 95% quantile of Student's t distribution
+ *
+ * @param Df degrees of freedom
+ * @return quantile value
+ *
+ * */
+double t_quantile_95(uint64_t Df) {
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  const uint64_t table_size = sizeof(table) / sizeof(table[0]);
+
+  if (Df == 0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  if (Df <= table_size) {
+    return table[Df - 1];
+  }
+  return Df < 120 ? 2.0 : 1.96;
+}
+
+}  // namespace
+
+//! Default constructor.
+rvs::sampler::sampler() {
+  clear();
+}
+
+/**
+ * @brief Forget all samples
+ *
+ * */
+void rvs::sampler::clear() {
+  samples = 0;
+  avg = 0;
+  m2 = 0;
+}
+
+/**
+ * @brief Add sample
+ *
+ * @param Value sample value
+ *
+ * */
+void rvs::sampler::add(double Value) {
+  samples++;
+  double delta = Value - avg;
+  avg += delta / samples;
+  m2 += delta * (Value - avg);
+}
+
+/**
+ * @brief Sample standard deviation
+ *
+ * @return standard deviation (0 if less than two samples)
+ *
+ * */
+double rvs::sampler::stddev() const {
+  return samples > 1 ? std::sqrt(m2 / (samples - 1)) : 0;
+}
+
+/**
+ * @brief Half width of 95% confidence interval of the mean
+ *
+ * @return half width (infinity if less than two samples)
+ *
+ * */
+double rvs::sampler::ci_halfwidth() const {
+  if (samples < 2) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return t_quantile_95(samples - 1) * stddev() / std::sqrt(samples);
+}
+
+/**
+ * @brief Half width of 95% confidence interval relative to the mean
+ *
+ * @return relative half width (infinity if not known)
+ *
+ * */
+double rvs::sampler::ci_relative() const {
+  if (samples < 2 || avg == 0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return ci_halfwidth() / std::fabs(avg);
+}
+
+/**
+ * @brief Check if mean is known precisely enough
+ *
+ * @param Tolerance max relative half width of 95% confidence interval
+ * @return 'true' if at least RVS_SAMPLER_MIN_SAMPLES samples are collected
+ * and confidence interval is within tolerance
+ *
+ * */
+bool rvs::sampler::converged(double Tolerance) const {
+  return samples >= RVS_SAMPLER_MIN_SAMPLES && ci_relative() <= Tolerance;
+}
@@ -0,0 +1,97 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_seqcounter.h"
+
+#include <thread>
+
+//! Default constructor
+rvs::seqcounter::seqcounter() : seq(0), size(0), duration(0) {
+}
+
+/**
+ * @brief Add one measurement (writer only)
+ *
+ * @param Size size of transferred data (bytes)
+ * @param Duration duration of transfer (sec)
+ *
+ * */
+void rvs::seqcounter::add(uint64_t Size, double Duration) {
+  // single writer, so plain loads of own values are safe
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size.store(size.load(std::memory_order_relaxed) + Size,
+             std::memory_order_relaxed);
+  duration.store(duration.load(std::memory_order_relaxed) + Duration,
+                 std::memory_order_relaxed);
+
+  seq.store(s + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Set counters to zero (writer only, or while there is no writer)
+ *
+ * */
+void rvs::seqcounter::clear() {
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size.store(0, std::memory_order_relaxed);
+  duration.store(0, std::memory_order_relaxed);
+
+  seq.store(s + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Take consistent snapshot of both counters (any thread)
+ *
+ * @param pSize [out] cumulative size (bytes)
+ * @param pDuration [out] cumulative duration (sec)
+ *
+ * */
+void rvs::seqcounter::snapshot(uint64_t* pSize, double* pDuration) const {
+  uint32_t s0;
+  uint32_t s1;
+
+  for (;;) {
+    s0 = seq.load(std::memory_order_acquire);
+    if (s0 & 1) {
+      // update in progress
+      std::this_thread::yield();
+      continue;
+    }
+
+    *pSize = size.load(std::memory_order_relaxed);
+    *pDuration = duration.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    s1 = seq.load(std::memory_order_relaxed);
+    if (s0 == s1) {
+      return;
+    }
+  }
+}
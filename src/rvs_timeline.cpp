@@ -0,0 +1,167 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_timeline.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <limits>
+
+//! Default constructor.
+rvs::timeline::timeline() {
+  count = 0;
+  lost = 0;
+  transfers = 0;
+}
+
+/**
+ * @brief Allocate event buffer and clear previously recorded events
+ *
+ * @param Capacity max number of events kept
+ *
+ * */
+void rvs::timeline::reserve(size_t Capacity) {
+  events.assign(Capacity, event_t());
+  clear();
+}
+
+/**
+ * @brief Forget recorded events, keep the buffer
+ *
+ * */
+void rvs::timeline::clear() {
+  count = 0;
+  lost = 0;
+  transfers = 0;
+}
+
+/**
+ * @brief Record copy event
+ *
+ * @param Event event to store
+ *
+ * */
+void rvs::timeline::record(const event_t& Event) {
+  if (count < events.size()) {
+    events[count++] = Event;
+  } else {
+    lost++;
+  }
+}
+
+/**
+ * @brief Escape string for use inside JSON string literal
+ *
+ * @param Str string to escape
+ * @return escaped string, without enclosing quotes
+ *
+ * */
+std::string rvs::timeline::json_escape(const std::string& Str) {
+  std::string out;
+  out.reserve(Str.size());
+  for (size_t i = 0; i < Str.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(Str[i]);
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += Str[i];
+    } else if (c < 0x20) {
+      char buff[8];
+      snprintf(buff, sizeof(buff), "\\u%04x", c);
+      out += buff;
+    } else {
+      out += Str[i];
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Write timelines as Chrome trace event JSON
+ *
+ * Each timeline is shown as a process and each direction and stripe of a
+ * transfer as a thread of that process. Timestamps are relative to the
+ * earliest recorded copy.
+ *
+ * @param Filename output file
+ * @param Timelines timelines to export
+ * @param Names display name of each timeline
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::timeline::write_chrome_trace(const std::string& Filename,
+                                 const std::vector<const timeline*>& Timelines,
+                                 const std::vector<std::string>& Names) {
+  uint64_t origin = std::numeric_limits<uint64_t>::max();
+  for (size_t t = 0; t < Timelines.size(); t++) {
+    for (size_t i = 0; i < Timelines[t]->size(); i++) {
+      origin = std::min(origin, Timelines[t]->at(i).start);
+    }
+  }
+
+  FILE* f = fopen(Filename.c_str(), "w");
+  if (f == nullptr) {
+    return -1;
+  }
+
+  const char* sep = "";
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (size_t t = 0; t < Timelines.size(); t++) {
+    const timeline* pt = Timelines[t];
+    std::string name = json_escape(t < Names.size() ? Names[t]
+                                                    : std::to_string(t));
+
+    fprintf(f, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%zu,"
+            "\"args\":{\"name\":\"%s\"}}", sep, t, name.c_str());
+    sep = ",";
+
+    // one thread per direction and stripe, named after first seen copy
+    std::vector<bool> named;
+    for (size_t i = 0; i < pt->size(); i++) {
+      const event_t& e = pt->at(i);
+      size_t tid = 2 * static_cast<size_t>(e.stripe) + e.reverse;
+      if (tid >= named.size()) {
+        named.resize(tid + 1, false);
+      }
+      if (!named[tid]) {
+        named[tid] = true;
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%zu,"
+                "\"tid\":%zu,\"args\":{\"name\":\"%s %u->%u stripe %u\"}}",
+                t, tid, e.reverse ? "rev" : "fwd", e.src, e.dst, e.stripe);
+      }
+      uint64_t end = std::max(e.end, e.start);
+      fprintf(f, ",\n{\"name\":\"%u->%u\",\"cat\":\"copy\",\"ph\":\"X\","
+              "\"pid\":%zu,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"transfer\":%u,\"size\":%llu,\"GBps\":%.3f}}",
+              e.src, e.dst, t, tid, (e.start - origin) / 1000.0,
+              (end - e.start) / 1000.0, e.transfer,
+              static_cast<unsigned long long>(e.size),
+              end > e.start ? static_cast<double>(e.size) / (end - e.start)
+                            : 0.0);
+    }
+  }
+  fprintf(f, "\n]}\n");
+
+  return fclose(f) ? -1 : 0;
+}
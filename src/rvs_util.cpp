@@ -24,6 +24,8 @@
  *******************************************************************************/
 #include "include/rvs_util.h"
 
+#include <algorithm>
+#include <cctype>
 #include <vector>
 #include <string>
 #include <regex>
@@ -80,3 +82,141 @@ int rvs_util_parse(const std::string& buff, bool* pval) {
 
   return 1;  // syntax error
 }
+
+/**
+ * @brief parses size given in bytes with optional binary suffix
+ *
+ * Suffixes K, M, G and T (case insensitive) multiply value by 1024,
+ * 1024^2, 1024^3 and 1024^4 respectively, e.g. "512M" or "6G".
+ *
+ * @param buff input string
+ * @param pval [out] size in bytes
+ * @return 0 - OK, 1 - syntax error or overflow, 2 - empty string
+ */
+int rvs_util_parse_size(const std::string& buff, uint64_t* pval) {
+  if (buff.empty()) {
+    return 2;
+  }
+
+  std::string digits = buff;
+  uint32_t shift = 0;
+  switch (std::toupper(buff[buff.size() - 1])) {
+    case 'K': shift = 10; break;
+    case 'M': shift = 20; break;
+    case 'G': shift = 30; break;
+    case 'T': shift = 40; break;
+    default: break;
+  }
+  if (shift) {
+    digits.erase(digits.size() - 1);
+  }
+
+  if (!is_positive_integer(digits)) {
+    return 1;
+  }
+
+  uint64_t val;
+  try {
+    val = std::stoull(digits);
+  } catch(...) {
+    return 1;
+  }
+  if (shift && val > (UINT64_MAX >> shift)) {
+    return 1;
+  }
+
+  *pval = val << shift;
+  return 0;
+}
+
+/**
+ * @brief expands list of sizes and size sweeps into sorted list of sizes
+ *
+ * Input is a space separated list of items, each of which is either
+ * a single size or a sweep in one of the forms:
+ *
+ *     start:stop:step     linear, start, start + step, ... up to stop
+ *     start:stop:*factor  geometric, start, start * factor, ... up to stop
+ *
+ * All sizes accept suffixes understood by rvs_util_parse_size(), factor
+ * may be fractional (e.g. *1.5) and values are rounded down to whole
+ * bytes. Duplicates are removed.
+ *
+ * @param buff input string
+ * @param pval [out] list of sizes in ascending order
+ * @return 0 - OK, 1 - syntax error or too many sizes, 2 - empty string
+ */
+int rvs_util_parse_sweep(const std::string& buff,
+                         std::vector<uint64_t>* pval) {
+  std::vector<uint64_t> sizes;
+  std::vector<std::string> items = str_split(buff, " ");
+
+  if (items.empty()) {
+    return 2;
+  }
+
+  for (auto it = items.begin(); it != items.end(); ++it) {
+    std::vector<std::string> parts = str_split(*it, ":");
+    uint64_t start;
+    uint64_t stop;
+
+    if (parts.size() == 1 && it->find(':') == std::string::npos) {
+      if (rvs_util_parse_size(parts[0], &start) || start == 0) {
+        return 1;
+      }
+      sizes.push_back(start);
+      continue;
+    }
+
+    if (parts.size() != 3 ||
+        rvs_util_parse_size(parts[0], &start) || start == 0 ||
+        rvs_util_parse_size(parts[1], &stop) || stop < start) {
+      return 1;
+    }
+
+    if (parts[2][0] == '*') {
+      double factor;
+      try {
+        size_t pos;
+        factor = std::stod(parts[2].substr(1), &pos);
+        if (pos != parts[2].size() - 1) {
+          return 1;
+        }
+      } catch(...) {
+        return 1;
+      }
+      if (!(factor > 1.0)) {
+        return 1;
+      }
+      for (double val = start; val <= stop; val *= factor) {
+        if (sizes.size() >= RVS_SWEEP_MAX_SIZES) {
+          return 1;
+        }
+        sizes.push_back(static_cast<uint64_t>(val));
+      }
+    } else {
+      uint64_t step;
+      if (rvs_util_parse_size(parts[2], &step) || step == 0) {
+        return 1;
+      }
+      if ((stop - start) / step >= RVS_SWEEP_MAX_SIZES) {
+        return 1;
+      }
+      for (uint64_t val = start; val <= stop; val += step) {
+        sizes.push_back(val);
+        if (stop - val < step) {
+          break;
+        }
+      }
+    }
+
+    if (sizes.size() > RVS_SWEEP_MAX_SIZES) {
+      return 1;
+    }
+  }
+
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  *pval = sizes;
+  return 0;
+}
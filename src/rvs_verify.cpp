@@ -0,0 +1,431 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without result_idtriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvs_verify.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RVS_VERIFY_X86
+#endif
+
+namespace {
+
+//! SIMD instruction set used for fill and compare
+enum simd_level_t {
+  simd_scalar = 0,
+  simd_avx2,
+  simd_avx512
+};
+
+/**
+ * @brief Pattern value of 32-bit word at index Ix
+ *
+ * Counter based so that any part of the buffer can be generated
+ * independently of the rest.
+ *
+ * */
+inline uint32_t pattern_word(uint32_t Lo, uint32_t Hi, uint32_t Ix) {
+  uint32_t x = Lo + Ix;
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x ^ Hi;
+}
+
+void fill_scalar(uint32_t* p, size_t n, size_t i, uint32_t lo, uint32_t hi) {
+  for (; i < n; i++) {
+    p[i] = pattern_word(lo, hi, static_cast<uint32_t>(i));
+  }
+}
+
+uint64_t compare_scalar(const uint32_t* p, size_t n, size_t i,
+                        uint32_t lo, uint32_t hi, size_t* pFirst) {
+  uint64_t errors = 0;
+  for (; i < n; i++) {
+    if (p[i] != pattern_word(lo, hi, static_cast<uint32_t>(i))) {
+      if (errors++ == 0) {
+        *pFirst = i;
+      }
+    }
+  }
+  return errors;
+}
+
+#ifdef RVS_VERIFY_X86
+
+__attribute__((target("avx2")))
+inline __m256i pattern_avx2(__m256i x, __m256i vhi) {
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x846ca68b));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  return _mm256_xor_si256(x, vhi);
+}
+
+__attribute__((target("avx2")))
+size_t fill_avx2(uint32_t* p, size_t n, uint32_t lo, uint32_t hi) {
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i vhi = _mm256_set1_epi32(hi);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_add_epi32(
+      _mm256_set1_epi32(lo + static_cast<uint32_t>(i)), step);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i),
+                        pattern_avx2(x, vhi));
+  }
+  return i;
+}
+
+__attribute__((target("avx2")))
+size_t compare_avx2(const uint32_t* p, size_t n, uint32_t lo, uint32_t hi,
+                    uint64_t* pErrors, size_t* pFirst) {
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i vhi = _mm256_set1_epi32(hi);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_add_epi32(
+      _mm256_set1_epi32(lo + static_cast<uint32_t>(i)), step);
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    __m256i eq = _mm256_cmpeq_epi32(d, pattern_avx2(x, vhi));
+    unsigned mism = ~_mm256_movemask_ps(_mm256_castsi256_ps(eq)) & 0xffu;
+    if (mism) {
+      if (*pErrors == 0) {
+        *pFirst = i + __builtin_ctz(mism);
+      }
+      *pErrors += __builtin_popcount(mism);
+    }
+  }
+  return i;
+}
+
+// masked shifts used as plain ones trigger spurious uninitialized value
+// warnings in some GCC versions
+__attribute__((target("avx512f")))
+inline __m512i pattern_avx512(__m512i x, __m512i vhi) {
+  x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xffff, x, 16));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x7feb352d));
+  x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xffff, x, 15));
+  x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x846ca68b));
+  x = _mm512_xor_si512(x, _mm512_maskz_srli_epi32(0xffff, x, 16));
+  return _mm512_xor_si512(x, vhi);
+}
+
+__attribute__((target("avx512f")))
+size_t fill_avx512(uint32_t* p, size_t n, uint32_t lo, uint32_t hi) {
+  const __m512i step = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15);
+  const __m512i vhi = _mm512_set1_epi32(hi);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_add_epi32(
+      _mm512_set1_epi32(lo + static_cast<uint32_t>(i)), step);
+    _mm512_storeu_si512(p + i, pattern_avx512(x, vhi));
+  }
+  return i;
+}
+
+__attribute__((target("avx512f")))
+size_t compare_avx512(const uint32_t* p, size_t n, uint32_t lo, uint32_t hi,
+                      uint64_t* pErrors, size_t* pFirst) {
+  const __m512i step = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                         8, 9, 10, 11, 12, 13, 14, 15);
+  const __m512i vhi = _mm512_set1_epi32(hi);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_add_epi32(
+      _mm512_set1_epi32(lo + static_cast<uint32_t>(i)), step);
+    __m512i d = _mm512_loadu_si512(p + i);
+    unsigned mism = _mm512_cmpneq_epi32_mask(d, pattern_avx512(x, vhi));
+    if (mism) {
+      if (*pErrors == 0) {
+        *pFirst = i + __builtin_ctz(mism);
+      }
+      *pErrors += __builtin_popcount(mism);
+    }
+  }
+  return i;
+}
+
+#endif  // RVS_VERIFY_X86
+
+//! detects best instruction set supported by this CPU
+simd_level_t detect_simd() {
+#ifdef RVS_VERIFY_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return simd_avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return simd_avx2;
+  }
+#endif
+  return simd_scalar;
+}
+
+simd_level_t simd_level() {
+  static const simd_level_t level = detect_simd();
+  return level;
+}
+
+}  // namespace
+
+//! Default constructor.
+rvs::verifier::verifier() {
+  brun = false;
+  busy = 0;
+  blocks = 0;
+  errors = 0;
+  first_seed = 0;
+  first_offset = 0;
+}
+
+//! Default destructor.
+rvs::verifier::~verifier() {
+  stop();
+}
+
+/**
+ * @brief Fill buffer with pattern derived from seed
+ *
+ * @param pBuff buffer to fill
+ * @param Size size of the buffer in bytes
+ * @param Seed pattern seed
+ *
+ * */
+void rvs::verifier::fill(void* pBuff, size_t Size, uint64_t Seed) {
+  uint32_t* p = static_cast<uint32_t*>(pBuff);
+  uint32_t lo = static_cast<uint32_t>(Seed);
+  uint32_t hi = static_cast<uint32_t>(Seed >> 32);
+  size_t n = Size / sizeof(uint32_t);
+  size_t i = 0;
+
+#ifdef RVS_VERIFY_X86
+  if (simd_level() == simd_avx512) {
+    i = fill_avx512(p, n, lo, hi);
+  } else if (simd_level() == simd_avx2) {
+    i = fill_avx2(p, n, lo, hi);
+  }
+#endif
+  fill_scalar(p, n, i, lo, hi);
+
+  // trailing bytes take the low bytes of the next pattern word
+  if (Size % sizeof(uint32_t)) {
+    uint32_t tail = pattern_word(lo, hi, static_cast<uint32_t>(n));
+    memcpy(p + n, &tail, Size % sizeof(uint32_t));
+  }
+}
+
+/**
+ * @brief Compare buffer against pattern derived from seed
+ *
+ * @param pBuff buffer to check
+ * @param Size size of the buffer in bytes
+ * @param Seed pattern seed the source buffer was filled with
+ * @param pFirst [out] byte offset of the first mismatched word (Size if none)
+ * @return number of mismatched 32-bit words
+ *
+ * */
+uint64_t rvs::verifier::compare(const void* pBuff, size_t Size, uint64_t Seed,
+                                size_t* pFirst) {
+  const uint32_t* p = static_cast<const uint32_t*>(pBuff);
+  uint32_t lo = static_cast<uint32_t>(Seed);
+  uint32_t hi = static_cast<uint32_t>(Seed >> 32);
+  size_t n = Size / sizeof(uint32_t);
+  size_t first = n;
+  uint64_t errors = 0;
+  size_t i = 0;
+
+#ifdef RVS_VERIFY_X86
+  if (simd_level() == simd_avx512) {
+    i = compare_avx512(p, n, lo, hi, &errors, &first);
+  } else if (simd_level() == simd_avx2) {
+    i = compare_avx2(p, n, lo, hi, &errors, &first);
+  }
+#endif
+  size_t first_scalar = n;
+  uint64_t errors_scalar = compare_scalar(p, n, i, lo, hi, &first_scalar);
+  if (errors == 0) {
+    first = first_scalar;
+  }
+  errors += errors_scalar;
+
+  if (Size % sizeof(uint32_t)) {
+    uint32_t tail = pattern_word(lo, hi, static_cast<uint32_t>(n));
+    if (memcmp(p + n, &tail, Size % sizeof(uint32_t))) {
+      if (errors++ == 0) {
+        first = n;
+      }
+    }
+  }
+
+  *pFirst = errors ? first * sizeof(uint32_t) : Size;
+  return errors;
+}
+
+/**
+ * @brief Name of the instruction set used for fill() and compare()
+ *
+ * @return "avx512", "avx2" or "scalar"
+ *
+ * */
+const char* rvs::verifier::simd_name() {
+  switch (simd_level()) {
+  case simd_avx512:
+    return "avx512";
+  case simd_avx2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+/**
+ * @brief Starts checking thread
+ *
+ * */
+void rvs::verifier::start() {
+  brun = true;
+  ThreadBase::start();
+}
+
+/**
+ * @brief Checks all pending blocks and stops checking thread
+ *
+ * */
+void rvs::verifier::stop() {
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    brun = false;
+  }
+  cv_work.notify_all();
+  if (t.joinable()) {
+    t.join();
+  }
+}
+
+/**
+ * @brief Queue block for checking
+ *
+ * Blocks while RVS_VERIFY_QUEUE_DEPTH blocks are already waiting. If checking
+ * thread is not running, block is checked synchronously.
+ *
+ * @param Block host buffer to check
+ *
+ * */
+void rvs::verifier::submit(const block_t& Block) {
+  std::unique_lock<std::mutex> lk(mtx);
+
+  if (!brun) {
+    lk.unlock();
+    size_t first;
+    uint64_t err = compare(Block.data, Block.size, Block.seed, &first);
+    if (Block.release) {
+      Block.release(Block.data);
+    }
+    lk.lock();
+    if (err && errors == 0) {
+      first_seed = Block.seed;
+      first_offset = first;
+    }
+    errors += err;
+    blocks++;
+    return;
+  }
+
+  cv_done.wait(lk, [this] { return queue.size() < RVS_VERIFY_QUEUE_DEPTH; });
+  queue.push_back(Block);
+  lk.unlock();
+  cv_work.notify_one();
+}
+
+/**
+ * @brief Wait until all queued blocks have been checked
+ *
+ * */
+void rvs::verifier::flush() {
+  std::unique_lock<std::mutex> lk(mtx);
+  cv_done.wait(lk, [this] { return queue.empty() && busy == 0; });
+}
+
+/**
+ * @brief Get verification results so far
+ *
+ * @param pBlocks [out] number of checked blocks
+ * @param pErrors [out] number of mismatched 32-bit words
+ * @param pFirstSeed [out] seed of the first block with mismatch
+ * @param pFirstOffset [out] byte offset of the first mismatch in that block
+ *
+ * */
+void rvs::verifier::get_results(uint64_t* pBlocks, uint64_t* pErrors,
+                                uint64_t* pFirstSeed, size_t* pFirstOffset) {
+  std::lock_guard<std::mutex> lk(mtx);
+  *pBlocks = blocks;
+  *pErrors = errors;
+  *pFirstSeed = first_seed;
+  *pFirstOffset = first_offset;
+}
+
+/**
+ * @brief Thread function
+ *
+ * Checks queued blocks until stop() is called and the queue is empty.
+ *
+ * */
+void rvs::verifier::run() {
+  std::unique_lock<std::mutex> lk(mtx);
+
+  for (;;) {
+    cv_work.wait(lk, [this] { return !queue.empty() || !brun; });
+    if (queue.empty()) {
+      break;
+    }
+
+    block_t block = queue.front();
+    queue.pop_front();
+    busy = 1;
+    lk.unlock();
+    cv_done.notify_all();
+
+    size_t first;
+    uint64_t err = compare(block.data, block.size, block.seed, &first);
+    if (block.release) {
+      block.release(block.data);
+    }
+
+    lk.lock();
+    if (err && errors == 0) {
+      first_seed = block.seed;
+      first_offset = first;
+    }
+    errors += err;
+    blocks++;
+    busy = 0;
+    cv_done.notify_all();
+  }
+}
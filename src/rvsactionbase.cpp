@@ -25,6 +25,7 @@
 #include "include/rvsactionbase.h"
 
 #include <unistd.h>
+#include <algorithm>
 #include <chrono>
 #include <utility>
 #include <regex>
@@ -33,6 +34,7 @@
 #include <vector>
 #include <iostream>
 
+#include "include/gpu_util.h"
 #include "include/rvsloglp.h"
 #include "include/rvs_key_def.h"
 #include "include/rvs_util.h"
@@ -129,6 +131,36 @@ int rvs::actionbase::property_get_device() {
     &property_device_all);
 }
 
+/**
+ * @brief Get GPUs selected by 'device' and 'deviceid' keys
+ *
+ * @param pGpuId [out] GPU IDs of selected GPUs, in ascending GPU ID order
+ *
+ * */
+void rvs::actionbase::get_selected_gpus(std::vector<uint16_t>* pGpuId) {
+  std::vector<uint16_t> gpu_id;
+  std::vector<uint16_t> gpu_device_id;
+
+  gpu_get_all_gpu_id(&gpu_id);
+  gpu_get_all_device_id(&gpu_device_id);
+
+  pGpuId->clear();
+  for (size_t i = 0; i < gpu_id.size(); i++) {
+    // filter out by device id
+    if (property_device_id > 0 && property_device_id != gpu_device_id[i]) {
+      continue;
+    }
+
+    // filter out by listed devices
+    if (!property_device_all &&
+        std::find(property_device.cbegin(), property_device.cend(),
+                  gpu_id[i]) == property_device.cend()) {
+      continue;
+    }
+    pGpuId->push_back(gpu_id[i]);
+  }
+}
+
 /**
  * @brief Reads boolean property value from properties collection
  */
@@ -168,3 +200,45 @@ int rvs::actionbase::property_get(const std::string& prop_name,
   }
   return 0;
 }
+
+/**
+ * @brief Reads size property value from properties collection
+ *
+ * Size is given in bytes with optional K, M, G or T suffix.
+ */
+int rvs::actionbase::property_get_size(const std::string& prop_name,
+                                       uint64_t* pVal) {
+  std::string sval;
+  if (!has_property(prop_name, &sval)) {
+    return 2;
+  }
+  return rvs_util_parse_size(sval, pVal);
+}
+
+/**
+ * @brief Reads list of sizes from properties collection
+ *
+ * List may mix single sizes and linear or geometric sweeps, see
+ * rvs_util_parse_sweep(). Value "all" sets *pAll and clears the list.
+ */
+int rvs::actionbase::property_get_size_list(const std::string& prop_name,
+                                            std::vector<uint64_t>* pVal,
+                                            bool* pAll) {
+  std::string sval;
+  if (!has_property(prop_name, &sval)) {
+    return 2;
+  }
+
+  if (sval == "all") {
+    *pAll = true;
+    pVal->clear();
+    return 0;
+  }
+  *pAll = false;
+
+  if (rvs_util_parse_sweep(sval, pVal)) {
+    pVal->clear();
+    return 1;
+  }
+  return 0;
+}
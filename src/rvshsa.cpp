@@ -26,8 +26,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <sys/mman.h>
 
+#include <chrono>
 #include <iostream>
+#include <fstream>
 #include <algorithm>
 #include <cstring>
 #include <string>
@@ -37,6 +41,9 @@
 #include "hsa/hsa_ext_amd.h"
 
 #include "include/rvs_util.h"
+#include "include/rvs_histogram.h"
+#include "include/rvs_timeline.h"
+#include "include/rvs_verify.h"
 #include "include/rvsloglp.h"
 
 extern void gpu_get_all_gpu_id(std::vector<uint16_t>* pgpus_id);
@@ -78,10 +85,14 @@ rvs::hsa* rvs::hsa::Get() {
 
 //! Default constructor
 rvs::hsa::hsa() {
+  topology_valid = false;
 }
 
 //! Default destructor
 rvs::hsa::~hsa() {
+  for (auto it = staging_free.begin(); it != staging_free.end(); ++it) {
+    FreeHost(it->ptr);
+  }
 }
 
 
@@ -334,13 +345,23 @@ void rvs::hsa::InitAgents() {
   // Initialize the list of buffer sizes to use in copy/read/write operations
   // For All Copy operations use only one buffer size
   if (size_list.size() == 0) {
-    uint32_t size_len = sizeof(DEFAULT_SIZE_LIST)/sizeof(uint32_t);
-    for (uint32_t idx = 0; idx < size_len; idx++) {
-      size_list.push_back(DEFAULT_SIZE_LIST[idx]);
-    }
+    rvs_util_parse_sweep(RVS_HSA_DEFAULT_SIZE_SWEEP, &size_list);
+  }
+
+  if (latency_size_list.size() == 0) {
+    rvs_util_parse_sweep(RVS_HSA_LATENCY_SIZE_SWEEP, &latency_size_list);
   }
 
-  std::sort(size_list.begin(), size_list.end());
+  // build NUMA node to agent index map so that FindAgent() is O(1)
+  node_index.clear();
+  for (size_t i = 0; i < agent_list.size(); i++) {
+    if (agent_list[i].node >= node_index.size()) {
+      node_index.resize(agent_list[i].node + 1, -1);
+    }
+    if (node_index[agent_list[i].node] < 0) {
+      node_index[agent_list[i].node] = i;
+    }
+  }
 
   PrintTopology();
 }
@@ -497,6 +518,7 @@ hsa_status_t rvs::hsa::ProcessMemPool(hsa_amd_memory_pool_t pool, void* data) {
     print_hsa_status(__FILE__, __LINE__, __func__,
                    "HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS", status);
   bool is_kernarg = (HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT & flag);
+  agent_info->pool_flags_list.push_back(flag);
 
   // Update the pool handle for system memory if kernarg is true
   rvs::lp::Log("[RVSHSA] ****************************************",
@@ -522,9 +544,8 @@ hsa_status_t rvs::hsa::ProcessMemPool(hsa_amd_memory_pool_t pool, void* data) {
  *
  * */
 int rvs::hsa::FindAgent(const uint32_t Node) {
-  for (size_t i = 0; i < agent_list.size(); i++) {
-    if (agent_list[i].node == Node)
-      return i;
+  if (Node < node_index.size()) {
+    return node_index[Node];
   }
   RVSHSATRACE_
   return -1;
@@ -538,33 +559,83 @@ int rvs::hsa::FindAgent(const uint32_t Node) {
  * @param bidirectional 'true' for bidirectional transfer
  * @param signal_fwd signal used for direct transfer
  * @param signal_rev signal used for reverse transfer
- * @return time in seconds
+ * @return time in nanoseconds
  *
  * */
 double rvs::hsa::GetCopyTime(bool bidirectional,
                              hsa_signal_t signal_fwd, hsa_signal_t signal_rev) {
+  std::vector<hsa_signal_t> fwd(1, signal_fwd);
+  std::vector<hsa_signal_t> rev(1, signal_rev);
+
+  return GetCopyTime(bidirectional, fwd, rev);
+}
+
+/**
+ * @brief Fetch interval spanned by a set of async copies
+ *
+ * @param signals signals of individual copies
+ * @param pInterval [out] earliest start and latest end of all copies
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::GetCopyInterval(const std::vector<hsa_signal_t>& signals,
+                     hsa_amd_profiling_async_copy_time_t* pInterval) {
   hsa_status_t status;
+  int sts = 0;
+
+  pInterval->start = std::numeric_limits<uint64_t>::max();
+  pInterval->end = 0;
+  for (size_t i = 0; i < signals.size(); i++) {
+    hsa_amd_profiling_async_copy_time_t async_time {0, 0};
+    if (HSA_STATUS_SUCCESS !=
+       (status =
+         hsa_amd_profiling_get_async_copy_time(signals[i], &async_time))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                     "hsa_amd_profiling_get_async_copy_time()",
+                     status);
+      sts = -1;
+      continue;
+    }
+    pInterval->start = std::min(pInterval->start, async_time.start);
+    pInterval->end = std::max(pInterval->end, async_time.end);
+  }
+
+  if (pInterval->end < pInterval->start) {
+    RVSHSATRACE_
+    pInterval->start = 0;
+    pInterval->end = 0;
+  }
+
+  return sts;
+}
+
+/**
+ * @brief Fetch time needed to copy data between two memory pools
+ *
+ * Transfer in each direction may consist of several concurrent copies
+ * (stripes). Time of one direction spans from the earliest start to the
+ * latest end of its copies.
+ *
+ * @param bidirectional 'true' for bidirectional transfer
+ * @param signal_fwd signals used for direct transfer
+ * @param signal_rev signals used for reverse transfer
+ * @return time in nanoseconds
+ *
+ * */
+double rvs::hsa::GetCopyTime(bool bidirectional,
+                             const std::vector<hsa_signal_t>& signal_fwd,
+                             const std::vector<hsa_signal_t>& signal_rev) {
   // Obtain time taken for forward copy
-  hsa_amd_profiling_async_copy_time_t async_time_fwd {0};
-  if (HSA_STATUS_SUCCESS !=
-     (status =
-       hsa_amd_profiling_get_async_copy_time(signal_fwd, &async_time_fwd)))
-    print_hsa_status(__FILE__, __LINE__, __func__,
-                   "hsa_amd_profiling_get_async_copy_time(forward)",
-                   status);
+  hsa_amd_profiling_async_copy_time_t async_time_fwd {0, 0};
+  GetCopyInterval(signal_fwd, &async_time_fwd);
   if (bidirectional == false) {
     RVSHSATRACE_
     return(async_time_fwd.end - async_time_fwd.start);
   }
   RVSHSATRACE_
 
-  hsa_amd_profiling_async_copy_time_t async_time_rev {0};
-  if (HSA_STATUS_SUCCESS !=
-     (status =
-        hsa_amd_profiling_get_async_copy_time(signal_rev, &async_time_rev)))
-    print_hsa_status(__FILE__, __LINE__, __func__,
-                   "hsa_amd_profiling_get_async_copy_time(backward)",
-                   status);
+  hsa_amd_profiling_async_copy_time_t async_time_rev {0, 0};
+  GetCopyInterval(signal_rev, &async_time_rev);
   double start = std::min(async_time_fwd.start, async_time_rev.start);
   double end = std::max(async_time_fwd.end, async_time_rev.end);
   double copy_time = end - start;
@@ -594,16 +665,24 @@ double rvs::hsa::GetCopyTime(bool bidirectional,
  * @param SrcBuff  [out] ptr to source buffer
  * @param pDstPool [out] ptr to destination memory pool
  * @param DstBuff  [out] ptr to destination buffer
+ * @param HostMem type of memory used if one of the agents is CPU
  * @return 0 - if successfull, non-zero otherwise
  *
  * */
 int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
                      hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
-                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff) {
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     int HostMem) {
   hsa_status_t status;
   void* srcbuff = nullptr;
   void* dstbuff = nullptr;
 
+  if (HostMem == HOST_MEM_LOCKED_MALLOC || HostMem == HOST_MEM_HUGEPAGE) {
+    RVSHSATRACE_
+    return AllocateLocked(SrcAgent, DstAgent, Size,
+                          pSrcPool, SrcBuff, pDstPool, DstBuff, HostMem);
+  }
+
   // iterate over src pools
   for (size_t i = 0; i < agent_list[SrcAgent].mem_pool_list.size(); i++) {
     RVSHSATRACE_
@@ -613,6 +692,12 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
       continue;
     }
 
+    // not the requested type of host memory, continue
+    if (!CheckPoolType(SrcAgent, i, HostMem)) {
+      RVSHSATRACE_
+      continue;
+    }
+
     RVSHSATRACE_
     // try allocating source buffer
     if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
@@ -633,6 +718,12 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
         continue;
       }
 
+      // not the requested type of host memory, continue
+      if (!CheckPoolType(DstAgent, j, HostMem)) {
+        RVSHSATRACE_
+        continue;
+      }
+
       RVSHSATRACE_
       // check if src agent has access to this dst agent's pool
       hsa_amd_memory_pool_access_t access =
@@ -722,6 +813,319 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
   return -1;
 }
 
+/**
+ * @brief Check if memory pool provides requested type of host memory
+ *
+ * @param AgentIx agent index in agent_list vector
+ * @param PoolIx pool index in agent's mem_pool_list
+ * @param HostMem requested type of host memory
+ * @return 'true' if pool can be used
+ *
+ * */
+bool rvs::hsa::CheckPoolType(int AgentIx, size_t PoolIx, int HostMem) {
+  // memory type applies to host side only
+  if (agent_list[AgentIx].agent_device_type != "CPU") {
+    return true;
+  }
+
+  uint32_t flags = agent_list[AgentIx].pool_flags_list[PoolIx];
+  switch (HostMem) {
+    case HOST_MEM_COARSE:
+      return flags & HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED;
+    case HOST_MEM_FINE:
+      return flags & HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED;
+    default:
+      return true;
+  }
+}
+
+/**
+ * @brief Allocate transfer buffers with host side in locked host memory
+ *
+ * Host side buffer is mmap()-ed by RVS and locked for access by the other
+ * agent. Device side buffer is allocated in the first suitable device pool.
+ *
+ * @param SrcAgent source agent index in agent_list vector
+ * @param DstAgent destination agent index in agent_list vector
+ * @param Size size of data to transfer
+ * @param pSrcPool [out] ptr to source memory pool
+ * @param SrcBuff  [out] ptr to source buffer
+ * @param pDstPool [out] ptr to destination memory pool
+ * @param DstBuff  [out] ptr to destination buffer
+ * @param HostMem HOST_MEM_LOCKED_MALLOC or HOST_MEM_HUGEPAGE
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::AllocateLocked(int SrcAgent, int DstAgent, size_t Size,
+                     hsa_amd_memory_pool_t* pSrcPool, void** SrcBuff,
+                     hsa_amd_memory_pool_t* pDstPool, void** DstBuff,
+                     int HostMem) {
+  hsa_status_t status;
+  bool src_host = agent_list[SrcAgent].agent_device_type == "CPU";
+  bool dst_host = agent_list[DstAgent].agent_device_type == "CPU";
+
+  // locked memory makes sense only between host and device
+  if (src_host == dst_host) {
+    RVSHSATRACE_
+    return Allocate(SrcAgent, DstAgent, Size,
+                    pSrcPool, SrcBuff, pDstPool, DstBuff);
+  }
+
+  int host_ix = src_host ? SrcAgent : DstAgent;
+  int dev_ix = src_host ? DstAgent : SrcAgent;
+
+  void* hostbuff = LockHost(dev_ix, Size, HostMem);
+  if (hostbuff == nullptr) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  for (size_t i = 0; i < agent_list[dev_ix].mem_pool_list.size(); i++) {
+    void* devbuff = nullptr;
+    if (Size > agent_list[dev_ix].max_size_list[i]) {
+      RVSHSATRACE_
+      continue;
+    }
+    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
+                agent_list[dev_ix].mem_pool_list[i], Size, 0, &devbuff))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                   "hsa_amd_memory_pool_allocate()",
+                   status);
+      continue;
+    }
+
+    RVSHSATRACE_
+    // host buffer is not allocated from a pool, report system pool for it
+    *pSrcPool = src_host ? agent_list[host_ix].sys_pool
+                         : agent_list[dev_ix].mem_pool_list[i];
+    *pDstPool = src_host ? agent_list[dev_ix].mem_pool_list[i]
+                         : agent_list[host_ix].sys_pool;
+    *SrcBuff = src_host ? hostbuff : devbuff;
+    *DstBuff = src_host ? devbuff : hostbuff;
+    return 0;
+  }
+
+  RVSHSATRACE_
+  FreeBuffer(hostbuff);
+  return -1;
+}
+
+/**
+ * @brief Map and lock host memory for access by given agent
+ *
+ * For HOST_MEM_HUGEPAGE explicit huge pages are tried first. If none are
+ * available, transparent huge pages are requested on a 2MB aligned region.
+ *
+ * @param AgentIx index in agent_list of the agent accessing the buffer
+ * @param Size size of the buffer
+ * @param HostMem HOST_MEM_LOCKED_MALLOC or HOST_MEM_HUGEPAGE
+ * @return agent address of the buffer, NULL on failure
+ *
+ * */
+void* rvs::hsa::LockHost(int AgentIx, size_t Size, int HostMem) {
+  const size_t huge_page = 2 * 1024 * 1024;
+  hsa_status_t status;
+  locked_buffer_t buff;
+  void* agent_ptr = nullptr;
+  bool thp = false;
+
+  buff.length = Size;
+  buff.base = MAP_FAILED;
+  if (HostMem == HOST_MEM_HUGEPAGE) {
+    buff.length = (Size + huge_page - 1) / huge_page * huge_page;
+    buff.base = mmap(nullptr, buff.length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (buff.base == MAP_FAILED) {
+      RVSHSATRACE_
+      rvs::lp::Log("[RVSHSA] no huge pages reserved, using transparent "
+                   "huge pages", rvs::logdebug);
+      buff.length += huge_page;
+      thp = true;
+    }
+  }
+  if (buff.base == MAP_FAILED) {
+    buff.base = mmap(nullptr, buff.length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (buff.base == MAP_FAILED) {
+    std::string msg = "[RVSHSA] mmap() failed: ";
+    rvs::lp::Log(msg + strerror(errno), rvs::logerror);
+    return nullptr;
+  }
+
+  buff.host = buff.base;
+  if (thp) {
+    // align start of the buffer to huge page boundary
+    uintptr_t addr = reinterpret_cast<uintptr_t>(buff.base);
+    addr = (addr + huge_page - 1) / huge_page * huge_page;
+    buff.host = reinterpret_cast<void*>(addr);
+    madvise(buff.host, buff.length - huge_page, MADV_HUGEPAGE);
+  }
+
+  // fault pages in before locking
+  memset(buff.host, 0, Size);
+
+  if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_lock(buff.host, Size,
+                                          &agent_list[AgentIx].agent, 1,
+                                          &agent_ptr))) {
+    print_hsa_status(__FILE__, __LINE__, __func__,
+                     "hsa_amd_memory_lock()", status);
+    munmap(buff.base, buff.length);
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lk(locked_mutex);
+  locked_list[agent_ptr] = buff;
+  return agent_ptr;
+}
+
+/**
+ * @brief Free buffer allocated with Allocate()
+ *
+ * @param pBuff buffer to free
+ *
+ * */
+void rvs::hsa::FreeBuffer(void* pBuff) {
+  locked_buffer_t buff;
+  {
+    std::lock_guard<std::mutex> lk(locked_mutex);
+    auto it = locked_list.find(pBuff);
+    if (it == locked_list.end()) {
+      hsa_amd_memory_pool_free(pBuff);
+      return;
+    }
+    buff = it->second;
+    locked_list.erase(it);
+  }
+
+  hsa_amd_memory_unlock(buff.host);
+  munmap(buff.base, buff.length);
+}
+
+/**
+ * @brief Get host address of a transfer buffer
+ *
+ * @param pBuff buffer returned by Allocate()
+ * @return host address of locked buffers, pBuff otherwise
+ *
+ * */
+void* rvs::hsa::HostPtr(void* pBuff) {
+  std::lock_guard<std::mutex> lk(locked_mutex);
+  auto it = locked_list.find(pBuff);
+  return it == locked_list.end() ? pBuff : it->second.host;
+}
+
+/**
+ * @brief Get part of a transfer copied by one stripe
+ *
+ * Transfer is split on 4K page boundaries, pages are distributed evenly
+ * over stripes.
+ *
+ * @param Size total transfer size
+ * @param Stripes number of stripes
+ * @param Ix stripe index
+ * @param pOffset [out] offset of the stripe in the buffer
+ * @param pLen [out] number of bytes copied by the stripe
+ *
+ * */
+void rvs::hsa::GetStripe(size_t Size, size_t Stripes, size_t Ix,
+                         size_t* pOffset, size_t* pLen) {
+  size_t pages = (Size + 4095) / 4096;
+  size_t first = Ix * (pages / Stripes) + std::min(Ix, pages % Stripes);
+  size_t count = pages / Stripes + (Ix < pages % Stripes ? 1 : 0);
+  *pOffset = std::min(first * 4096, Size);
+  *pLen = std::min(count * 4096, Size - *pOffset);
+}
+
+/**
+ * @brief Issue async copies of one transfer direction
+ *
+ * Buffer is split into as many contiguous chunks as there are signals, each
+ * copied by its own hsa_amd_memory_async_copy() call. Caller makes sure
+ * there is at least one 4K page per chunk.
+ *
+ * @param DstIx destination agent index in agent_list vector
+ * @param pDst destination buffer
+ * @param SrcIx source agent index in agent_list vector
+ * @param pSrc source buffer
+ * @param Size size of data to transfer
+ * @param Signals signals, one per stripe
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::StartCopy(int DstIx, void* pDst, int SrcIx, void* pSrc,
+                        size_t Size, const std::vector<hsa_signal_t>& Signals) {
+  hsa_status_t status;
+  size_t offset;
+  size_t len;
+  int sts = 0;
+
+  for (size_t i = 0; i < Signals.size(); i++) {
+    GetStripe(Size, Signals.size(), i, &offset, &len);
+    hsa_signal_store_relaxed(Signals[i], 1);
+    if (HSA_STATUS_SUCCESS !=
+       (status = hsa_amd_memory_async_copy(
+                  static_cast<char*>(pDst) + offset, agent_list[DstIx].agent,
+                  static_cast<char*>(pSrc) + offset, agent_list[SrcIx].agent,
+                  len,
+                  0, NULL, Signals[i]))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_memory_async_copy()",
+                status);
+      hsa_signal_store_relaxed(Signals[i], 0);
+      sts = -1;
+    }
+  }
+
+  return sts;
+}
+
+/**
+ * @brief Record device timestamps of completed copies into timeline
+ *
+ * @param pTimeline timeline to record into
+ * @param Transfer sequence number of the transfer
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @param Size total transfer size as given to StartCopy()
+ * @param Reverse 'true' for reverse direction of bidirectional transfer
+ * @param Signals completion signals, one per stripe
+ *
+ * */
+void rvs::hsa::RecordCopies(rvs::timeline* pTimeline, uint32_t Transfer,
+                            uint32_t SrcNode, uint32_t DstNode, size_t Size,
+                            bool Reverse,
+                            const std::vector<hsa_signal_t>& Signals) {
+  hsa_status_t status;
+  size_t offset;
+  size_t len;
+
+  for (size_t i = 0; i < Signals.size(); i++) {
+    GetStripe(Size, Signals.size(), i, &offset, &len);
+
+    hsa_amd_profiling_async_copy_time_t async_time {0, 0};
+    if (HSA_STATUS_SUCCESS !=
+       (status =
+         hsa_amd_profiling_get_async_copy_time(Signals[i], &async_time))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                     "hsa_amd_profiling_get_async_copy_time()",
+                     status);
+      continue;
+    }
+
+    rvs::timeline::event_t event;
+    event.start = async_time.start;
+    event.end = async_time.end;
+    event.size = len;
+    event.src = SrcNode;
+    event.dst = DstNode;
+    event.transfer = Transfer;
+    event.stripe = static_cast<uint16_t>(i);
+    event.reverse = Reverse ? 1 : 0;
+    pTimeline->record(event);
+  }
+}
+
 /**
  * @brief Allocate buffers in source and destination memory pools
  *
@@ -730,13 +1134,20 @@ int rvs::hsa::Allocate(int SrcAgent, int DstAgent, size_t Size,
  * @param Size size of data to transfer
  * @param bidirectional 'true' for bidirectional transfer
  * @param Duration [out] duration of transfer in seconds
+ * @param Stripes number of concurrent copies the transfer is split into
+ * @param pVerifier if not NULL, source buffers are filled with pattern and
+ * destination buffers are submitted to this verifier after the transfer
+ * @param Seed pattern seed for forward transfer (Seed + 1 is used for
+ * reverse one)
+ * @param HostMem type of host memory used for host side buffers
  * @return 0 - if successfull, non-zero otherwise
  *
  * */
 int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
                               size_t Size, bool bidirectional,
-                              double* Duration) {
-  hsa_status_t status;
+                              double* Duration, uint32_t Stripes,
+                              rvs::verifier* pVerifier, uint64_t Seed,
+                              int HostMem, rvs::timeline* pTimeline) {
   int sts;
 
   int32_t src_ix_fwd;
@@ -745,7 +1156,7 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
   hsa_amd_memory_pool_t dst_pool_fwd;
   void* src_ptr_fwd = nullptr;
   void* dst_ptr_fwd = nullptr;
-  hsa_signal_t signal_fwd;
+  std::vector<hsa_signal_t> signal_fwd;
 
   int32_t src_ix_rev;
   int32_t dst_ix_rev;
@@ -753,10 +1164,16 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
   hsa_amd_memory_pool_t dst_pool_rev;
   void* src_ptr_rev = nullptr;
   void* dst_ptr_rev = nullptr;
-  hsa_signal_t signal_rev;
+  std::vector<hsa_signal_t> signal_rev;
 
   RVSHSATRACE_
 
+  // at least one 4K page per stripe
+  Stripes = std::min<size_t>(Stripes, (Size + 4095) / 4096);
+  if (Stripes < 1) {
+    Stripes = 1;
+  }
+
   // given NUMA nodes, find agent indexes
   src_ix_fwd = FindAgent(SrcNode);
   dst_ix_fwd = FindAgent(DstNode);
@@ -771,20 +1188,16 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
   // allocate buffers and grant permissions for forward transfer
   sts = Allocate(src_ix_fwd, dst_ix_fwd, Size,
            &src_pool_fwd, &src_ptr_fwd,
-           &dst_pool_fwd, &dst_ptr_fwd);
+           &dst_pool_fwd, &dst_ptr_fwd, HostMem);
   if (sts) {
     RVSHSATRACE_
     return -1;
   }
 
-  // Create a signal to wait on copy operation
-  if (HSA_STATUS_SUCCESS !=
-     (status = hsa_signal_create(1, 0, NULL, &signal_fwd))) {
-    print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_signal_create()",
-              status);
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
+  // Create signals to wait on copy operation
+  if (CreateSignals(Stripes, &signal_fwd)) {
+      FreeBuffer(src_ptr_fwd);
+      FreeBuffer(dst_ptr_fwd);
       RVSHSATRACE_
       return -1;
   }
@@ -795,118 +1208,658 @@ int rvs::hsa::SendTraffic(uint32_t SrcNode, uint32_t DstNode,
     // allocate buffers and grant permissions for reverse transfer
     sts = Allocate(src_ix_rev, dst_ix_rev, Size,
             &src_pool_rev, &src_ptr_rev,
-            &dst_pool_rev, &dst_ptr_rev);
+            &dst_pool_rev, &dst_ptr_rev, HostMem);
 
     if (sts) {
       RVSHSATRACE_
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
+      FreeBuffer(src_ptr_fwd);
+      FreeBuffer(dst_ptr_fwd);
+      DestroySignals(&signal_fwd);
       return -1;
     }
 
-    // Create a signal to wait on for reverse copy operation
-    if (HSA_STATUS_SUCCESS !=
-       (status = hsa_signal_create(1, 0, NULL, &signal_rev))) {
-      print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_signal_create()",
-              status);
-      hsa_amd_memory_pool_free(src_ptr_fwd);
-      hsa_amd_memory_pool_free(dst_ptr_fwd);
-      hsa_amd_memory_pool_free(src_ptr_rev);
-      hsa_amd_memory_pool_free(dst_ptr_rev);
-      hsa_signal_destroy(signal_fwd);
+    // Create signals to wait on for reverse copy operation
+    if (CreateSignals(Stripes, &signal_rev)) {
+      FreeBuffer(src_ptr_fwd);
+      FreeBuffer(dst_ptr_fwd);
+      FreeBuffer(src_ptr_rev);
+      FreeBuffer(dst_ptr_rev);
+      DestroySignals(&signal_fwd);
       return -1;
     }
   }
 
-  // initiate forward transfer
-  hsa_signal_store_relaxed(signal_fwd, 1);
-  if (HSA_STATUS_SUCCESS !=
-     (status = hsa_amd_memory_async_copy(
-                dst_ptr_fwd, agent_list[dst_ix_fwd].agent,
-                src_ptr_fwd, agent_list[src_ix_fwd].agent,
-                Size,
-                0, NULL, signal_fwd)))
-    print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_amd_memory_async_copy()",
-              status);
-  if (bidirectional) {
+  // fill source buffers with pattern (not part of the timed transfer)
+  if (pVerifier) {
     RVSHSATRACE_
-    // initiate reverse transfer
-    hsa_signal_store_relaxed(signal_rev, 1);
-    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_async_copy(
-        dst_ptr_rev, agent_list[dst_ix_rev].agent,
-        src_ptr_rev, agent_list[src_ix_rev].agent, Size,
-        0, NULL, signal_rev)))
-      print_hsa_status(__FILE__, __LINE__, __func__,
-              "hsa_amd_memory_async_copy()",
-              status);
+    sts = WritePattern(src_ix_fwd, src_ptr_fwd, Size, Seed);
+    if (bidirectional) {
+      sts |= WritePattern(src_ix_rev, src_ptr_rev, Size, Seed + 1);
+    }
   }
 
-  // wait for transfer to complete
-  RVSHSATRACE_
-  hsa_signal_wait_acquire(signal_fwd, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+  if (sts == 0) {
+    // initiate forward transfer
+    sts = StartCopy(dst_ix_fwd, dst_ptr_fwd, src_ix_fwd, src_ptr_fwd,
+                    Size, signal_fwd);
+    if (bidirectional) {
+      RVSHSATRACE_
+      // initiate reverse transfer
+      sts |= StartCopy(dst_ix_rev, dst_ptr_rev, src_ix_rev, src_ptr_rev,
+                       Size, signal_rev);
+    }
+
+    // wait for transfer to complete
+    RVSHSATRACE_
+    for (size_t i = 0; i < signal_fwd.size(); i++) {
+      hsa_signal_wait_acquire(signal_fwd[i], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+    }
+
+    // if bidirectional, also wait for reverse transfer to complete
+    for (size_t i = 0; i < signal_rev.size(); i++) {
+      RVSHSATRACE_
+      hsa_signal_wait_acquire(signal_rev[i], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+    }
 
-  // if bidirectional, also wait for reverse transfer to complete
-  if (bidirectional == true) {
     RVSHSATRACE_
-    hsa_signal_wait_acquire(signal_rev, HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+    // get transfer duration
+    *Duration = GetCopyTime(bidirectional, signal_fwd, signal_rev)/1000000000;
+
+    // keep raw copy intervals of both directions
+    if (pTimeline) {
+      RVSHSATRACE_
+      uint32_t transfer = pTimeline->next_transfer();
+      RecordCopies(pTimeline, transfer, SrcNode, DstNode, Size, false,
+                   signal_fwd);
+      RecordCopies(pTimeline, transfer, DstNode, SrcNode, Size, true,
+                   signal_rev);
+    }
   }
 
-  RVSHSATRACE_
-  // get transfer duration
-  *Duration = GetCopyTime(bidirectional, signal_fwd, signal_rev)/1000000000;
+  // copy destination buffers back to host and queue them for checking
+  if (sts == 0 && pVerifier) {
+    RVSHSATRACE_
+    sts = SubmitCheck(pVerifier, dst_ix_fwd, dst_ptr_fwd, Size, Seed);
+    if (bidirectional) {
+      sts |= SubmitCheck(pVerifier, dst_ix_rev, dst_ptr_rev, Size, Seed + 1);
+    }
+  }
 
-  hsa_amd_memory_pool_free(src_ptr_fwd);
-  hsa_amd_memory_pool_free(dst_ptr_fwd);
-  hsa_signal_destroy(signal_fwd);
+  FreeBuffer(src_ptr_fwd);
+  FreeBuffer(dst_ptr_fwd);
+  DestroySignals(&signal_fwd);
 
   if (bidirectional) {
     RVSHSATRACE_
-    hsa_amd_memory_pool_free(src_ptr_rev);
-    hsa_amd_memory_pool_free(dst_ptr_rev);
-    hsa_signal_destroy(signal_rev);
+    FreeBuffer(src_ptr_rev);
+    FreeBuffer(dst_ptr_rev);
+    DestroySignals(&signal_rev);
   }
   RVSHSATRACE_
 
-  return 0;
+  return sts ? -1 : 0;
 }
 
-
 /**
- * @brief Get peer status between Src and Dst nodes
+ * @brief Measure round trip time of small copies
+ *
+ * Each round trip is a copy from source to destination followed by a copy
+ * back which depends on completion of the first one, so that no host
+ * intervention is needed between them. Round trip time is measured both
+ * with device profiling timestamps (start of the first to end of the
+ * second copy) and with host clock (issue of the first copy to observed
+ * completion of the second one).
  *
  * @param SrcNode source NUMA node
  * @param DstNode destination NUMA node
- * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
+ * @param Size size of data to transfer
+ * @param Count number of round trips
+ * @param pDevice [out] round trip times (usec) based on device timestamps
+ * @param pHost [out] round trip times (usec) based on host clock
+ * @param HostMem type of host memory used if one side is a CPU
+ * @return 0 - if successfull, non-zero otherwise
  *
  * */
-int rvs::hsa::GetPeerStatus(uint32_t SrcNode, uint32_t DstNode) {
-  int32_t srcix;
-  int32_t dstix;
-  std::string msg;
+int rvs::hsa::PingPong(uint32_t SrcNode, uint32_t DstNode, size_t Size,
+                       uint32_t Count, rvs::histogram* pDevice,
+                       rvs::histogram* pHost, int HostMem) {
+  hsa_status_t status;
+  int src_ix = FindAgent(SrcNode);
+  int dst_ix = FindAgent(DstNode);
+  hsa_amd_memory_pool_t src_pool_fwd, dst_pool_fwd;
+  hsa_amd_memory_pool_t src_pool_rev, dst_pool_rev;
+  void* src_ptr_fwd = nullptr;
+  void* dst_ptr_fwd = nullptr;
+  void* src_ptr_rev = nullptr;
+  void* dst_ptr_rev = nullptr;
+  std::vector<hsa_signal_t> signal;
+  int sts = 0;
 
   RVSHSATRACE_
-  // given NUMA nodes, find agent indexes
-  srcix = FindAgent(SrcNode);
-  dstix = FindAgent(DstNode);
-  if (srcix < 0 || dstix < 0) {
+  if (src_ix < 0 || dst_ix < 0) {
     RVSHSATRACE_
-    return 0;
+    return -1;
   }
 
-  int peer_status = GetPeerStatusAgent(agent_list[srcix], agent_list[dstix]);
-
-  msg = "Src: " + std::to_string(SrcNode) + "  Dst: " + std::to_string(DstNode)
-      + "  access: " + std::to_string(peer_status);
-  rvs::lp::Log(msg, rvs::logdebug);
+  if (Allocate(src_ix, dst_ix, Size, &src_pool_fwd, &src_ptr_fwd,
+               &dst_pool_fwd, &dst_ptr_fwd, HostMem)) {
+    RVSHSATRACE_
+    return -1;
+  }
+  if (Allocate(dst_ix, src_ix, Size, &src_pool_rev, &src_ptr_rev,
+               &dst_pool_rev, &dst_ptr_rev, HostMem)) {
+    RVSHSATRACE_
+    FreeBuffer(src_ptr_fwd);
+    FreeBuffer(dst_ptr_fwd);
+    return -1;
+  }
+  if (CreateSignals(2, &signal)) {
+    RVSHSATRACE_
+    FreeBuffer(src_ptr_fwd);
+    FreeBuffer(dst_ptr_fwd);
+    FreeBuffer(src_ptr_rev);
+    FreeBuffer(dst_ptr_rev);
+    return -1;
+  }
 
-  return peer_status;
-}
+  for (uint32_t i = 0; sts == 0 && i < Count; i++) {
+    hsa_signal_store_relaxed(signal[0], 1);
+    hsa_signal_store_relaxed(signal[1], 1);
 
-/**
- * @brief Get peer status between Src and Dst agents
- *
+    auto t0 = std::chrono::steady_clock::now();
+    if (HSA_STATUS_SUCCESS !=
+       (status = hsa_amd_memory_async_copy(
+                  dst_ptr_fwd, agent_list[dst_ix].agent,
+                  src_ptr_fwd, agent_list[src_ix].agent,
+                  Size, 0, NULL, signal[0]))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_memory_async_copy()",
+                status);
+      sts = -1;
+      break;
+    }
+    if (HSA_STATUS_SUCCESS !=
+       (status = hsa_amd_memory_async_copy(
+                  dst_ptr_rev, agent_list[src_ix].agent,
+                  src_ptr_rev, agent_list[dst_ix].agent,
+                  Size, 1, &signal[0], signal[1]))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_memory_async_copy()",
+                status);
+      hsa_signal_wait_acquire(signal[0], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+      sts = -1;
+      break;
+    }
+    hsa_signal_wait_acquire(signal[1], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+    auto t1 = std::chrono::steady_clock::now();
+
+    hsa_amd_profiling_async_copy_time_t interval;
+    if (GetCopyInterval(signal, &interval) == 0) {
+      pDevice->add((interval.end - interval.start) / 1000.0);
+    }
+    pHost->add(std::chrono::duration<double, std::micro>(t1 - t0).count());
+  }
+
+  DestroySignals(&signal);
+  FreeBuffer(src_ptr_fwd);
+  FreeBuffer(dst_ptr_fwd);
+  FreeBuffer(src_ptr_rev);
+  FreeBuffer(dst_ptr_rev);
+
+  return sts;
+}
+
+/**
+ * @brief Run a set of copies in synchronized steps
+ *
+ * In each step all copies are started at the same time and the next step
+ * starts only after all of them have completed. Step time spans from the
+ * earliest start to the latest end of its copies as reported by device
+ * timestamps. Buffers are allocated once and reused in all steps.
+ *
+ * @param Copies list of (source NUMA node, destination NUMA node) pairs
+ * @param Size size of data transferred by each copy
+ * @param Steps number of steps
+ * @param pDurations [out] duration of each step in seconds
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::SendPattern(
+                const std::vector<std::pair<uint32_t, uint32_t>>& Copies,
+                size_t Size, uint32_t Steps, std::vector<double>* pDurations) {
+  std::vector<int> src_ix;
+  std::vector<int> dst_ix;
+  std::vector<void*> src_ptr;
+  std::vector<void*> dst_ptr;
+  std::vector<hsa_signal_t> signal;
+  int sts = 0;
+
+  RVSHSATRACE_
+  pDurations->clear();
+
+  for (size_t i = 0; i < Copies.size(); i++) {
+    hsa_amd_memory_pool_t src_pool;
+    hsa_amd_memory_pool_t dst_pool;
+    void* psrc = nullptr;
+    void* pdst = nullptr;
+    int six = FindAgent(Copies[i].first);
+    int dix = FindAgent(Copies[i].second);
+    if (six < 0 || dix < 0 ||
+        Allocate(six, dix, Size, &src_pool, &psrc, &dst_pool, &pdst)) {
+      RVSHSATRACE_
+      sts = -1;
+      break;
+    }
+    src_ix.push_back(six);
+    dst_ix.push_back(dix);
+    src_ptr.push_back(psrc);
+    dst_ptr.push_back(pdst);
+  }
+
+  if (sts == 0 && CreateSignals(Copies.size(), &signal)) {
+    RVSHSATRACE_
+    sts = -1;
+  }
+
+  for (uint32_t step = 0; sts == 0 && step < Steps; step++) {
+    // one stripe per copy, all copies of the step in flight together
+    for (size_t i = 0; i < signal.size(); i++) {
+      std::vector<hsa_signal_t> sig(1, signal[i]);
+      sts |= StartCopy(dst_ix[i], dst_ptr[i], src_ix[i], src_ptr[i],
+                       Size, sig);
+    }
+
+    RVSHSATRACE_
+    for (size_t i = 0; i < signal.size(); i++) {
+      hsa_signal_wait_acquire(signal[i], HSA_SIGNAL_CONDITION_LT, 1,
+                              uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+    }
+
+    hsa_amd_profiling_async_copy_time_t interval;
+    if (sts == 0 && GetCopyInterval(signal, &interval) == 0) {
+      pDurations->push_back((interval.end - interval.start) / 1e9);
+    } else {
+      RVSHSATRACE_
+      sts = -1;
+    }
+  }
+
+  DestroySignals(&signal);
+  for (size_t i = 0; i < src_ptr.size(); i++) {
+    FreeBuffer(src_ptr[i]);
+    FreeBuffer(dst_ptr[i]);
+  }
+
+  return sts ? -1 : 0;
+}
+
+/**
+ * @brief Create a set of HSA signals
+ *
+ * @param Count number of signals to create
+ * @param pSignals [out] created signals
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::CreateSignals(uint32_t Count,
+                            std::vector<hsa_signal_t>* pSignals) {
+  hsa_status_t status;
+
+  pSignals->clear();
+  for (uint32_t i = 0; i < Count; i++) {
+    hsa_signal_t signal;
+    if (HSA_STATUS_SUCCESS !=
+       (status = hsa_signal_create(1, 0, NULL, &signal))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_signal_create()",
+                status);
+      DestroySignals(pSignals);
+      return -1;
+    }
+    pSignals->push_back(signal);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Destroy a set of HSA signals
+ *
+ * @param pSignals signals to destroy, cleared on return
+ *
+ * */
+void rvs::hsa::DestroySignals(std::vector<hsa_signal_t>* pSignals) {
+  for (size_t i = 0; i < pSignals->size(); i++) {
+    hsa_signal_destroy((*pSignals)[i]);
+  }
+  pSignals->clear();
+}
+
+/**
+ * @brief Find agent used for host staging buffers of given agent
+ *
+ * @param AgentIx index in agent_list of the agent accessing the buffers
+ * @return index in agent_list of the CPU agent with the smallest NUMA
+ * distance to the agent (the agent itself if it is a CPU, the first CPU
+ * agent if none is connected), -1 if there is no CPU agent
+ *
+ * */
+int rvs::hsa::FindHostAgent(int AgentIx) {
+  uint32_t min_distance = NO_CONN;
+  int host_ix = -1;
+
+  if (agent_list[AgentIx].agent_device_type == "CPU") {
+    return AgentIx;
+  }
+
+  for (size_t i = 0; i < agent_list.size(); i++) {
+    if (agent_list[i].agent_device_type != "CPU") {
+      continue;
+    }
+    if (host_ix < 0) {
+      host_ix = i;
+    }
+    // distance in either direction as the copy may be initiated by the GPU
+    topology_entry_t entry;
+    uint32_t distance = NO_CONN;
+    if (GetTopologyEntry(i, AgentIx, &entry) == 0) {
+      distance = entry.distance;
+    }
+    if (distance == NO_CONN && GetTopologyEntry(AgentIx, i, &entry) == 0) {
+      distance = entry.distance;
+    }
+    if (distance < min_distance) {
+      min_distance = distance;
+      host_ix = i;
+    }
+  }
+  return host_ix;
+}
+
+/**
+ * @brief Allocate host staging buffer accessible by given agent
+ *
+ * @param AgentIx index in agent_list of the agent accessing the buffer
+ * @param Size size of the buffer
+ * @param pHostIx [out] index in agent_list of the CPU agent owning the buffer
+ * @return ptr to buffer, NULL if allocation failed
+ *
+ * */
+void* rvs::hsa::AllocateHost(int AgentIx, size_t Size, int* pHostIx) {
+  hsa_status_t status;
+  void* buff = nullptr;
+  int host_ix = FindHostAgent(AgentIx);
+
+  if (host_ix < 0) {
+    RVSHSATRACE_
+    return nullptr;
+  }
+  *pHostIx = host_ix;
+
+  for (size_t i = 0; i < agent_list[host_ix].mem_pool_list.size(); i++) {
+    if (Size > agent_list[host_ix].max_size_list[i]) {
+      continue;
+    }
+    if (HSA_STATUS_SUCCESS != (status = hsa_amd_memory_pool_allocate(
+                agent_list[host_ix].mem_pool_list[i], Size, 0, &buff))) {
+      print_hsa_status(__FILE__, __LINE__, __func__,
+                   "hsa_amd_memory_pool_allocate()",
+                   status);
+      continue;
+    }
+    if (AgentIx != host_ix) {
+      if (HSA_STATUS_SUCCESS != (status = hsa_amd_agents_allow_access(1,
+                                            &agent_list[AgentIx].agent,
+                                            NULL,
+                                            buff))) {
+        print_hsa_status(__FILE__, __LINE__, __func__,
+                "hsa_amd_agents_allow_access()",
+                status);
+        hsa_amd_memory_pool_free(buff);
+        buff = nullptr;
+        continue;
+      }
+    }
+    return buff;
+  }
+
+  RVSHSATRACE_
+  return nullptr;
+}
+
+/**
+ * @brief Free buffer allocated with AllocateHost()
+ *
+ * @param pBuff buffer to free
+ *
+ * */
+void rvs::hsa::FreeHost(void* pBuff) {
+  hsa_amd_memory_pool_free(pBuff);
+}
+
+/**
+ * @brief Get host staging buffer accessible by given agent
+ *
+ * Buffers returned by ReleaseStaging() are reused, so that a worker
+ * repeating transfers of the same size does not allocate on every
+ * transfer. Idle buffers of the agent with another size are freed first, as
+ * the worker has moved on to the next transfer size.
+ *
+ * @param AgentIx index in agent_list of the agent accessing the buffer
+ * @param Size size of the buffer
+ * @param pHostIx [out] index in agent_list of the CPU agent owning the buffer
+ * @return ptr to buffer, NULL if allocation failed
+ *
+ * */
+void* rvs::hsa::GetStaging(int AgentIx, size_t Size, int* pHostIx) {
+  staging_buffer_t buff;
+  vector<void*> stale;
+
+  {
+    std::lock_guard<std::mutex> lk(staging_mutex);
+    for (auto it = staging_free.begin(); it != staging_free.end(); ) {
+      if (it->agent_ix != AgentIx) {
+        ++it;
+      } else if (it->size == Size) {
+        buff = *it;
+        staging_free.erase(it);
+        staging_used[buff.ptr] = buff;
+        *pHostIx = buff.host_ix;
+        return buff.ptr;
+      } else {
+        stale.push_back(it->ptr);
+        it = staging_free.erase(it);
+      }
+    }
+  }
+  for (auto it = stale.begin(); it != stale.end(); ++it) {
+    FreeHost(*it);
+  }
+
+  buff.ptr = AllocateHost(AgentIx, Size, &buff.host_ix);
+  if (buff.ptr == nullptr) {
+    RVSHSATRACE_
+    return nullptr;
+  }
+  buff.agent_ix = AgentIx;
+  buff.size = Size;
+
+  std::lock_guard<std::mutex> lk(staging_mutex);
+  staging_used[buff.ptr] = buff;
+  *pHostIx = buff.host_ix;
+  return buff.ptr;
+}
+
+/**
+ * @brief Return buffer obtained with GetStaging() for reuse
+ *
+ * Up to RVS_HSA_STAGING_SPARE idle buffers are kept per agent, the rest is
+ * freed.
+ *
+ * @param pBuff buffer to release
+ *
+ * */
+void rvs::hsa::ReleaseStaging(void* pBuff) {
+  rvs::hsa* pHsa = Get();
+  {
+    std::lock_guard<std::mutex> lk(pHsa->staging_mutex);
+    auto it = pHsa->staging_used.find(pBuff);
+    if (it != pHsa->staging_used.end()) {
+      staging_buffer_t buff = it->second;
+      pHsa->staging_used.erase(it);
+      size_t spare = std::count_if(pHsa->staging_free.begin(),
+                                   pHsa->staging_free.end(),
+                                   [&buff](const staging_buffer_t& b) {
+                                     return b.agent_ix == buff.agent_ix;
+                                   });
+      if (spare < RVS_HSA_STAGING_SPARE) {
+        pHsa->staging_free.push_back(buff);
+        return;
+      }
+    }
+  }
+  FreeHost(pBuff);
+}
+
+/**
+ * @brief Copy data and wait for completion
+ *
+ * @param DstIx destination agent index in agent_list vector
+ * @param pDst destination buffer
+ * @param SrcIx source agent index in agent_list vector
+ * @param pSrc source buffer
+ * @param Size size of data to copy
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::CopySync(int DstIx, void* pDst, int SrcIx, void* pSrc,
+                       size_t Size) {
+  std::vector<hsa_signal_t> signal;
+  int sts;
+
+  if (CreateSignals(1, &signal)) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  sts = StartCopy(DstIx, pDst, SrcIx, pSrc, Size, signal);
+  hsa_signal_wait_acquire(signal[0], HSA_SIGNAL_CONDITION_LT, 1, uint64_t(-1), HSA_WAIT_STATE_ACTIVE);
+  DestroySignals(&signal);
+
+  return sts;
+}
+
+/**
+ * @brief Fill transfer buffer with verification pattern
+ *
+ * CPU buffers are filled directly, device buffers through a host
+ * staging buffer.
+ *
+ * @param AgentIx index in agent_list of the agent owning the buffer
+ * @param pBuff buffer to fill
+ * @param Size size of the buffer
+ * @param Seed pattern seed
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::WritePattern(int AgentIx, void* pBuff, size_t Size,
+                           uint64_t Seed) {
+  if (agent_list[AgentIx].agent_device_type == "CPU") {
+    rvs::verifier::fill(HostPtr(pBuff), Size, Seed);
+    return 0;
+  }
+
+  int host_ix;
+  void* host = GetStaging(AgentIx, Size, &host_ix);
+  if (host == nullptr) {
+    RVSHSATRACE_
+    return -1;
+  }
+  rvs::verifier::fill(host, Size, Seed);
+  int sts = CopySync(AgentIx, pBuff, host_ix, host, Size);
+  ReleaseStaging(host);
+
+  return sts;
+}
+
+/**
+ * @brief Copy transfer buffer to host and queue it for checking
+ *
+ * @param pVerifier verifier checking the data
+ * @param AgentIx index in agent_list of the agent owning the buffer
+ * @param pBuff transfer buffer
+ * @param Size size of the buffer
+ * @param Seed pattern seed the source buffer was filled with
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::SubmitCheck(rvs::verifier* pVerifier, int AgentIx, void* pBuff,
+                          size_t Size, uint64_t Seed) {
+  int sts = 0;
+  int host_ix;
+  void* host = GetStaging(AgentIx, Size, &host_ix);
+  if (host == nullptr) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  if (agent_list[AgentIx].agent_device_type == "CPU") {
+    memcpy(host, HostPtr(pBuff), Size);
+  } else {
+    sts = CopySync(host_ix, host, AgentIx, pBuff, Size);
+  }
+  if (sts) {
+    ReleaseStaging(host);
+    return sts;
+  }
+
+  rvs::verifier::block_t block;
+  block.data = host;
+  block.size = Size;
+  block.seed = Seed;
+  block.release = &rvs::hsa::ReleaseStaging;
+  pVerifier->submit(block);
+
+  return 0;
+}
+
+
+/**
+ * @brief Get peer status between Src and Dst nodes
+ *
+ * @param SrcNode source NUMA node
+ * @param DstNode destination NUMA node
+ * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
+ *
+ * */
+int rvs::hsa::GetPeerStatus(uint32_t SrcNode, uint32_t DstNode) {
+  int32_t srcix;
+  int32_t dstix;
+  std::string msg;
+
+  RVSHSATRACE_
+  // given NUMA nodes, find agent indexes
+  srcix = FindAgent(SrcNode);
+  dstix = FindAgent(DstNode);
+  if (srcix < 0 || dstix < 0) {
+    RVSHSATRACE_
+    return 0;
+  }
+
+  int peer_status = GetPeerStatusAgent(agent_list[srcix], agent_list[dstix]);
+
+  msg = "Src: " + std::to_string(SrcNode) + "  Dst: " + std::to_string(DstNode)
+      + "  access: " + std::to_string(peer_status);
+  rvs::lp::Log(msg, rvs::logdebug);
+
+  return peer_status;
+}
+
+/**
+ * @brief Get peer status between Src and Dst agents
+ *
+ * Answered from topology matrix built on first use.
+ *
  * @param SrcAgent source agent
  * @param DstAgent destination agent
  * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
@@ -914,6 +1867,28 @@ int rvs::hsa::GetPeerStatus(uint32_t SrcNode, uint32_t DstNode) {
  * */
 int rvs::hsa::GetPeerStatusAgent(const AgentInformation&  SrcAgent,
                                  const AgentInformation&  DstAgent) {
+  topology_entry_t entry;
+
+  RVSHSATRACE_
+  if (GetTopologyEntry(FindAgent(SrcAgent.node), FindAgent(DstAgent.node),
+                       &entry)) {
+    RVSHSATRACE_
+    return 0;
+  }
+
+  return entry.peer_status;
+}
+
+/**
+ * @brief Query HSA runtime for peer status between Src and Dst agents
+ *
+ * @param SrcAgent source agent
+ * @param DstAgent destination agent
+ * @return 0 - no access, 1 - Src can acces Dst, 2 - both have access
+ *
+ * */
+int rvs::hsa::QueryPeerStatus(const AgentInformation&  SrcAgent,
+                              const AgentInformation&  DstAgent) {
   hsa_amd_memory_pool_access_t access_fwd;
   hsa_amd_memory_pool_access_t access_bck;
   hsa_status_t status;
@@ -991,6 +1966,8 @@ int rvs::hsa::GetPeerStatusAgent(const AgentInformation&  SrcAgent,
 /**
  * @brief Get link information between Src and Dst nodes
  *
+ * Answered from topology matrix built on first use.
+ *
  * @param SrcNode source node
  * @param DstNode destination node
  * @param pDistance ptr to NUMA distance
@@ -1000,19 +1977,36 @@ int rvs::hsa::GetPeerStatusAgent(const AgentInformation&  SrcAgent,
  * */
 int rvs::hsa::GetLinkInfo(uint32_t SrcNode, uint32_t DstNode,
                   uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr) {
-  int32_t srcix;
-  int32_t dstix;
-  hsa_status_t sts;
+  topology_entry_t entry;
 
   RVSHSATRACE_
-  // given NUMA nodes, find agent indexes
-  srcix = FindAgent(SrcNode);
-  dstix = FindAgent(DstNode);
-  if (srcix < 0 || dstix < 0) {
+  if (GetTopologyEntry(FindAgent(SrcNode), FindAgent(DstNode), &entry)) {
     RVSHSATRACE_
     return -1;
   }
 
+  *pDistance = entry.distance;
+  *pInfoarr = entry.hops;
+
+  return 0;
+}
+
+/**
+ * @brief Query HSA runtime for link information between Src and Dst agents
+ *
+ * @param SrcIx source agent index in agent_list vector
+ * @param DstIx destination agent index in agent_list vector
+ * @param pDistance ptr to NUMA distance
+ * @param pInfoarr ptr to list of hop infos
+ * @return 0 - OK, non-zero otherwise
+ *
+ * */
+int rvs::hsa::QueryLinkInfo(int SrcIx, int DstIx,
+                  uint32_t* pDistance, std::vector<linkinfo_t>* pInfoarr) {
+  int32_t srcix = SrcIx;
+  int32_t dstix = DstIx;
+  hsa_status_t sts;
+
   RVSHSATRACE_
 
   *pDistance = NO_CONN;
@@ -1055,27 +2049,7 @@ int rvs::hsa::GetLinkInfo(uint32_t SrcNode, uint32_t DstNode,
     *pDistance += (link_info[hopIdx]).numa_distance;
     rvslinkinfo.distance = (link_info[hopIdx]).numa_distance;
     rvslinkinfo.etype = (link_info[hopIdx]).link_type;
-    switch (rvslinkinfo.etype) {
-      case HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT:
-        rvslinkinfo.strtype = "HyperTransport";
-        break;
-      case HSA_AMD_LINK_INFO_TYPE_QPI:
-        rvslinkinfo.strtype = "QPI";
-        break;
-      case HSA_AMD_LINK_INFO_TYPE_PCIE:
-        rvslinkinfo.strtype = "PCIe";
-        break;
-      case HSA_AMD_LINK_INFO_TYPE_INFINBAND:
-        rvslinkinfo.strtype = "InfiniBand";
-        break;
-      case HSA_AMD_LINK_INFO_TYPE_XGMI:
-        rvslinkinfo.strtype = "xGMI";
-        break;
-      default:
-        RVSHSATRACE_
-        rvslinkinfo.strtype = "unknown-"
-                            + std::to_string(rvslinkinfo.etype);
-    }
+    rvslinkinfo.strtype = link_type_name(rvslinkinfo.etype);
     pInfoarr->push_back(rvslinkinfo);
   }
   free(link_info);
@@ -1085,11 +2059,307 @@ int rvs::hsa::GetLinkInfo(uint32_t SrcNode, uint32_t DstNode,
 }
 
 
+/**
+ * @brief Converts HSA link type into its printable name
+ *
+ * @param LinkType type of HSA link
+ * @return link type name
+ *
+ * */
+std::string rvs::hsa::link_type_name(hsa_amd_link_info_type_t LinkType) {
+  switch (LinkType) {
+    case HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT:
+      return "HyperTransport";
+    case HSA_AMD_LINK_INFO_TYPE_QPI:
+      return "QPI";
+    case HSA_AMD_LINK_INFO_TYPE_PCIE:
+      return "PCIe";
+    case HSA_AMD_LINK_INFO_TYPE_INFINBAND:
+      return "InfiniBand";
+    case HSA_AMD_LINK_INFO_TYPE_XGMI:
+      return "xGMI";
+    default:
+      RVSHSATRACE_
+      return "unknown-" + std::to_string(LinkType);
+  }
+}
+
+/**
+ * @brief Convert host memory type name into host_mem_t value
+ *
+ * @param Name one of "default", "coarse", "fine", "locked_malloc" or
+ * "hugepage"
+ * @return host_mem_t value, -1 if name is not recognized
+ *
+ * */
+int rvs::hsa::host_mem_type(const std::string& Name) {
+  const char* names[] = {"default", "coarse", "fine",
+                         "locked_malloc", "hugepage"};
+  for (int i = HOST_MEM_DEFAULT; i <= HOST_MEM_HUGEPAGE; i++) {
+    if (Name == names[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Get name of host memory type
+ *
+ * @param HostMem host_mem_t value
+ * @return name as accepted by host_mem_type()
+ *
+ * */
+std::string rvs::hsa::host_mem_name(int HostMem) {
+  switch (HostMem) {
+    case HOST_MEM_COARSE:
+      return "coarse";
+    case HOST_MEM_FINE:
+      return "fine";
+    case HOST_MEM_LOCKED_MALLOC:
+      return "locked_malloc";
+    case HOST_MEM_HUGEPAGE:
+      return "hugepage";
+    default:
+      return "default";
+  }
+}
+
+/**
+ * @brief Discover connectivity between all pairs of HSA agents
+ *
+ * Queries link hops, NUMA distances and peer access rights for every
+ * (source, destination) pair of agents and stores them into a dense matrix
+ * indexed by agent_list position. Subsequent link and peer queries are
+ * answered from this matrix. Does nothing if the matrix is already there
+ * (discovered or loaded).
+ *
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::BuildTopology() {
+  std::lock_guard<std::mutex> lk(topology_mutex);
+  size_t agent_num = agent_list.size();
+
+  RVSHSATRACE_
+  // another thread may have discovered it while we waited for the lock
+  if (topology_valid) {
+    RVSHSATRACE_
+    return 0;
+  }
+
+  topology.clear();
+  topology.resize(agent_num * agent_num);
+
+  for (size_t i = 0; i < agent_num; i++) {
+    for (size_t j = 0; j < agent_num; j++) {
+      topology_entry_t& entry = topology[i * agent_num + j];
+      if (QueryLinkInfo(i, j, &entry.distance, &entry.hops)) {
+        RVSHSATRACE_
+        entry.distance = NO_CONN;
+        entry.hops.clear();
+      }
+      entry.peer_status = QueryPeerStatus(agent_list[i], agent_list[j]);
+    }
+  }
+  topology_valid = true;
+
+  rvs::lp::Log("[RVSHSA] topology discovered for " +
+               std::to_string(agent_num) + " agents", rvs::logdebug);
+  return 0;
+}
+
+/**
+ * @brief Fetch copy of topology matrix entry, discover topology if needed
+ *
+ * Entry is copied under topology_mutex, so it stays valid while another
+ * thread loads the matrix.
+ *
+ * @param SrcIx source agent index in agent_list vector
+ * @param DstIx destination agent index in agent_list vector
+ * @param pEntry [out] matrix entry
+ * @return 0 - if successfull, non-zero if index is out of range
+ *
+ * */
+int rvs::hsa::GetTopologyEntry(int SrcIx, int DstIx,
+                               topology_entry_t* pEntry) {
+  size_t agent_num = agent_list.size();
+
+  if (SrcIx < 0 || DstIx < 0 ||
+      static_cast<size_t>(SrcIx) >= agent_num ||
+      static_cast<size_t>(DstIx) >= agent_num) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  BuildTopology();
+
+  std::lock_guard<std::mutex> lk(topology_mutex);
+  *pEntry = topology[SrcIx * agent_num + DstIx];
+  return 0;
+}
+
+/**
+ * @brief Save topology matrix into a file
+ *
+ * Agent signature (node, type, number of pools and name) is stored together
+ * with the matrix so that a stale file can be detected when loading.
+ *
+ * @param Filename name of the file
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::SaveTopology(const std::string& Filename) {
+  size_t agent_num = agent_list.size();
+
+  RVSHSATRACE_
+  if (agent_num == 0) {
+    RVSHSATRACE_
+    return -1;
+  }
+  // make sure topology is there before saving
+  BuildTopology();
+
+  std::ofstream ofs(Filename.c_str());
+  if (!ofs.good()) {
+    rvs::lp::Log("[RVSHSA] could not open topology file " + Filename +
+                 " for writing", rvs::logdebug);
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lk(topology_mutex);
+  ofs << "rvs-hsa-topology 1\n";
+  ofs << "agents " << agent_num << "\n";
+  for (size_t i = 0; i < agent_num; i++) {
+    ofs << "agent " << agent_list[i].node << " "
+        << agent_list[i].agent_device_type << " "
+        << agent_list[i].mem_pool_list.size() << " "
+        << agent_list[i].agent_name << "\n";
+  }
+  for (size_t i = 0; i < agent_num; i++) {
+    for (size_t j = 0; j < agent_num; j++) {
+      const topology_entry_t& entry = topology[i * agent_num + j];
+      ofs << "link " << i << " " << j << " " << entry.peer_status << " "
+          << entry.distance << " " << entry.hops.size();
+      for (auto it = entry.hops.begin(); it != entry.hops.end(); ++it) {
+        ofs << " " << static_cast<int>(it->etype) << " " << it->distance;
+      }
+      ofs << "\n";
+    }
+  }
+
+  if (!ofs.good()) {
+    rvs::lp::Log("[RVSHSA] error writing topology file " + Filename,
+                 rvs::logdebug);
+    return -1;
+  }
+
+  rvs::lp::Log("[RVSHSA] topology saved to " + Filename, rvs::logdebug);
+  return 0;
+}
+
+/**
+ * @brief Load topology matrix from a file
+ *
+ * File is accepted only if it describes exactly the agents discovered in
+ * this run. On any mismatch existing topology is left untouched.
+ *
+ * @param Filename name of the file
+ * @return 0 - if successfull, non-zero otherwise
+ *
+ * */
+int rvs::hsa::LoadTopology(const std::string& Filename) {
+  size_t agent_num = agent_list.size();
+  std::string tag;
+  size_t version = 0;
+  size_t file_agent_num = 0;
+
+  RVSHSATRACE_
+  std::ifstream ifs(Filename.c_str());
+  if (!ifs.good()) {
+    rvs::lp::Log("[RVSHSA] could not open topology file " + Filename,
+                 rvs::logdebug);
+    return -1;
+  }
+
+  // header
+  if (!(ifs >> tag >> version) || tag != "rvs-hsa-topology" || version != 1 ||
+      !(ifs >> tag >> file_agent_num) || tag != "agents" ||
+      file_agent_num != agent_num) {
+    rvs::lp::Log("[RVSHSA] topology file " + Filename +
+                 " does not match this system", rvs::logdebug);
+    return -1;
+  }
+
+  // agent signatures
+  for (size_t i = 0; i < agent_num; i++) {
+    uint32_t node;
+    std::string type;
+    size_t pools;
+    std::string name;
+    if (!(ifs >> tag >> node >> type >> pools) || tag != "agent") {
+      RVSHSATRACE_
+      return -1;
+    }
+    std::getline(ifs, name);
+    if (!name.empty() && name[0] == ' ') {
+      name.erase(0, 1);
+    }
+    if (node != agent_list[i].node ||
+        type != agent_list[i].agent_device_type ||
+        pools != agent_list[i].mem_pool_list.size() ||
+        name != agent_list[i].agent_name) {
+      rvs::lp::Log("[RVSHSA] topology file " + Filename +
+                   " does not match this system", rvs::logdebug);
+      return -1;
+    }
+  }
+
+  // connectivity matrix
+  vector<topology_entry_t> loaded(agent_num * agent_num);
+  vector<bool> present(agent_num * agent_num, false);
+  for (size_t k = 0; k < agent_num * agent_num; k++) {
+    size_t i, j, hops;
+    topology_entry_t entry;
+    if (!(ifs >> tag >> i >> j >> entry.peer_status >> entry.distance
+              >> hops) || tag != "link" || i >= agent_num || j >= agent_num) {
+      RVSHSATRACE_
+      rvs::lp::Log("[RVSHSA] topology file " + Filename + " is corrupt",
+                   rvs::logdebug);
+      return -1;
+    }
+    for (size_t h = 0; h < hops; h++) {
+      int etype;
+      linkinfo_t info;
+      if (!(ifs >> etype >> info.distance)) {
+        RVSHSATRACE_
+        return -1;
+      }
+      info.etype = static_cast<hsa_amd_link_info_type_t>(etype);
+      info.strtype = link_type_name(info.etype);
+      entry.hops.push_back(info);
+    }
+    loaded[i * agent_num + j] = entry;
+    present[i * agent_num + j] = true;
+  }
+
+  if (std::find(present.begin(), present.end(), false) != present.end()) {
+    RVSHSATRACE_
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lk(topology_mutex);
+  topology.swap(loaded);
+  topology_valid = true;
+
+  rvs::lp::Log("[RVSHSA] topology loaded from " + Filename, rvs::logdebug);
+  return 0;
+}
+
 void rvs::hsa::PrintTopology() {
   vector<uint16_t> gpuId;
-  hsa_status_t status;
   string log_msg;
-  int j = 0;
+  size_t j = 0;
 
   gpu_get_all_gpu_id(&gpuId);
 
@@ -1101,7 +2371,7 @@ void rvs::hsa::PrintTopology() {
 
   RVSHSATRACE_
   for (uint32_t i = 0; i < agent_list.size(); i++) {
-     if (agent_list[i].agent_device_type == "GPU") {
+     if (agent_list[i].agent_device_type == "GPU" && j < gpuId.size()) {
           std::cout << "\n " << std::left << std::setw(80) << agent_list[i].agent_name <<  std::setw(20) << agent_list[i].agent_device_type << std::setw(10) << agent_list[i].node << gpuId[j++] << "\n";
      }else{
             std::cout << "\n " << std::left << std::setw(80) << agent_list[i].agent_name <<  std::setw(20) << agent_list[i].agent_device_type << std::setw(10) << agent_list[i].node << "N/A " << "\n";
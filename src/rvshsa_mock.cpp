@@ -0,0 +1,893 @@
+/********************************************************************************
+ *
+ * Copyright (c) 2018 ROCm Developer Tools
+ *
+ * MIT LICENSE:
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *******************************************************************************/
+#include "include/rvshsa_mock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hsa/hsa.h"
+#include "hsa/hsa_ext_amd.h"
+
+namespace {
+
+//! emulated HSA agent
+struct mock_agent {
+  //! NUMA node
+  uint32_t node;
+  //! device type
+  hsa_device_type_t type;
+  //! agent name
+  std::string name;
+};
+
+//! emulated memory pool
+struct mock_pool {
+  //! index of owner agent
+  size_t agent_ix;
+  //! pool size in bytes
+  size_t size;
+  //! HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS value
+  uint32_t flags;
+};
+
+//! emulated link between two NUMA nodes
+struct mock_link {
+  //! link type
+  hsa_amd_link_info_type_t type;
+  //! NUMA distance
+  uint32_t distance;
+  //! bandwidth in bytes per nanosecond (same as GBps)
+  double bandwidth;
+  //! latency in nanoseconds
+  double latency;
+};
+
+//! emulated signal
+struct mock_signal {
+  //! signal value
+  std::atomic<hsa_signal_value_t> value;
+  //! protects timestamps and serves the condition variable
+  std::mutex mtx;
+  //! notified on every value change
+  std::condition_variable cv;
+  //! 'true' once an async copy signaling this object has completed
+  bool copy_done;
+  //! start of last async copy (system timestamp)
+  uint64_t copy_start;
+  //! end of last async copy (system timestamp)
+  uint64_t copy_end;
+};
+
+//! async copy waiting for completion
+struct mock_copy {
+  //! modeled start time
+  uint64_t start;
+  //! modeled completion time
+  uint64_t end;
+  //! destination buffer
+  void* dst;
+  //! source buffer
+  const void* src;
+  //! number of bytes
+  size_t size;
+  //! completion signal
+  mock_signal* signal;
+
+  bool operator>(const mock_copy& rhs) const {
+    return end > rhs.end;
+  }
+};
+
+//! async copy waiting for its dependency signals
+struct mock_pending {
+  //! copy to be queued, start and end are set once it is queued
+  mock_copy copy;
+  //! source node
+  uint32_t snode;
+  //! destination node
+  uint32_t dnode;
+  //! link the copy goes over
+  const mock_link* link;
+  //! time the copy was submitted
+  uint64_t submit;
+  //! signals which must drop below 1 before the copy starts
+  std::vector<mock_signal*> deps;
+};
+
+//! complete emulated system
+struct mock_system {
+  std::vector<mock_agent> agents;
+  std::vector<mock_pool> pools;
+  std::map<std::pair<uint32_t, uint32_t>, mock_link> links;
+  std::map<std::pair<uint32_t, uint32_t>, uint64_t> busy_until;
+  std::map<void*, size_t> allocations;
+  std::map<void*, size_t> locked;
+  std::priority_queue<mock_copy, std::vector<mock_copy>,
+                      std::greater<mock_copy> > queue;
+  std::vector<mock_pending> pending;
+  //! size of pending, readable without holding mtx
+  std::atomic<size_t> waiting;
+  bool copy_data;
+  bool profiling;
+  bool stop;
+  int refcount;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::thread engine;
+
+  ~mock_system() {
+    // hsa_shut_down() may never be called, stop copy engine at exit
+    if (engine.joinable()) {
+      {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop = true;
+        cv.notify_all();
+      }
+      engine.join();
+    }
+  }
+};
+
+mock_system sys;
+
+//! built-in model used when RVS_HSA_MOCK_MODEL is not set
+const char* default_model =
+  "agent 0 CPU Mock CPU\n"
+  "agent 1 GPU gfx906\n"
+  "agent 2 GPU gfx906\n"
+  "pool 0 17179869184 kernarg fine\n"
+  "pool 0 17179869184 coarse\n"
+  "pool 1 17163091968 coarse\n"
+  "pool 2 17163091968 coarse\n"
+  "link 0 1 PCIe 20 24 2\n"
+  "link 0 2 PCIe 20 24 2\n"
+  "link 1 2 xGMI 15 46 1\n"
+  "copy_data 1\n";
+
+uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int find_node(uint32_t node) {
+  for (size_t i = 0; i < sys.agents.size(); i++) {
+    if (sys.agents[i].node == node)
+      return i;
+  }
+  return -1;
+}
+
+int agent_ix(hsa_agent_t agent) {
+  if (agent.handle < 1 || agent.handle > sys.agents.size())
+    return -1;
+  return agent.handle - 1;
+}
+
+int pool_ix(hsa_amd_memory_pool_t pool) {
+  if (pool.handle < 1 || pool.handle > sys.pools.size())
+    return -1;
+  return pool.handle - 1;
+}
+
+mock_signal* to_signal(hsa_signal_t signal) {
+  return reinterpret_cast<mock_signal*>(signal.handle);
+}
+
+bool link_type_from_name(const std::string& name,
+                         hsa_amd_link_info_type_t* type) {
+  if (name == "HyperTransport") {
+    *type = HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT;
+  } else if (name == "QPI") {
+    *type = HSA_AMD_LINK_INFO_TYPE_QPI;
+  } else if (name == "PCIe") {
+    *type = HSA_AMD_LINK_INFO_TYPE_PCIE;
+  } else if (name == "InfiniBand") {
+    *type = HSA_AMD_LINK_INFO_TYPE_INFINBAND;
+  } else if (name == "xGMI") {
+    *type = HSA_AMD_LINK_INFO_TYPE_XGMI;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Fetch link between two nodes
+ * @return ptr to link, nullptr if nodes are not connected
+ */
+const mock_link* find_link(uint32_t src, uint32_t dst) {
+  static mock_link local = {HSA_AMD_LINK_INFO_TYPE_HYPERTRANSPORT,
+                            RVS_HSA_MOCK_LOCAL_DISTANCE,
+                            RVS_HSA_MOCK_LOCAL_BANDWIDTH,
+                            RVS_HSA_MOCK_LOCAL_LATENCY * 1000};
+  if (src == dst)
+    return &local;
+
+  auto it = sys.links.find(std::make_pair(src, dst));
+  if (it == sys.links.end())
+    return nullptr;
+  return &it->second;
+}
+
+/**
+ * @brief Parse model description
+ * @param is input stream holding the model
+ * @return 0 - if successfull, non-zero otherwise
+ */
+int parse_model(std::istream& is) {
+  std::string line;
+
+  while (std::getline(is, line)) {
+    size_t pos = line.find('#');
+    if (pos != std::string::npos)
+      line.erase(pos);
+
+    std::istringstream ls(line);
+    std::string tag;
+    if (!(ls >> tag))
+      continue;
+
+    if (tag == "agent") {
+      mock_agent agent;
+      std::string type;
+      if (!(ls >> agent.node >> type))
+        return -1;
+      if (type == "CPU") {
+        agent.type = HSA_DEVICE_TYPE_CPU;
+      } else if (type == "GPU") {
+        agent.type = HSA_DEVICE_TYPE_GPU;
+      } else {
+        return -1;
+      }
+      std::getline(ls >> std::ws, agent.name);
+      if (agent.name.empty() || find_node(agent.node) >= 0)
+        return -1;
+      sys.agents.push_back(agent);
+    } else if (tag == "pool") {
+      mock_pool pool;
+      uint32_t node;
+      std::string attr;
+      if (!(ls >> node >> pool.size))
+        return -1;
+      int ix = find_node(node);
+      if (ix < 0)
+        return -1;
+      pool.agent_ix = ix;
+      pool.flags = 0;
+      while (ls >> attr) {
+        if (attr == "kernarg") {
+          pool.flags |= HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_KERNARG_INIT;
+        } else if (attr == "fine") {
+          pool.flags |= HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED;
+        } else if (attr == "coarse") {
+          pool.flags |= HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_COARSE_GRAINED;
+        } else {
+          return -1;
+        }
+      }
+      sys.pools.push_back(pool);
+    } else if (tag == "link") {
+      mock_link link;
+      uint32_t src, dst;
+      std::string type;
+      double latency_us;
+      if (!(ls >> src >> dst >> type >> link.distance >> link.bandwidth
+               >> latency_us))
+        return -1;
+      if (!link_type_from_name(type, &link.type) || link.bandwidth <= 0 ||
+          find_node(src) < 0 || find_node(dst) < 0 || src == dst)
+        return -1;
+      link.latency = latency_us * 1000;
+      sys.links[std::make_pair(src, dst)] = link;
+      sys.links[std::make_pair(dst, src)] = link;
+    } else if (tag == "copy_data") {
+      int val;
+      if (!(ls >> val))
+        return -1;
+      sys.copy_data = (val != 0);
+    } else {
+      return -1;
+    }
+  }
+
+  return sys.agents.empty() ? -1 : 0;
+}
+
+/**
+ * @brief Load model from file given in RVS_HSA_MOCK_MODEL or use built-in one
+ * @return 0 - if successfull, non-zero otherwise
+ */
+int load_model() {
+  const char* path = getenv(RVS_HSA_MOCK_MODEL_ENV);
+
+  sys.agents.clear();
+  sys.pools.clear();
+  sys.links.clear();
+  sys.busy_until.clear();
+  sys.copy_data = true;
+
+  if (path == nullptr || *path == '\0') {
+    std::istringstream is(default_model);
+    return parse_model(is);
+  }
+
+  std::ifstream ifs(path);
+  if (!ifs.good())
+    return -1;
+  return parse_model(ifs);
+}
+
+/**
+ * @brief Mark copy as completed and decrement its completion signal
+ */
+void complete_copy(const mock_copy& copy) {
+  if (sys.copy_data && copy.size > 0)
+    memcpy(copy.dst, copy.src, copy.size);
+
+  std::lock_guard<std::mutex> lk(copy.signal->mtx);
+  copy.signal->copy_start = copy.start;
+  copy.signal->copy_end = copy.end;
+  copy.signal->copy_done = true;
+  copy.signal->value -= 1;
+  copy.signal->cv.notify_all();
+}
+
+/**
+ * @brief Queue pending copies whose dependencies are satisfied
+ *
+ * A copy is modeled to start once the last dependency completed and the
+ * link direction is free. Copies in the same direction of a link are
+ * serialized in the order they become ready. Must be called with sys.mtx
+ * held.
+ *
+ * @param force queue all pending copies (used on shutdown)
+ */
+void schedule_pending(bool force) {
+  for (auto it = sys.pending.begin(); it != sys.pending.end();) {
+    bool ready = true;
+    for (size_t i = 0; i < it->deps.size() && !force; i++) {
+      if (it->deps[i]->value.load() >= 1) {
+        ready = false;
+        break;
+      }
+    }
+    if (!ready) {
+      ++it;
+      continue;
+    }
+
+    uint64_t start = it->submit;
+    for (size_t i = 0; i < it->deps.size(); i++) {
+      mock_signal* dep = it->deps[i];
+      std::lock_guard<std::mutex> lk(dep->mtx);
+      // signals set by the host count from the moment they are seen
+      start = std::max(start, dep->copy_done ? dep->copy_end : now_ns());
+    }
+
+    uint64_t& busy = sys.busy_until[std::make_pair(it->snode, it->dnode)];
+    mock_copy copy = it->copy;
+    copy.start = std::max(start, busy);
+    copy.end = copy.start + static_cast<uint64_t>(it->link->latency +
+                                                  copy.size /
+                                                  it->link->bandwidth);
+    busy = copy.end;
+    sys.queue.push(copy);
+    it = sys.pending.erase(it);
+  }
+  sys.waiting = sys.pending.size();
+}
+
+/**
+ * @brief Copy engine thread
+ *
+ * Queues submitted copies once their dependencies are satisfied and
+ * completes queued copies in order of their modeled end time. On shutdown,
+ * remaining copies are completed immediately.
+ */
+void engine_run() {
+  std::unique_lock<std::mutex> lk(sys.mtx);
+
+  for (;;) {
+    schedule_pending(sys.stop);
+
+    if (sys.queue.empty()) {
+      if (sys.stop)
+        break;
+      sys.cv.wait(lk);
+      continue;
+    }
+
+    mock_copy copy = sys.queue.top();
+    uint64_t now = now_ns();
+    if (copy.end > now && !sys.stop) {
+      sys.cv.wait_for(lk, std::chrono::nanoseconds(copy.end - now));
+      continue;
+    }
+
+    sys.queue.pop();
+    lk.unlock();
+    complete_copy(copy);
+    lk.lock();
+  }
+}
+
+bool check_condition(hsa_signal_value_t value,
+                     hsa_signal_condition_t condition,
+                     hsa_signal_value_t compare_value) {
+  switch (condition) {
+    case HSA_SIGNAL_CONDITION_EQ:
+      return value == compare_value;
+    case HSA_SIGNAL_CONDITION_NE:
+      return value != compare_value;
+    case HSA_SIGNAL_CONDITION_LT:
+      return value < compare_value;
+    case HSA_SIGNAL_CONDITION_GTE:
+      return value >= compare_value;
+    default:
+      return true;
+  }
+}
+
+hsa_signal_value_t signal_wait(hsa_signal_t signal,
+                               hsa_signal_condition_t condition,
+                               hsa_signal_value_t compare_value,
+                               uint64_t timeout_hint) {
+  mock_signal* s = to_signal(signal);
+  auto pred = [&]() {
+    return check_condition(s->value.load(), condition, compare_value);
+  };
+
+  std::unique_lock<std::mutex> lk(s->mtx);
+  // anything longer than an hour is treated as "wait forever"
+  if (timeout_hint > 3600ull * 1000000000ull) {
+    s->cv.wait(lk, pred);
+  } else {
+    s->cv.wait_for(lk, std::chrono::nanoseconds(timeout_hint), pred);
+  }
+  return s->value.load();
+}
+
+void signal_store(hsa_signal_t signal, hsa_signal_value_t value) {
+  mock_signal* s = to_signal(signal);
+  {
+    std::lock_guard<std::mutex> lk(s->mtx);
+    s->value = value;
+    s->cv.notify_all();
+  }
+
+  // copies may be waiting for this signal; a copy submitted concurrently
+  // is counted before its dependencies are checked, so it cannot be missed
+  if (sys.waiting.load() == 0)
+    return;
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  sys.cv.notify_all();
+}
+
+}  // namespace
+
+
+hsa_status_t hsa_init() {
+  std::lock_guard<std::mutex> lk(sys.mtx);
+
+  if (sys.refcount++ > 0)
+    return HSA_STATUS_SUCCESS;
+
+  if (load_model()) {
+    sys.refcount = 0;
+    return HSA_STATUS_ERROR;
+  }
+
+  sys.profiling = false;
+  sys.stop = false;
+  sys.engine = std::thread(engine_run);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_shut_down() {
+  {
+    std::lock_guard<std::mutex> lk(sys.mtx);
+    if (sys.refcount < 1)
+      return HSA_STATUS_ERROR_NOT_INITIALIZED;
+    if (--sys.refcount > 0)
+      return HSA_STATUS_SUCCESS;
+    sys.stop = true;
+    sys.cv.notify_all();
+  }
+
+  sys.engine.join();
+
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  for (auto it = sys.allocations.begin(); it != sys.allocations.end(); ++it)
+    free(it->first);
+  sys.allocations.clear();
+  sys.locked.clear();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_system_get_info(hsa_system_info_t attribute, void* value) {
+  switch (attribute) {
+    case HSA_SYSTEM_INFO_TIMESTAMP:
+      *static_cast<uint64_t*>(value) = now_ns();
+      return HSA_STATUS_SUCCESS;
+    case HSA_SYSTEM_INFO_TIMESTAMP_FREQUENCY:
+      *static_cast<uint64_t*>(value) = 1000000000ull;
+      return HSA_STATUS_SUCCESS;
+    default:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+}
+
+hsa_status_t hsa_iterate_agents(
+    hsa_status_t (*callback)(hsa_agent_t agent, void* data), void* data) {
+  if (sys.refcount < 1)
+    return HSA_STATUS_ERROR_NOT_INITIALIZED;
+
+  for (size_t i = 0; i < sys.agents.size(); i++) {
+    hsa_agent_t agent;
+    agent.handle = i + 1;
+    hsa_status_t status = callback(agent, data);
+    if (status != HSA_STATUS_SUCCESS)
+      return status;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_agent_get_info(hsa_agent_t agent,
+                                hsa_agent_info_t attribute, void* value) {
+  int ix = agent_ix(agent);
+  if (ix < 0)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  switch (attribute) {
+    case HSA_AGENT_INFO_NAME: {
+      char* name = static_cast<char*>(value);
+      memset(name, 0, 64);
+      strncpy(name, sys.agents[ix].name.c_str(), 63);
+      return HSA_STATUS_SUCCESS;
+    }
+    case HSA_AGENT_INFO_DEVICE:
+      *static_cast<hsa_device_type_t*>(value) = sys.agents[ix].type;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AGENT_INFO_NODE:
+      *static_cast<uint32_t*>(value) = sys.agents[ix].node;
+      return HSA_STATUS_SUCCESS;
+    default:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+}
+
+hsa_status_t hsa_amd_agent_iterate_memory_pools(hsa_agent_t agent,
+    hsa_status_t (*callback)(hsa_amd_memory_pool_t memory_pool, void* data),
+    void* data) {
+  int ix = agent_ix(agent);
+  if (ix < 0)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+
+  for (size_t i = 0; i < sys.pools.size(); i++) {
+    if (sys.pools[i].agent_ix != static_cast<size_t>(ix))
+      continue;
+    hsa_amd_memory_pool_t pool;
+    pool.handle = i + 1;
+    hsa_status_t status = callback(pool, data);
+    if (status != HSA_STATUS_SUCCESS)
+      return status;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_pool_get_info(hsa_amd_memory_pool_t memory_pool,
+                                          hsa_amd_memory_pool_info_t attribute,
+                                          void* value) {
+  int ix = pool_ix(memory_pool);
+  if (ix < 0)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  switch (attribute) {
+    case HSA_AMD_MEMORY_POOL_INFO_SEGMENT:
+      *static_cast<hsa_amd_segment_t*>(value) = HSA_AMD_SEGMENT_GLOBAL;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_MEMORY_POOL_INFO_GLOBAL_FLAGS:
+      *static_cast<uint32_t*>(value) = sys.pools[ix].flags;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_MEMORY_POOL_INFO_SIZE:
+      *static_cast<size_t*>(value) = sys.pools[ix].size;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALLOWED:
+      *static_cast<bool*>(value) = true;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_GRANULE:
+    case HSA_AMD_MEMORY_POOL_INFO_RUNTIME_ALLOC_ALIGNMENT:
+      *static_cast<size_t*>(value) = 4096;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_MEMORY_POOL_INFO_ACCESSIBLE_BY_ALL:
+      *static_cast<bool*>(value) = false;
+      return HSA_STATUS_SUCCESS;
+    default:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+}
+
+hsa_status_t hsa_amd_agent_memory_pool_get_info(
+    hsa_agent_t agent, hsa_amd_memory_pool_t memory_pool,
+    hsa_amd_agent_memory_pool_info_t attribute, void* value) {
+  int aix = agent_ix(agent);
+  int pix = pool_ix(memory_pool);
+  if (aix < 0)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  if (pix < 0)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  const mock_pool& pool = sys.pools[pix];
+  uint32_t src = sys.agents[aix].node;
+  uint32_t dst = sys.agents[pool.agent_ix].node;
+  const mock_link* link = find_link(src, dst);
+
+  switch (attribute) {
+    case HSA_AMD_AGENT_MEMORY_POOL_INFO_ACCESS: {
+      hsa_amd_memory_pool_access_t access;
+      if (src == dst ||
+          (link && (pool.flags & HSA_AMD_MEMORY_POOL_GLOBAL_FLAG_FINE_GRAINED))) {
+        access = HSA_AMD_MEMORY_POOL_ACCESS_ALLOWED_BY_DEFAULT;
+      } else if (link) {
+        access = HSA_AMD_MEMORY_POOL_ACCESS_DISALLOWED_BY_DEFAULT;
+      } else {
+        access = HSA_AMD_MEMORY_POOL_ACCESS_NEVER_ALLOWED;
+      }
+      *static_cast<hsa_amd_memory_pool_access_t*>(value) = access;
+      return HSA_STATUS_SUCCESS;
+    }
+    case HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS:
+      *static_cast<uint32_t*>(value) = (src != dst && link) ? 1 : 0;
+      return HSA_STATUS_SUCCESS;
+    case HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO: {
+      if (src == dst || link == nullptr)
+        return HSA_STATUS_SUCCESS;
+      hsa_amd_memory_pool_link_info_t* info =
+        static_cast<hsa_amd_memory_pool_link_info_t*>(value);
+      memset(info, 0, sizeof(*info));
+      info->min_latency = static_cast<uint32_t>(link->latency);
+      info->max_latency = static_cast<uint32_t>(link->latency);
+      // bandwidth is reported in MBps
+      info->min_bandwidth = static_cast<uint32_t>(link->bandwidth * 1000);
+      info->max_bandwidth = static_cast<uint32_t>(link->bandwidth * 1000);
+      info->link_type = link->type;
+      info->numa_distance = link->distance;
+      return HSA_STATUS_SUCCESS;
+    }
+    default:
+      return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  }
+}
+
+hsa_status_t hsa_amd_memory_pool_allocate(hsa_amd_memory_pool_t memory_pool,
+                                          size_t size, uint32_t flags,
+                                          void** ptr) {
+  (void)flags;
+  int ix = pool_ix(memory_pool);
+  if (ix < 0 || size == 0 || ptr == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  if (size > sys.pools[ix].size)
+    return HSA_STATUS_ERROR_INVALID_ALLOCATION;
+
+  if (posix_memalign(ptr, 4096, size))
+    return HSA_STATUS_ERROR_OUT_OF_RESOURCES;
+
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  sys.allocations[*ptr] = ix;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_pool_free(void* ptr) {
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  auto it = sys.allocations.find(ptr);
+  if (it == sys.allocations.end())
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  free(ptr);
+  sys.allocations.erase(it);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_agents_allow_access(uint32_t num_agents,
+                                         const hsa_agent_t* agents,
+                                         const uint32_t* flags,
+                                         const void* ptr) {
+  (void)flags;
+  if (ptr == nullptr || agents == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  for (uint32_t i = 0; i < num_agents; i++) {
+    if (agent_ix(agents[i]) < 0)
+      return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_lock(void* host_ptr, size_t size,
+                                 hsa_agent_t* agents, int num_agent,
+                                 void** agent_ptr) {
+  if (host_ptr == nullptr || size == 0 || agent_ptr == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  for (int i = 0; agents != nullptr && i < num_agent; i++) {
+    if (agent_ix(agents[i]) < 0)
+      return HSA_STATUS_ERROR_INVALID_AGENT;
+  }
+
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  sys.locked[host_ptr] = size;
+  *agent_ptr = host_ptr;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_memory_unlock(void* host_ptr) {
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  auto it = sys.locked.find(host_ptr);
+  if (it == sys.locked.end())
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+  sys.locked.erase(it);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_signal_create(hsa_signal_value_t initial_value,
+                               uint32_t num_consumers,
+                               const hsa_agent_t* consumers,
+                               hsa_signal_t* signal) {
+  (void)num_consumers;
+  (void)consumers;
+  if (signal == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  mock_signal* s = new mock_signal;
+  s->value = initial_value;
+  s->copy_done = false;
+  s->copy_start = 0;
+  s->copy_end = 0;
+  signal->handle = reinterpret_cast<uint64_t>(s);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_signal_destroy(hsa_signal_t signal) {
+  if (signal.handle == 0)
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+  delete to_signal(signal);
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_signal_value_t hsa_signal_load_relaxed(hsa_signal_t signal) {
+  return to_signal(signal)->value.load();
+}
+
+hsa_signal_value_t hsa_signal_load_scacquire(hsa_signal_t signal) {
+  return to_signal(signal)->value.load();
+}
+
+void hsa_signal_store_relaxed(hsa_signal_t signal, hsa_signal_value_t value) {
+  signal_store(signal, value);
+}
+
+void hsa_signal_store_screlease(hsa_signal_t signal,
+                                hsa_signal_value_t value) {
+  signal_store(signal, value);
+}
+
+hsa_signal_value_t hsa_signal_wait_acquire(hsa_signal_t signal,
+                                           hsa_signal_condition_t condition,
+                                           hsa_signal_value_t compare_value,
+                                           uint64_t timeout_hint,
+                                           hsa_wait_state_t wait_state_hint) {
+  (void)wait_state_hint;
+  return signal_wait(signal, condition, compare_value, timeout_hint);
+}
+
+hsa_signal_value_t hsa_signal_wait_scacquire(hsa_signal_t signal,
+                                             hsa_signal_condition_t condition,
+                                             hsa_signal_value_t compare_value,
+                                             uint64_t timeout_hint,
+                                             hsa_wait_state_t wait_state_hint) {
+  (void)wait_state_hint;
+  return signal_wait(signal, condition, compare_value, timeout_hint);
+}
+
+hsa_status_t hsa_amd_memory_async_copy(void* dst, hsa_agent_t dst_agent,
+                                       const void* src, hsa_agent_t src_agent,
+                                       size_t size, uint32_t num_dep_signals,
+                                       const hsa_signal_t* dep_signals,
+                                       hsa_signal_t completion_signal) {
+  int six = agent_ix(src_agent);
+  int dix = agent_ix(dst_agent);
+  if (six < 0 || dix < 0)
+    return HSA_STATUS_ERROR_INVALID_AGENT;
+  if (completion_signal.handle == 0)
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+
+  uint32_t snode = sys.agents[six].node;
+  uint32_t dnode = sys.agents[dix].node;
+  const mock_link* link = find_link(snode, dnode);
+  if (link == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  // as with the real runtime, the call returns at once, copies still waiting
+  // for dependencies are started by the copy engine thread
+  mock_pending pending;
+  pending.copy.start = pending.copy.end = 0;
+  pending.copy.dst = dst;
+  pending.copy.src = src;
+  pending.copy.size = size;
+  pending.copy.signal = to_signal(completion_signal);
+  pending.snode = snode;
+  pending.dnode = dnode;
+  pending.link = link;
+  pending.submit = now_ns();
+  for (uint32_t i = 0; i < num_dep_signals; i++)
+    pending.deps.push_back(to_signal(dep_signals[i]));
+  {
+    std::lock_guard<std::mutex> lk(pending.copy.signal->mtx);
+    pending.copy.signal->copy_done = false;
+  }
+
+  std::lock_guard<std::mutex> lk(sys.mtx);
+  if (sys.refcount < 1)
+    return HSA_STATUS_ERROR_NOT_INITIALIZED;
+
+  sys.pending.push_back(pending);
+  sys.waiting = sys.pending.size();
+  schedule_pending(false);
+  sys.cv.notify_all();
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_profiling_async_copy_enable(bool enable) {
+  sys.profiling = enable;
+  return HSA_STATUS_SUCCESS;
+}
+
+hsa_status_t hsa_amd_profiling_get_async_copy_time(
+    hsa_signal_t signal, hsa_amd_profiling_async_copy_time_t* time) {
+  if (!sys.profiling)
+    return HSA_STATUS_ERROR;
+  if (signal.handle == 0 || time == nullptr)
+    return HSA_STATUS_ERROR_INVALID_ARGUMENT;
+
+  mock_signal* s = to_signal(signal);
+  std::lock_guard<std::mutex> lk(s->mtx);
+  if (!s->copy_done)
+    return HSA_STATUS_ERROR_INVALID_SIGNAL;
+  time->start = s->copy_start;
+  time->end = s->copy_end;
+  return HSA_STATUS_SUCCESS;
+}